@@ -0,0 +1,176 @@
+#include <fstream>
+#include <cstdio>
+#include "CpuProfiler.h"
+#include "Logger.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/StringUtil.h"
+
+namespace adria
+{
+	namespace
+	{
+		thread_local CpuProfiler::ThreadBuffer* tls_buffer = nullptr;
+
+		Float64 TicksToMicroseconds(Int64 ticks)
+		{
+			static Float64 const ticks_per_microsecond = []()
+			{
+				LARGE_INTEGER frequency;
+				QueryPerformanceFrequency(&frequency);
+				return frequency.QuadPart / 1e6;
+			}();
+			return ticks / ticks_per_microsecond;
+		}
+
+		Char const* CategoryName(CpuProfileCategory category)
+		{
+			switch (category)
+			{
+			case CpuProfileCategory::GfxPass: return "gfx_pass";
+			case CpuProfileCategory::Frame:	  return "frame";
+			case CpuProfileCategory::Cpu:
+			default:
+				return "cpu";
+			}
+		}
+	}
+
+	void CpuProfiler::StartCapture(Uint32 frame_count, std::string const& path)
+	{
+		if (IsCapturing()) return;
+		trace_path = path;
+		frames_left = std::max(frame_count, 1u);
+		capture_begin = Now();
+		frame_begin = capture_begin;
+		current_frame.store(0, std::memory_order_relaxed);
+		capture_id.fetch_add(1, std::memory_order_relaxed);
+		capturing.store(true, std::memory_order_release);
+		ADRIA_LOG(INFO, "CPU profiler capturing %u frames", frames_left);
+	}
+
+	void CpuProfiler::StopCapture()
+	{
+		if (!IsCapturing()) return;
+		capturing.store(false, std::memory_order_release);
+		if (ExportChromeTrace(trace_path)) ADRIA_LOG(INFO, "CPU profiler trace written to %s", trace_path.c_str());
+		else ADRIA_LOG(ERROR, "Failed to write CPU profiler trace to %s", trace_path.c_str());
+	}
+
+	void CpuProfiler::NewFrame()
+	{
+		if (!IsCapturing()) return;
+		Int64 const now = Now();
+		ThreadBuffer* buffer = GetThreadBuffer();
+		Record(buffer, CpuProfileEvent{ .name = "Frame", .begin = frame_begin, .end = now, .frame = current_frame.load(std::memory_order_relaxed),
+										.depth = buffer->depth, .category = CpuProfileCategory::Frame });
+		frame_begin = now;
+		current_frame.fetch_add(1, std::memory_order_relaxed);
+		if (--frames_left == 0) StopCapture();
+	}
+
+	void CpuProfiler::SetThreadName(std::string const& name)
+	{
+		ThreadBuffer* buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		buffer->name = name;
+	}
+
+	Bool CpuProfiler::ExportChromeTrace(std::string const& path)
+	{
+		std::error_code error;
+		fs::create_directories(GetParentPath(path), error);
+		std::ofstream os(path, std::ios::trunc);
+		if (!os) return false;
+
+		Uint32 const current_capture_id = capture_id.load(std::memory_order_relaxed);
+		Uint64 dropped = 0;
+		Char number[64];
+		Bool first = true;
+		auto BeginEvent = [&]()
+		{
+			os << (first ? "\n" : ",\n");
+			first = false;
+		};
+
+		os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		for (std::unique_ptr<ThreadBuffer> const& buffer : buffers)
+		{
+			BeginEvent();
+			os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"args\":{\"name\":";
+			WriteJsonString(os, buffer->name.c_str());
+			os << "}}";
+
+			//capture_id is published after the buffer was reset for that capture, so count can be read after it
+			if (buffer->capture_id.load(std::memory_order_acquire) != current_capture_id) continue;
+			Uint32 const count = buffer->count.load(std::memory_order_acquire);
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				CpuProfileEvent const& event = buffer->events[i];
+				//scopes of an earlier capture that ended during this one
+				if (event.begin < capture_begin) continue;
+
+				BeginEvent();
+				os << "{\"name\":";
+				WriteJsonString(os, event.name);
+				std::snprintf(number, sizeof(number), "%.3f", TicksToMicroseconds(event.begin - capture_begin));
+				os << ",\"cat\":\"" << CategoryName(event.category) << "\",\"ph\":\"X\",\"ts\":" << number;
+				std::snprintf(number, sizeof(number), "%.3f", TicksToMicroseconds(event.end - event.begin));
+				os << ",\"dur\":" << number << ",\"pid\":1,\"tid\":" << buffer->thread_index
+				   << ",\"args\":{\"frame\":" << event.frame << ",\"depth\":" << event.depth << "}}";
+			}
+		}
+		os << "\n]}\n";
+		if (dropped > 0) ADRIA_LOG(WARNING, "CPU profiler dropped %llu events, thread buffers hold %u events", dropped, MAX_EVENTS_PER_THREAD);
+		return (Bool)os;
+	}
+
+	CpuProfiler::ThreadBuffer* CpuProfiler::BeginScope()
+	{
+		ThreadBuffer* buffer = GetThreadBuffer();
+		++buffer->depth;
+		return buffer;
+	}
+
+	void CpuProfiler::EndScope(ThreadBuffer* buffer, Char const* name, Int64 begin, CpuProfileCategory category)
+	{
+		--buffer->depth;
+		if (!IsCapturing()) return;
+		Record(buffer, CpuProfileEvent{ .name = name, .begin = begin, .end = Now(), .frame = current_frame.load(std::memory_order_relaxed),
+										.depth = buffer->depth, .category = category });
+	}
+
+	CpuProfiler::ThreadBuffer* CpuProfiler::GetThreadBuffer()
+	{
+		if (tls_buffer) return tls_buffer;
+
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		std::unique_ptr<ThreadBuffer>& buffer = buffers.emplace_back(std::make_unique<ThreadBuffer>());
+		buffer->thread_index = static_cast<Uint32>(buffers.size() - 1);
+		buffer->name = "Thread " + std::to_string(buffer->thread_index);
+		tls_buffer = buffer.get();
+		return tls_buffer;
+	}
+
+	void CpuProfiler::Record(ThreadBuffer* buffer, CpuProfileEvent const& event)
+	{
+		Uint32 const id = capture_id.load(std::memory_order_relaxed);
+		if (buffer->capture_id.load(std::memory_order_relaxed) != id)
+		{
+			if (!buffer->events) buffer->events = std::make_unique<CpuProfileEvent[]>(MAX_EVENTS_PER_THREAD);
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->dropped.store(0, std::memory_order_relaxed);
+			buffer->capture_id.store(id, std::memory_order_release);
+		}
+
+		Uint32 const index = buffer->count.load(std::memory_order_relaxed);
+		if (index >= MAX_EVENTS_PER_THREAD)
+		{
+			buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		buffer->events[index] = event;
+		buffer->count.store(index + 1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace adria
+{
+	enum class CpuProfileCategory : Uint8
+	{
+		Cpu,
+		GfxPass,	//CPU side of a GfxProfileScope, carries the same name as its GPU timestamps
+		Frame
+	};
+
+	struct CpuProfileEvent
+	{
+		Char const* name;
+		Int64 begin;
+		Int64 end;
+		Uint32 frame;
+		Uint16 depth;
+		CpuProfileCategory category;
+	};
+
+	//Records nested CPU scopes while a capture is running and exports them as a Chrome trace (chrome://tracing, Perfetto).
+	//Every thread writes completed scopes into its own fixed-size buffer, only the exporter reads it, so recording is
+	//a clock read and a store. A thread resets its buffer the first time it records into a new capture.
+	class CpuProfiler
+	{
+		static constexpr Uint32 MAX_EVENTS_PER_THREAD = 1 << 16;
+
+	public:
+		struct ThreadBuffer
+		{
+			std::string name;
+			Uint32 thread_index = 0;
+			Uint16 depth = 0;
+			std::atomic<Uint32> capture_id = 0;
+			std::atomic<Uint32> count = 0;
+			std::atomic<Uint32> dropped = 0;
+			std::unique_ptr<CpuProfileEvent[]> events; //allocated when the thread records its first event
+		};
+
+		//captures the next frame_count frames and writes the trace to trace_path when done
+		void StartCapture(Uint32 frame_count, std::string const& trace_path);
+		void StopCapture();
+		//marks the end of a frame, called once per frame from the main thread
+		void NewFrame();
+		Bool IsCapturing() const { return capturing.load(std::memory_order_acquire); }
+
+		void SetThreadName(std::string const& name);
+		//writes the events of the current or last capture
+		Bool ExportChromeTrace(std::string const& path);
+
+		ThreadBuffer* BeginScope();
+		void EndScope(ThreadBuffer* buffer, Char const* name, Int64 begin, CpuProfileCategory category);
+
+		//raw performance counter ticks, they are converted to time only when exporting
+		static Int64 Now()
+		{
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter(&counter);
+			return counter.QuadPart;
+		}
+
+	private:
+		std::atomic<Bool> capturing = false;
+		std::atomic<Uint32> capture_id = 0;
+		std::atomic<Uint32> current_frame = 0;
+		Uint32 frames_left = 0;
+		Int64 capture_begin = 0;
+		Int64 frame_begin = 0;
+		std::string trace_path;
+
+		std::mutex buffers_mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	private:
+		ThreadBuffer* GetThreadBuffer();
+		void Record(ThreadBuffer* buffer, CpuProfileEvent const& event);
+	};
+	inline CpuProfiler g_CpuProfiler{};
+
+	class CpuProfileScope
+	{
+	public:
+		explicit CpuProfileScope(Char const* name, CpuProfileCategory category = CpuProfileCategory::Cpu)
+		{
+			if (!g_CpuProfiler.IsCapturing()) return;
+			buffer = g_CpuProfiler.BeginScope();
+			this->name = name;
+			this->category = category;
+			begin = CpuProfiler::Now();
+		}
+		~CpuProfileScope()
+		{
+			if (buffer) g_CpuProfiler.EndScope(buffer, name, begin, category);
+		}
+		CpuProfileScope(CpuProfileScope const&) = delete;
+		CpuProfileScope& operator=(CpuProfileScope const&) = delete;
+
+	private:
+		CpuProfiler::ThreadBuffer* buffer = nullptr;
+		Char const* name = nullptr;
+		Int64 begin = 0;
+		CpuProfileCategory category = CpuProfileCategory::Cpu;
+	};
+	#define AdriaCpuProfileScope(name) CpuProfileScope ADRIA_CONCAT(cpu_profile, __COUNTER__)(name)
+}
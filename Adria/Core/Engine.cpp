@@ -3,12 +3,14 @@
 #include "Math/Constants.h"
 #include "Core/Logger.h"
 #include "Core/Paths.h"
+#include "Core/CpuProfiler.h"
 #include "Editor/ImGuiManager.h"
 #include "Graphics/GfxDevice.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/ModelImporter.h"
 #include "Rendering/ShaderManager.h"
-#include "Utilities/ThreadPool.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/FrameArena.h"
 #include "Utilities/Random.h"
 #include "Utilities/Timer.h"
 #include "Utilities/JsonUtil.h"
@@ -74,8 +76,9 @@ namespace adria
 				model_params.FindArray("scale", scale_factors);
 				Matrix scale = XMMatrixScaling(scale_factors[0], scale_factors[1], scale_factors[2]);
 				Matrix transform = rotation * scale * translation;
+				Bool compress_vertices = model_params.FindOr<Bool>("compress_vertices", false);
 
-				config.scene_models.emplace_back(path, tex_path, transform);
+				config.scene_models.emplace_back(path, tex_path, transform, compress_vertices);
 			}
 
 			for (auto&& light_json : lights)
@@ -201,11 +204,20 @@ namespace adria
 
 	using namespace tecs;
 
-	Engine::Engine(EngineInit const& init) : window(init.window), vsync{ init.vsync }, scene_viewport_data{}
+	Engine::Engine(EngineInit const& init) : window(init.window), vsync{ init.vsync }, bake_models{ init.bake_models }, scene_viewport_data{}
 	{
-		g_ThreadPool.Initialize();
+		g_JobSystem.Initialize();
+		tecs::set_parallel_for([](size_t count, size_t grain, void* context, tecs::parallel_body body)
+			{
+				g_JobSystem.ParallelFor((Uint32)count, (Uint32)grain, [context, body](Uint32 begin, Uint32 end) { body(context, begin, end); });
+			});
+
+		//parse the scene file on a worker while the device and shaders are being created
+		std::optional<SceneConfig> scene_config;
+		JobCounter scene_config_counter{};
+		g_JobSystem.Submit([&scene_config, &init]() { scene_config = ParseSceneConfig(init.scene_file); }, scene_config_counter);
 
-		gfx = std::make_unique<GfxDevice>(window);
+		gfx = std::make_unique<GfxDevice>(window, init.headless);
 		g_TextureManager.Initialize(gfx.get());
 		ShaderManager::Initialize(gfx.get());
 		renderer = std::make_unique<Renderer>(reg, gfx.get(), window->Width(), window->Height());
@@ -218,7 +230,7 @@ namespace adria
 		std::ignore = input_events.left_mouse_clicked.Add([this](Int32 mx, Int32 my) { renderer->OnLeftMouseClicked(); });
 		std::ignore = input_events.f5_pressed_event.Add(ShaderManager::CheckIfShadersHaveChanged);
 
-		std::optional<SceneConfig> scene_config = ParseSceneConfig(init.scene_file);
+		g_JobSystem.Wait(scene_config_counter);
 		if (scene_config.has_value())
 		{
 			InitializeScene(scene_config.value());
@@ -238,7 +250,8 @@ namespace adria
 		ShaderManager::Destroy();
 		g_TextureManager.Destroy();
 		gfx = nullptr;
-		g_ThreadPool.Destroy();
+		tecs::set_parallel_for(nullptr);
+		g_JobSystem.Destroy();
 	}
 
 	void Engine::OnWindowEvent(WindowEventData const& data)
@@ -251,6 +264,7 @@ namespace adria
 		static AdriaTimer timer;
 		Float const dt = timer.MarkInSeconds();
 
+		g_CpuProfiler.NewFrame();
 		g_Input.Tick();
 		if (window->IsActive())
 		{
@@ -261,14 +275,17 @@ namespace adria
 
 	void Engine::Update(Float dt)
 	{
+		AdriaCpuProfileScope("Engine::Update");
 		camera->Tick(dt);
 		renderer->SetSceneViewportData(scene_viewport_data);
 		renderer->Tick(camera.get());
+		g_TextureManager.Update();
 		renderer->Update(dt);
 	}
 
 	void Engine::Render(RendererSettings const& settings)
 	{
+		AdriaCpuProfileScope("Engine::Render");
 		renderer->Render(settings);
 		if (editor_active)
 		{
@@ -305,12 +322,27 @@ namespace adria
 	void Engine::Present()
 	{
 		gfx->SwapBuffers(vsync);
+		g_FrameArena.Reset();
 	}
 
 	void Engine::InitializeScene(SceneConfig const& config)
 	{
+		AdriaCpuProfileScope("Engine::InitializeScene");
 		model_importer->LoadSkybox(config.skybox_params);
-		for (auto&& model : config.scene_models) model_importer->ImportModel_GLTF(model);
+		AdriaTimer models_timer;
+		for (ModelParameters model : config.scene_models)
+		{
+			AdriaTimer model_timer;
+			Char const* load_path = "baked";
+			if (bake_models || model_importer->LoadModel_Baked(model).empty())
+			{
+				load_path = "imported";
+				model.bake = bake_models;
+				model_importer->ImportModel_GLTF(model);
+			}
+			ADRIA_LOG(INFO, "Model %s %s in %.3f s", model.model_path.c_str(), load_path, model_timer.ElapsedInSeconds());
+		}
+		ADRIA_LOG(INFO, "Scene models loaded in %.3f s", models_timer.ElapsedInSeconds());
 		for (auto&& light : config.scene_lights) model_importer->LoadLight(light);
 	}
 }
\ No newline at end of file
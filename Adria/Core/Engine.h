@@ -21,6 +21,8 @@ namespace adria
 		Bool vsync = false;
 		Window* window = nullptr;
 		std::string scene_file = "scene.json";
+		Bool bake_models = false; //import the scene models and write their baked packages instead of loading them
+		Bool headless = false; //render with the null device, see GfxDevice
 	};
 
 	struct SceneConfig;
@@ -28,6 +30,7 @@ namespace adria
 	class Engine
 	{
 		friend class Editor;
+		friend class FrameBenchmark;
 
 	public:
 		explicit Engine(EngineInit const&);
@@ -51,6 +54,7 @@ namespace adria
 		std::unique_ptr<ModelImporter> model_importer;
 
 		Bool vsync;
+		Bool bake_models;
 		Bool editor_active = true;
 		SceneViewport scene_viewport_data;
 
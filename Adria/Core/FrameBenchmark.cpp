@@ -0,0 +1,116 @@
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include "FrameBenchmark.h"
+#include "Engine.h"
+#include "Logger.h"
+#include "CpuProfiler.h"
+#include "Graphics/GfxDevice.h"
+#include "Graphics/GfxCommandContext.h"
+#include "Rendering/TextureManager.h"
+#include "Utilities/Timer.h"
+#include "Utilities/FrameArena.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Float FIXED_DT = 1.0f / 60.0f;
+
+		Float Percentile(std::vector<Float> const& sorted_values, Float percentile)
+		{
+			if (sorted_values.empty()) return 0.0f;
+			Uint64 const index = static_cast<Uint64>(percentile * (sorted_values.size() - 1) + 0.5f);
+			return sorted_values[index];
+		}
+	}
+
+	FrameBenchmarkReport FrameBenchmark::Run(RendererSettings const& settings, Uint32 frame_count, Uint32 warmup_frames)
+	{
+		GfxCommandContext* command_context = engine.gfx->GetCommandContext();
+		engine.SetSceneViewportData(std::nullopt);
+
+		while (g_TextureManager.IsStreaming()) RunFrame(settings);
+		for (Uint32 i = 0; i < warmup_frames; ++i) RunFrame(settings);
+
+		FrameBenchmarkReport report{};
+		report.frame_ms.reserve(frame_count);
+		std::unordered_map<std::string, Uint64> pass_indices;
+		command_context->SetRecorder(&recorder);
+		for (Uint32 i = 0; i < frame_count; ++i)
+		{
+			recorder.BeginFrame();
+			Timer<std::chrono::nanoseconds> frame_timer;
+			RunFrame(settings);
+			report.frame_ms.push_back(frame_timer.Elapsed() / 1e6f);
+			recorder.EndFrame();
+
+			report.stats += recorder.GetFrameStats();
+			report.stream_bytes += recorder.GetStream().size();
+			report.arena_block_allocations += g_FrameArena.GetStats().block_allocations;
+			report.heap_allocations += g_FrameArena.GetStats().heap_allocations;
+			report.arena_peak_bytes = std::max(report.arena_peak_bytes, g_FrameArena.GetStats().used_bytes);
+			for (GfxRecordedPass const& recorded_pass : recorder.GetPasses())
+			{
+				auto [it, inserted] = pass_indices.try_emplace(recorded_pass.name, report.passes.size());
+				if (inserted) report.passes.push_back(FrameBenchmarkPass{ .name = recorded_pass.name, .depth = recorded_pass.depth });
+
+				FrameBenchmarkPass& pass = report.passes[it->second];
+				++pass.frame_count;
+				pass.total_ms += recorded_pass.cpu_time_ms;
+				pass.max_ms = std::max(pass.max_ms, recorded_pass.cpu_time_ms);
+				pass.stats += recorded_pass.stats;
+			}
+		}
+		command_context->SetRecorder(nullptr);
+		report.last_frame_stream.assign(recorder.GetStream().begin(), recorder.GetStream().end());
+		return report;
+	}
+
+	void FrameBenchmark::Log(FrameBenchmarkReport const& report)
+	{
+		Uint64 const frame_count = report.frame_ms.size();
+		if (frame_count == 0) return;
+
+		std::vector<Float> sorted_ms = report.frame_ms;
+		std::sort(sorted_ms.begin(), sorted_ms.end());
+		Float total_ms = 0.0f;
+		for (Float ms : sorted_ms) total_ms += ms;
+
+		ADRIA_LOG(INFO, "Frame benchmark: %llu frames, CPU ms per frame mean %.3f, min %.3f, median %.3f, p95 %.3f, max %.3f", frame_count,
+			total_ms / frame_count, sorted_ms.front(), Percentile(sorted_ms, 0.5f), Percentile(sorted_ms, 0.95f), sorted_ms.back());
+
+		GfxCommandStats const& stats = report.stats;
+		ADRIA_LOG(INFO, "Per frame: %.1f commands, %.1f draws, %.1f dispatches, %.1f binds, %.1f copies, %.1f clears, %.1f uploads (%.1f KB), stream %.1f KB",
+			(Float)stats.commands / frame_count, (Float)stats.draws / frame_count, (Float)stats.dispatches / frame_count, (Float)stats.binds / frame_count,
+			(Float)stats.copies / frame_count, (Float)stats.clears / frame_count, (Float)stats.uploads / frame_count,
+			stats.uploaded_bytes / 1024.0f / frame_count, report.stream_bytes / 1024.0f / frame_count);
+
+		ADRIA_LOG(INFO, "Frame arena: peak %.1f KB, %llu arena block allocations during the measured frames", report.arena_peak_bytes / 1024.0f, report.arena_block_allocations);
+		ADRIA_LOG(INFO, "Heap: %.1f operator new calls per frame", (Float)report.heap_allocations / frame_count);
+
+		for (FrameBenchmarkPass const& pass : report.passes)
+		{
+			Float const pass_frames = static_cast<Float>(pass.frame_count);
+			ADRIA_LOG(INFO, "%s%s: %u frames, CPU ms mean %.3f, max %.3f, per frame %.1f draws, %.1f dispatches, %.1f binds, %.1f KB uploaded",
+				std::string(pass.depth * 2, ' ').c_str(), pass.name.c_str(), pass.frame_count, pass.total_ms / pass_frames, pass.max_ms,
+				pass.stats.draws / pass_frames, pass.stats.dispatches / pass_frames, pass.stats.binds / pass_frames, pass.stats.uploaded_bytes / 1024.0f / pass_frames);
+		}
+	}
+
+	Bool FrameBenchmark::WriteStream(FrameBenchmarkReport const& report, std::string const& path)
+	{
+		std::ofstream os(path, std::ios::binary);
+		if (!os) return false;
+		os.write(reinterpret_cast<Char const*>(report.last_frame_stream.data()), report.last_frame_stream.size());
+		return (Bool)os;
+	}
+
+	void FrameBenchmark::RunFrame(RendererSettings const& settings)
+	{
+		g_CpuProfiler.NewFrame();
+		engine.Update(FIXED_DT);
+		engine.Render(settings);
+		engine.Present();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Graphics/GfxCommandRecorder.h"
+
+namespace adria
+{
+	class Engine;
+	struct RendererSettings;
+
+	struct FrameBenchmarkPass
+	{
+		std::string name;
+		Uint32 depth = 0;
+		Uint32 frame_count = 0; //frames the pass ran in
+		Float total_ms = 0.0f;
+		Float max_ms = 0.0f;
+		GfxCommandStats stats;
+	};
+
+	struct FrameBenchmarkReport
+	{
+		std::vector<Float> frame_ms;
+		std::vector<FrameBenchmarkPass> passes; //in the order they first ran
+		GfxCommandStats stats;					//summed over all measured frames
+		Uint64 stream_bytes = 0;
+		Uint64 arena_block_allocations = 0; //frame arena blocks allocated during the measured frames, zero in a steady state
+		Uint64 arena_peak_bytes = 0;
+		Uint64 heap_allocations = 0; //every operator new call during the measured frames, not only the arena's
+		std::vector<Uint8> last_frame_stream;
+	};
+
+	//Runs engine frames with a fixed time step and records each one through a GfxCommandRecorder. Meant for a headless engine,
+	//where the null driver leaves only the CPU cost of a frame: culling, sorting, constant buffer updates and state setting.
+	class FrameBenchmark
+	{
+	public:
+		explicit FrameBenchmark(Engine& engine) : engine(engine) {}
+
+		//frames are measured once texture streaming is done and warmup_frames have been rendered
+		FrameBenchmarkReport Run(RendererSettings const& settings, Uint32 frame_count, Uint32 warmup_frames = 16);
+
+		static void Log(FrameBenchmarkReport const& report);
+		static Bool WriteStream(FrameBenchmarkReport const& report, std::string const& path);
+
+	private:
+		Engine& engine;
+		GfxCommandRecorder recorder;
+
+	private:
+		void RunFrame(RendererSettings const& settings);
+	};
+}
@@ -1,6 +1,9 @@
 #include <chrono>
 #include <ctime>   
 #include <iostream>
+#include <cstdio>
+#include <charconv>
+#include <string_view>
 #include "Logger.h"
 #include "Core/Windows.h"
 #include "Core/Paths.h"
@@ -36,24 +39,228 @@ namespace adria
 		return "[File: " + std::string(file) + "  Line: " + std::to_string(line) + "]";
 	}
 
-	LogManager::LogManager() : log_thread(&LogManager::ProcessLogs, this)
-	{}
+	namespace
+	{
+		class LogArgReader
+		{
+		public:
+			LogArgReader(Uint8 const* data, Uint64 size) : data(data), size(size) {}
+
+			Bool Read(LogArgType& type, Uint64& value, std::string_view& str)
+			{
+				if (offset + 1 > size) return false;
+				type = static_cast<LogArgType>(data[offset++]);
+				if (type == LogArgType::String)
+				{
+					Uint32 length = 0;
+					std::memcpy(&length, data + offset, sizeof(length));
+					offset += sizeof(length);
+					str = std::string_view(reinterpret_cast<Char const*>(data + offset), length);
+					offset += length;
+				}
+				else
+				{
+					std::memcpy(&value, data + offset, sizeof(value));
+					offset += sizeof(value);
+				}
+				return true;
+			}
+
+		private:
+			Uint8 const* data;
+			Uint64 size;
+			Uint64 offset = 0;
+		};
+
+		template<typename T>
+		void AppendFormatted(std::string& out, Char const* spec, T value)
+		{
+			Int32 const length = snprintf(nullptr, 0, spec, value);
+			if (length <= 0) return;
+			Uint64 const offset = out.size();
+			out.resize(offset + length);
+			snprintf(out.data() + offset, length + 1, spec, value);
+		}
+
+		//replays printf formatting one conversion at a time, length modifiers are replaced to match the captured argument type
+		void FormatLogRecord(Char const* format, Uint8 const* payload, Uint64 payload_size, std::string& out)
+		{
+			LogArgReader reader(payload, payload_size);
+			out.clear();
+			for (Char const* c = format; *c;)
+			{
+				if (*c != '%') { out.push_back(*c++); continue; }
+				if (c[1] == '%') { out.push_back('%'); c += 2; continue; }
+
+				//the spec is rebuilt with '*' width and precision replaced by the values read from the payload
+				Char const* spec_begin = c++;
+				Char spec[64] = { '%' };
+				Char* spec_tail = spec + 1;
+				Char* const spec_limit = spec + sizeof(spec) - 8; //room for the length modifier, conversion and terminator
+				Bool missing_argument = false, invalid_argument = false;
+				auto CopySpec = [&](Char const* begin, Char const* end)
+				{
+					Uint64 const length = std::min<Uint64>(end - begin, spec_limit - spec_tail);
+					std::memcpy(spec_tail, begin, length);
+					spec_tail += length;
+				};
+				auto ReadStarArgument = [&](Int64& star_value)
+				{
+					LogArgType star_type{};
+					Uint64 star_bits = 0;
+					std::string_view star_str;
+					if (!reader.Read(star_type, star_bits, star_str)) missing_argument = true;
+					else if (star_type != LogArgType::Int && star_type != LogArgType::Uint) invalid_argument = true;
+					star_value = static_cast<Int64>(star_bits);
+				};
+
+				Char const* field_begin = c;
+				while (*c && std::strchr("-+ #0", *c)) ++c;
+				CopySpec(field_begin, c);
+				if (*c == '*')
+				{
+					++c;
+					Int64 width = 0;
+					ReadStarArgument(width);
+					spec_tail = std::to_chars(spec_tail, spec_limit, width).ptr;
+				}
+				else
+				{
+					field_begin = c;
+					while (*c >= '0' && *c <= '9') ++c;
+					CopySpec(field_begin, c);
+				}
+				if (*c == '.')
+				{
+					++c;
+					if (*c == '*')
+					{
+						++c;
+						Int64 precision = 0;
+						ReadStarArgument(precision);
+						//a negative precision is taken as if it was omitted
+						if (precision >= 0 && spec_tail < spec_limit)
+						{
+							*spec_tail++ = '.';
+							spec_tail = std::to_chars(spec_tail, spec_limit, precision).ptr;
+						}
+					}
+					else
+					{
+						field_begin = c - 1;
+						while (*c >= '0' && *c <= '9') ++c;
+						CopySpec(field_begin, c);
+					}
+				}
+				Uint64 const spec_length = spec_tail - spec;
+				while (*c && std::strchr("hljztL", *c)) ++c;
+				Char const conversion = *c;
+				if (!conversion) break;
+				++c;
+
+				LogArgType type{};
+				Uint64 value = 0;
+				std::string_view str;
+				if (missing_argument || !reader.Read(type, value, str))
+				{
+					out.append(spec_begin, c);
+					continue;
+				}
+				if (invalid_argument)
+				{
+					out.append("<invalid log argument>");
+					continue;
+				}
+
+				switch (conversion)
+				{
+				case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+				{
+					if (type != LogArgType::Int && type != LogArgType::Uint) break;
+					*spec_tail++ = 'l'; *spec_tail++ = 'l'; *spec_tail++ = conversion; *spec_tail = '\0';
+					if (type == LogArgType::Int && (conversion == 'd' || conversion == 'i')) AppendFormatted(out, spec, static_cast<long long>(value));
+					else AppendFormatted(out, spec, static_cast<unsigned long long>(value));
+					continue;
+				}
+				case 'c':
+					if (type != LogArgType::Int && type != LogArgType::Uint) break;
+					*spec_tail++ = 'c'; *spec_tail = '\0';
+					AppendFormatted(out, spec, static_cast<Int32>(value));
+					continue;
+				case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+				{
+					if (type != LogArgType::Float) break;
+					Float64 float_value;
+					std::memcpy(&float_value, &value, sizeof(float_value));
+					*spec_tail++ = conversion; *spec_tail = '\0';
+					AppendFormatted(out, spec, float_value);
+					continue;
+				}
+				case 's':
+					if (type != LogArgType::String) break;
+					if (spec_length == 1) out.append(str);
+					else
+					{
+						*spec_tail++ = 's'; *spec_tail = '\0';
+						AppendFormatted(out, spec, std::string(str).c_str());
+					}
+					continue;
+				case 'p':
+					if (type != LogArgType::Pointer) break;
+					*spec_tail++ = 'p'; *spec_tail = '\0';
+					AppendFormatted(out, spec, reinterpret_cast<void const*>(value));
+					continue;
+				}
+				out.append("<invalid log argument>");
+			}
+		}
+	}
+
+	void LogArgWriter::WriteString(Char const* str)
+	{
+		if (!str) str = "(null)";
+		if (size + 1 + sizeof(Uint32) > capacity)
+		{
+			truncated = true;
+			return;
+		}
+		Uint64 length = std::strlen(str);
+		Uint64 const available = capacity - size - 1 - sizeof(Uint32);
+		if (length > available)
+		{
+			length = available;
+			truncated = true;
+		}
+		Uint32 const length32 = static_cast<Uint32>(length);
+		data[size++] = static_cast<Uint8>(LogArgType::String);
+		std::memcpy(data + size, &length32, sizeof(length32));
+		size += sizeof(length32);
+		std::memcpy(data + size, str, length);
+		size += length;
+	}
+
+	LogManager::LogManager() : slots(std::make_unique<LogSlot[]>(SLOT_COUNT))
+	{
+		for (Uint64 i = 0; i < SLOT_COUNT; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+		log_thread = std::thread(&LogManager::ProcessLogs, this);
+	}
 
 	LogManager::~LogManager()
 	{
 		exit.store(true);
+		WakeConsumer();
 		log_thread.join();
 	}
 
 	void LogManager::RegisterLogger(ILogger* logger)
 	{
+		std::lock_guard lock(loggers_mutex);
 		loggers.emplace_back(logger);
 	}
 
 	void LogManager::Log(LogLevel level, Char const* str, Char const* filename, uint32_t line)
 	{
-		QueueEntry entry{ level, str, filename, line };
-		log_queue.Push(std::move(entry));
+		LogFormat(level, filename, line, str);
 	}
 
 	void LogManager::Log(LogLevel level, Char const* str, std::source_location location /*= std::source_location::current()*/)
@@ -61,17 +268,135 @@ namespace adria
 		Log(level, str, location.file_name(), location.line());
 	}
 
+	LogStats LogManager::GetStats() const
+	{
+		LogStats stats{};
+		stats.processed = processed.load(std::memory_order_relaxed);
+		stats.dropped = dropped.load(std::memory_order_relaxed);
+		stats.blocked = blocked.load(std::memory_order_relaxed);
+		stats.truncated = truncated.load(std::memory_order_relaxed);
+		stats.high_water_slots = high_water_slots.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	Uint8* LogManager::GetRecordBuffer()
+	{
+		thread_local std::unique_ptr<Uint8[]> record_buffer = std::make_unique<Uint8[]>(MAX_RECORD_SIZE);
+		return record_buffer.get();
+	}
+
+	void LogManager::Push(LogRecordHeader header, Uint8* record)
+	{
+		Uint64 const record_size = sizeof(LogRecordHeader) + header.payload_size;
+		Uint64 const slot_count = (record_size + SLOT_DATA_SIZE - 1) / SLOT_DATA_SIZE;
+		header.slot_count = static_cast<Uint8>(slot_count);
+
+		//the consumer frees slots in order, so the last slot of a range being free means the whole range is free
+		Uint64 pos = enqueue_pos.load(std::memory_order_relaxed);
+		Bool counted_block = false;
+		while (true)
+		{
+			Uint64 const last = pos + slot_count - 1;
+			Uint64 const sequence = slots[last & SLOT_MASK].sequence.load(std::memory_order_acquire);
+			Int64 const diff = static_cast<Int64>(sequence - last);
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + slot_count, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0)
+			{
+				if (overflow_policy.load(std::memory_order_relaxed) == LogOverflowPolicy::Drop)
+				{
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				if (!counted_block)
+				{
+					blocked.fetch_add(1, std::memory_order_relaxed);
+					counted_block = true;
+				}
+				WakeConsumer();
+				std::this_thread::yield();
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+			else pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+
+		std::memcpy(record, &header, sizeof(LogRecordHeader));
+		for (Uint64 i = 0; i < slot_count; ++i)
+		{
+			Uint64 const offset = i * SLOT_DATA_SIZE;
+			std::memcpy(slots[(pos + i) & SLOT_MASK].data, record + offset, std::min(SLOT_DATA_SIZE, record_size - offset));
+		}
+		for (Uint64 i = 0; i < slot_count; ++i) slots[(pos + i) & SLOT_MASK].sequence.store(pos + i + 1, std::memory_order_release);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (consumer_sleeping.load(std::memory_order_relaxed)) WakeConsumer();
+	}
+
+	void LogManager::WakeConsumer()
+	{
+		std::lock_guard lock(sleep_mutex);
+		sleep_cv.notify_one();
+	}
+
 	void LogManager::ProcessLogs()
 	{
-		QueueEntry entry{};
+		std::vector<Uint8> record(MAX_RECORD_SIZE);
+		std::string message;
 		while (true)
 		{
-			Bool success = log_queue.TryPop(entry);
-			if (success)
+			LogSlot& first_slot = slots[dequeue_pos & SLOT_MASK];
+			if (first_slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+			{
+				if (exit.load() && enqueue_pos.load() == dequeue_pos) break;
+
+				std::unique_lock lock(sleep_mutex);
+				consumer_sleeping.store(true);
+				if (first_slot.sequence.load() != dequeue_pos + 1 && !exit.load()) sleep_cv.wait(lock);
+				consumer_sleeping.store(false);
+				continue;
+			}
+
+			Uint64 const used_slots = enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos;
+			if (used_slots > high_water_slots.load(std::memory_order_relaxed)) high_water_slots.store(used_slots, std::memory_order_relaxed);
+
+			LogRecordHeader header{};
+			std::memcpy(&header, first_slot.data, sizeof(LogRecordHeader));
+			for (Uint64 i = 0; i < header.slot_count; ++i)
+			{
+				LogSlot& slot = slots[(dequeue_pos + i) & SLOT_MASK];
+				while (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + i + 1) std::this_thread::yield();
+				std::memcpy(record.data() + i * SLOT_DATA_SIZE, slot.data, SLOT_DATA_SIZE);
+			}
+			for (Uint64 i = 0; i < header.slot_count; ++i)
+			{
+				slots[(dequeue_pos + i) & SLOT_MASK].sequence.store(dequeue_pos + i + SLOT_COUNT, std::memory_order_release);
+			}
+			dequeue_pos += header.slot_count;
+
+			Uint8 const* payload = record.data() + sizeof(LogRecordHeader);
+			if (header.format) FormatLogRecord(header.format, payload, header.payload_size, message);
+			else
+			{
+				LogArgReader reader(payload, header.payload_size);
+				LogArgType type{};
+				Uint64 value = 0;
+				std::string_view str;
+				reader.Read(type, value, str);
+				message.assign(str);
+			}
+			if (header.truncated)
+			{
+				message += " [truncated]";
+				truncated.fetch_add(1, std::memory_order_relaxed);
+			}
+
 			{
-				for (auto&& logger : loggers) if (logger) logger->Log(entry.level, entry.str.c_str(), entry.filename.c_str(), entry.line);
+				std::lock_guard lock(loggers_mutex);
+				for (auto&& logger : loggers) if (logger) logger->Log(header.level, message.c_str(), header.file, header.line);
 			}
-			if (exit.load() && log_queue.Empty()) break;
+			processed.fetch_add(1, std::memory_order_relaxed);
 		}
 	}
 
@@ -5,7 +5,11 @@
 #include <string>
 #include <fstream>
 #include <source_location>
-#include "Utilities/ConcurrentQueue.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <type_traits>
 
 
 namespace adria
@@ -62,16 +66,109 @@ namespace adria
 		LogLevel const logger_level;
 	};
 
+	enum class LogOverflowPolicy : Uint8
+	{
+		Drop,
+		Block
+	};
+
+	struct LogStats
+	{
+		Uint64 processed = 0;
+		Uint64 dropped = 0;
+		Uint64 blocked = 0;
+		Uint64 truncated = 0;
+		Uint64 high_water_slots = 0;
+	};
+
+	enum class LogArgType : Uint8
+	{
+		Int,
+		Uint,
+		Float,
+		Pointer,
+		String
+	};
+
+	//Serializes printf arguments into a record payload: a type tag followed by the value, strings as a length and their bytes.
+	//Strings that do not fit are cut and the payload is marked as truncated.
+	class LogArgWriter
+	{
+	public:
+		LogArgWriter(Uint8* data, Uint64 capacity) : data(data), capacity(capacity) {}
+
+		template<typename T>
+		void Write(T const& arg)
+		{
+			using U = std::decay_t<T>;
+			if constexpr (std::is_same_v<U, Bool>) WriteValue(LogArgType::Uint, static_cast<Uint64>(arg));
+			else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) WriteValue(LogArgType::Int, static_cast<Int64>(arg));
+			else if constexpr (std::is_integral_v<U>) WriteValue(LogArgType::Uint, static_cast<Uint64>(arg));
+			else if constexpr (std::is_enum_v<U>) Write(static_cast<std::underlying_type_t<U>>(arg));
+			else if constexpr (std::is_floating_point_v<U>) WriteValue(LogArgType::Float, static_cast<Float64>(arg));
+			else if constexpr (std::is_convertible_v<U, Char const*>) WriteString(arg);
+			else if constexpr (std::is_pointer_v<U>) WriteValue(LogArgType::Pointer, reinterpret_cast<Uint64>(arg));
+			else static_assert(!sizeof(U), "Unsupported log argument type!");
+		}
+		void WriteString(Char const* str);
+
+		Uint64 Size() const { return size; }
+		Bool Truncated() const { return truncated; }
+
+	private:
+		Uint8* data;
+		Uint64 capacity;
+		Uint64 size = 0;
+		Bool truncated = false;
+
+	private:
+		template<typename T>
+		void WriteValue(LogArgType type, T value)
+		{
+			if (size + 1 + sizeof(T) > capacity)
+			{
+				truncated = true;
+				return;
+			}
+			data[size++] = static_cast<Uint8>(type);
+			std::memcpy(data + size, &value, sizeof(T));
+			size += sizeof(T);
+		}
+	};
+
+	//Producers copy the format pointer and binary arguments into fixed-size slots of a bounded lock-free ring,
+	//a record takes as many consecutive slots as it needs. The log thread formats records and sleeps while the ring is empty.
+	//Format strings have to outlive the record, a message without arguments is copied and printed as is.
 	class LogManager
 	{
-		struct QueueEntry
+		static constexpr Uint64 SLOT_SIZE = 128;
+		static constexpr Uint64 SLOT_COUNT = 4096;
+		static constexpr Uint64 SLOT_MASK = SLOT_COUNT - 1;
+		static constexpr Uint64 MAX_RECORD_SLOTS = 64;
+		static_assert((SLOT_COUNT & SLOT_MASK) == 0, "Log slot count has to be a power of two!");
+
+		struct LogSlot
 		{
+			std::atomic<Uint64> sequence;
+			Uint8 data[SLOT_SIZE - sizeof(std::atomic<Uint64>)];
+		};
+		static constexpr Uint64 SLOT_DATA_SIZE = sizeof(LogSlot::data);
+
+		struct LogRecordHeader
+		{
+			Char const* format;
+			Char const* file;
+			Uint32 line;
+			Uint32 payload_size;
 			LogLevel level;
-			std::string str;
-			std::string filename;
-			uint32_t line;
+			Uint8 slot_count;
+			Bool truncated;
 		};
+
 	public:
+		static constexpr Uint64 MAX_RECORD_SIZE = MAX_RECORD_SLOTS * SLOT_DATA_SIZE;
+		static constexpr Uint64 MAX_PAYLOAD_SIZE = MAX_RECORD_SIZE - sizeof(LogRecordHeader);
+
 		LogManager();
 		LogManager(LogManager const&) = delete;
 		LogManager& operator=(LogManager const&) = delete;
@@ -83,25 +180,57 @@ namespace adria
 		void Log(LogLevel level, Char const* str, Char const* file, uint32_t line);
 		void Log(LogLevel level, Char const* str, std::source_location location = std::source_location::current());
 
+		template<typename... Args>
+		void LogFormat(LogLevel level, Char const* file, uint32_t line, Char const* format, Args const&... args)
+		{
+			Uint8* record = GetRecordBuffer();
+			LogArgWriter writer(record + sizeof(LogRecordHeader), MAX_PAYLOAD_SIZE);
+			if constexpr (sizeof...(Args) == 0)
+			{
+				writer.WriteString(format);
+				format = nullptr;
+			}
+			else (writer.Write(args), ...);
+			Push(LogRecordHeader{ .format = format, .file = file, .line = line, .payload_size = static_cast<Uint32>(writer.Size()),
+								  .level = level, .slot_count = 0, .truncated = writer.Truncated() }, record);
+		}
+
+		void SetOverflowPolicy(LogOverflowPolicy policy) { overflow_policy.store(policy, std::memory_order_relaxed); }
+		LogStats GetStats() const;
+
 	private:
+		std::unique_ptr<LogSlot[]> slots;
+		alignas(64) std::atomic<Uint64> enqueue_pos = 0;
+		alignas(64) Uint64 dequeue_pos = 0;
+		std::atomic<LogOverflowPolicy> overflow_policy = LogOverflowPolicy::Block;
+
+		std::atomic<Uint64> processed = 0;
+		std::atomic<Uint64> dropped = 0;
+		std::atomic<Uint64> blocked = 0;
+		std::atomic<Uint64> truncated = 0;
+		std::atomic<Uint64> high_water_slots = 0;
+
+		std::atomic<Bool> consumer_sleeping = false;
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+
+		std::mutex loggers_mutex;
 		std::vector<std::unique_ptr<ILogger>> loggers;
-		std::thread log_thread;
-		adria::ConcurrentQueue<QueueEntry> log_queue;
 		std::atomic_bool exit = false;
+		std::thread log_thread;
 
 	private:
+		//per thread staging buffer of MAX_RECORD_SIZE bytes, too large for the caller's stack
+		static Uint8* GetRecordBuffer();
+		//record holds the payload after sizeof(LogRecordHeader) reserved bytes
+		void Push(LogRecordHeader header, Uint8* record);
+		void WakeConsumer();
 		void ProcessLogs();
 	};
 
 	inline LogManager g_log{};
 
 #define ADRIA_REGISTER_LOGGER(logger) g_log.RegisterLogger(logger)
-#define ADRIA_LOG(level, ... ) [&]()  \
-{ \
-	size_t const size = snprintf(nullptr, 0, __VA_ARGS__) + 1; \
-	std::unique_ptr<char[]> buf = std::make_unique<char[]>(size); \
-	snprintf(buf.get(), size, __VA_ARGS__); \
-	g_log.Log(LogLevel::LOG_##level, buf.get(), __FILE__, __LINE__);  \
-}()
+#define ADRIA_LOG(level, ... ) g_log.LogFormat(LogLevel::LOG_##level, __FILE__, __LINE__, __VA_ARGS__)
 
 }
\ No newline at end of file
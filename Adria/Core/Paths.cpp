@@ -15,6 +15,7 @@ namespace adria
 	std::string const paths::ScreenshotsDir = SavedDir + "Screenshots/";
 	std::string const paths::LogDir = SavedDir + "Log/";
 	std::string const paths::ShaderCacheDir = SavedDir + "ShaderCache/";
+	std::string const paths::BakedDir = SavedDir + "Baked/";
 	std::string const paths::IniDir = SavedDir + "Ini/";
 	std::string const paths::ScenesDir = SavedDir + "Scenes/";
 }
@@ -16,6 +16,7 @@ namespace adria::paths
 	extern std::string const LogDir;
 	extern std::string const ScreenshotsDir;
 	extern std::string const ShaderCacheDir;
+	extern std::string const BakedDir;
 	extern std::string const IniDir;
 	extern std::string const ScenesDir;
 }
\ No newline at end of file
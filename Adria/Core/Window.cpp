@@ -78,6 +78,7 @@ namespace adria
 		SetWindowLong(hwnd, GWL_STYLE, GetWindowLong(hwnd, GWL_STYLE) & ~WS_MINIMIZEBOX);
 		SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
 
+		if (init.hidden) return;
 		if (init.maximize) ShowWindow(hwnd, SW_SHOWMAXIMIZED);
 		else ShowWindow(hwnd, SW_SHOWNORMAL);
 
@@ -20,6 +20,7 @@ namespace adria
 		Char const* title;
 		Uint32 width, height;
 		Bool maximize;
+		Bool hidden;
 	};
 
 	DECLARE_EVENT(WindowEvent, Window, WindowEventData const&);
@@ -3,13 +3,16 @@
 #include <nfd.h>
 #include "Core/Logger.h"
 #include "Core/Paths.h"
+#include "Core/CpuProfiler.h"
 #include "Core/Window.h"
 #include "Rendering/Renderer.h"
 #include "Graphics/GfxDevice.h"
 #include "Rendering/ModelImporter.h"
+#include "Rendering/Hierarchy.h"
 #include "Utilities/FilesUtil.h"
 #include "Utilities/StringUtil.h"
 #include "Utilities/Random.h"
+#include "Utilities/FrameArena.h"
 
 using namespace DirectX;
 
@@ -17,27 +20,6 @@ namespace adria
 {
 	using namespace tecs; 
 
-	struct ProfilerState
-	{
-		Bool  show_average;
-		struct AccumulatedTimeStamp
-		{
-			Float sum;
-			Float minimum;
-			Float maximum;
-
-			AccumulatedTimeStamp()
-				: sum(0.0f), minimum(FLT_MAX), maximum(0)
-			{
-			}
-		};
-
-		std::vector<AccumulatedTimeStamp> displayed_timestamps;
-		std::vector<AccumulatedTimeStamp> accumulating_timestamps;
-		Float64 last_reset_time;
-		Uint32 accumulating_frame_count;
-	};
-
     Editor::Editor(EditorInit const& init) : engine()
     {
         engine = std::make_unique<Engine>(init.engine_init);
@@ -59,6 +41,7 @@ namespace adria
 
     void Editor::Run()
     {
+        AdriaCpuProfileScope("Editor::Run");
         HandleInput();
         
         if (gui->IsVisible())
@@ -69,6 +52,7 @@ namespace adria
             engine->gfx->SetBackbuffer();
             gui->Begin();
             {
+				AdriaCpuProfileScope("Editor::Gui");
 				ImGuiID dockspace_id = ImGui::DockSpaceOverViewport(ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
                 MenuBar();
                 ListEntities();
@@ -165,6 +149,7 @@ namespace adria
 			g_Input.SetMouseVisibility(gui->IsVisible());
 		}
 		if (scene_focused && g_Input.IsKeyDown(KeyCode::G)) gizmo_enabled = !gizmo_enabled;
+		if (scene_focused && g_Input.IsKeyDown(KeyCode::Esc)) selected_entity = null_entity;
         if (gizmo_enabled && gui->IsVisible())
         {
             if ( g_Input.IsKeyDown(KeyCode::T)) gizmo_op = ImGuizmo::TRANSLATE;
@@ -562,6 +547,7 @@ namespace adria
 			{
 				engine->reg.destroy<TerrainComponent>();
                 TerrainComponent::terrain = nullptr;
+				engine->reg.compact();
 			}
 			if (ImGui::TreeNodeEx("Terrain Settings", 0))
 			{
@@ -605,6 +591,7 @@ namespace adria
 			if (ImGui::Button("Clear"))
 			{
 				engine->reg.destroy<Ocean>();
+				engine->reg.compact();
 			}
 
 			if (ImGui::TreeNodeEx("Ocean Settings", 0))
@@ -824,10 +811,7 @@ namespace adria
 				{
 					if (relationship)
 					{
-						for (size_t i = 0; i < relationship->children_count; ++i)
-						{
-							ShowEntity(relationship->children[i], false);
-						}
+						ForEachChild(engine->reg, e, [&](entity child) { ShowEntity(child, false); });
 					}
 					ImGui::TreePop();
 				}
@@ -889,6 +873,8 @@ namespace adria
                 auto light = engine->reg.get_if<Light>(selected_entity);
                 if (light && ImGui::CollapsingHeader("Light"))
                 {
+					//the light and its transform are only touched when a widget reports an edit
+					Bool light_changed = false;
 
 					if (light->type == LightType::Directional)			ImGui::Text("Directional Light");
 					else if (light->type == LightType::Spot)			ImGui::Text("Spot Light");
@@ -896,29 +882,31 @@ namespace adria
 
 					Vector4 light_color = light->color, light_direction = light->direction, light_position = light->position;
 					Float color[3] = { light_color.x, light_color.y, light_color.z };
-					ImGui::ColorEdit3("Light Color", color);
-
-					light->color = Vector4(color[0], color[1], color[2], 1.0f);
-
-					ImGui::SliderFloat("Light Energy", &light->energy, 0.0f, 50.0f);
-
-					if (engine->reg.has<Material>(selected_entity))
+					if (ImGui::ColorEdit3("Light Color", color))
 					{
-						auto& material = engine->reg.get<Material>(selected_entity);
-						material.diffuse = Vector3(color[0], color[1], color[2]);
+						light->color = Vector4(color[0], color[1], color[2], 1.0f);
+						if (engine->reg.has<Material>(selected_entity))
+						{
+							auto& material = engine->reg.get<Material>(selected_entity);
+							material.diffuse = Vector3(color[0], color[1], color[2]);
+						}
+						light_changed = true;
 					}
 
+					light_changed |= ImGui::SliderFloat("Light Energy", &light->energy, 0.0f, 50.0f);
+
 					if (light->type == LightType::Directional || light->type == LightType::Spot)
 					{
 						Float direction[3] = { light_direction.x, light_direction.y, light_direction.z };
 
-						ImGui::SliderFloat3("Light direction", direction, -1.0f, 1.0f);
-
-						light->direction = Vector4(direction[0], direction[1], direction[2], 0.0f);
-
-						if (light->type == LightType::Directional)
+						if (ImGui::SliderFloat3("Light direction", direction, -1.0f, 1.0f))
 						{
-							light->position = -light->direction * 1e3;
+							light->direction = Vector4(direction[0], direction[1], direction[2], 0.0f);
+							if (light->type == LightType::Directional)
+							{
+								light->position = -light->direction * 1e3;
+							}
+							light_changed = true;
 						}
 					}
 
@@ -926,67 +914,79 @@ namespace adria
 					{
 						Float inner_angle = XMConvertToDegrees(acos(light->inner_cosine))
 							, outer_angle = XMConvertToDegrees(acos(light->outer_cosine));
-						ImGui::SliderFloat("Inner Spot Angle", &inner_angle, 0.0f, 90.0f);
-						ImGui::SliderFloat("Outer Spot Angle", &outer_angle, inner_angle, 90.0f);
+						Bool angles_changed = ImGui::SliderFloat("Inner Spot Angle", &inner_angle, 0.0f, 90.0f);
+						angles_changed |= ImGui::SliderFloat("Outer Spot Angle", &outer_angle, inner_angle, 90.0f);
 
-						light->inner_cosine = cos(XMConvertToRadians(inner_angle));
-						light->outer_cosine = cos(XMConvertToRadians(outer_angle));
+						if (angles_changed)
+						{
+							light->inner_cosine = cos(XMConvertToRadians(inner_angle));
+							light->outer_cosine = cos(XMConvertToRadians(outer_angle));
+							light_changed = true;
+						}
 					}
 
 					if (light->type == LightType::Point || light->type == LightType::Spot)
 					{
 						Float position[3] = { light_position.x, light_position.y, light_position.z };
 
-						ImGui::SliderFloat3("Light position", position, -300.0f, 500.0f);
-
-						light->position = Vector4(position[0], position[1], position[2], 1.0f);
-
-						ImGui::SliderFloat("Range", &light->range, 50.0f, 1000.0f);
-					}
-
-					if (engine->reg.has<Transform>(selected_entity))
-					{
-						auto& tr = engine->reg.get<Transform>(selected_entity);
+						if (ImGui::SliderFloat3("Light position", position, -300.0f, 500.0f))
+						{
+							light->position = Vector4(position[0], position[1], position[2], 1.0f);
+							light_changed = true;
+						}
 
-						tr.current_transform = XMMatrixTranslationFromVector(light->position);
+						light_changed |= ImGui::SliderFloat("Range", &light->range, 50.0f, 1000.0f);
 					}
 
-					ImGui::Checkbox("Active", &light->active);
-					ImGui::Checkbox("God Rays", &light->god_rays);
+					light_changed |= ImGui::Checkbox("Active", &light->active);
+					light_changed |= ImGui::Checkbox("God Rays", &light->god_rays);
 
 					if (light->god_rays)
 					{
-						ImGui::SliderFloat("God Rays decay", &light->godrays_decay, 0.0f, 1.0f);
-						ImGui::SliderFloat("God Rays weight", &light->godrays_weight, 0.0f, 0.5f);
-						ImGui::SliderFloat("God Rays density", &light->godrays_density, 0.1f, 3.0f);
-						ImGui::SliderFloat("God Rays exposure", &light->godrays_exposure, 0.1f, 10.0f);
+						light_changed |= ImGui::SliderFloat("God Rays decay", &light->godrays_decay, 0.0f, 1.0f);
+						light_changed |= ImGui::SliderFloat("God Rays weight", &light->godrays_weight, 0.0f, 0.5f);
+						light_changed |= ImGui::SliderFloat("God Rays density", &light->godrays_density, 0.1f, 3.0f);
+						light_changed |= ImGui::SliderFloat("God Rays exposure", &light->godrays_exposure, 0.1f, 10.0f);
 					}
 
-					ImGui::Checkbox("Casts Shadows", &light->casts_shadows);
+					light_changed |= ImGui::Checkbox("Casts Shadows", &light->casts_shadows);
 
-					ImGui::Checkbox("Screen Space Contact Shadows", &light->screen_space_contact_shadows);
+					light_changed |= ImGui::Checkbox("Screen Space Contact Shadows", &light->screen_space_contact_shadows);
                     if (light->screen_space_contact_shadows)
                     {
-                        ImGui::SliderFloat("Thickness", &light->sscs_thickness, 0.0f, 1.0f);
-                        ImGui::SliderFloat("Max Ray Distance", &light->sscs_max_ray_distance, 0.0f, 0.3f);
-                        ImGui::SliderFloat("Max Depth Distance", &light->sscs_max_depth_distance, 0.0f, 500.0f);
+                        light_changed |= ImGui::SliderFloat("Thickness", &light->sscs_thickness, 0.0f, 1.0f);
+                        light_changed |= ImGui::SliderFloat("Max Ray Distance", &light->sscs_max_ray_distance, 0.0f, 0.3f);
+                        light_changed |= ImGui::SliderFloat("Max Depth Distance", &light->sscs_max_depth_distance, 0.0f, 500.0f);
                     }
 
-					ImGui::Checkbox("Volumetric Lighting", &light->volumetric);
+					light_changed |= ImGui::Checkbox("Volumetric Lighting", &light->volumetric);
 					if (light->volumetric)
 					{
-						ImGui::SliderFloat("Volumetric lighting Strength", &light->volumetric_strength, 0.0f, 5.0f);
+						light_changed |= ImGui::SliderFloat("Volumetric lighting Strength", &light->volumetric_strength, 0.0f, 5.0f);
 					}
 
-					ImGui::Checkbox("Lens Flare", &light->lens_flare);
+					light_changed |= ImGui::Checkbox("Lens Flare", &light->lens_flare);
 
 					if (light->type == LightType::Directional && light->casts_shadows)
 					{
 						Bool use_cascades = static_cast<Bool>(light->use_cascades);
-						ImGui::Checkbox("Use Cascades", &use_cascades);
-						light->use_cascades = use_cascades;
+						if (ImGui::Checkbox("Use Cascades", &use_cascades))
+						{
+							light->use_cascades = use_cascades;
+							light_changed = true;
+						}
 					}
 
+					if (light_changed)
+					{
+						engine->reg.touch<Light>(selected_entity);
+						if (engine->reg.has<Transform>(selected_entity))
+						{
+							auto& tr = engine->reg.get<Transform>(selected_entity);
+							tr.current_transform = XMMatrixTranslationFromVector(light->position);
+							engine->reg.touch<Transform>(selected_entity);
+						}
+					}
                 }
 
                 auto material = engine->reg.get_if<Material>(selected_entity);
@@ -1090,22 +1090,21 @@ namespace adria
 						aabb->bounding_box.Transform(aabb->bounding_box, transform->current_transform.Invert());
 						aabb->bounding_box.Transform(aabb->bounding_box, tr);
 						aabb->UpdateBuffer(engine->gfx.get());
+						engine->reg.touch<AABB>(selected_entity);
 					}
 
-					if (Relationship* relationship = engine->reg.get_if<Relationship>(selected_entity))
-					{
-						for (size_t i = 0; i < relationship->children_count; ++i)
+					ForEachChild(engine->reg, selected_entity, [&](entity child)
 						{
-							entity child = relationship->children[i];
 							if (AABB* aabb = engine->reg.get_if<AABB>(child))
 							{
 								aabb->bounding_box.Transform(aabb->bounding_box, transform->current_transform.Invert());
 								aabb->bounding_box.Transform(aabb->bounding_box, tr);
 								aabb->UpdateBuffer(engine->gfx.get());
+								engine->reg.touch<AABB>(child);
 							}
-						}
-					}
+						});
 					transform->current_transform = tr;
+					engine->reg.touch<Transform>(selected_entity);
                 }
 
                 auto skybox = engine->reg.get_if<Skybox>(selected_entity);
@@ -1166,6 +1165,7 @@ namespace adria
 						ImGuizmo::DecomposeMatrixToComponents(tr.m[0], translation, rotation, scale);
 						ImGuizmo::RecomposeMatrixFromComponents(pos, rotation, scale, tr.m[0]);
 						transform->current_transform = tr;
+						engine->reg.touch<Transform>(selected_entity);
 					}
 
 					ImGui::SliderFloat("Velocity Variance", &emitter->velocity_variance, -10.0f, 10.0f);
@@ -1216,7 +1216,7 @@ namespace adria
 						if (result == NFD_OKAY)
 						{
 							std::wstring texture_path = ToWideString(file_path);
-							decal->normal_decal_texture = g_TextureManager.LoadTexture(texture_path);
+							decal->normal_decal_texture = g_TextureManager.LoadTexture(texture_path, TexturePlaceholder::FlatNormal);
 							free(file_path);
 						}
 					}
@@ -1268,6 +1268,12 @@ namespace adria
 
             scene_focused = ImGui::IsWindowFocused();
             ImGui::Image(engine->renderer->GetOffscreenTexture()->SRV(), size);
+            if (ImGui::IsItemClicked() && !ImGuizmo::IsOver())
+            {
+                //a click on empty space keeps the selection, Esc clears it
+                entity picked_entity = engine->renderer->GetLastPickedEntity();
+                if (picked_entity != null_entity) selected_entity = picked_entity;
+            }
             //ImGui::GetForegroundDrawList()->AddRect(v_min, v_max, IM_COL32(255, 0, 0, 255));
 
             ImVec2 mouse_pos = ImGui::GetMousePos();
@@ -1308,22 +1314,21 @@ namespace adria
 					aabb->bounding_box.Transform(aabb->bounding_box, entity_transform.current_transform.Invert());
 					aabb->bounding_box.Transform(aabb->bounding_box, tr);
 					aabb->UpdateBuffer(engine->gfx.get());
+					engine->reg.touch<AABB>(selected_entity);
                 }
                
-				if (Relationship* relationship = engine->reg.get_if<Relationship>(selected_entity))
-				{
-					for (Uint32 i = 0; i < relationship->children_count; ++i)
+				ForEachChild(engine->reg, selected_entity, [&](entity child)
 					{
-						entity child = relationship->children[i];
 						if (AABB* aabb = engine->reg.get_if<AABB>(child))
 						{
 							aabb->bounding_box.Transform(aabb->bounding_box, entity_transform.current_transform.Invert());
 							aabb->bounding_box.Transform(aabb->bounding_box, tr);
 							aabb->UpdateBuffer(engine->gfx.get());
+							engine->reg.touch<AABB>(child);
 						}
-					}
-				}
+					});
 				entity_transform.current_transform = tr;
+				engine->reg.touch<Transform>(selected_entity);
             }
         }
 
@@ -1373,6 +1378,14 @@ namespace adria
 					ImGui::Separator();
 				}
 
+				if (renderer_settings.use_clustered_deferred && ImGui::TreeNodeEx("Clustered Deferred", ImGuiTreeNodeFlags_OpenOnDoubleClick))
+				{
+					ImGui::Checkbox("CPU Light Binning", &renderer_settings.cpu_light_binning);
+
+					ImGui::TreePop();
+					ImGui::Separator();
+				}
+
 				renderer_settings.recreate_initial_spectrum = ImGui::SliderFloat2("Wind Direction", renderer_settings.wind_direction, 0.0f, 50.0f);
 				ImGui::SliderFloat("Wind Speed Factor", &renderer_settings.wind_speed, 0.0f, 100.0f);
 				ImGui::ColorEdit3("Ambient Color", renderer_settings.ambient_color);
@@ -1635,7 +1648,6 @@ namespace adria
 			ImGui::Checkbox("Enable Profiling", &enable_profiling);
 			if (enable_profiling)
 			{
-				static ProfilerState state;
 				static constexpr Uint64 NUM_FRAMES = 128;
 				static Float FRAME_TIME_ARRAY[NUM_FRAMES] = { 0 };
 				static Float RECENT_HIGHEST_FRAME_TIME = 0.0f;
@@ -1643,7 +1655,6 @@ namespace adria
 				static Float FRAME_TIME_GRAPH_MAX_VALUES[ARRAYSIZE(FRAME_TIME_GRAPH_MAX_FPS)] = { 0 };
 				for (Uint64 i = 0; i < ARRAYSIZE(FRAME_TIME_GRAPH_MAX_FPS); ++i) { FRAME_TIME_GRAPH_MAX_VALUES[i] = 1000.f / FRAME_TIME_GRAPH_MAX_FPS[i]; }
 
-				std::vector<Timestamp> time_stamps = engine->renderer->GetProfilerResults();
 				FRAME_TIME_ARRAY[NUM_FRAMES - 1] = 1000.0f / io.Framerate;
 				for (Uint32 i = 0; i < NUM_FRAMES - 1; i++) FRAME_TIME_ARRAY[i] = FRAME_TIME_ARRAY[i + 1];
 				RECENT_HIGHEST_FRAME_TIME = std::max(RECENT_HIGHEST_FRAME_TIME, FRAME_TIME_ARRAY[NUM_FRAMES - 1]);
@@ -1653,7 +1664,10 @@ namespace adria
 				ImGui::Text("FPS        : %d (%.2f ms)", fps, frameTime_ms);
 				if (ImGui::CollapsingHeader("Timings", ImGuiTreeNodeFlags_DefaultOpen))
 				{
-					ImGui::Checkbox("Show Avg/Min/Max", &state.show_average);
+					static Bool show_percentiles = false;
+					static Int32 stats_window = 128;
+					ImGui::Checkbox("Show Percentiles", &show_percentiles);
+					ImGui::SliderInt("Window", &stats_window, 1, (Int32)GfxTimingHistory::HISTORY_SIZE);
 					ImGui::Spacing();
 
 					Uint64 i_max = 0;
@@ -1667,74 +1681,118 @@ namespace adria
 					}
 					ImGui::PlotLines("",FRAME_TIME_ARRAY, NUM_FRAMES, 0, "GPU frame time (ms)", 0.0f, FRAME_TIME_GRAPH_MAX_VALUES[i_max], ImVec2(0, 80));
 
-					constexpr uint32_t avg_timestamp_update_interval = 1000;
-					static auto MillisecondsNow = []()
+					GfxTimingHistory& gpu_timings = engine->renderer->GetGpuTimingHistory();
+					Uint64 last_frame = 0;
+					for (Uint32 i = 0; i < gpu_timings.GetScopeCount(); ++i) last_frame = std::max(last_frame, gpu_timings.GetLastFrame(i));
+
+					Float total_time_ms = 0.0f;
+					for (Uint32 i = 0; i < gpu_timings.GetScopeCount(); ++i)
 					{
-						static LARGE_INTEGER s_frequency;
-						static BOOL s_use_qpc = QueryPerformanceFrequency(&s_frequency);
-						Float64 milliseconds = 0;
-						if (s_use_qpc)
+						//passes that did not run in the last resolved frame
+						if (gpu_timings.GetLastFrame(i) != last_frame) continue;
+						GfxTimingStats const stats = gpu_timings.GetStats(i, stats_window);
+						if (stats.sample_count == 0) continue;
+
+						ImGui::Text("%-18s: %7.2f ms", gpu_timings.GetScopeName(i), stats.last);
+						if (show_percentiles)
 						{
-							LARGE_INTEGER now;
-							QueryPerformanceCounter(&now);
-							milliseconds = Float64(1000.0 * now.QuadPart) / s_frequency.QuadPart;
+							ImGui::SameLine();
+							ImGui::Text("  p50: %7.2f  p95: %7.2f  p99: %7.2f  max: %7.2f ms", stats.p50, stats.p95, stats.p99, stats.max);
 						}
-						else milliseconds = Float64(GetTickCount64());
-						return milliseconds;
-					};
-					const Float64 current_time = MillisecondsNow();
-
-					Bool reset_accumulating_state = false;
-					if ((state.accumulating_frame_count > 1) &&
-						((current_time - state.last_reset_time) > avg_timestamp_update_interval))
+						total_time_ms += stats.last;
+					}
+					ImGui::Text("Total: %7.2f %s", total_time_ms, "ms");
+				}
+				if (ImGui::CollapsingHeader("GPU Budgets"))
+				{
+					GfxTimingHistory& gpu_timings = engine->renderer->GetGpuTimingHistory();
+					for (Uint32 i = 0; i < gpu_timings.GetScopeCount(); ++i)
 					{
-						std::swap(state.displayed_timestamps, state.accumulating_timestamps);
-						for (uint32_t i = 0; i < state.displayed_timestamps.size(); i++)
-						{
-							state.displayed_timestamps[i].sum /= state.accumulating_frame_count;
-						}
-						reset_accumulating_state = true;
+						Float budget_ms = gpu_timings.GetBudget(i);
+						if (ImGui::DragFloat(gpu_timings.GetScopeName(i), &budget_ms, 0.01f, 0.0f, 100.0f, "%.2f ms")) gpu_timings.SetBudget(i, budget_ms);
 					}
-
-					reset_accumulating_state |= (state.accumulating_timestamps.size() != time_stamps.size());
-					if (reset_accumulating_state)
+					if (ImGui::Button("Dump CSV"))
 					{
-						state.accumulating_timestamps.resize(0);
-						state.accumulating_timestamps.resize(time_stamps.size());
-						state.last_reset_time = current_time;
-						state.accumulating_frame_count = 0;
+						std::string const csv_path = paths::SavedDir + "GpuTimings.csv";
+						if (gpu_timings.WriteCsv(csv_path)) ADRIA_LOG(INFO, "GPU timings written to %s", csv_path.c_str());
 					}
-
-					Float total_time_ms = 0.0f;
-					for (Uint64 i = 0; i < time_stamps.size(); i++)
+					ImGui::SameLine();
+					if (ImGui::Button("Dump JSON"))
 					{
-						Float value = time_stamps[i].time_in_ms;
-						Char const* pStrUnit = "ms";
-						ImGui::Text("%-18s: %7.2f %s", time_stamps[i].name.c_str(), value, pStrUnit);
-						if (state.show_average)
-						{
-							if (state.displayed_timestamps.size() == time_stamps.size())
-							{
-								ImGui::SameLine();
-								ImGui::Text("  avg: %7.2f %s", state.displayed_timestamps[i].sum, pStrUnit);
-								ImGui::SameLine();
-								ImGui::Text("  min: %7.2f %s", state.displayed_timestamps[i].minimum, pStrUnit);
-								ImGui::SameLine();
-								ImGui::Text("  max: %7.2f %s", state.displayed_timestamps[i].maximum, pStrUnit);
-							}
-
-							ProfilerState::AccumulatedTimeStamp* pAccumulatingTimeStamp = &state.accumulating_timestamps[i];
-							pAccumulatingTimeStamp->sum += time_stamps[i].time_in_ms;
-							pAccumulatingTimeStamp->minimum = std::min<Float>(pAccumulatingTimeStamp->minimum, time_stamps[i].time_in_ms);
-							pAccumulatingTimeStamp->maximum = std::max<Float>(pAccumulatingTimeStamp->maximum, time_stamps[i].time_in_ms);
-						}
-						total_time_ms += value;
+						std::string const json_path = paths::SavedDir + "GpuTimings.json";
+						if (gpu_timings.WriteJson(json_path)) ADRIA_LOG(INFO, "GPU timings written to %s", json_path.c_str());
 					}
-					ImGui::Text("Total: %7.2f %s", total_time_ms, "ms");
-					state.accumulating_frame_count++;
+				}
+				if (ImGui::CollapsingHeader("Render Queue"))
+				{
+					RenderQueueStats const& gbuffer_stats = engine->renderer->GetRenderQueueStats(RenderQueuePass_GBuffer);
+					ImGui::Text("GBuffer Draws          : %u", gbuffer_stats.draws);
+					ImGui::Text("GBuffer Program Binds  : %u", gbuffer_stats.shader_program_binds);
+					ImGui::Text("GBuffer Raster Binds   : %u", gbuffer_stats.raster_state_binds);
+					ImGui::Text("GBuffer Material Binds : %u", gbuffer_stats.material_binds);
+					ImGui::Text("GBuffer CBuffer Updates: %u", gbuffer_stats.cbuffer_updates);
+					ImGui::Text("Binds Saved            : %u", gbuffer_stats.binds_saved);
+					ImGui::Text("CBuffer Updates Saved  : %u", gbuffer_stats.cbuffer_updates_saved);
+				}
+				if (ImGui::CollapsingHeader("Texture Streaming"))
+				{
+					TextureStreamerStats const& streaming_stats = g_TextureManager.GetStreamingStats();
+					ImGui::Text("Pending Decodes : %u", streaming_stats.pending_decodes);
+					ImGui::Text("Pending Uploads : %u", streaming_stats.pending_uploads);
+					ImGui::Text("Failed Decodes  : %u", streaming_stats.failed_decodes);
+					ImGui::Text("Uploaded Mips   : %u", streaming_stats.uploaded_mips);
+					ImGui::Text("Uploaded MB     : %.2f", streaming_stats.uploaded_bytes / (1024.0f * 1024.0f));
+					ImGui::Text("Decoded MB      : %.2f", streaming_stats.decoded_bytes / (1024.0f * 1024.0f));
+				}
+				if (ImGui::CollapsingHeader("Light Table"))
+				{
+					LightTableStats const& light_stats = engine->renderer->GetLightTableStats();
+					ImGui::Text("Lights             : %u / %u", light_stats.light_count, light_stats.capacity);
+					ImGui::Text("Synced Lights      : %u", light_stats.synced_lights);
+					ImGui::Text("Transformed Lights : %u", light_stats.transformed_lights);
+					ImGui::Text("Upload Ranges      : %u", light_stats.upload_ranges);
+					ImGui::Text("Uploaded KB        : %.2f", light_stats.uploaded_bytes / 1024.0f);
+				}
+				if (ImGui::CollapsingHeader("Cluster Binner"))
+				{
+					ClusterBinnerStats const& binner_stats = engine->renderer->GetClusterBinnerStats();
+					ImGui::Text("Binned Lights      : %u", binner_stats.binned_lights);
+					ImGui::Text("Light Indices      : %u", binner_stats.light_indices);
+					ImGui::Text("Max Cluster Lights : %u", binner_stats.max_cluster_lights);
+				}
+				if (ImGui::CollapsingHeader("Frame Arena"))
+				{
+					FrameArenaStats const& arena_stats = g_FrameArena.GetStats();
+					ImGui::Text("Used KB            : %.2f", arena_stats.used_bytes / 1024.0f);
+					ImGui::Text("Peak KB            : %.2f", arena_stats.peak_bytes / 1024.0f);
+					ImGui::Text("Capacity KB        : %.2f", arena_stats.capacity_bytes / 1024.0f);
+					ImGui::Text("Threads            : %u", arena_stats.thread_count);
+					ImGui::Text("Block Allocations  : %u", arena_stats.block_allocations);
+					ImGui::Text("Total Block Allocs : %llu", arena_stats.total_block_allocations);
+					ImGui::Text("Heap Allocations   : %llu", arena_stats.heap_allocations);
+				}
+				if (ImGui::CollapsingHeader("Constant Buffer Ring"))
+				{
+					GfxConstantBufferRingStats const& ring_stats = engine->renderer->GetConstantBufferRingStats();
+					if (ring_stats.capacity == 0) ImGui::Text("Not supported, updates use WRITE_DISCARD");
+					ImGui::Text("Frame KB           : %.2f", ring_stats.frame_bytes / 1024.0f);
+					ImGui::Text("High Water Mark KB : %.2f", ring_stats.high_water_mark / 1024.0f);
+					ImGui::Text("Capacity KB        : %.2f", ring_stats.capacity / 1024.0f);
+					ImGui::Text("Uploads            : %u", ring_stats.frame_uploads);
+					ImGui::Text("Fallbacks          : %u", ring_stats.frame_fallbacks);
+					ImGui::Text("Total Fallbacks    : %llu", ring_stats.total_fallbacks);
 				}
 			}
 			engine->renderer->SetProfiling(enable_profiling);
+
+			if (ImGui::CollapsingHeader("CPU Trace"))
+			{
+				static Int32 capture_frames = 10;
+				ImGui::SliderInt("Frames", &capture_frames, 1, 120);
+				if (g_CpuProfiler.IsCapturing()) ImGui::Text("Capturing...");
+				else if (ImGui::Button("Capture")) g_CpuProfiler.StartCapture(capture_frames, paths::SavedDir + "CpuTrace.json");
+				ImGui::TextWrapped("Writes %sCpuTrace.json, open it in chrome://tracing or Perfetto", paths::SavedDir.c_str());
+			}
         }
         ImGui::End();
     }
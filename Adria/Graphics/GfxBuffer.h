@@ -205,6 +205,20 @@ namespace adria
 			}
 			else ctx->UpdateSubresource(resource.Get(), 0, nullptr, src_data, 0, 0);
 		}
+		//partial update of a default usage buffer, offset and size are in bytes
+		void UpdateRange(void const* src_data, Uint64 offset, Uint64 data_size)
+		{
+			ADRIA_ASSERT(desc.resource_usage == GfxResourceUsage::Default);
+			ADRIA_ASSERT(offset + data_size <= desc.size);
+			D3D11_BOX box{};
+			box.left = (Uint32)offset;
+			box.right = (Uint32)(offset + data_size);
+			box.top = 0;
+			box.bottom = 1;
+			box.front = 0;
+			box.back = 1;
+			gfx->GetContext()->UpdateSubresource(resource.Get(), 0, &box, src_data, 0, 0);
+		}
 		template<typename T>
 		void Update(T const& src_data)
 		{
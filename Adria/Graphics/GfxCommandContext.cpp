@@ -76,54 +76,64 @@ namespace adria
 
 	void GfxCommandContext::Draw(Uint32 vertex_count, Uint32 instance_count /*= 1*/, Uint32 start_vertex_location /*= 0*/, Uint32 start_instance_location /*= 0*/)
 	{
+		Record(GfxRecordedOp::Draw, vertex_count, instance_count);
 		if(instance_count == 1) command_context->Draw(vertex_count, start_vertex_location);
 		else  command_context->DrawInstanced(vertex_count, instance_count, start_vertex_location, start_instance_location);
 	}
 
 	void GfxCommandContext::DrawIndexed(Uint32 index_count, Uint32 instance_count /*= 1*/, Uint32 index_offset /*= 0*/, Uint32 base_vertex_location /*= 0*/, Uint32 start_instance_location /*= 0*/)
 	{
+		Record(GfxRecordedOp::Draw, index_count, instance_count);
 		if (instance_count == 1) command_context->DrawIndexed(index_count, index_offset, base_vertex_location);
 		else  command_context->DrawIndexedInstanced(index_count, instance_count, index_offset, base_vertex_location, start_instance_location);
 	}
 
 	void GfxCommandContext::Dispatch(Uint32 group_count_x, Uint32 group_count_y, Uint32 group_count_z /*= 1*/)
 	{
+		Record(GfxRecordedOp::Dispatch, group_count_x, group_count_y, group_count_z);
 		command_context->Dispatch(group_count_x, group_count_y, group_count_z);
 	}
 
 	void GfxCommandContext::DrawIndirect(GfxBuffer const& buffer, Uint32 offset)
 	{
+		Record(GfxRecordedOp::DrawIndirect);
 		command_context->DrawInstancedIndirect(buffer.GetNative(), offset);
 	}
 
 	void GfxCommandContext::DrawIndexedIndirect(GfxBuffer const& buffer, Uint32 offset)
 	{
+		Record(GfxRecordedOp::DrawIndirect);
 		command_context->DrawIndexedInstancedIndirect(buffer.GetNative(), offset);
 	}
 
 	void GfxCommandContext::DispatchIndirect(GfxBuffer const& buffer, Uint32 offset)
 	{
+		Record(GfxRecordedOp::DispatchIndirect);
 		command_context->DispatchIndirect(buffer.GetNative(), offset);
 	}
 
 	void GfxCommandContext::CopyBuffer(GfxBuffer& dst, GfxBuffer const& src)
 	{
+		Record(GfxRecordedOp::Copy);
 		command_context->CopyResource(dst.GetNative(), src.GetNative());
 	}
 
 	void GfxCommandContext::CopyBuffer(GfxBuffer& dst, Uint32 dst_offset, GfxBuffer const& src, Uint32 src_offset, Uint32 size)
 	{
+		Record(GfxRecordedOp::Copy);
 		D3D11_BOX box{ .left = src_offset, .right = src_offset + size };
 		command_context->CopySubresourceRegion(dst.GetNative(), 0, dst_offset, 0, 0, src.GetNative(), 0, &box);
 	}
 
 	void GfxCommandContext::CopyTexture(GfxTexture& dst, GfxTexture const& src)
 	{
+		Record(GfxRecordedOp::Copy);
 		command_context->CopyResource(dst.GetNative(), src.GetNative());
 	}
 
 	void GfxCommandContext::CopyTexture(GfxTexture& dst, Uint32 dst_mip, Uint32 dst_array, GfxTexture const& src, Uint32 src_mip, Uint32 src_array)
 	{
+		Record(GfxRecordedOp::Copy);
 		command_context->CopySubresourceRegion(dst.GetNative(), dst_mip + dst.GetDesc().mip_levels * dst_array, 0, 0, 0, src.GetNative(),
 			src_mip + src.GetDesc().mip_levels * src_array, nullptr);
 	}
@@ -168,6 +178,7 @@ namespace adria
 
 	void GfxCommandContext::EndRenderPass()
 	{
+		Record(GfxRecordedOp::SetRenderTargets, 0);
 		command_context->OMSetRenderTargets(0, nullptr, nullptr);
 	}
 
@@ -176,12 +187,14 @@ namespace adria
 		if (current_topology != topology)
 		{
 			current_topology = topology;
+			Record(GfxRecordedOp::SetTopology);
 			command_context->IASetPrimitiveTopology(ConvertPrimitiveTopology(current_topology));
 		}
 	}
 
 	void GfxCommandContext::SetIndexBuffer(GfxBuffer* index_buffer, Uint32 offset)
 	{
+		Record(GfxRecordedOp::SetIndexBuffer);
 		if (index_buffer) command_context->IASetIndexBuffer(index_buffer->GetNative(), ConvertGfxFormat(index_buffer->GetDesc().format), offset);
 		else command_context->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
 	}
@@ -194,6 +207,7 @@ namespace adria
 
 	void GfxCommandContext::SetVertexBuffers(std::span<GfxBuffer*> vertex_buffers, Uint32 start_slot /*= 0*/)
 	{
+		Record(GfxRecordedOp::SetVertexBuffers, start_slot, (Uint32)vertex_buffers.size());
 		std::vector<ID3D11Buffer*> d3d11_buffers(vertex_buffers.size());
 		std::vector<Uint32> strides(vertex_buffers.size());
 		std::vector<Uint32> offsets(vertex_buffers.size());
@@ -208,6 +222,7 @@ namespace adria
 
 	void GfxCommandContext::SetViewport(Uint32 x, Uint32 y, Uint32 width, Uint32 height)
 	{
+		Record(GfxRecordedOp::SetViewport);
 		D3D11_VIEWPORT vp{};
 		vp.MinDepth = 0.0f; 
 		vp.MaxDepth = 1.0f;
@@ -220,6 +235,7 @@ namespace adria
 
 	void GfxCommandContext::SetScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height)
 	{
+		Record(GfxRecordedOp::SetScissorRect);
 		D3D11_RECT rect{};
 		rect.left = x;
 		rect.right = x + width;
@@ -230,21 +246,25 @@ namespace adria
 
 	void GfxCommandContext::ClearReadWriteDescriptorFloat(GfxShaderResourceRW descriptor, const Float v[4])
 	{
+		Record(GfxRecordedOp::Clear);
 		command_context->ClearUnorderedAccessViewFloat(descriptor, v);
 	}
 
 	void GfxCommandContext::ClearReadWriteDescriptorUint(GfxShaderResourceRW descriptor, const Uint32 v[4])
 	{
+		Record(GfxRecordedOp::Clear);
 		command_context->ClearUnorderedAccessViewUint(descriptor, v);
 	}
 
 	void GfxCommandContext::ClearRenderTarget(GfxRenderTarget rtv, Float const* clear_color)
 	{
+		Record(GfxRecordedOp::Clear);
 		command_context->ClearRenderTargetView(rtv, clear_color);
 	}
 
 	void GfxCommandContext::ClearDepth(GfxDepthTarget dsv, Float depth /*= 1.0f*/, Uint8 stencil /*= 0*/, Bool clear_stencil /*= false*/)
 	{
+		Record(GfxRecordedOp::Clear);
 		Uint32 flags = D3D11_CLEAR_DEPTH;
 		if (clear_stencil) flags |= D3D11_CLEAR_STENCIL;
 		command_context->ClearDepthStencilView(dsv, flags, depth, stencil);
@@ -255,6 +275,7 @@ namespace adria
 		if (current_input_layout != il)
 		{
 			current_input_layout = il;
+			Record(GfxRecordedOp::SetInputLayout);
 			if (il) command_context->IASetInputLayout(*il);
 			else command_context->IASetInputLayout(nullptr);
 		}
@@ -265,6 +286,7 @@ namespace adria
 		if (current_depth_state != dss)
 		{
 			current_depth_state = dss;
+			Record(GfxRecordedOp::SetState);
 			if(dss) command_context->OMSetDepthStencilState(*dss, stencil_ref);
 			else command_context->OMSetDepthStencilState(nullptr, stencil_ref);
 		}
@@ -275,6 +297,7 @@ namespace adria
 		if (current_rasterizer_state != rs)
 		{
 			current_rasterizer_state = rs;
+			Record(GfxRecordedOp::SetState);
 			if (rs) command_context->RSSetState(*rs);
 			else command_context->RSSetState(nullptr);
 		}
@@ -285,6 +308,7 @@ namespace adria
 		if (current_blend_state != bs)
 		{
 			current_blend_state = bs;
+			Record(GfxRecordedOp::SetState);
 			if (bs) command_context->OMSetBlendState(*bs, blend_factors, mask);
 			else command_context->OMSetBlendState(nullptr, blend_factors, mask);
 		}
@@ -292,6 +316,7 @@ namespace adria
 
 	void GfxCommandContext::CopyStructureCount(GfxBuffer* dst_buffer, Uint32 dst_buffer_offset, GfxShaderResourceRW src_view)
 	{
+		Record(GfxRecordedOp::Copy);
 		command_context->CopyStructureCount(dst_buffer->GetNative(), dst_buffer_offset, src_view);
 	}
 
@@ -328,6 +353,7 @@ namespace adria
 	void GfxCommandContext::UpdateBuffer(GfxBuffer* buffer, void const* data, Uint32 data_size)
 	{
 		GfxBufferDesc desc = buffer->GetDesc();
+		Record(GfxRecordedOp::Upload, data_size);
 
 		if (desc.resource_usage == GfxResourceUsage::Dynamic)
 		{
@@ -343,6 +369,7 @@ namespace adria
 		if (shader != current_vs)
 		{
 			current_vs = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::VS);
 			command_context->VSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -352,6 +379,7 @@ namespace adria
 		if (shader != current_ps)
 		{
 			current_ps = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::PS);
 			command_context->PSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -361,6 +389,7 @@ namespace adria
 		if (shader != current_hs)
 		{
 			current_hs = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::HS);
 			command_context->HSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -370,6 +399,7 @@ namespace adria
 		if (shader != current_ds)
 		{
 			current_ds = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::DS);
 			command_context->DSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -379,6 +409,7 @@ namespace adria
 		if (shader != current_gs)
 		{
 			current_gs = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::GS);
 			command_context->GSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -388,6 +419,7 @@ namespace adria
 		if (shader != current_cs)
 		{
 			current_cs = shader;
+			Record(GfxRecordedOp::SetShader, (Uint32)GfxShaderStage::CS);
 			command_context->CSSetShader(shader ? *shader : nullptr, nullptr, 0);
 		}
 	}
@@ -402,6 +434,7 @@ namespace adria
 	{
 		std::vector<ID3D11Buffer*> d3d11_buffers(buffers.size());
 		for (Uint32 i = 0; i < buffers.size(); ++i) d3d11_buffers[i] = buffers[i] ?  buffers[i]->GetNative() : nullptr;
+		Record(GfxRecordedOp::SetConstantBuffers, (Uint32)stage, start, (Uint32)buffers.size());
 		switch (stage)
 		{
 		case GfxShaderStage::VS:
@@ -425,6 +458,36 @@ namespace adria
 		}
 	}
 
+	void GfxCommandContext::SetConstantBuffer(GfxShaderStage stage, Uint32 slot, GfxBuffer* buffer, Uint32 offset, Uint32 size)
+	{
+		ADRIA_ASSERT(offset % 256 == 0 && size % 256 == 0);
+		ID3D11Buffer* const d3d11_buffer = buffer->GetNative();
+		Uint32 const first_constant = offset / 16;
+		Uint32 const constant_count = size / 16;
+		Record(GfxRecordedOp::SetConstantBuffers, (Uint32)stage, slot, 1);
+		switch (stage)
+		{
+		case GfxShaderStage::VS:
+			command_context->VSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		case GfxShaderStage::PS:
+			command_context->PSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		case GfxShaderStage::HS:
+			command_context->HSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		case GfxShaderStage::DS:
+			command_context->DSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		case GfxShaderStage::GS:
+			command_context->GSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		case GfxShaderStage::CS:
+			command_context->CSSetConstantBuffers1(slot, 1, &d3d11_buffer, &first_constant, &constant_count);
+			break;
+		}
+	}
+
 	void GfxCommandContext::SetSampler(GfxShaderStage stage, Uint32 start, GfxSampler* sampler)
 	{
 		GfxSampler* samplers[1] = { sampler };
@@ -435,6 +498,7 @@ namespace adria
 	{
 		std::vector<ID3D11SamplerState*> d3d11_samplers(samplers.size());
 		for (Uint32 i = 0; i < samplers.size(); ++i) d3d11_samplers[i] = *samplers[i];
+		Record(GfxRecordedOp::SetSamplers, (Uint32)stage, start, (Uint32)samplers.size());
 		switch (stage)
 		{
 		case GfxShaderStage::VS:
@@ -466,6 +530,7 @@ namespace adria
 
 	void GfxCommandContext::SetShaderResourcesRO(GfxShaderStage stage, Uint32 start, std::span<GfxShaderResourceRO> descriptors)
 	{
+		Record(GfxRecordedOp::SetShaderResources, (Uint32)stage, start, (Uint32)descriptors.size());
 		switch (stage)
 		{
 		case GfxShaderStage::VS:
@@ -491,6 +556,7 @@ namespace adria
 
 	void GfxCommandContext::UnsetShaderResourcesRO(GfxShaderStage stage, Uint32 start, Uint32 count)
 	{
+		Record(GfxRecordedOp::SetShaderResources, (Uint32)stage, start, count);
 		switch (stage)
 		{
 		case GfxShaderStage::VS:
@@ -522,33 +588,40 @@ namespace adria
 
 	void GfxCommandContext::SetShaderResourcesRW(Uint32 start, std::span<GfxShaderResourceRW> descriptors)
 	{
+		Record(GfxRecordedOp::SetUnorderedAccessViews, start, (Uint32)descriptors.size());
 		command_context->CSSetUnorderedAccessViews(start, (Uint32)descriptors.size(), descriptors.data(), nullptr);
 	}
 
 	void GfxCommandContext::SetShaderResourcesRW(Uint32 start, std::span<GfxShaderResourceRW> descriptors, std::span<Uint32> initial_counts)
 	{
 		ADRIA_ASSERT(descriptors.size() == initial_counts.size());
+		Record(GfxRecordedOp::SetUnorderedAccessViews, start, (Uint32)descriptors.size());
 		command_context->CSSetUnorderedAccessViews(start, (Uint32)descriptors.size(), descriptors.data(), initial_counts.data());
 	}
 
 	void GfxCommandContext::UnsetShaderResourcesRW(Uint32 start, Uint32 count)
 	{
+		Record(GfxRecordedOp::SetUnorderedAccessViews, start, count);
 		command_context->CSSetUnorderedAccessViews(start, count, NULL_UAVS, nullptr);
 	}
 
 
 	void GfxCommandContext::SetRenderTarget(GfxRenderTarget rtv, GfxDepthTarget dsv /*= nullptr*/)
 	{
+		Record(GfxRecordedOp::SetRenderTargets, 1);
 		command_context->OMSetRenderTargets(1, &rtv, dsv);
 	}
 
 	void GfxCommandContext::SetRenderTargets(std::span<GfxRenderTarget> rtvs, GfxDepthTarget dsv /*= nullptr*/)
 	{
+		Record(GfxRecordedOp::SetRenderTargets, (Uint32)rtvs.size());
 		command_context->OMSetRenderTargets((Uint32)rtvs.size(), rtvs.data(), dsv);
 	}
 
 	void GfxCommandContext::SetRenderTargetsAndShaderResourcesRW(std::span<GfxRenderTarget> rtvs, GfxDepthTarget dsv, Uint32 start_slot, std::span<GfxShaderResourceRW> uavs, std::span<Uint32> initial_counts /*= {}*/)
 	{
+		Record(GfxRecordedOp::SetRenderTargets, (Uint32)rtvs.size());
+		Record(GfxRecordedOp::SetUnorderedAccessViews, start_slot, (Uint32)uavs.size());
 		command_context->OMSetRenderTargetsAndUnorderedAccessViews((Uint32)rtvs.size(), rtvs.data(), dsv, start_slot,
 																   (Uint32)uavs.size(), uavs.data(), initial_counts.data());
 	}
@@ -575,12 +648,14 @@ namespace adria
 
 	void GfxCommandContext::BeginEvent(Char const* event_name)
 	{
+		if (recorder) recorder->BeginPass(event_name);
 		annotation->BeginEvent(ToWideString(event_name).c_str());
 	}
 
 	void GfxCommandContext::EndEvent()
 	{
 		annotation->EndEvent();
+		if (recorder) recorder->EndPass();
 	}
 
 }
\ No newline at end of file
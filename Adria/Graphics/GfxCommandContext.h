@@ -4,6 +4,7 @@
 #include "GfxView.h"
 #include "GfxResourceCommon.h"
 #include "GfxShader.h"
+#include "GfxCommandRecorder.h"
 
 namespace adria
 {
@@ -88,6 +89,8 @@ namespace adria
 
 		void SetConstantBuffer(GfxShaderStage stage, Uint32 slot, GfxBuffer* buffer);
 		void SetConstantBuffers(GfxShaderStage stage, Uint32 start, std::span<GfxBuffer*> buffers);
+		//binds size bytes of the buffer starting at offset, both must be multiples of 256 (D3D11.1 constant buffer offsetting)
+		void SetConstantBuffer(GfxShaderStage stage, Uint32 slot, GfxBuffer* buffer, Uint32 offset, Uint32 size);
 		void SetSampler(GfxShaderStage stage, Uint32 start, GfxSampler* sampler);
 		void SetSamplers(GfxShaderStage stage, Uint32 start, std::span<GfxSampler*> samplers);
 		void SetShaderResourceRO(GfxShaderStage stage, Uint32 slot, GfxShaderResourceRO srv);
@@ -113,10 +116,15 @@ namespace adria
 		void BeginEvent(Char const* event_name);
 		void EndEvent();
 
+		//every command issued through the context is also recorded while a recorder is set, direct calls on GetNative() are not
+		void SetRecorder(GfxCommandRecorder* _recorder) { recorder = _recorder; }
+		GfxCommandRecorder* GetRecorder() const { return recorder; }
+
 		ID3D11DeviceContext4* GetNative() const { return command_context.Get(); }
 	private:
 		GfxDevice* gfx = nullptr;
 		Uint32 frame_count = 0;
+		GfxCommandRecorder* recorder = nullptr;
 		Ref<ID3D11DeviceContext4> command_context = nullptr;
 		Ref<ID3DUserDefinedAnnotation> annotation = nullptr;
 
@@ -137,6 +145,10 @@ namespace adria
 
 	private:
 		explicit GfxCommandContext(GfxDevice* gfx) : gfx(gfx) {}
+		void Record(GfxRecordedOp op, Uint32 arg0 = 0, Uint32 arg1 = 0, Uint32 arg2 = 0)
+		{
+			if (recorder) recorder->Record(op, arg0, arg1, arg2);
+		}
 		void Create(ID3D11DeviceContext* ctx) 
 		{
 			HRESULT hr = ctx->QueryInterface(__uuidof(ID3D11DeviceContext4), (void**)command_context.GetAddressOf());
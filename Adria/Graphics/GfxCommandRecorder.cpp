@@ -0,0 +1,158 @@
+#include "GfxCommandRecorder.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 OP_ARG_COUNTS[] =
+		{
+			2, //Draw
+			0, //DrawIndirect
+			3, //Dispatch
+			0, //DispatchIndirect
+			0, //Copy
+			1, //Upload
+			0, //Clear
+			1, //SetRenderTargets
+			0, //SetViewport
+			0, //SetScissorRect
+			0, //SetState
+			1, //SetShader
+			0, //SetInputLayout
+			0, //SetTopology
+			2, //SetVertexBuffers
+			0, //SetIndexBuffer
+			3, //SetConstantBuffers
+			3, //SetSamplers
+			3, //SetShaderResources
+			2, //SetUnorderedAccessViews
+			1, //BeginPass
+			0  //EndPass
+		};
+		static_assert(std::size(OP_ARG_COUNTS) == (Uint64)GfxRecordedOp::Count);
+
+		void AddCommand(GfxCommandStats& stats, GfxRecordedOp op, Uint32 arg0)
+		{
+			++stats.commands;
+			switch (op)
+			{
+			case GfxRecordedOp::Draw:
+			case GfxRecordedOp::DrawIndirect:
+				++stats.draws;
+				break;
+			case GfxRecordedOp::Dispatch:
+			case GfxRecordedOp::DispatchIndirect:
+				++stats.dispatches;
+				break;
+			case GfxRecordedOp::Copy:
+				++stats.copies;
+				break;
+			case GfxRecordedOp::Upload:
+				++stats.uploads;
+				stats.uploaded_bytes += arg0;
+				break;
+			case GfxRecordedOp::Clear:
+				++stats.clears;
+				break;
+			case GfxRecordedOp::BeginPass:
+			case GfxRecordedOp::EndPass:
+				--stats.commands;
+				break;
+			default:
+				++stats.binds;
+			}
+		}
+	}
+
+	GfxCommandStats& GfxCommandStats::operator+=(GfxCommandStats const& other)
+	{
+		commands += other.commands;
+		draws += other.draws;
+		dispatches += other.dispatches;
+		binds += other.binds;
+		copies += other.copies;
+		clears += other.clears;
+		uploads += other.uploads;
+		uploaded_bytes += other.uploaded_bytes;
+		return *this;
+	}
+
+	void GfxCommandRecorder::BeginFrame()
+	{
+		stream.clear();
+		passes.clear();
+		pass_stack.clear();
+		frame_stats = {};
+	}
+
+	void GfxCommandRecorder::EndFrame()
+	{
+		while (!pass_stack.empty()) EndPass();
+	}
+
+	void GfxCommandRecorder::Record(GfxRecordedOp op, Uint32 arg0, Uint32 arg1, Uint32 arg2)
+	{
+		Uint32 const args[] = { arg0, arg1, arg2 };
+		stream.push_back(static_cast<Uint8>(op));
+		for (Uint32 i = 0; i < OP_ARG_COUNTS[(Uint64)op]; ++i) Write(args[i]);
+
+		AddCommand(frame_stats, op, arg0);
+		for (auto const& [pass_index, timer] : pass_stack) AddCommand(passes[pass_index].stats, op, arg0);
+	}
+
+	void GfxCommandRecorder::BeginPass(Char const* name)
+	{
+		Uint32 const pass_index = static_cast<Uint32>(passes.size());
+		Record(GfxRecordedOp::BeginPass, pass_index);
+		passes.push_back(GfxRecordedPass{ .name = name, .depth = static_cast<Uint32>(pass_stack.size()), .cpu_time_ms = 0.0f, .stats = {} });
+		pass_stack.emplace_back(pass_index, Timer<std::chrono::nanoseconds>{});
+	}
+
+	void GfxCommandRecorder::EndPass()
+	{
+		if (pass_stack.empty()) return;
+		auto const& [pass_index, timer] = pass_stack.back();
+		passes[pass_index].cpu_time_ms = timer.Elapsed() / 1e6f;
+		pass_stack.pop_back();
+		Record(GfxRecordedOp::EndPass);
+	}
+
+	Bool GfxCommandRecorder::Decode(std::span<Uint8 const> stream, std::vector<GfxRecordedCommand>& commands)
+	{
+		Uint64 offset = 0;
+		auto Read = [&](Uint32& value)
+		{
+			value = 0;
+			for (Uint32 shift = 0; shift < 35; shift += 7)
+			{
+				if (offset >= stream.size()) return false;
+				Uint8 const byte = stream[offset++];
+				value |= Uint32(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return true;
+			}
+			return false;
+		};
+
+		while (offset < stream.size())
+		{
+			GfxRecordedCommand command{ .op = static_cast<GfxRecordedOp>(stream[offset++]), .args = {} };
+			if (command.op >= GfxRecordedOp::Count) return false;
+			for (Uint32 i = 0; i < OP_ARG_COUNTS[(Uint64)command.op]; ++i)
+			{
+				if (!Read(command.args[i])) return false;
+			}
+			commands.push_back(command);
+		}
+		return true;
+	}
+
+	void GfxCommandRecorder::Write(Uint32 value)
+	{
+		while (value >= 0x80)
+		{
+			stream.push_back(static_cast<Uint8>(value | 0x80));
+			value >>= 7;
+		}
+		stream.push_back(static_cast<Uint8>(value));
+	}
+}
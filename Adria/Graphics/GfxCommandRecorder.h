@@ -0,0 +1,94 @@
+#pragma once
+#include <span>
+#include <string>
+#include <vector>
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	enum class GfxRecordedOp : Uint8
+	{
+		Draw,				//vertex or index count, instance count
+		DrawIndirect,
+		Dispatch,			//group counts x, y, z
+		DispatchIndirect,
+		Copy,
+		Upload,				//bytes
+		Clear,
+		SetRenderTargets,	//render target count
+		SetViewport,
+		SetScissorRect,
+		SetState,
+		SetShader,			//stage
+		SetInputLayout,
+		SetTopology,
+		SetVertexBuffers,	//start slot, count
+		SetIndexBuffer,
+		SetConstantBuffers,	//stage, start slot, count
+		SetSamplers,		//stage, start slot, count
+		SetShaderResources,	//stage, start slot, count
+		SetUnorderedAccessViews, //start slot, count
+		BeginPass,			//pass index
+		EndPass,
+		Count
+	};
+
+	struct GfxCommandStats
+	{
+		Uint64 commands = 0;
+		Uint64 draws = 0;
+		Uint64 dispatches = 0;
+		Uint64 binds = 0;
+		Uint64 copies = 0;
+		Uint64 clears = 0;
+		Uint64 uploads = 0;
+		Uint64 uploaded_bytes = 0;
+
+		GfxCommandStats& operator+=(GfxCommandStats const& other);
+	};
+
+	//nested passes are included in the stats and time of their parent
+	struct GfxRecordedPass
+	{
+		std::string name;
+		Uint32 depth;
+		Float cpu_time_ms;
+		GfxCommandStats stats;
+	};
+
+	struct GfxRecordedCommand
+	{
+		GfxRecordedOp op;
+		Uint32 args[3];
+	};
+
+	//Records what a GfxCommandContext is asked to do in one frame into a byte stream: an op byte followed by its
+	//arguments as LEB128 varints, so a typical command takes two to four bytes. Passes are delimited by the
+	//annotation events of the context and get their own stats and the CPU time spent between their begin and end.
+	class GfxCommandRecorder
+	{
+	public:
+		void BeginFrame();
+		void EndFrame();
+
+		void Record(GfxRecordedOp op, Uint32 arg0 = 0, Uint32 arg1 = 0, Uint32 arg2 = 0);
+		void BeginPass(Char const* name);
+		void EndPass();
+
+		std::span<Uint8 const> GetStream() const { return stream; }
+		std::span<GfxRecordedPass const> GetPasses() const { return passes; }
+		GfxCommandStats const& GetFrameStats() const { return frame_stats; }
+
+		//decodes a recorded stream, returns false if it is malformed
+		static Bool Decode(std::span<Uint8 const> stream, std::vector<GfxRecordedCommand>& commands);
+
+	private:
+		std::vector<Uint8> stream;
+		std::vector<GfxRecordedPass> passes;
+		std::vector<std::pair<Uint32, Timer<std::chrono::nanoseconds>>> pass_stack;
+		GfxCommandStats frame_stats;
+
+	private:
+		void Write(Uint32 value);
+	};
+}
@@ -2,16 +2,29 @@
 #include "GfxBuffer.h"
 #include "GfxDevice.h"
 #include "GfxCommandContext.h"
+#include "GfxConstantBufferRing.h"
 
 namespace adria
 {
 	template<typename CBuffer>
 	class GfxConstantBuffer
 	{
+		static constexpr Uint32 MAX_BINDINGS = 8;
+
 		static constexpr Uint32 GetCBufferSize()
 		{
 			return (sizeof(CBuffer) + (64 - 1)) & ~(64 - 1);
 		}
+		static constexpr Uint32 GetRingBindSize()
+		{
+			return GfxConstantBufferRing::AlignedSize(sizeof(CBuffer));
+		}
+
+		struct Binding
+		{
+			GfxShaderStage stage;
+			Uint32 slot;
+		};
 
 	public:
 
@@ -21,6 +34,13 @@ namespace adria
 		void Update(GfxCommandContext* context, void const* data, Uint32 data_size);
 		void Update(GfxCommandContext* context, CBuffer const& buffer_data);
 
+		//updates go to the ring and every slot the buffer was bound to is rebound at the new offset
+		void SetUploadRing(GfxConstantBufferRing* _ring)
+		{
+			ADRIA_ASSERT(dynamic || _ring == nullptr);
+			ring = _ring;
+		}
+
 		void Bind(GfxCommandContext* context, GfxShaderStage stage, Uint32 slot) const;
 		GfxBuffer* Buffer() const
 		{
@@ -30,6 +50,13 @@ namespace adria
 	private:
 		std::unique_ptr<GfxBuffer> buffer = nullptr;
 		Bool dynamic;
+		GfxConstantBufferRing* ring = nullptr;
+		OffsetType ring_offset = INVALID_OFFSET;
+		mutable Binding bindings[MAX_BINDINGS]{};
+		mutable Uint32 binding_count = 0;
+
+	private:
+		void BindCurrent(GfxCommandContext* context, Binding const& binding) const;
 	};
 
 
@@ -61,6 +88,19 @@ namespace adria
 	template<typename CBuffer>
 	void GfxConstantBuffer<CBuffer>::Update(GfxCommandContext* context, void const* data, Uint32 data_size)
 	{
+		if (ring)
+		{
+			Bool const was_in_ring = ring_offset != INVALID_OFFSET;
+			ring_offset = ring->Upload(context, data, data_size, GetRingBindSize());
+			if (ring_offset == INVALID_OFFSET)
+			{
+				ring->AddFallback();
+				context->UpdateBuffer(buffer.get(), data, data_size);
+				if (!was_in_ring) return;
+			}
+			for (Uint32 i = 0; i < binding_count; ++i) BindCurrent(context, bindings[i]);
+			return;
+		}
 		context->UpdateBuffer(buffer.get(), data, data_size);
 	}
 
@@ -73,7 +113,31 @@ namespace adria
 	template<typename CBuffer>
 	void GfxConstantBuffer<CBuffer>::Bind(GfxCommandContext* context, GfxShaderStage stage, Uint32 slot) const
 	{
-		context->SetConstantBuffer(stage, slot, buffer.get());
+		Binding const binding{ .stage = stage, .slot = slot };
+		if (ring)
+		{
+			Bool already_bound = false;
+			for (Uint32 i = 0; i < binding_count; ++i)
+			{
+				already_bound |= bindings[i].stage == stage && bindings[i].slot == slot;
+			}
+			if (!already_bound)
+			{
+				ADRIA_ASSERT(binding_count < MAX_BINDINGS);
+				bindings[binding_count++] = binding;
+			}
+		}
+		BindCurrent(context, binding);
+	}
+
+	template<typename CBuffer>
+	void GfxConstantBuffer<CBuffer>::BindCurrent(GfxCommandContext* context, Binding const& binding) const
+	{
+		if (ring_offset != INVALID_OFFSET)
+		{
+			context->SetConstantBuffer(binding.stage, binding.slot, ring->Buffer(), (Uint32)ring_offset, GetRingBindSize());
+		}
+		else context->SetConstantBuffer(binding.stage, binding.slot, buffer.get());
 	}
 
 }
\ No newline at end of file
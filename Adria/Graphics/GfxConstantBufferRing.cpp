@@ -0,0 +1,104 @@
+#include "GfxConstantBufferRing.h"
+#include "GfxDevice.h"
+#include "GfxBuffer.h"
+#include "GfxQuery.h"
+#include "GfxCommandContext.h"
+#include "Core/Logger.h"
+
+namespace adria
+{
+	GfxConstantBufferRing::GfxConstantBufferRing(GfxDevice* gfx, Uint64 size) : gfx(gfx), allocator(size)
+	{
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+		HRESULT hr = gfx->GetDevice()->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+		if (FAILED(hr) || !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+		{
+			ADRIA_LOG(WARNING, "Constant buffer offsetting is not supported, constant buffers will be updated with WRITE_DISCARD");
+			return;
+		}
+
+		GfxBufferDesc desc{};
+		desc.size = size;
+		desc.resource_usage = GfxResourceUsage::Dynamic;
+		desc.cpu_access = GfxCpuAccess::Write;
+		desc.bind_flags = GfxBindFlag::ConstantBuffer;
+		buffer = std::make_unique<GfxBuffer>(gfx, desc);
+		stats.capacity = size;
+	}
+
+	GfxConstantBufferRing::~GfxConstantBufferRing() = default;
+
+	OffsetType GfxConstantBufferRing::Upload(GfxCommandContext* context, void const* data, Uint32 data_size, Uint32 bound_size)
+	{
+		if (!buffer) return INVALID_OFFSET;
+
+		Uint32 const allocation_size = AlignedSize(std::max(data_size, bound_size));
+		OffsetType const offset = allocator.Allocate(allocation_size, ALIGNMENT);
+		if (offset == INVALID_OFFSET)
+		{
+			if (stats.total_fallbacks == 0 && frame_stats.frame_fallbacks == 0)
+			{
+				ADRIA_LOG(WARNING, "Constant buffer ring of %llu bytes is full, falling back to WRITE_DISCARD updates", stats.capacity);
+			}
+			return INVALID_OFFSET;
+		}
+
+		//the rest of the ring may still be read by the GPU, but nothing in it is overwritten
+		GfxMappedSubresource mapped_buffer = context->MapBuffer(buffer.get(), GfxMapType::WriteNoOverwrite);
+		memcpy(static_cast<Uint8*>(mapped_buffer.p_data) + offset, data, data_size);
+		context->UnmapBuffer(buffer.get());
+
+		++frame_stats.frame_uploads;
+		frame_stats.frame_bytes += allocation_size;
+		stats.high_water_mark = std::max<Uint64>(stats.high_water_mark, allocator.UsedSize());
+		return offset;
+	}
+
+	void GfxConstantBufferRing::NewFrame(GfxCommandContext* context)
+	{
+		Uint64 const used_size_before = allocator.UsedSize();
+		allocator.FinishCurrentFrame(frame);
+		if (buffer && !gfx->IsHeadless())
+		{
+			std::unique_ptr<GfxQuery> fence;
+			if (!free_fences.empty())
+			{
+				fence = std::move(free_fences.back());
+				free_fences.pop_back();
+			}
+			else fence = std::make_unique<GfxQuery>(gfx, QueryType::Event);
+			context->EndQuery(fence.get());
+			frame_fences.emplace(frame, std::move(fence));
+
+			//only wait for the GPU when too many frames are in flight, otherwise release what is already done
+			while (!frame_fences.empty())
+			{
+				auto& [fence_frame, frame_fence] = frame_fences.front();
+				Bool32 done = false;
+				if (frame_fences.size() > MAX_FRAMES_IN_FLIGHT)
+				{
+					while (!context->GetQueryData(frame_fence.get(), &done, sizeof(done)));
+				}
+				else if (!context->GetQueryData(frame_fence.get(), &done, sizeof(done))) break;
+
+				allocator.ReleaseCompletedFrames(fence_frame);
+				free_fences.push_back(std::move(frame_fence));
+				frame_fences.pop();
+			}
+		}
+		else
+		{
+			//the null device never executes anything, so nothing can still be in flight
+			allocator.ReleaseCompletedFrames(frame);
+		}
+		++frame;
+
+		Uint64 const total_fallbacks = stats.total_fallbacks + frame_stats.frame_fallbacks;
+		Uint64 const high_water_mark = std::max(stats.high_water_mark, used_size_before);
+		frame_stats.capacity = stats.capacity;
+		stats = frame_stats;
+		stats.total_fallbacks = total_fallbacks;
+		stats.high_water_mark = high_water_mark;
+		frame_stats = GfxConstantBufferRingStats{};
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <queue>
+#include <vector>
+#include "Utilities/RingAllocator.h"
+
+namespace adria
+{
+	class GfxDevice;
+	class GfxBuffer;
+	class GfxQuery;
+	class GfxCommandContext;
+
+	struct GfxConstantBufferRingStats
+	{
+		Uint64 capacity = 0;
+		Uint64 frame_bytes = 0;		 //allocated during the last frame
+		Uint64 high_water_mark = 0;	 //most bytes in flight at once, over all frames not yet completed by the GPU
+		Uint32 frame_uploads = 0;
+		Uint32 frame_fallbacks = 0;	 //uploads that did not fit and went to the constant buffer's own storage
+		Uint64 total_fallbacks = 0;
+	};
+
+	//One large dynamic constant buffer that per-draw constants are sub-allocated from at 256 byte aligned offsets and bound by
+	//offset, mapped with WRITE_NO_OVERWRITE instead of a WRITE_DISCARD of a dedicated buffer per update. Each frame is
+	//fenced with an event query and its part of the ring is released once the GPU is done with it.
+	class GfxConstantBufferRing
+	{
+		static constexpr Uint64 MAX_FRAMES_IN_FLIGHT = 8;
+
+	public:
+		static constexpr Uint32 ALIGNMENT = 256;
+
+	public:
+		GfxConstantBufferRing(GfxDevice* gfx, Uint64 size);
+		~GfxConstantBufferRing();
+
+		//false if the device cannot bind constant buffers by offset or map them without discarding, every upload falls back then
+		Bool IsSupported() const { return buffer != nullptr; }
+
+		//copies data into the ring and returns its offset, INVALID_OFFSET if the ring is full or unsupported.
+		//bound_size is how much of the ring the constant buffer will be bound with, at least data_size
+		OffsetType Upload(GfxCommandContext* context, void const* data, Uint32 data_size, Uint32 bound_size);
+		void AddFallback() { ++frame_stats.frame_fallbacks; }
+		//fences the frame that just ended and releases the frames the GPU has completed
+		void NewFrame(GfxCommandContext* context);
+
+		GfxBuffer* Buffer() const { return buffer.get(); }
+		GfxConstantBufferRingStats const& GetStats() const { return stats; }
+
+		static constexpr Uint32 AlignedSize(Uint32 size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+	private:
+		GfxDevice* gfx;
+		std::unique_ptr<GfxBuffer> buffer;
+		RingAllocator allocator;
+		Uint64 frame = 0;
+		std::queue<std::pair<Uint64, std::unique_ptr<GfxQuery>>> frame_fences;
+		std::vector<std::unique_ptr<GfxQuery>> free_fences;
+		GfxConstantBufferRingStats stats;
+		GfxConstantBufferRingStats frame_stats;
+	};
+}
@@ -20,7 +20,7 @@ namespace adria
 		}
 	}
 
-	GfxDevice::GfxDevice(Window* window) : window(window), command_context(new GfxCommandContext(this))
+	GfxDevice::GfxDevice(Window* window, Bool headless) : window(window), headless(headless), command_context(new GfxCommandContext(this))
 	{
 		width	= window->Width();
 		height	= window->Height();
@@ -50,20 +50,42 @@ namespace adria
 		ID3D11DeviceContext* context = nullptr;
 		ID3D11Device* _device = nullptr;
 		D3D_FEATURE_LEVEL feature_level = D3D_FEATURE_LEVEL_12_0;
-		HRESULT hr = D3D11CreateDeviceAndSwapChain(
-			nullptr,
-			D3D_DRIVER_TYPE_HARDWARE,
-			nullptr,
-			swapchain_create_flags,
-			&feature_level,
-			1,
-			D3D11_SDK_VERSION,
-			&swapchain_desc,
-			swapchain.GetAddressOf(),
-			&_device,
-			nullptr,
-			&context
-		);
+		HRESULT hr = S_OK;
+		if (headless)
+		{
+			//the null driver may not expose 12_0, the renderer only needs 11_0 features there
+			D3D_FEATURE_LEVEL const null_feature_levels[] = { D3D_FEATURE_LEVEL_12_0, D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
+			hr = D3D11CreateDevice(
+				nullptr,
+				D3D_DRIVER_TYPE_NULL,
+				nullptr,
+				swapchain_create_flags,
+				null_feature_levels,
+				ARRAYSIZE(null_feature_levels),
+				D3D11_SDK_VERSION,
+				&_device,
+				nullptr,
+				&context
+			);
+		}
+		else
+		{
+			hr = D3D11CreateDeviceAndSwapChain(
+				nullptr,
+				D3D_DRIVER_TYPE_HARDWARE,
+				nullptr,
+				swapchain_create_flags,
+				&feature_level,
+				1,
+				D3D11_SDK_VERSION,
+				&swapchain_desc,
+				swapchain.GetAddressOf(),
+				&_device,
+				nullptr,
+				&context
+			);
+		}
+		GFX_CHECK_HR(hr);
 		hr = _device->QueryInterface(__uuidof(ID3D11Device3), (void**)device.GetAddressOf());
 		_device->Release();
 
@@ -117,7 +139,7 @@ namespace adria
 	}
 	void GfxDevice::SwapBuffers(Bool vsync)
 	{
-		GFX_CHECK_HR(swapchain->Present(vsync, 0));
+		if (swapchain) GFX_CHECK_HR(swapchain->Present(vsync, 0));
 		command_context->End();
 	}
 	void GfxDevice::SetBackbuffer()
@@ -137,6 +159,8 @@ namespace adria
 
 	void GfxDevice::WaitForGPU()
 	{
+		//queries never complete on the null driver
+		if (headless) return;
 		command_context->WaitForGPU();
 	}
 	void GfxDevice::CreateBackBufferResources(Uint32 w, Uint32 h)
@@ -146,10 +170,25 @@ namespace adria
 		command_context->Flush();
 
 		if (backbuffer_rtv) backbuffer_rtv->Release();
-		GFX_CHECK_HR(swapchain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0));
-
 		Ref<ID3D11Texture2D> p_buffer = nullptr;
-		GFX_CHECK_HR(swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)p_buffer.GetAddressOf()));
+		if (swapchain)
+		{
+			GFX_CHECK_HR(swapchain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0));
+			GFX_CHECK_HR(swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)p_buffer.GetAddressOf()));
+		}
+		else
+		{
+			D3D11_TEXTURE2D_DESC desc{};
+			desc.Width = w;
+			desc.Height = h;
+			desc.MipLevels = 1;
+			desc.ArraySize = 1;
+			desc.Format = DXGI_FORMAT_R10G10B10A2_UNORM;
+			desc.SampleDesc.Count = 1;
+			desc.Usage = D3D11_USAGE_DEFAULT;
+			desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+			GFX_CHECK_HR(device->CreateTexture2D(&desc, nullptr, p_buffer.GetAddressOf()));
+		}
 		GFX_CHECK_HR(device->CreateRenderTargetView(p_buffer.Get(), nullptr, backbuffer_rtv.GetAddressOf()));
 
 		GfxRenderTarget rtv[] = { backbuffer_rtv.Get()};
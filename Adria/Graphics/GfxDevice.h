@@ -10,7 +10,9 @@ namespace adria
 	class GfxDevice
 	{
 	public:
-		explicit GfxDevice(Window* window);
+		//a headless device uses the D3D11 null driver: the full API without rendering or GPU allocations and without a swapchain,
+		//the window only provides the backbuffer size
+		explicit GfxDevice(Window* window, Bool headless = false);
 		GfxDevice(GfxDevice const&) = delete;
 		GfxDevice(GfxDevice&&) = default;
 		GfxDevice& operator=(GfxDevice const&) = delete;
@@ -26,9 +28,11 @@ namespace adria
 		ID3D11DeviceContext4* GetContext() const;
 		GfxCommandContext* GetCommandContext() const { return command_context.get(); }
 		Window* GetWindow() const { return window; }
+		Bool IsHeadless() const { return headless; }
 
 	private:
 		Window* window;
+		Bool headless;
 		Uint32 width, height;
 		Ref<ID3D11Device3> device = nullptr;
 		Ref<IDXGISwapChain> swapchain = nullptr;
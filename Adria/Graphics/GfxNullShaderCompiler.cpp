@@ -0,0 +1,70 @@
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include "GfxNullShaderCompiler.h"
+#include "Core/Paths.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/HashUtil.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 MAX_INCLUDE_DEPTH = 32;
+
+		Bool ExpandIncludes(std::string const& file, Uint32 depth, std::string& output, std::vector<std::string>& includes)
+		{
+			if (depth > MAX_INCLUDE_DEPTH) return false;
+			std::ifstream file_stream(file);
+			if (!file_stream) return false;
+
+			std::string line;
+			while (std::getline(file_stream, line))
+			{
+				size_t const directive = line.find("#include");
+				if (directive == std::string::npos)
+				{
+					output += line;
+					output += '\n';
+					continue;
+				}
+
+				size_t const open = line.find_first_of("\"<", directive);
+				size_t const close = open == std::string::npos ? std::string::npos : line.find_first_of("\">", open + 1);
+				if (close == std::string::npos) return false;
+
+				std::string const include_name = line.substr(open + 1, close - open - 1);
+				std::string const include_path = line[open] == '<' ? paths::ShaderDir + include_name : (fs::path(GetParentPath(file)) / include_name).string();
+				includes.push_back(include_path);
+				if (!ExpandIncludes(include_path, depth + 1, output, includes)) return false;
+			}
+			return true;
+		}
+	}
+
+	Bool GfxNullShaderCompilerBackend::Preprocess(GfxShaderDesc const& input, std::string& preprocessed_source, std::vector<std::string>& includes)
+	{
+		preprocessed_source.clear();
+		for (GfxShaderMacro const& macro : input.macros)
+		{
+			preprocessed_source += "#define " + macro.name + " " + macro.value + "\n";
+		}
+		return ExpandIncludes(input.source_file, 0, preprocessed_source, includes);
+	}
+
+	Bool GfxNullShaderCompilerBackend::Compile(GfxShaderDesc const& input, std::string const& preprocessed_source, GfxShaderBytecode& bytecode, std::string& errors)
+	{
+		if (preprocessed_source.empty())
+		{
+			errors = "Empty shader source: " + input.source_file;
+			return false;
+		}
+
+		Uint64 const source_hash = crc64(preprocessed_source.c_str(), preprocessed_source.size());
+		std::string const entrypoint = input.entrypoint;
+		bytecode.bytecode.resize(sizeof(source_hash) + entrypoint.size());
+		std::memcpy(bytecode.bytecode.data(), &source_hash, sizeof(source_hash));
+		std::memcpy(bytecode.bytecode.data() + sizeof(source_hash), entrypoint.data(), entrypoint.size());
+		return true;
+	}
+}
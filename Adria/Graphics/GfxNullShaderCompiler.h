@@ -0,0 +1,14 @@
+#pragma once
+#include "GfxShaderCompiler.h"
+
+namespace adria
+{
+	//Platform independent backend for headless runs: expands #include and macros textually and
+	//"compiles" into a deterministic blob derived from the preprocessed source.
+	class GfxNullShaderCompilerBackend : public GfxShaderCompilerBackend
+	{
+	public:
+		virtual Bool Preprocess(GfxShaderDesc const& input, std::string& preprocessed_source, std::vector<std::string>& includes) override;
+		virtual Bool Compile(GfxShaderDesc const& input, std::string const& preprocessed_source, GfxShaderBytecode& bytecode, std::string& errors) override;
+	};
+}
@@ -18,111 +18,97 @@ namespace adria
 				block.timestamp_query_end = std::make_unique<GfxQuery>(gfx, QueryType::Timestamp);
 			}
 		}
+		timing_history.GetBudgetExceededEvent().Add([](GfxBudgetExceeded const& budget_exceeded)
+			{
+				ADRIA_LOG(WARNING, "%s took %.3f ms in frame %llu, over its budget of %.3f ms", budget_exceeded.name,
+					budget_exceeded.time_ms, budget_exceeded.frame, budget_exceeded.budget_ms);
+			});
 	}
 	void GfxProfiler::Destroy()
 	{
-		name_to_index_map.clear();
+		open_queries.clear();
 		gfx = nullptr;
 	}
 	void GfxProfiler::NewFrame()
 	{
 		++current_frame;
-		name_to_index_map.clear();
-		scope_counter = 0;
-
 		Uint64 i = current_frame % FRAME_COUNT;
-		for (auto& block : queries[i])
-		{
-			block.begin_called = false;
-			block.end_called = false;
-		}
-
+		if (query_counts[i] > 0) ResolveQueries(i, current_frame - FRAME_COUNT);
+		query_counts[i] = 0;
+		open_queries.clear();
 	}
 
 
-	void GfxProfiler::BeginProfileScope(GfxCommandContext* context, Char const* name)
+	void GfxProfiler::BeginProfileScope(GfxCommandContext* context, Uint32 scope_id)
 	{
 		Uint64 i = current_frame % FRAME_COUNT;
-		Uint32 profile_index = scope_counter++;
-		name_to_index_map[name] = profile_index;
+		Uint32 profile_index = query_counts[i]++;
+		ADRIA_ASSERT(profile_index < MAX_QUERIES);
+		open_queries.push_back(profile_index);
 
 		QueryData& query_data = queries[i][profile_index];
 		ADRIA_ASSERT(!query_data.begin_called);
 		ADRIA_ASSERT(!query_data.end_called);
 		context->BeginQuery(query_data.disjoint_query.get());
 		context->EndQuery(query_data.timestamp_query_start.get());
+		query_data.scope_id = scope_id;
 		query_data.begin_called = true;
 	}
-	void GfxProfiler::EndProfileScope(GfxCommandContext* context, Char const* name)
+	void GfxProfiler::EndProfileScope(GfxCommandContext* context, Uint32 scope_id)
 	{
 		Uint64 i = current_frame % FRAME_COUNT;
-		Uint32 profile_index = -1;
-		profile_index = name_to_index_map[name];
-		ADRIA_ASSERT(profile_index != Uint32(-1));
+		ADRIA_ASSERT(!open_queries.empty());
+		Uint32 profile_index = open_queries.back();
+		open_queries.pop_back();
 
 		QueryData& query_data = queries[i][profile_index];
+		ADRIA_ASSERT(query_data.scope_id == scope_id);
 		ADRIA_ASSERT(query_data.begin_called);
 		ADRIA_ASSERT(!query_data.end_called);
 		context->EndQuery(query_data.timestamp_query_end.get());
 		context->EndQuery(query_data.disjoint_query.get());
 		query_data.end_called = true;
 	}
-	std::vector<Timestamp> GfxProfiler::GetProfilingResults()
+
+	void GfxProfiler::ResolveQueries(Uint64 frame_index, Uint64 frame)
 	{
 		GfxCommandContext* context = gfx->GetCommandContext();
-		if (current_frame < FRAME_COUNT - 1)
-		{
-			++current_frame;
-			return {};
-		}
-
-		Uint64 old_index = (current_frame - FRAME_COUNT + 1) % FRAME_COUNT;
-		auto& old_queries = queries[old_index];
-
-		Bool hr = true;
 		QueryDataTimestampDisjoint disjoint_ts{};
-
-		std::vector<Timestamp> results{};
-		results.reserve(name_to_index_map.size());
-		for (auto const& [name, index] : name_to_index_map)
+		for (Uint32 k = 0; k < query_counts[frame_index]; ++k)
 		{
-			ADRIA_ASSERT(index < MAX_QUERIES);
-			QueryData& query = old_queries[index];
+			QueryData& query = queries[frame_index][k];
 			if (query.begin_called && query.end_called)
 			{
+				Char const* name = timing_history.GetScopeName(query.scope_id);
 				while (!context->GetQueryData(query.disjoint_query.get(), nullptr, 0))
 				{
-					ADRIA_LOG(INFO, "Waiting for disjoint timestamp of %s in frame %llu", name.c_str(), current_frame);
+					ADRIA_LOG(INFO, "Waiting for disjoint timestamp of %s in frame %llu", name, frame);
 					std::this_thread::sleep_for(std::chrono::nanoseconds(500));
 				}
-				hr = context->GetQueryData(query.disjoint_query.get(), &disjoint_ts, sizeof(QueryDataTimestampDisjoint));
+				context->GetQueryData(query.disjoint_query.get(), &disjoint_ts, sizeof(QueryDataTimestampDisjoint));
 				if (disjoint_ts.disjoint)
 				{
-					ADRIA_LOG(WARNING, "Disjoint Timestamp Flag in %s!", name.c_str());
+					ADRIA_LOG(WARNING, "Disjoint Timestamp Flag in %s!", name);
 				}
 				else
 				{
 					Uint64 begin_ts = 0;
 					Uint64 end_ts = 0;
-					hr = context->GetQueryData(query.timestamp_query_start.get(), &begin_ts, sizeof(Uint64));
+					context->GetQueryData(query.timestamp_query_start.get(), &begin_ts, sizeof(Uint64));
 					while (!context->GetQueryData(query.timestamp_query_end.get(), nullptr, 0))
 					{
-						ADRIA_LOG(INFO, "Waiting for disjoint timestamp of %s in frame %llu", name.c_str(), current_frame);
+						ADRIA_LOG(INFO, "Waiting for disjoint timestamp of %s in frame %llu", name, frame);
 						std::this_thread::sleep_for(std::chrono::nanoseconds(500));
 					}
-					hr = context->GetQueryData(query.timestamp_query_end.get(), &end_ts, sizeof(Uint64));
+					context->GetQueryData(query.timestamp_query_end.get(), &end_ts, sizeof(Uint64));
 
 					Float time_ms = (end_ts - begin_ts) * 1000.0f / disjoint_ts.frequency;
-					std::string time_ms_string = std::to_string(time_ms);
-					std::string result = name + " time: " + time_ms_string + "ms";
-
-					results.push_back(Timestamp{ .name = name, .time_in_ms = time_ms });
+					timing_history.AddSample(query.scope_id, frame, time_ms);
 				}
 			}
 			query.begin_called = false;
 			query.end_called = false;
 		}
-		return results;
 	}
 
 	GfxProfiler::GfxProfiler() {}
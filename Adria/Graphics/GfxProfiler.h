@@ -1,19 +1,14 @@
 #pragma once
 #include <string>
 #include <array>
-#include <unordered_map>
 #include <d3d11.h>
 #include "GfxMacros.h"
+#include "GfxTimingHistory.h"
+#include "Core/CpuProfiler.h"
 #include "Utilities/Singleton.h"
 
 namespace adria
 {
-	struct Timestamp
-	{
-		std::string name;
-		Float time_in_ms;
-	};
-
 	class GfxDevice;
 	class GfxCommandContext;
 	class GfxQuery;
@@ -29,52 +24,63 @@ namespace adria
 			std::unique_ptr<GfxQuery> disjoint_query;
 			std::unique_ptr<GfxQuery> timestamp_query_start;
 			std::unique_ptr<GfxQuery> timestamp_query_end;
+			Uint32 scope_id = GfxTimingHistory::INVALID_SCOPE;
 			Bool begin_called = false, end_called = false;
 		};
 
 	public:
 		void Initialize(GfxDevice* gfx);
 		void Destroy();
+		//resolves the queries of the frame that used the same query set FRAME_COUNT frames ago into the timing history
 		void NewFrame();
 
-		void BeginProfileScope(GfxCommandContext* context, Char const* name);
-		void EndProfileScope(GfxCommandContext* context, Char const* name);
-		std::vector<Timestamp> GetProfilingResults();
+		//called once per call site by the profile scope macros
+		Uint32 RegisterScope(Char const* name) { return timing_history.RegisterScope(name); }
+		void BeginProfileScope(GfxCommandContext* context, Uint32 scope_id);
+		void EndProfileScope(GfxCommandContext* context, Uint32 scope_id);
+		GfxTimingHistory& GetTimingHistory() { return timing_history; }
 
 	private:
 		GfxDevice* gfx = nullptr;
 		Uint64 current_frame = 0;
 		std::array<std::array<QueryData, MAX_QUERIES>, FRAME_COUNT> queries;
-		std::unordered_map<std::string, Uint32> name_to_index_map;
-		Uint32 scope_counter = 0;
+		std::array<Uint32, FRAME_COUNT> query_counts{};
+		std::vector<Uint32> open_queries;
+		GfxTimingHistory timing_history;
 
 	private:
 		GfxProfiler();
 		~GfxProfiler();
+
+		void ResolveQueries(Uint64 frame_index, Uint64 frame);
 	};
 	#define g_GfxProfiler GfxProfiler::Get()
 
 #if GFX_PROFILING
 	struct GfxProfileScope
 	{
-		GfxProfileScope(GfxCommandContext* context, Char const* name, Bool active = true)
-			: name{ name }, context{ context }, active{ active }
+		GfxProfileScope(GfxCommandContext* context, Char const* name, Uint32 scope_id, Bool active = true)
+			: cpu_scope{ name, CpuProfileCategory::GfxPass }, context{ context }, scope_id{ scope_id }, active{ active }
 		{
-			if (active) g_GfxProfiler.BeginProfileScope(context, name);
+			if (active) g_GfxProfiler.BeginProfileScope(context, scope_id);
 		}
 
 		~GfxProfileScope()
 		{
 			if (active)
-				g_GfxProfiler.EndProfileScope(context, name);
+				g_GfxProfiler.EndProfileScope(context, scope_id);
 		}
 
+		CpuProfileScope cpu_scope; //first so that it encloses the GPU queries
 		GfxCommandContext* context;
-		Char const* name;
+		Uint32 scope_id;
 		Bool active;
 	};
-	#define AdriaGfxProfileScope(context, name) GfxProfileScope ADRIA_CONCAT(gfx_profile, __COUNTER__)(context, name)
-	#define AdriaGfxProfileCondScope(context, name, cond) GfxProfileScope ADRIA_CONCAT(gfx_profile, __COUNTER__)(context, name, cond)
+	//the scope id is interned once per call site
+	#define AdriaGfxProfileCondScope(context, name, cond) \
+		static Uint32 const ADRIA_CONCAT(gfx_profile_id, __LINE__) = g_GfxProfiler.RegisterScope(name); \
+		GfxProfileScope ADRIA_CONCAT(gfx_profile, __LINE__)(context, name, ADRIA_CONCAT(gfx_profile_id, __LINE__), cond)
+	#define AdriaGfxProfileScope(context, name) AdriaGfxProfileCondScope(context, name, true)
 	#define AdriaGfxProfileScopeOld(context, name) 
 	#define AdriaGfxProfileCondScopeOld(context, name, active) 
 #else
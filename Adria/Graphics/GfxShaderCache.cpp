@@ -0,0 +1,215 @@
+#include <fstream>
+#include <cstring>
+#include "GfxShaderCache.h"
+#include "Core/Logger.h"
+#include "Utilities/HashUtil.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		struct ArchiveHeader
+		{
+			Uint32 magic;
+			Uint32 version;
+			Uint64 entry_count;
+			Uint64 blob_size;
+		};
+		struct ArchiveIndexEntry
+		{
+			Uint64 key;
+			Uint64 offset;
+			Uint32 size;
+			Uint32 padding;
+		};
+	}
+
+	Bool GfxShaderCache::Load(std::string const& _archive_path)
+	{
+		std::lock_guard lock(mutex);
+		archive_path = _archive_path;
+		blobs.clear();
+		index.clear();
+		dirty = false;
+		used_count = 0;
+		saved_count = 0;
+
+		std::ifstream is(archive_path, std::ios::binary | std::ios::ate);
+		if (!is) return false;
+		Uint64 const file_size = (Uint64)is.tellg();
+		is.seekg(0);
+		std::vector<Uint8> data(file_size);
+		if (!is.read(reinterpret_cast<Char*>(data.data()), file_size)) return false;
+
+		ArchiveHeader header{};
+		if (file_size < sizeof(ArchiveHeader)) return false;
+		std::memcpy(&header, data.data(), sizeof(ArchiveHeader));
+		if (header.magic != MAGIC || header.version != VERSION) return false;
+
+		Uint64 const index_size = header.entry_count * sizeof(ArchiveIndexEntry);
+		if (sizeof(ArchiveHeader) + index_size + header.blob_size != file_size) return false;
+
+		Uint8 const* index_data = data.data() + sizeof(ArchiveHeader);
+		index.reserve(header.entry_count);
+		for (Uint64 i = 0; i < header.entry_count; ++i)
+		{
+			ArchiveIndexEntry entry{};
+			std::memcpy(&entry, index_data + i * sizeof(ArchiveIndexEntry), sizeof(ArchiveIndexEntry));
+			if (entry.offset + entry.size > header.blob_size) return false;
+			index[entry.key] = Entry{ .offset = entry.offset, .size = entry.size };
+		}
+		blobs.assign(index_data + index_size, index_data + index_size + header.blob_size);
+		saved_count = index.size();
+		return true;
+	}
+
+	Bool GfxShaderCache::Save() const
+	{
+		std::lock_guard lock(mutex);
+		std::ofstream os(archive_path, std::ios::binary | std::ios::trunc);
+		if (!os) return false;
+
+		//the in-memory cache keeps unused entries, later lookups in this session can still hit them
+		std::vector<ArchiveIndexEntry> index_entries;
+		index_entries.reserve(used_count);
+		Uint64 blob_size = 0;
+		for (auto const& [key, entry] : index)
+		{
+			if (!entry.used) continue;
+			index_entries.push_back(ArchiveIndexEntry{ .key = key, .offset = blob_size, .size = entry.size, .padding = 0 });
+			blob_size += entry.size;
+		}
+
+		ArchiveHeader header{ .magic = MAGIC, .version = VERSION, .entry_count = index_entries.size(), .blob_size = blob_size };
+		os.write(reinterpret_cast<Char const*>(&header), sizeof(header));
+		os.write(reinterpret_cast<Char const*>(index_entries.data()), index_entries.size() * sizeof(ArchiveIndexEntry));
+		for (ArchiveIndexEntry const& index_entry : index_entries)
+		{
+			Entry const& entry = index.at(index_entry.key);
+			os.write(reinterpret_cast<Char const*>(blobs.data() + entry.offset), entry.size);
+		}
+		dirty = false;
+		saved_count = index_entries.size();
+		return (Bool)os;
+	}
+
+	Bool GfxShaderCache::Find(Uint64 key, GfxShaderBytecode& bytecode) const
+	{
+		std::lock_guard lock(mutex);
+		auto it = index.find(key);
+		if (it == index.end()) return false;
+		Entry const& entry = it->second;
+		if (!entry.used)
+		{
+			entry.used = true;
+			++used_count;
+		}
+		bytecode.bytecode.assign(blobs.begin() + entry.offset, blobs.begin() + entry.offset + entry.size);
+		return true;
+	}
+
+	void GfxShaderCache::Insert(Uint64 key, GfxShaderBytecode const& bytecode)
+	{
+		std::lock_guard lock(mutex);
+		auto [it, inserted] = index.try_emplace(key, Entry{ .offset = blobs.size(), .size = bytecode.GetLength() });
+		if (!it->second.used)
+		{
+			it->second.used = true;
+			++used_count;
+		}
+		if (!inserted) return;
+		blobs.insert(blobs.end(), bytecode.bytecode.begin(), bytecode.bytecode.end());
+		dirty = true;
+	}
+
+	Uint64 GfxShaderCache::ComputeKey(GfxShaderDesc const& desc, std::string const& preprocessed_source)
+	{
+		std::string compile_options = desc.entrypoint;
+		compile_options += '|';
+		compile_options += std::to_string((Uint32)desc.stage);
+		compile_options += '|';
+		compile_options += std::to_string(desc.flags);
+		for (GfxShaderMacro const& macro : desc.macros)
+		{
+			compile_options += '|';
+			compile_options += macro.name;
+			compile_options += '=';
+			compile_options += macro.value;
+		}
+
+		size_t key = crc64(preprocessed_source.c_str(), preprocessed_source.size());
+		HashCombine(key, crc64(compile_options.c_str(), compile_options.size()));
+		return key;
+	}
+
+	GfxShaderBatchStats CompileShadersCached(GfxShaderCompilerBackend& backend, GfxShaderCache& cache,
+		std::span<GfxShaderDesc const> inputs, std::span<GfxShaderCompileOutput> outputs)
+	{
+		ADRIA_ASSERT(inputs.size() == outputs.size());
+		GfxShaderBatchStats stats{};
+		Uint32 const count = (Uint32)inputs.size();
+
+		std::vector<std::string> sources(count);
+		std::vector<Uint64> keys(count, 0);
+		std::vector<Uint8> succeeded(count, 0);
+
+		Timer<> timer;
+		g_JobSystem.ParallelFor(count, 1, [&](Uint32 i)
+		{
+			outputs[i] = GfxShaderCompileOutput{};
+			if (!backend.Preprocess(inputs[i], sources[i], outputs[i].includes)) return;
+			keys[i] = GfxShaderCache::ComputeKey(inputs[i], sources[i]);
+			succeeded[i] = 1;
+		});
+		stats.preprocess_time = timer.MarkInSeconds();
+
+		//inputs that preprocess to the same key are compiled once
+		std::vector<Uint32> misses;
+		std::vector<std::pair<Uint32, Uint32>> duplicate_misses;
+		std::unordered_map<Uint64, Uint32> miss_keys;
+		for (Uint32 i = 0; i < count; ++i)
+		{
+			if (!succeeded[i]) continue;
+			if (cache.Find(keys[i], outputs[i].shader_bytecode)) ++stats.cache_hits;
+			else if (auto [it, inserted] = miss_keys.try_emplace(keys[i], i); inserted) misses.push_back(i);
+			else duplicate_misses.emplace_back(i, it->second);
+		}
+		stats.cache_misses = (Uint32)(misses.size() + duplicate_misses.size());
+
+		g_JobSystem.ParallelFor((Uint32)misses.size(), 1, [&](Uint32 j)
+		{
+			Uint32 const i = misses[j];
+			std::string errors;
+			if (backend.Compile(inputs[i], sources[i], outputs[i].shader_bytecode, errors))
+			{
+				cache.Insert(keys[i], outputs[i].shader_bytecode);
+			}
+			else
+			{
+				ADRIA_LOG(ERROR, "%s", errors.c_str());
+				succeeded[i] = 0;
+			}
+		});
+		stats.compile_time = timer.MarkInSeconds();
+		for (auto const& [duplicate, original] : duplicate_misses)
+		{
+			succeeded[duplicate] = succeeded[original];
+			outputs[duplicate].shader_bytecode = outputs[original].shader_bytecode;
+		}
+
+		for (Uint32 i = 0; i < count; ++i)
+		{
+			if (!succeeded[i])
+			{
+				stats.failed_inputs.push_back(i);
+				continue;
+			}
+			GfxShaderBytecode const& bytecode = outputs[i].shader_bytecode;
+			outputs[i].includes.push_back(inputs[i].source_file);
+			outputs[i].hash = crc64(reinterpret_cast<Char const*>(bytecode.GetPointer()), bytecode.GetLength());
+		}
+		return stats;
+	}
+}
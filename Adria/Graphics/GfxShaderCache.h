@@ -0,0 +1,62 @@
+#pragma once
+#include <span>
+#include <mutex>
+#include <unordered_map>
+#include "GfxShaderCompiler.h"
+
+namespace adria
+{
+	//Packed shader cache: one archive file with all bytecode blobs followed by an index of content keys.
+	//A key hashes the preprocessed source (macros and includes already expanded), entry point, target and flags,
+	//so an entry can never be stale and needs no timestamp checks.
+	class GfxShaderCache
+	{
+		static constexpr Uint32 MAGIC = 0x48534441; //'ADSH'
+		static constexpr Uint32 VERSION = 1;
+
+		struct Entry
+		{
+			Uint64 offset;
+			Uint32 size;
+			mutable Bool used = false;
+		};
+
+	public:
+		GfxShaderCache() = default;
+
+		Bool Load(std::string const& archive_path);
+		//only writes entries that were found or inserted since Load, keys superseded by edited shaders are dropped
+		Bool Save() const;
+
+		Bool Find(Uint64 key, GfxShaderBytecode& bytecode) const;
+		void Insert(Uint64 key, GfxShaderBytecode const& bytecode);
+
+		Uint64 EntryCount() const { return index.size(); }
+		Bool IsDirty() const { return dirty || used_count != saved_count; }
+
+		static Uint64 ComputeKey(GfxShaderDesc const& desc, std::string const& preprocessed_source);
+
+	private:
+		std::string archive_path;
+		std::vector<Uint8> blobs;
+		std::unordered_map<Uint64, Entry> index;
+		mutable std::mutex mutex;
+		mutable Bool dirty = false;
+		mutable Uint64 used_count = 0;
+		mutable Uint64 saved_count = 0;
+	};
+
+	struct GfxShaderBatchStats
+	{
+		Uint32 cache_hits = 0;
+		Uint32 cache_misses = 0;
+		std::vector<Uint64> failed_inputs;
+		Float preprocess_time = 0.0f;
+		Float compile_time = 0.0f;
+	};
+
+	//Preprocesses every input in parallel, checks all keys against the cache in one pass and compiles the misses in parallel.
+	//Indices of inputs that failed to preprocess or compile are returned in failed_inputs.
+	GfxShaderBatchStats CompileShadersCached(GfxShaderCompilerBackend& backend, GfxShaderCache& cache,
+		std::span<GfxShaderDesc const> inputs, std::span<GfxShaderCompileOutput> outputs);
+}
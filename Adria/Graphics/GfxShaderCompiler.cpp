@@ -1,12 +1,12 @@
+#include <fstream>
 #include <d3dcompiler.h> 
 #include "GfxShaderCompiler.h"
+#include "GfxShaderCache.h"
 #include "GfxInputLayout.h"
 #include "Core/Logger.h" 
 #include "Core/Paths.h" 
-#include "Utilities/HashUtil.h"
 #include "Utilities/StringUtil.h"
 #include "Utilities/FilesUtil.h"
-#include "cereal/archives/binary.hpp"
 
 namespace adria
 {
@@ -71,62 +71,8 @@ namespace adria
 			std::vector<std::string> includes;
 		};
 
-		Bool CheckCache(Char const* cache_path, GfxShaderDesc const& input, GfxShaderCompileOutput& output)
+		std::pair<std::string, std::string> GetEntryPointAndModel(GfxShaderDesc const& input)
 		{
-			if (!FileExists(cache_path)) return false;
-			if (GetFileLastWriteTime(cache_path) < GetFileLastWriteTime(input.source_file)) return false;
-
-			std::ifstream is(cache_path, std::ios::binary);
-			cereal::BinaryInputArchive archive(is);
-
-			archive(output.hash);
-			archive(output.includes);
-			Uint32 binary_size = 0;
-			archive(binary_size);
-
-			//check if the one of the includes was modified after the cache binary was generated
-			for (std::string const& include : output.includes)
-			{
-				if (GetFileLastWriteTime(cache_path) < GetFileLastWriteTime(include))
-					return false;
-			}
-
-			std::unique_ptr<Char[]> binary_data(new Char[binary_size]);
-			archive.loadBinary(binary_data.get(), binary_size);
-			output.shader_bytecode.SetBytecode(binary_data.get(), binary_size);
-			return true;
-		}
-		Bool SaveToCache(Char const* cache_path, GfxShaderCompileOutput const& output)
-		{
-			std::ofstream os(cache_path, std::ios::binary);
-			cereal::BinaryOutputArchive archive(os);
-			archive(output.hash);
-			archive(output.includes);
-			archive(output.shader_bytecode.GetLength());
-			archive.saveBinary(output.shader_bytecode.GetPointer(), output.shader_bytecode.GetLength());
-			return true;
-		}
-	}
-
-	namespace GfxShaderCompiler
-	{
-
-		void GetBytecodeFromCompiledShader(Char const* filename, GfxShaderBytecode& blob)
-		{
-			Ref<ID3DBlob> bytecode_blob;
-
-			std::wstring wide_filename = ToWideString(std::string(filename));
-			HRESULT hr = D3DReadFileToBlob(wide_filename.c_str(), bytecode_blob.GetAddressOf());
-			GFX_CHECK_HR(hr);
-
-			blob.bytecode.resize(bytecode_blob->GetBufferSize());
-			std::memcpy(blob.GetPointer(), bytecode_blob->GetBufferPointer(), blob.GetLength());
-		}
-
-		Bool CompileShader(GfxShaderDesc const& input,
-			GfxShaderCompileOutput& output)
-		{
-			output = GfxShaderCompileOutput{};
 			std::string default_entrypoint, model;
 			switch (input.stage)
 			{
@@ -157,82 +103,128 @@ namespace adria
 			default:
 				ADRIA_ASSERT_MSG(false, "Unsupported Shader Stage!");
 			}
-			default_entrypoint = input.entrypoint.empty() ? default_entrypoint : input.entrypoint;
+			return { input.entrypoint.empty() ? default_entrypoint : input.entrypoint, model };
+		}
 
-			std::string macro_key;
-			for (GfxShaderMacro const& macro : input.macros)
+		class D3DShaderCompilerBackend : public GfxShaderCompilerBackend
+		{
+		public:
+			virtual Bool Preprocess(GfxShaderDesc const& input, std::string& preprocessed_source, std::vector<std::string>& includes) override
 			{
-				macro_key += macro.name;
-				macro_key += macro.value;
-			}
-			Uint64 macro_hash = crc64(macro_key.c_str(), macro_key.size());
+				std::ifstream file_stream(input.source_file, std::ios::binary);
+				if (!file_stream)
+				{
+					ADRIA_LOG(ERROR, "Could not open shader file '%s'!", input.source_file.c_str());
+					return false;
+				}
+				std::string source((std::istreambuf_iterator<Char>(file_stream)), std::istreambuf_iterator<Char>());
+
+				std::vector<D3D_SHADER_MACRO> defines;
+				defines.reserve(input.macros.size() + 1);
+				for (GfxShaderMacro const& macro : input.macros) defines.push_back({ macro.name.c_str(), macro.value.c_str() });
+				defines.push_back({ NULL, NULL });
+
+				CShaderInclude includer(GetParentPath(input.source_file).c_str());
+				Ref<ID3DBlob> preprocessed_blob = nullptr;
+				Ref<ID3DBlob> error_blob = nullptr;
+				HRESULT hr = D3DPreprocess(source.data(), source.size(), input.source_file.c_str(), defines.data(), &includer,
+					preprocessed_blob.GetAddressOf(), error_blob.GetAddressOf());
+				if (FAILED(hr))
+				{
+					if (error_blob) ADRIA_LOG(ERROR, "%s", reinterpret_cast<Char const*>(error_blob->GetBufferPointer()));
+					return false;
+				}
 
-			std::string build_string = input.flags & GfxShaderCompilerFlagBit_Debug ? "debug" : "release";
-			Char cache_path[256];
-			sprintf_s(cache_path, "%s%s_%s_%llx_%s.bin", paths::ShaderCacheDir.c_str(),
-				GetFilenameWithoutExtension(input.source_file).c_str(), default_entrypoint.c_str(), macro_hash, build_string.c_str());
+				preprocessed_source.assign(reinterpret_cast<Char const*>(preprocessed_blob->GetBufferPointer()), preprocessed_blob->GetBufferSize());
+				while (!preprocessed_source.empty() && preprocessed_source.back() == '\0') preprocessed_source.pop_back();
+				includes = includer.GetIncludes();
+				return true;
+			}
 
-			if (CheckCache(cache_path, input, output)) return true;
-			ADRIA_LOG(INFO, "Shader '%s.%s' not found in cache. Compiling...", input.source_file.c_str(), default_entrypoint.c_str());
+			virtual Bool Compile(GfxShaderDesc const& input, std::string const& preprocessed_source, GfxShaderBytecode& bytecode, std::string& errors) override
+			{
+				auto const [entrypoint, model] = GetEntryPointAndModel(input);
+				Uint32 shader_compile_flags = D3DCOMPILE_ENABLE_STRICTNESS;
+				if (input.flags & GfxShaderCompilerFlagBit_DisableOptimization) shader_compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+				if (input.flags & GfxShaderCompilerFlagBit_Debug) shader_compile_flags |= D3DCOMPILE_DEBUG;
+
+				Ref<ID3DBlob> bytecode_blob = nullptr;
+				Ref<ID3DBlob> error_blob = nullptr;
+				HRESULT hr = D3DCompile(preprocessed_source.data(), preprocessed_source.size(), input.source_file.c_str(), nullptr, nullptr,
+					entrypoint.c_str(), model.c_str(), shader_compile_flags, 0, bytecode_blob.GetAddressOf(), error_blob.GetAddressOf());
+				if (FAILED(hr))
+				{
+					if (error_blob) errors.assign(reinterpret_cast<Char const*>(error_blob->GetBufferPointer()), error_blob->GetBufferSize());
+					return false;
+				}
+				bytecode.SetBytecode(bytecode_blob->GetBufferPointer(), (Uint32)bytecode_blob->GetBufferSize());
+				return true;
+			}
+		};
 
-		compile:
-			Uint32 shader_compile_flags = D3DCOMPILE_ENABLE_STRICTNESS;
-			if (input.flags & GfxShaderCompilerFlagBit_DisableOptimization) shader_compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-			if (input.flags & GfxShaderCompilerFlagBit_Debug) shader_compile_flags |= D3DCOMPILE_DEBUG;
-			std::vector<D3D_SHADER_MACRO> defines{};
-			defines.resize(input.macros.size());
+		std::unique_ptr<GfxShaderCompilerBackend> backend;
+		GfxShaderCache cache;
+	}
 
-			for (Uint32 i = 0; i < input.macros.size(); ++i)
-			{
-				defines[i].Name = (Char*)malloc(sizeof(input.macros[i].name));
-				defines[i].Definition = (Char*)malloc(sizeof(input.macros[i].value));
+	namespace GfxShaderCompiler
+	{
 
-				strcpy(const_cast<Char*>(defines[i].Name), input.macros[i].name.c_str());
-				strcpy(const_cast<Char*>(defines[i].Definition), input.macros[i].value.c_str());
-			}
-			defines.push_back({ NULL,NULL });
+		void GetBytecodeFromCompiledShader(Char const* filename, GfxShaderBytecode& blob)
+		{
+			Ref<ID3DBlob> bytecode_blob;
 
-			Ref<ID3DBlob> bytecode_blob = nullptr;
-			Ref<ID3DBlob> error_blob = nullptr;
+			std::wstring wide_filename = ToWideString(std::string(filename));
+			HRESULT hr = D3DReadFileToBlob(wide_filename.c_str(), bytecode_blob.GetAddressOf());
+			GFX_CHECK_HR(hr);
 
-			CShaderInclude includer(GetParentPath(input.source_file).c_str());
-			HRESULT hr = D3DCompileFromFile(ToWideString(input.source_file).c_str(), defines.data(),
-				&includer, default_entrypoint.c_str(), model.c_str(), shader_compile_flags, 0,
-				bytecode_blob.GetAddressOf(), error_blob.GetAddressOf());
+			blob.bytecode.resize(bytecode_blob->GetBufferSize());
+			std::memcpy(blob.GetPointer(), bytecode_blob->GetBufferPointer(), blob.GetLength());
+		}
 
-			auto const& includes = includer.GetIncludes();
-			if (FAILED(hr))
+		void Initialize()
+		{
+			backend = std::make_unique<D3DShaderCompilerBackend>();
+			if (!cache.Load(paths::ShaderCacheDir + "shaders.bin"))
 			{
-				if (error_blob)
-				{
-					Char const* err_msg = reinterpret_cast<Char const*>(error_blob->GetBufferPointer());
-					ADRIA_LOG(ERROR, "%s", err_msg);
-					std::string msg = "Click OK after you have fixed the following errors: \n";
-					msg += err_msg;
-					Int32 result = MessageBoxA(NULL, msg.c_str(), NULL, MB_OKCANCEL);
-					if (result == IDOK) goto compile;
-					else if (result == IDCANCEL) return false;
-				}
-				return false;
+				ADRIA_LOG(INFO, "Shader cache archive not found or outdated, it will be rebuilt.");
 			}
-			for (auto& define : defines)
+		}
+
+		void Destroy()
+		{
+			if (cache.IsDirty()) cache.Save();
+			backend = nullptr;
+		}
+
+		Bool CompileShader(GfxShaderDesc const& input, GfxShaderCompileOutput& output)
+		{
+			while (true)
 			{
-				if (define.Name)		free((void*)define.Name);
-				if (define.Definition)  free((void*)define.Definition); //change malloc and free to new and delete
+				GfxShaderBatchStats stats = CompileShadersCached(*backend, cache, std::span(&input, 1), std::span(&output, 1));
+				if (stats.failed_inputs.empty()) return true;
+
+				std::string msg = "Shader '" + input.source_file + "." + GetEntryPointAndModel(input).first + "' failed to compile, check the log for errors.\n";
+				msg += "Click OK after you have fixed them.";
+				Int32 result = MessageBoxA(NULL, msg.c_str(), NULL, MB_OKCANCEL);
+				if (result != IDOK) return false;
 			}
+		}
 
-			Uint64 shader_hash = crc64((Char*)bytecode_blob->GetBufferPointer(), bytecode_blob->GetBufferSize());
+		std::vector<Uint64> CompileShaders(std::span<GfxShaderDesc const> inputs, std::span<GfxShaderCompileOutput> outputs)
+		{
+			GfxShaderBatchStats stats = CompileShadersCached(*backend, cache, inputs, outputs);
+			ADRIA_LOG(INFO, "Shader cache: %u hits, %u misses (preprocess %f s, compile %f s)",
+				stats.cache_hits, stats.cache_misses, stats.preprocess_time, stats.compile_time);
 
-			output.shader_bytecode.bytecode.resize(bytecode_blob->GetBufferSize());
-			std::memcpy(output.shader_bytecode.GetPointer(), bytecode_blob->GetBufferPointer(), bytecode_blob->GetBufferSize());
-			output.includes = includes;
-			output.includes.push_back(input.source_file);
-			output.hash = shader_hash;
-			SaveToCache(cache_path, output);
-			return true;
+			std::vector<Uint64> failed_inputs;
+			for (Uint64 i : stats.failed_inputs)
+			{
+				if (!CompileShader(inputs[i], outputs[i])) failed_inputs.push_back(i);
+			}
+			if (cache.IsDirty()) cache.Save();
+			return failed_inputs;
 		}
 
-
 		void FillInputLayoutDesc(GfxShaderBytecode const& blob, GfxInputLayoutDesc& input_desc)
 		{
 			Ref<ID3D11ShaderReflection> vertex_shader_reflection = nullptr;
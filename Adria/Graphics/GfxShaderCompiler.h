@@ -1,4 +1,5 @@
 #pragma once
+#include <span>
 #include "GfxShader.h"
 
 namespace adria
@@ -10,12 +11,28 @@ namespace adria
 		std::vector<std::string> includes;
 		Uint64 hash;
 	};
+
+	//Both calls can run concurrently from several threads
+	class GfxShaderCompilerBackend
+	{
+	public:
+		virtual ~GfxShaderCompilerBackend() = default;
+
+		//expands includes and macros, includes receives every file that was opened
+		virtual Bool Preprocess(GfxShaderDesc const& input, std::string& preprocessed_source, std::vector<std::string>& includes) = 0;
+		virtual Bool Compile(GfxShaderDesc const& input, std::string const& preprocessed_source, GfxShaderBytecode& bytecode, std::string& errors) = 0;
+	};
 	
 	struct GfxInputLayoutDesc;
 	namespace GfxShaderCompiler
 	{
+		void Initialize();
+		void Destroy();
+
 		Bool CompileShader(GfxShaderDesc const& input, GfxShaderCompileOutput& output);
+		//returns the indices of the inputs that could not be compiled
+		std::vector<Uint64> CompileShaders(std::span<GfxShaderDesc const> inputs, std::span<GfxShaderCompileOutput> outputs);
 		void GetBytecodeFromCompiledShader(Char const* filename, GfxShaderBytecode& blob);
 		void FillInputLayoutDesc(GfxShaderBytecode const& blob, GfxInputLayoutDesc& input_desc);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,142 @@
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include "GfxTimingHistory.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/StringUtil.h"
+
+namespace adria
+{
+	namespace
+	{
+		Float Percentile(std::vector<Float> const& sorted_values, Float percentile)
+		{
+			if (sorted_values.empty()) return 0.0f;
+			Uint64 const index = static_cast<Uint64>(percentile * (sorted_values.size() - 1) + 0.5f);
+			return sorted_values[index];
+		}
+
+		Bool OpenDumpFile(std::string const& path, std::ofstream& os)
+		{
+			std::error_code error;
+			fs::create_directories(GetParentPath(path), error);
+			os.open(path, std::ios::trunc);
+			return (Bool)os;
+		}
+	}
+
+	Uint32 GfxTimingHistory::RegisterScope(Char const* name)
+	{
+		for (Uint32 i = 0; i < scopes.size(); ++i)
+		{
+			if (scopes[i].name == name) return i;
+		}
+		scopes.emplace_back().name = name;
+		return static_cast<Uint32>(scopes.size() - 1);
+	}
+
+	void GfxTimingHistory::AddSample(Uint32 scope_id, Uint64 frame, Float time_ms)
+	{
+		ADRIA_ASSERT(scope_id < scopes.size());
+		ScopeHistory& scope = scopes[scope_id];
+		scope.samples[scope.head] = time_ms;
+		scope.head = (scope.head + 1) % HISTORY_SIZE;
+		scope.count = std::min(scope.count + 1, HISTORY_SIZE);
+		scope.last_frame = frame;
+
+		Bool const over_budget = scope.budget_ms > 0.0f && time_ms > scope.budget_ms;
+		if (over_budget && !scope.over_budget)
+		{
+			budget_exceeded_event.Broadcast(GfxBudgetExceeded{ .name = scope.name.c_str(), .frame = frame, .time_ms = time_ms, .budget_ms = scope.budget_ms });
+		}
+		scope.over_budget = over_budget;
+	}
+
+	void GfxTimingHistory::Clear()
+	{
+		for (ScopeHistory& scope : scopes)
+		{
+			scope.head = 0;
+			scope.count = 0;
+			scope.over_budget = false;
+		}
+	}
+
+	void GfxTimingHistory::SetBudget(Uint32 scope_id, Float budget_ms)
+	{
+		ADRIA_ASSERT(scope_id < scopes.size());
+		scopes[scope_id].budget_ms = std::max(budget_ms, 0.0f);
+		scopes[scope_id].over_budget = false;
+	}
+
+	GfxTimingStats GfxTimingHistory::GetStats(Uint32 scope_id, Uint32 window) const
+	{
+		ADRIA_ASSERT(scope_id < scopes.size());
+		ScopeHistory const& scope = scopes[scope_id];
+		GfxTimingStats stats{};
+		stats.sample_count = std::min(window, scope.count);
+		if (stats.sample_count == 0) return stats;
+
+		//the newest sample is just before head
+		sorted_samples.resize(stats.sample_count);
+		for (Uint32 i = 0; i < stats.sample_count; ++i)
+		{
+			sorted_samples[i] = scope.samples[(scope.head + HISTORY_SIZE - 1 - i) % HISTORY_SIZE];
+		}
+		stats.last = sorted_samples[0];
+
+		Float total = 0.0f;
+		for (Float sample : sorted_samples)
+		{
+			total += sample;
+			if (scope.budget_ms > 0.0f && sample > scope.budget_ms) ++stats.over_budget_count;
+		}
+		stats.mean = total / stats.sample_count;
+
+		std::sort(sorted_samples.begin(), sorted_samples.end());
+		stats.p50 = Percentile(sorted_samples, 0.5f);
+		stats.p95 = Percentile(sorted_samples, 0.95f);
+		stats.p99 = Percentile(sorted_samples, 0.99f);
+		stats.max = sorted_samples.back();
+		return stats;
+	}
+
+	Bool GfxTimingHistory::WriteCsv(std::string const& path, Uint32 window) const
+	{
+		std::ofstream os;
+		if (!OpenDumpFile(path, os)) return false;
+
+		Char line[512];
+		os << "scope,samples,last_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,budget_ms,over_budget\n";
+		for (Uint32 i = 0; i < scopes.size(); ++i)
+		{
+			GfxTimingStats const stats = GetStats(i, window);
+			std::snprintf(line, sizeof(line), ",%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u\n", stats.sample_count, stats.last, stats.mean,
+				stats.p50, stats.p95, stats.p99, stats.max, scopes[i].budget_ms, stats.over_budget_count);
+			WriteCsvString(os, scopes[i].name.c_str());
+			os << line;
+		}
+		return (Bool)os;
+	}
+
+	Bool GfxTimingHistory::WriteJson(std::string const& path, Uint32 window) const
+	{
+		std::ofstream os;
+		if (!OpenDumpFile(path, os)) return false;
+
+		Char line[512];
+		os << "{\"window\":" << window << ",\"scopes\":[";
+		for (Uint32 i = 0; i < scopes.size(); ++i)
+		{
+			GfxTimingStats const stats = GetStats(i, window);
+			std::snprintf(line, sizeof(line), ",\"samples\":%u,\"last_ms\":%.4f,\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f,"
+				"\"budget_ms\":%.4f,\"over_budget\":%u}", stats.sample_count, stats.last, stats.mean, stats.p50, stats.p95, stats.p99, stats.max,
+				scopes[i].budget_ms, stats.over_budget_count);
+			os << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+			WriteJsonString(os, scopes[i].name.c_str());
+			os << line;
+		}
+		os << "\n]}\n";
+		return (Bool)os;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include "Utilities/Delegate.h"
+
+namespace adria
+{
+	struct GfxTimingStats
+	{
+		Uint32 sample_count = 0;
+		Uint32 over_budget_count = 0;
+		Float last = 0.0f;
+		Float mean = 0.0f;
+		Float p50 = 0.0f;
+		Float p95 = 0.0f;
+		Float p99 = 0.0f;
+		Float max = 0.0f;
+	};
+
+	struct GfxBudgetExceeded
+	{
+		Char const* name;
+		Uint64 frame;
+		Float time_ms;
+		Float budget_ms;
+	};
+
+	DECLARE_EVENT(GfxBudgetExceededEvent, GfxTimingHistory, GfxBudgetExceeded const&);
+
+	//Keeps the last HISTORY_SIZE samples of every registered scope in a ring and computes statistics over the most recent
+	//samples on request. A scope that goes over its budget raises one event, and another only after it was back within it.
+	//Knows nothing about queries, so it can be fed from the GPU profiler or from synthetic timings.
+	class GfxTimingHistory
+	{
+	public:
+		static constexpr Uint32 HISTORY_SIZE = 512;
+		static constexpr Uint32 INVALID_SCOPE = Uint32(-1);
+
+	public:
+		GfxTimingHistory() = default;
+		~GfxTimingHistory()
+		{
+			budget_exceeded_event.RemoveAll();
+		}
+
+		//returns the id of the scope with that name, registering it the first time
+		Uint32 RegisterScope(Char const* name);
+		void AddSample(Uint32 scope_id, Uint64 frame, Float time_ms);
+		void Clear();
+
+		//a budget of zero disables the check
+		void SetBudget(Uint32 scope_id, Float budget_ms);
+		Float GetBudget(Uint32 scope_id) const { return scopes[scope_id].budget_ms; }
+
+		//statistics over the last window samples of the scope
+		GfxTimingStats GetStats(Uint32 scope_id, Uint32 window = HISTORY_SIZE) const;
+		Uint32 GetScopeCount() const { return static_cast<Uint32>(scopes.size()); }
+		Char const* GetScopeName(Uint32 scope_id) const { return scopes[scope_id].name.c_str(); }
+		Uint64 GetLastFrame(Uint32 scope_id) const { return scopes[scope_id].last_frame; }
+
+		Bool WriteCsv(std::string const& path, Uint32 window = HISTORY_SIZE) const;
+		Bool WriteJson(std::string const& path, Uint32 window = HISTORY_SIZE) const;
+
+		GfxBudgetExceededEvent& GetBudgetExceededEvent() { return budget_exceeded_event; }
+
+	private:
+		struct ScopeHistory
+		{
+			std::string name;
+			std::array<Float, HISTORY_SIZE> samples{};
+			Uint32 head = 0;
+			Uint32 count = 0;
+			Uint64 last_frame = 0;
+			Float budget_ms = 0.0f;
+			Bool over_budget = false;
+		};
+		std::vector<ScopeHistory> scopes;
+		mutable std::vector<Float> sorted_samples;
+		GfxBudgetExceededEvent budget_exceeded_event;
+	};
+}
@@ -48,5 +48,16 @@ namespace adria
 		Vector3 bitangent;
 	};
 
+	//compact CompleteVertex, 20 instead of 56 bytes. Positions are 16 bit unorm inside the mesh bounds with the tangent handedness in w,
+	//uvs are half floats and normal and tangent are octahedral encoded snorm, the bitangent is rebuilt from them in the vertex shader
+	struct CompressedVertex
+	{
+		Uint16 position[4];
+		Uint16 uv[2];
+		Int16  normal[2];
+		Int16  tangent[2];
+	};
+	static_assert(sizeof(CompressedVertex) == 20);
+
 }
 
@@ -0,0 +1,246 @@
+#include "DynamicBVH.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Float FAT_BOX_MARGIN = 0.1f;
+		constexpr Float FAT_BOX_RELATIVE_MARGIN = 0.1f;
+
+		BoundingBox Merge(BoundingBox const& a, BoundingBox const& b)
+		{
+			BoundingBox merged;
+			BoundingBox::CreateMerged(merged, a, b);
+			return merged;
+		}
+
+		Float SurfaceArea(BoundingBox const& box)
+		{
+			return 8.0f * (box.Extents.x * box.Extents.y + box.Extents.y * box.Extents.z + box.Extents.z * box.Extents.x);
+		}
+
+		BoundingBox Fatten(BoundingBox const& box)
+		{
+			BoundingBox fat_box = box;
+			fat_box.Extents.x += FAT_BOX_MARGIN + box.Extents.x * FAT_BOX_RELATIVE_MARGIN;
+			fat_box.Extents.y += FAT_BOX_MARGIN + box.Extents.y * FAT_BOX_RELATIVE_MARGIN;
+			fat_box.Extents.z += FAT_BOX_MARGIN + box.Extents.z * FAT_BOX_RELATIVE_MARGIN;
+			return fat_box;
+		}
+	}
+
+	Int32 DynamicBVH::Insert(BoundingBox const& box, Uint64 user_data)
+	{
+		Int32 proxy = AllocateNode();
+		nodes[proxy].box = Fatten(box);
+		nodes[proxy].tight_box = box;
+		nodes[proxy].user_data = user_data;
+		nodes[proxy].height = 0;
+		InsertLeaf(proxy);
+		++proxy_count;
+		return proxy;
+	}
+
+	void DynamicBVH::Remove(Int32 proxy)
+	{
+		ADRIA_ASSERT(0 <= proxy && proxy < (Int32)nodes.size());
+		ADRIA_ASSERT(nodes[proxy].IsLeaf());
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--proxy_count;
+	}
+
+	Bool DynamicBVH::Move(Int32 proxy, BoundingBox const& box)
+	{
+		ADRIA_ASSERT(0 <= proxy && proxy < (Int32)nodes.size());
+		ADRIA_ASSERT(nodes[proxy].IsLeaf());
+
+		nodes[proxy].tight_box = box;
+		if (nodes[proxy].box.Contains(box) == DirectX::CONTAINS) return false;
+
+		RemoveLeaf(proxy);
+		nodes[proxy].box = Fatten(box);
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicBVH::Clear()
+	{
+		nodes.clear();
+		root = NULL_NODE;
+		free_list = NULL_NODE;
+		proxy_count = 0;
+	}
+
+	Int32 DynamicBVH::AllocateNode()
+	{
+		if (free_list == NULL_NODE)
+		{
+			nodes.emplace_back();
+			return (Int32)nodes.size() - 1;
+		}
+		Int32 node = free_list;
+		free_list = nodes[node].parent;
+		nodes[node] = Node{};
+		return node;
+	}
+
+	void DynamicBVH::FreeNode(Int32 node)
+	{
+		nodes[node].parent = free_list;
+		nodes[node].child1 = NULL_NODE;
+		nodes[node].child2 = NULL_NODE;
+		nodes[node].height = -1;
+		free_list = node;
+	}
+
+	void DynamicBVH::InsertLeaf(Int32 leaf)
+	{
+		if (root == NULL_NODE)
+		{
+			root = leaf;
+			nodes[root].parent = NULL_NODE;
+			return;
+		}
+
+		//find the best sibling using the surface area heuristic
+		BoundingBox const leaf_box = nodes[leaf].box;
+		Int32 index = root;
+		while (!nodes[index].IsLeaf())
+		{
+			Int32 const child1 = nodes[index].child1;
+			Int32 const child2 = nodes[index].child2;
+
+			Float const area = SurfaceArea(nodes[index].box);
+			Float const combined_area = SurfaceArea(Merge(nodes[index].box, leaf_box));
+
+			Float const cost = 2.0f * combined_area;
+			Float const inheritance_cost = 2.0f * (combined_area - area);
+
+			auto DescendCost = [&](Int32 child)
+			{
+				Float const merged_area = SurfaceArea(Merge(leaf_box, nodes[child].box));
+				if (nodes[child].IsLeaf()) return merged_area + inheritance_cost;
+				return (merged_area - SurfaceArea(nodes[child].box)) + inheritance_cost;
+			};
+			Float const cost1 = DescendCost(child1);
+			Float const cost2 = DescendCost(child2);
+
+			if (cost < cost1 && cost < cost2) break;
+			index = cost1 < cost2 ? child1 : child2;
+		}
+
+		Int32 const sibling = index;
+		Int32 const old_parent = nodes[sibling].parent;
+		Int32 const new_parent = AllocateNode();
+		nodes[new_parent].parent = old_parent;
+		nodes[new_parent].box = Merge(leaf_box, nodes[sibling].box);
+		nodes[new_parent].height = nodes[sibling].height + 1;
+		nodes[new_parent].child1 = sibling;
+		nodes[new_parent].child2 = leaf;
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		if (old_parent != NULL_NODE)
+		{
+			if (nodes[old_parent].child1 == sibling) nodes[old_parent].child1 = new_parent;
+			else nodes[old_parent].child2 = new_parent;
+		}
+		else root = new_parent;
+
+		//refit and rebalance the ancestors
+		index = nodes[leaf].parent;
+		while (index != NULL_NODE)
+		{
+			index = Balance(index);
+			Int32 const child1 = nodes[index].child1;
+			Int32 const child2 = nodes[index].child2;
+			nodes[index].height = 1 + (std::max)(nodes[child1].height, nodes[child2].height);
+			nodes[index].box = Merge(nodes[child1].box, nodes[child2].box);
+			index = nodes[index].parent;
+		}
+	}
+
+	void DynamicBVH::RemoveLeaf(Int32 leaf)
+	{
+		if (leaf == root)
+		{
+			root = NULL_NODE;
+			return;
+		}
+
+		Int32 const parent = nodes[leaf].parent;
+		Int32 const grand_parent = nodes[parent].parent;
+		Int32 const sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grand_parent != NULL_NODE)
+		{
+			if (nodes[grand_parent].child1 == parent) nodes[grand_parent].child1 = sibling;
+			else nodes[grand_parent].child2 = sibling;
+			nodes[sibling].parent = grand_parent;
+			FreeNode(parent);
+
+			Int32 index = grand_parent;
+			while (index != NULL_NODE)
+			{
+				index = Balance(index);
+				Int32 const child1 = nodes[index].child1;
+				Int32 const child2 = nodes[index].child2;
+				nodes[index].box = Merge(nodes[child1].box, nodes[child2].box);
+				nodes[index].height = 1 + (std::max)(nodes[child1].height, nodes[child2].height);
+				index = nodes[index].parent;
+			}
+		}
+		else
+		{
+			root = sibling;
+			nodes[sibling].parent = NULL_NODE;
+			FreeNode(parent);
+		}
+	}
+
+	//rotates the taller child up if the subtree rooted at a is imbalanced, returns the new subtree root
+	Int32 DynamicBVH::Balance(Int32 a)
+	{
+		if (nodes[a].IsLeaf() || nodes[a].height < 2) return a;
+
+		Int32 const b = nodes[a].child1;
+		Int32 const c = nodes[a].child2;
+		Int32 const balance = nodes[c].height - nodes[b].height;
+
+		auto RotateUp = [&](Int32 up, Int32 other, Bool up_is_child2) -> Int32
+		{
+			Int32 const f = nodes[up].child1;
+			Int32 const g = nodes[up].child2;
+
+			nodes[up].child1 = a;
+			nodes[up].parent = nodes[a].parent;
+			nodes[a].parent = up;
+
+			if (nodes[up].parent != NULL_NODE)
+			{
+				if (nodes[nodes[up].parent].child1 == a) nodes[nodes[up].parent].child1 = up;
+				else nodes[nodes[up].parent].child2 = up;
+			}
+			else root = up;
+
+			Int32 const taller = nodes[f].height > nodes[g].height ? f : g;
+			Int32 const shorter = taller == f ? g : f;
+
+			nodes[up].child2 = taller;
+			if (up_is_child2) nodes[a].child2 = shorter;
+			else nodes[a].child1 = shorter;
+			nodes[shorter].parent = a;
+
+			nodes[a].box = Merge(nodes[other].box, nodes[shorter].box);
+			nodes[up].box = Merge(nodes[a].box, nodes[taller].box);
+			nodes[a].height = 1 + (std::max)(nodes[other].height, nodes[shorter].height);
+			nodes[up].height = 1 + (std::max)(nodes[a].height, nodes[taller].height);
+			return up;
+		};
+
+		if (balance > 1) return RotateUp(c, b, true);
+		if (balance < -1) return RotateUp(b, c, false);
+		return a;
+	}
+}
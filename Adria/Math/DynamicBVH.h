@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <DirectXCollision.h>
+
+namespace adria
+{
+	//Incrementally updated AABB tree. Leaves keep a fattened box so small movements don't require reinsertion.
+	class DynamicBVH
+	{
+		static constexpr Uint32 MAX_STACK_SIZE = 256;
+
+		struct Node
+		{
+			BoundingBox box;
+			BoundingBox tight_box;
+			Uint64 user_data = 0;
+			Int32 parent = -1;
+			Int32 child1 = -1;
+			Int32 child2 = -1;
+			Int32 height = -1;
+
+			Bool IsLeaf() const { return child1 == -1; }
+		};
+
+	public:
+		static constexpr Int32 NULL_NODE = -1;
+
+	public:
+		DynamicBVH() = default;
+
+		Int32 Insert(BoundingBox const& box, Uint64 user_data);
+		void Remove(Int32 proxy);
+		Bool Move(Int32 proxy, BoundingBox const& box);
+		void Clear();
+
+		Uint64 GetUserData(Int32 proxy) const { return nodes[proxy].user_data; }
+		BoundingBox const& GetFatBox(Int32 proxy) const { return nodes[proxy].box; }
+		Int32 GetHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+		Uint32 GetProxyCount() const { return proxy_count; }
+
+		//V is any DirectXCollision volume (BoundingFrustum, BoundingBox, BoundingSphere...), F is void(Uint64 user_data)
+		template<typename V, typename F>
+		void Query(V const& volume, F&& callback) const
+		{
+			if (root == NULL_NODE) return;
+
+			std::array<Int32, MAX_STACK_SIZE> stack;
+			Uint32 stack_size = 0;
+			stack[stack_size++] = root;
+			while (stack_size > 0)
+			{
+				Int32 const node_index = stack[--stack_size];
+				Node const& node = nodes[node_index];
+				DirectX::ContainmentType containment = volume.Contains(node.box);
+				if (containment == DirectX::DISJOINT) continue;
+
+				if (node.IsLeaf())
+				{
+					if (containment == DirectX::CONTAINS || volume.Contains(node.tight_box) != DirectX::DISJOINT) callback(node.user_data);
+				}
+				else if (containment == DirectX::CONTAINS)
+				{
+					ReportSubtree(node_index, callback);
+				}
+				else
+				{
+					ADRIA_ASSERT(stack_size + 2 <= MAX_STACK_SIZE);
+					stack[stack_size++] = node.child1;
+					stack[stack_size++] = node.child2;
+				}
+			}
+		}
+
+		//F is Float(Uint64 user_data, Float distance), returning the new maximum distance of the ray (a negative one stops the traversal).
+		//a box the ray starts in is reported at distance 0 and the traversal goes on, so boxes in front can still be found
+		template<typename F>
+		void RayCast(Vector3 const& origin, Vector3 const& direction, Float max_distance, F&& callback) const
+		{
+			if (root == NULL_NODE) return;
+
+			DirectX::XMVECTOR ray_origin = origin;
+			DirectX::XMVECTOR ray_direction = DirectX::XMVector3Normalize(direction);
+
+			std::array<Int32, MAX_STACK_SIZE> stack;
+			Uint32 stack_size = 0;
+			stack[stack_size++] = root;
+			while (stack_size > 0)
+			{
+				Node const& node = nodes[stack[--stack_size]];
+
+				//Intersects gives the negative distance to the entry point behind the origin when the ray starts inside
+				Float distance = 0.0f;
+				if (!node.box.Intersects(ray_origin, ray_direction, distance) || (std::max)(distance, 0.0f) > max_distance) continue;
+
+				if (node.IsLeaf())
+				{
+					if (!node.tight_box.Intersects(ray_origin, ray_direction, distance)) continue;
+					distance = (std::max)(distance, 0.0f);
+					if (distance > max_distance) continue;
+					max_distance = callback(node.user_data, distance);
+					if (max_distance < 0.0f) return;
+				}
+				else
+				{
+					ADRIA_ASSERT(stack_size + 2 <= MAX_STACK_SIZE);
+					stack[stack_size++] = node.child1;
+					stack[stack_size++] = node.child2;
+				}
+			}
+		}
+
+	private:
+		std::vector<Node> nodes;
+		Int32 root = NULL_NODE;
+		Int32 free_list = NULL_NODE;
+		Uint32 proxy_count = 0;
+
+	private:
+		Int32 AllocateNode();
+		void FreeNode(Int32 node);
+		void InsertLeaf(Int32 leaf);
+		void RemoveLeaf(Int32 leaf);
+		Int32 Balance(Int32 node);
+
+		template<typename F>
+		void ReportSubtree(Int32 subtree_root, F& callback) const
+		{
+			std::array<Int32, MAX_STACK_SIZE> stack;
+			Uint32 stack_size = 0;
+			stack[stack_size++] = subtree_root;
+			while (stack_size > 0)
+			{
+				Node const& node = nodes[stack[--stack_size]];
+				if (node.IsLeaf())
+				{
+					callback(node.user_data);
+				}
+				else
+				{
+					ADRIA_ASSERT(stack_size + 2 <= MAX_STACK_SIZE);
+					stack[stack_size++] = node.child1;
+					stack[stack_size++] = node.child2;
+				}
+			}
+		}
+	};
+}
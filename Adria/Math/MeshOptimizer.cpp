@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cmath>
+#include "MeshOptimizer.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 FORSYTH_CACHE_SIZE = 32;
+		constexpr Uint32 FORSYTH_MAX_VALENCE = 32;
+		constexpr Float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+		constexpr Float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr Float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+		constexpr Float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+		inline Uint32 IndexAt(Uint32 const* indices, Uint64 i)
+		{
+			return indices ? indices[i] : static_cast<Uint32>(i);
+		}
+
+		//FIFO cache with timestamps, a vertex is cached while less than cache_size vertices were transformed after it
+		class VertexCacheSimulator
+		{
+		public:
+			VertexCacheSimulator(Uint64 vertex_count, Uint32 cache_size) : timestamps(vertex_count, 0), cache_size(cache_size), timestamp(cache_size + 1)
+			{}
+
+			Uint32 Update(Uint32 a, Uint32 b, Uint32 c)
+			{
+				return Update(a) + Update(b) + Update(c);
+			}
+
+			void Reset()
+			{
+				timestamp += cache_size + 1;
+			}
+
+		private:
+			std::vector<Uint32> timestamps;
+			Uint32 cache_size;
+			Uint32 timestamp;
+
+		private:
+			Uint32 Update(Uint32 v)
+			{
+				if (timestamp - timestamps[v] <= cache_size) return 0;
+				timestamps[v] = timestamp++;
+				return 1;
+			}
+		};
+
+		struct VertexScoreTable
+		{
+			Float cache[FORSYTH_CACHE_SIZE];
+			Float valence[FORSYTH_MAX_VALENCE + 1];
+
+			VertexScoreTable()
+			{
+				for (Uint32 i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+				{
+					cache[i] = i < 3 ? FORSYTH_LAST_TRIANGLE_SCORE : std::pow(1.0f - Float(i - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+				}
+				valence[0] = 0.0f;
+				for (Uint32 i = 1; i <= FORSYTH_MAX_VALENCE; ++i)
+				{
+					valence[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(Float(i), -FORSYTH_VALENCE_BOOST_POWER);
+				}
+			}
+
+			Float Score(Int32 cache_position, Uint32 live_triangles) const
+			{
+				if (live_triangles == 0) return -1.0f;
+				Float score = valence[(std::min)(live_triangles, FORSYTH_MAX_VALENCE)];
+				if (cache_position >= 0) score += cache[cache_position];
+				return score;
+			}
+		};
+
+		struct Float3
+		{
+			Float x, y, z;
+		};
+
+		inline Float3 PositionAt(Float const* positions, Uint64 position_stride, Uint32 v)
+		{
+			Float const* p = reinterpret_cast<Float const*>(reinterpret_cast<Uint8 const*>(positions) + v * position_stride);
+			return Float3{ p[0], p[1], p[2] };
+		}
+
+		inline Uint64 HashBytes(void const* data, Uint64 size)
+		{
+			Uint8 const* bytes = static_cast<Uint8 const*>(data);
+			Uint64 hash = 14695981039346656037ull;
+			for (Uint64 i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+	}
+
+	VertexCacheStats AnalyzeVertexCache(Uint32 const* indices, Uint64 index_count, Uint64 vertex_count, Uint32 cache_size)
+	{
+		VertexCacheStats stats{};
+		if (index_count < 3 || vertex_count == 0) return stats;
+
+		VertexCacheSimulator cache(vertex_count, cache_size);
+		Uint64 misses = 0;
+		for (Uint64 i = 0; i + 2 < index_count; i += 3)
+		{
+			misses += cache.Update(IndexAt(indices, i + 0), IndexAt(indices, i + 1), IndexAt(indices, i + 2));
+		}
+		stats.acmr = Float(misses) / (index_count / 3);
+		stats.atvr = Float(misses) / vertex_count;
+		return stats;
+	}
+
+	Uint64 GenerateVertexRemap(Uint32* remap, Uint32 const* indices, Uint64 index_count, void const* vertices, Uint64 vertex_count, Uint64 vertex_size)
+	{
+		std::fill(remap, remap + vertex_count, Uint32(-1));
+
+		Uint64 table_size = 16;
+		while (table_size < vertex_count * 2) table_size *= 2;
+		std::vector<Uint32> table(table_size, Uint32(-1));
+		Uint8 const* vertex_bytes = static_cast<Uint8 const*>(vertices);
+
+		Uint32 unique_count = 0;
+		for (Uint64 i = 0; i < index_count; ++i)
+		{
+			Uint32 const v = IndexAt(indices, i);
+			if (remap[v] != Uint32(-1)) continue;
+
+			void const* vertex = vertex_bytes + v * vertex_size;
+			Uint64 slot = HashBytes(vertex, vertex_size) & (table_size - 1);
+			while (table[slot] != Uint32(-1) && std::memcmp(vertex_bytes + table[slot] * vertex_size, vertex, vertex_size) != 0)
+			{
+				slot = (slot + 1) & (table_size - 1);
+			}
+
+			if (table[slot] == Uint32(-1))
+			{
+				table[slot] = v;
+				remap[v] = unique_count++;
+			}
+			else remap[v] = remap[table[slot]];
+		}
+		return unique_count;
+	}
+
+	void OptimizeVertexCache(Uint32* indices, Uint64 index_count, Uint64 vertex_count)
+	{
+		Uint64 const triangle_count = index_count / 3;
+		if (triangle_count == 0) return;
+
+		static VertexScoreTable const score_table;
+
+		//triangles of every vertex, the live ones are kept at the front of each range
+		std::vector<Uint32> live_triangles(vertex_count, 0);
+		for (Uint64 i = 0; i < triangle_count * 3; ++i) ++live_triangles[indices[i]];
+		std::vector<Uint32> adjacency_offsets(vertex_count + 1, 0);
+		for (Uint64 v = 0; v < vertex_count; ++v) adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+		std::vector<Uint32> adjacency(triangle_count * 3);
+		{
+			std::vector<Uint32> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (Uint64 i = 0; i < triangle_count * 3; ++i) adjacency[fill[indices[i]]++] = static_cast<Uint32>(i / 3);
+		}
+
+		std::vector<Float> vertex_scores(vertex_count);
+		for (Uint64 v = 0; v < vertex_count; ++v) vertex_scores[v] = score_table.Score(-1, live_triangles[v]);
+
+		std::vector<Uint32> const source(indices, indices + triangle_count * 3);
+		std::vector<Uint8> emitted(triangle_count, 0);
+		std::vector<Uint32> cache;
+		std::vector<Uint32> new_cache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		Uint64 input_cursor = 0;
+		Int64 current = 0;
+		for (Uint64 output = 0; output < triangle_count; ++output)
+		{
+			//dead end, continue with the next triangle in input order
+			if (current < 0)
+			{
+				while (emitted[input_cursor]) ++input_cursor;
+				current = static_cast<Int64>(input_cursor);
+			}
+
+			Uint32 const* triangle = &source[current * 3];
+			std::copy(triangle, triangle + 3, indices + output * 3);
+			emitted[current] = 1;
+
+			for (Uint32 k = 0; k < 3; ++k)
+			{
+				Uint32 const v = triangle[k];
+				Uint32* first = &adjacency[adjacency_offsets[v]];
+				Uint32* last = first + live_triangles[v];
+				Uint32* it = std::find(first, last, static_cast<Uint32>(current));
+				if (it != last)
+				{
+					std::swap(*it, *(last - 1));
+					--live_triangles[v];
+				}
+			}
+
+			new_cache.clear();
+			for (Uint32 k = 0; k < 3; ++k)
+			{
+				if (std::find(new_cache.begin(), new_cache.end(), triangle[k]) == new_cache.end()) new_cache.push_back(triangle[k]);
+			}
+			size_t const triangle_vertices = new_cache.size();
+			for (Uint32 v : cache)
+			{
+				if (std::find(new_cache.begin(), new_cache.begin() + triangle_vertices, v) == new_cache.begin() + triangle_vertices) new_cache.push_back(v);
+			}
+
+			//vertices pushed out of the cache lose their cache score
+			for (Uint64 i = FORSYTH_CACHE_SIZE; i < new_cache.size(); ++i)
+			{
+				Uint32 const v = new_cache[i];
+				vertex_scores[v] = score_table.Score(-1, live_triangles[v]);
+			}
+			if (new_cache.size() > FORSYTH_CACHE_SIZE) new_cache.resize(FORSYTH_CACHE_SIZE);
+			for (Uint32 i = 0; i < new_cache.size(); ++i)
+			{
+				Uint32 const v = new_cache[i];
+				vertex_scores[v] = score_table.Score(static_cast<Int32>(i), live_triangles[v]);
+			}
+			std::swap(cache, new_cache);
+
+			//only triangles using cached vertices changed their score
+			current = -1;
+			Float best_score = -1.0f;
+			for (Uint32 v : cache)
+			{
+				for (Uint32 a = adjacency_offsets[v], end = adjacency_offsets[v] + live_triangles[v]; a < end; ++a)
+				{
+					Uint32 const t = adjacency[a];
+					Float const score = vertex_scores[source[t * 3 + 0]] + vertex_scores[source[t * 3 + 1]] + vertex_scores[source[t * 3 + 2]];
+					if (score > best_score)
+					{
+						best_score = score;
+						current = t;
+					}
+				}
+			}
+		}
+	}
+
+	void OptimizeOverdraw(Uint32* indices, Uint64 index_count, Float const* positions, Uint64 vertex_count, Uint64 position_stride, Float threshold)
+	{
+		Uint64 const triangle_count = index_count / 3;
+		if (triangle_count == 0) return;
+
+		//hard boundaries are triangles that miss the cache with all three vertices, splitting there costs nothing
+		std::vector<Uint32> hard_clusters;
+		{
+			VertexCacheSimulator cache(vertex_count, VERTEX_CACHE_SIZE);
+			for (Uint32 t = 0; t < triangle_count; ++t)
+			{
+				if (cache.Update(indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2]) == 3) hard_clusters.push_back(t);
+			}
+			if (hard_clusters.empty() || hard_clusters[0] != 0) hard_clusters.insert(hard_clusters.begin(), 0);
+		}
+
+		//soft boundaries split hard clusters wherever the ACMR so far is within the threshold of the whole cluster
+		std::vector<Uint32> clusters;
+		VertexCacheSimulator cache(vertex_count, VERTEX_CACHE_SIZE);
+		for (Uint64 c = 0; c < hard_clusters.size(); ++c)
+		{
+			Uint32 const start = hard_clusters[c];
+			Uint32 const end = c + 1 < hard_clusters.size() ? hard_clusters[c + 1] : static_cast<Uint32>(triangle_count);
+
+			cache.Reset();
+			Uint32 cluster_misses = 0;
+			for (Uint32 t = start; t < end; ++t) cluster_misses += cache.Update(indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2]);
+			Float const cluster_threshold = threshold * Float(cluster_misses) / Float(end - start);
+
+			clusters.push_back(start);
+			cache.Reset();
+			Uint32 running_misses = 0;
+			Uint32 running_triangles = 0;
+			for (Uint32 t = start; t < end; ++t)
+			{
+				running_misses += cache.Update(indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2]);
+				++running_triangles;
+				if (Float(running_misses) / Float(running_triangles) <= cluster_threshold)
+				{
+					clusters.push_back(t + 1);
+					cache.Reset();
+					running_misses = 0;
+					running_triangles = 0;
+				}
+			}
+			//the tail after the last split is merged into the cluster before it, this also drops a split at end
+			if (clusters.back() != start) clusters.pop_back();
+		}
+
+		Float3 mesh_center{ 0.0f, 0.0f, 0.0f };
+		{
+			std::vector<Uint8> counted(vertex_count, 0);
+			Uint64 used_vertices = 0;
+			for (Uint64 i = 0; i < triangle_count * 3; ++i)
+			{
+				Uint32 const v = indices[i];
+				if (counted[v]) continue;
+				counted[v] = 1;
+				Float3 const p = PositionAt(positions, position_stride, v);
+				mesh_center.x += p.x; mesh_center.y += p.y; mesh_center.z += p.z;
+				++used_vertices;
+			}
+			mesh_center.x /= used_vertices; mesh_center.y /= used_vertices; mesh_center.z /= used_vertices;
+		}
+
+		//clusters facing away from the center are drawn first, they are the most likely to occlude the rest
+		std::vector<Float> sort_data(clusters.size());
+		for (Uint64 c = 0; c < clusters.size(); ++c)
+		{
+			Uint32 const start = clusters[c];
+			Uint32 const end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<Uint32>(triangle_count);
+
+			Float3 center{ 0.0f, 0.0f, 0.0f };
+			Float3 normal{ 0.0f, 0.0f, 0.0f };
+			Float area_sum = 0.0f;
+			for (Uint32 t = start; t < end; ++t)
+			{
+				Float3 const p0 = PositionAt(positions, position_stride, indices[t * 3 + 0]);
+				Float3 const p1 = PositionAt(positions, position_stride, indices[t * 3 + 1]);
+				Float3 const p2 = PositionAt(positions, position_stride, indices[t * 3 + 2]);
+				Float3 const e1{ p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+				Float3 const e2{ p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+				Float3 const n{ e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+				Float const area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+				center.x += (p0.x + p1.x + p2.x) / 3.0f * area;
+				center.y += (p0.y + p1.y + p2.y) / 3.0f * area;
+				center.z += (p0.z + p1.z + p2.z) / 3.0f * area;
+				normal.x += n.x; normal.y += n.y; normal.z += n.z;
+				area_sum += area;
+			}
+			Float const inverse_area = area_sum == 0.0f ? 0.0f : 1.0f / area_sum;
+			center.x *= inverse_area; center.y *= inverse_area; center.z *= inverse_area;
+			Float const normal_length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			Float const inverse_normal_length = normal_length == 0.0f ? 0.0f : 1.0f / normal_length;
+
+			sort_data[c] = ((center.x - mesh_center.x) * normal.x + (center.y - mesh_center.y) * normal.y + (center.z - mesh_center.z) * normal.z) * inverse_normal_length;
+		}
+
+		std::vector<Uint32> order(clusters.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](Uint32 a, Uint32 b) { return sort_data[a] > sort_data[b]; });
+
+		std::vector<Uint32> const source(indices, indices + triangle_count * 3);
+		Uint64 output = 0;
+		for (Uint32 c : order)
+		{
+			Uint32 const start = clusters[c];
+			Uint32 const end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<Uint32>(triangle_count);
+			std::copy(source.begin() + start * 3, source.begin() + end * 3, indices + output);
+			output += (end - start) * 3;
+		}
+	}
+
+	Uint64 GenerateVertexFetchRemap(Uint32* remap, Uint32 const* indices, Uint64 index_count, Uint64 vertex_count)
+	{
+		std::fill(remap, remap + vertex_count, Uint32(-1));
+		Uint32 next = 0;
+		for (Uint64 i = 0; i < index_count; ++i)
+		{
+			Uint32 const v = IndexAt(indices, i);
+			if (remap[v] == Uint32(-1)) remap[v] = next++;
+		}
+		return next;
+	}
+}
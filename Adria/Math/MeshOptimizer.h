@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <concepts>
+#include <DirectXMath.h>
+
+namespace adria
+{
+	static constexpr Uint32 VERTEX_CACHE_SIZE = 16;
+	static constexpr Float OVERDRAW_THRESHOLD = 1.05f;
+
+	struct VertexCacheStats
+	{
+		Float acmr = 0.0f; //transformed vertices per triangle
+		Float atvr = 0.0f; //transformed vertices per vertex
+	};
+
+	struct MeshOptimizationStats
+	{
+		Uint32 vertices_before = 0;
+		Uint32 vertices_after = 0;
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	//All functions work on triangle lists. Indices can be nullptr for an unindexed list, vertex i is then used by index i.
+
+	//simulates a FIFO post transform cache of cache_size entries
+	VertexCacheStats AnalyzeVertexCache(Uint32 const* indices, Uint64 index_count, Uint64 vertex_count, Uint32 cache_size = VERTEX_CACHE_SIZE);
+
+	//remap[v] is the new index of vertex v, bitwise equal vertices get the same index and indices are handed out in order of first use.
+	//Unused vertices are set to Uint32(-1). Returns the number of unique vertices.
+	Uint64 GenerateVertexRemap(Uint32* remap, Uint32 const* indices, Uint64 index_count, void const* vertices, Uint64 vertex_count, Uint64 vertex_size);
+
+	//reorders triangles for the post transform cache (Forsyth)
+	void OptimizeVertexCache(Uint32* indices, Uint64 index_count, Uint64 vertex_count);
+
+	//reorders clusters of the cache optimized order front to back from the mesh center outwards (Sander et al.), the ACMR gets
+	//at most threshold times worse. Positions are three floats at the start of every position_stride bytes.
+	void OptimizeOverdraw(Uint32* indices, Uint64 index_count, Float const* positions, Uint64 vertex_count, Uint64 position_stride, Float threshold = OVERDRAW_THRESHOLD);
+
+	//remap for laying out vertices in the order the indices first use them, unused vertices are dropped. Returns the vertex count.
+	Uint64 GenerateVertexFetchRemap(Uint32* remap, Uint32 const* indices, Uint64 index_count, Uint64 vertex_count);
+
+	template<typename V>
+	concept HasPosition = requires (V v)
+	{
+		{v.position} -> std::convertible_to<DirectX::XMFLOAT3>;
+	};
+
+	//welds bitwise equal vertices, then optimizes for the vertex cache, overdraw and vertex fetch. Empty indices are treated as an
+	//unindexed triangle list and get generated. The vertex type must not have padding.
+	template<typename V> requires HasPosition<V>
+	MeshOptimizationStats OptimizeMesh(std::vector<V>& vertices, std::vector<Uint32>& indices)
+	{
+		MeshOptimizationStats stats{};
+		stats.vertices_before = static_cast<Uint32>(vertices.size());
+		stats.vertices_after = stats.vertices_before;
+		if (vertices.empty()) return stats;
+		if (indices.empty())
+		{
+			indices.resize(vertices.size());
+			for (Uint32 i = 0; i < indices.size(); ++i) indices[i] = i;
+		}
+		stats.before = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+		std::vector<Uint32> remap(vertices.size());
+		Uint64 unique_count = GenerateVertexRemap(remap.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(V));
+		std::vector<V> welded(unique_count);
+		for (Uint64 v = 0; v < vertices.size(); ++v)
+		{
+			if (remap[v] != Uint32(-1)) welded[remap[v]] = vertices[v];
+		}
+		for (Uint32& index : indices) index = remap[index];
+
+		OptimizeVertexCache(indices.data(), indices.size(), welded.size());
+		OptimizeOverdraw(indices.data(), indices.size(), &welded[0].position.x, welded.size(), sizeof(V));
+
+		remap.resize(welded.size());
+		Uint64 const fetch_count = GenerateVertexFetchRemap(remap.data(), indices.data(), indices.size(), welded.size());
+		vertices.resize(fetch_count);
+		for (Uint64 v = 0; v < welded.size(); ++v)
+		{
+			if (remap[v] != Uint32(-1)) vertices[remap[v]] = welded[v];
+		}
+		for (Uint32& index : indices) index = remap[index];
+
+		stats.vertices_after = static_cast<Uint32>(vertices.size());
+		stats.after = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+		return stats;
+	}
+}
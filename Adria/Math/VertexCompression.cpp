@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <DirectXPackedVector.h>
+#include "VertexCompression.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Float DEGENERATE_LENGTH = 1e-6f;
+
+		Float SignNotZero(Float v)
+		{
+			return v >= 0.0f ? 1.0f : -1.0f;
+		}
+
+		Uint16 QuantizeUnorm16(Float v)
+		{
+			return static_cast<Uint16>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+		}
+		Float DequantizeUnorm16(Uint16 v)
+		{
+			return v / 65535.0f;
+		}
+		Int16 QuantizeSnorm16(Float v)
+		{
+			return static_cast<Int16>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+		}
+		Float DequantizeSnorm16(Int16 v)
+		{
+			return std::max(v / 32767.0f, -1.0f);
+		}
+
+		//atan2 keeps its precision for the tiny angles acos loses to rounding
+		Float AngleDegrees(Vector3 const& a, Vector3 const& b)
+		{
+			return XMConvertToDegrees(std::atan2(a.Cross(b).Length(), a.Dot(b)));
+		}
+	}
+
+	Vector2 OctahedralEncode(Vector3 const& n)
+	{
+		Float const l1_norm = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		if (l1_norm < DEGENERATE_LENGTH) return Vector2(0.0f, 0.0f);
+
+		Vector2 e(n.x / l1_norm, n.y / l1_norm);
+		if (n.z < 0.0f)
+		{
+			e = Vector2((1.0f - std::abs(e.y)) * SignNotZero(e.x), (1.0f - std::abs(e.x)) * SignNotZero(e.y));
+		}
+		return e;
+	}
+
+	Vector3 OctahedralDecode(Vector2 const& e)
+	{
+		Vector3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+		Float const t = std::max(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+		n.Normalize();
+		return n;
+	}
+
+	VertexQuantization ComputeVertexQuantization(CompleteVertex const* vertices, Uint64 vertex_count)
+	{
+		VertexQuantization quantization{};
+		if (vertex_count == 0) return quantization;
+
+		Vector3 min_position = vertices[0].position;
+		Vector3 max_position = vertices[0].position;
+		for (Uint64 i = 1; i < vertex_count; ++i)
+		{
+			min_position = Vector3::Min(min_position, vertices[i].position);
+			max_position = Vector3::Max(max_position, vertices[i].position);
+		}
+		quantization.position_offset = min_position;
+		quantization.position_scale = max_position - min_position;
+		return quantization;
+	}
+
+	CompressedVertex CompressVertex(CompleteVertex const& vertex, VertexQuantization const& quantization)
+	{
+		Vector3 const& offset = quantization.position_offset;
+		Vector3 const& scale = quantization.position_scale;
+		auto NormalizedPosition = [](Float p, Float offset, Float scale)
+		{
+			return scale > 0.0f ? (p - offset) / scale : 0.0f;
+		};
+
+		CompressedVertex compressed{};
+		compressed.position[0] = QuantizeUnorm16(NormalizedPosition(vertex.position.x, offset.x, scale.x));
+		compressed.position[1] = QuantizeUnorm16(NormalizedPosition(vertex.position.y, offset.y, scale.y));
+		compressed.position[2] = QuantizeUnorm16(NormalizedPosition(vertex.position.z, offset.z, scale.z));
+		Bool const right_handed = vertex.normal.Cross(vertex.tangent).Dot(vertex.bitangent) >= 0.0f;
+		compressed.position[3] = right_handed ? 65535 : 0;
+
+		compressed.uv[0] = PackedVector::XMConvertFloatToHalf(vertex.uv.x);
+		compressed.uv[1] = PackedVector::XMConvertFloatToHalf(vertex.uv.y);
+
+		Vector2 const normal = OctahedralEncode(vertex.normal);
+		compressed.normal[0] = QuantizeSnorm16(normal.x);
+		compressed.normal[1] = QuantizeSnorm16(normal.y);
+		Vector2 const tangent = OctahedralEncode(vertex.tangent);
+		compressed.tangent[0] = QuantizeSnorm16(tangent.x);
+		compressed.tangent[1] = QuantizeSnorm16(tangent.y);
+		return compressed;
+	}
+
+	CompleteVertex DecompressVertex(CompressedVertex const& vertex, VertexQuantization const& quantization)
+	{
+		CompleteVertex decompressed{};
+		Vector3 const position(DequantizeUnorm16(vertex.position[0]), DequantizeUnorm16(vertex.position[1]), DequantizeUnorm16(vertex.position[2]));
+		decompressed.position = quantization.position_offset + position * quantization.position_scale;
+		decompressed.uv = Vector2(PackedVector::XMConvertHalfToFloat(vertex.uv[0]), PackedVector::XMConvertHalfToFloat(vertex.uv[1]));
+		decompressed.normal = OctahedralDecode(Vector2(DequantizeSnorm16(vertex.normal[0]), DequantizeSnorm16(vertex.normal[1])));
+		decompressed.tangent = OctahedralDecode(Vector2(DequantizeSnorm16(vertex.tangent[0]), DequantizeSnorm16(vertex.tangent[1])));
+		Float const handedness = DequantizeUnorm16(vertex.position[3]) * 2.0f - 1.0f;
+		decompressed.bitangent = decompressed.normal.Cross(decompressed.tangent) * handedness;
+		return decompressed;
+	}
+
+	VertexCompressionReport CompressVertices(CompleteVertex const* vertices, Uint64 vertex_count, VertexQuantization const& quantization, CompressedVertex* compressed)
+	{
+		VertexCompressionReport report{};
+		report.bytes_before = vertex_count * sizeof(CompleteVertex);
+		report.bytes_after = vertex_count * sizeof(CompressedVertex);
+		for (Uint64 i = 0; i < vertex_count; ++i)
+		{
+			CompleteVertex const& vertex = vertices[i];
+			compressed[i] = CompressVertex(vertex, quantization);
+			CompleteVertex const decompressed = DecompressVertex(compressed[i], quantization);
+
+			report.max_position_error = std::max(report.max_position_error, Vector3::Distance(vertex.position, decompressed.position));
+			report.max_uv_error = std::max({ report.max_uv_error, std::abs(vertex.uv.x - decompressed.uv.x), std::abs(vertex.uv.y - decompressed.uv.y) });
+			//missing attributes are imported as zero vectors and have no direction to lose
+			if (vertex.normal.Length() > DEGENERATE_LENGTH)
+			{
+				report.max_normal_error = std::max(report.max_normal_error, AngleDegrees(vertex.normal, decompressed.normal));
+			}
+			if (vertex.tangent.Length() > DEGENERATE_LENGTH)
+			{
+				report.max_tangent_error = std::max(report.max_tangent_error, AngleDegrees(vertex.tangent, decompressed.tangent));
+			}
+			if (vertex.bitangent.Length() > DEGENERATE_LENGTH)
+			{
+				report.max_bitangent_error = std::max(report.max_bitangent_error, AngleDegrees(vertex.bitangent, decompressed.bitangent));
+			}
+		}
+		return report;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Graphics/GfxVertexFormat.h"
+
+namespace adria
+{
+	//positions are dequantized as offset + unorm * scale, the vertex shader gets both through the object constant buffer
+	struct VertexQuantization
+	{
+		Vector3 position_offset = Vector3(0.0f, 0.0f, 0.0f);
+		Vector3 position_scale = Vector3(1.0f, 1.0f, 1.0f);
+	};
+
+	//worst round trip error per attribute, positions are in mesh units and directions in degrees
+	struct VertexCompressionReport
+	{
+		Float max_position_error = 0.0f;
+		Float max_uv_error = 0.0f;
+		Float max_normal_error = 0.0f;
+		Float max_tangent_error = 0.0f;
+		Float max_bitangent_error = 0.0f;
+		Uint64 bytes_before = 0;
+		Uint64 bytes_after = 0;
+	};
+
+	//maps a unit vector to the [-1, 1] square by projecting it on the octahedron and folding the lower half over the upper one
+	Vector2 OctahedralEncode(Vector3 const& n);
+	Vector3 OctahedralDecode(Vector2 const& e);
+
+	//the bounds of the mesh positions, every axis is spread over the full 16 bit range
+	VertexQuantization ComputeVertexQuantization(CompleteVertex const* vertices, Uint64 vertex_count);
+
+	CompressedVertex CompressVertex(CompleteVertex const& vertex, VertexQuantization const& quantization);
+	//what the vertex shader reconstructs, the bitangent is cross(normal, tangent) times the handedness
+	CompleteVertex DecompressVertex(CompressedVertex const& vertex, VertexQuantization const& quantization);
+
+	//compresses vertex_count vertices into compressed and decodes them again to measure the error
+	VertexCompressionReport CompressVertices(CompleteVertex const* vertices, Uint64 vertex_count, VertexQuantization const& quantization, CompressedVertex* compressed);
+}
@@ -0,0 +1,301 @@
+#include <fstream>
+#include <cstdio>
+#include "BakedModel.h"
+#include "ModelImporter.h"
+#include "Core/Logger.h"
+#include "Core/Paths.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/HashUtil.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint64 SECTION_ALIGNMENT = 16;
+		//decoded textures with all mips are large, only this many are kept in memory while writing
+		constexpr Uint32 TEXTURE_BATCH_SIZE = 8;
+
+		constexpr Uint32 MipmapLevels(Uint32 width, Uint32 height)
+		{
+			Uint32 levels = 1U;
+			while ((width | height) >> levels) ++levels;
+			return levels;
+		}
+
+		class SectionWriter
+		{
+		public:
+			explicit SectionWriter(std::ofstream& os) : os(os) {}
+
+			void Skip(Uint64 bytes)
+			{
+				static constexpr Char zeros[SECTION_ALIGNMENT] = {};
+				while (bytes > 0)
+				{
+					Uint64 const count = std::min(bytes, SECTION_ALIGNMENT);
+					os.write(zeros, count);
+					offset += count;
+					bytes -= count;
+				}
+			}
+			void Align()
+			{
+				Skip((SECTION_ALIGNMENT - offset % SECTION_ALIGNMENT) % SECTION_ALIGNMENT);
+			}
+			void Write(void const* data, Uint64 size)
+			{
+				os.write(static_cast<Char const*>(data), size);
+				offset += size;
+			}
+			BakedSection WriteSection(void const* data, Uint64 size)
+			{
+				Align();
+				BakedSection section{ .offset = offset, .size = size };
+				Write(data, size);
+				return section;
+			}
+			template<typename T>
+			BakedSection WriteSection(std::vector<T> const& records)
+			{
+				return WriteSection(records.data(), records.size() * sizeof(T));
+			}
+			Uint64 Offset() const { return offset; }
+
+		private:
+			std::ofstream& os;
+			Uint64 offset = 0;
+		};
+
+		Bool IsSectionInFile(BakedSection const& section, Uint64 file_size)
+		{
+			return section.offset <= file_size && section.size <= file_size - section.offset;
+		}
+		template<typename T>
+		Bool IsRecordSection(BakedSection const& section)
+		{
+			return section.offset % alignof(T) == 0 && section.size % sizeof(T) == 0;
+		}
+
+		//write time and size of a file, zero for both if it doesn't exist
+		BakedSource StampSource(std::string const& path)
+		{
+			BakedSource source{};
+			std::error_code error;
+			Uint64 const size = fs::file_size(path, error);
+			if (error) return source;
+			source.write_time = static_cast<Int64>(GetFileLastWriteTime(path).time_since_epoch().count());
+			source.size = size;
+			return source;
+		}
+	}
+
+	Uint64 BakedModelKey(ModelParameters const& params)
+	{
+		std::string key_data = params.model_path + '|' + params.textures_path + '|';
+		key_data.append(reinterpret_cast<Char const*>(&params.model_matrix), sizeof(Matrix));
+		key_data.push_back(params.compress_vertices ? '1' : '0');
+		return crc64(key_data.c_str(), key_data.size());
+	}
+
+	std::string BakedModelPath(ModelParameters const& params)
+	{
+		Char key[17];
+		std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(BakedModelKey(params)));
+		std::string const& baked_dir = params.baked_dir.empty() ? paths::BakedDir : params.baked_dir;
+		return baked_dir + GetFilenameWithoutExtension(params.model_path) + "_" + key + ".bin";
+	}
+
+	Bool WriteBakedModel(std::string const& path, BakedModelDesc const& desc)
+	{
+		ADRIA_ASSERT(desc.nodes.size() == desc.node_names.size());
+		std::error_code error;
+		fs::create_directories(GetParentPath(path), error);
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		if (!os) return false;
+
+		std::string strings;
+		auto AddString = [&strings](std::string const& string)
+		{
+			BakedString baked_string{ .offset = static_cast<Uint32>(strings.size()), .length = static_cast<Uint32>(string.size()) };
+			strings += string;
+			return baked_string;
+		};
+		std::vector<BakedNode> nodes = desc.nodes;
+		for (Uint64 i = 0; i < nodes.size(); ++i) nodes[i].name = AddString(desc.node_names[i]);
+
+		BakedModelHeader header{};
+		header.magic = BAKED_MODEL_MAGIC;
+		header.version = BAKED_MODEL_VERSION;
+		header.key = desc.key;
+		header.vertex_stride = desc.vertex_stride;
+
+		SectionWriter writer(os);
+		writer.Skip(sizeof(BakedModelHeader));
+		header.vertices = writer.WriteSection(desc.vertices, desc.vertex_count * desc.vertex_stride);
+		header.indices = writer.WriteSection(desc.indices, desc.index_count * sizeof(Uint32));
+		header.materials = writer.WriteSection(desc.materials);
+		header.nodes = writer.WriteSection(nodes);
+
+		//textures are decoded in parallel batches and their mips are appended to one data section
+		std::vector<BakedTexture> textures(desc.texture_paths.size());
+		std::vector<TextureMip> texture_mips;
+		writer.Align();
+		header.texture_data.offset = writer.Offset();
+		for (Uint64 batch_begin = 0; batch_begin < textures.size(); batch_begin += TEXTURE_BATCH_SIZE)
+		{
+			Uint32 const batch_size = static_cast<Uint32>(std::min<Uint64>(TEXTURE_BATCH_SIZE, textures.size() - batch_begin));
+			std::vector<DecodedTexture> decoded(batch_size);
+			std::vector<Uint8> decoded_ok(batch_size, false);
+			g_JobSystem.ParallelFor(batch_size, 1, [&](Uint32 i)
+				{
+					decoded_ok[i] = DecodeTexture(desc.texture_paths[batch_begin + i], true, decoded[i]);
+				});
+
+			for (Uint32 i = 0; i < batch_size; ++i)
+			{
+				BakedTexture& texture = textures[batch_begin + i];
+				texture.name = AddString(desc.texture_paths[batch_begin + i]);
+				texture.first_mip = static_cast<Uint32>(texture_mips.size());
+				//failed textures have no mips and get loaded like imported ones at runtime
+				if (!decoded_ok[i])
+				{
+					ADRIA_LOG(WARNING, "Failed to decode %s for the baked model!", desc.texture_paths[batch_begin + i].c_str());
+					continue;
+				}
+				writer.Align();
+				texture.width = decoded[i].width;
+				texture.height = decoded[i].height;
+				texture.format = static_cast<Uint32>(decoded[i].format);
+				texture.mip_count = static_cast<Uint32>(decoded[i].mips.size());
+				texture.data_offset = writer.Offset() - header.texture_data.offset;
+				texture_mips.insert(texture_mips.end(), decoded[i].mips.begin(), decoded[i].mips.end());
+				writer.Write(decoded[i].data.data(), decoded[i].data.size());
+			}
+		}
+		header.texture_data.size = writer.Offset() - header.texture_data.offset;
+		header.textures = writer.WriteSection(textures);
+		header.texture_mips = writer.WriteSection(texture_mips);
+
+		std::vector<BakedSource> sources;
+		for (std::vector<std::string> const* source_paths : { &desc.source_paths, &desc.texture_paths })
+		{
+			for (std::string const& source_path : *source_paths)
+			{
+				BakedSource& source = sources.emplace_back(StampSource(source_path));
+				source.path = AddString(source_path);
+			}
+		}
+		header.sources = writer.WriteSection(sources);
+		header.strings = writer.WriteSection(strings.data(), strings.size());
+
+		os.seekp(0);
+		os.write(reinterpret_cast<Char const*>(&header), sizeof(header));
+		return (Bool)os;
+	}
+
+	BakedModelFile::BakedModelFile(std::string const& path) : file(path)
+	{
+		if (!file.IsValid() || file.Size() < sizeof(BakedModelHeader)) return;
+		header = reinterpret_cast<BakedModelHeader const*>(file.Data());
+		if (!Validate()) header = nullptr;
+	}
+
+	Bool BakedModelFile::IsStale() const
+	{
+		for (BakedSource const& source : Sources())
+		{
+			//a file that was missing while baking is stamped with zeros and stays fresh as long as it is missing
+			BakedSource const current = StampSource(std::string(String(source.path)));
+			if (current.write_time != source.write_time || current.size != source.size) return true;
+		}
+		return false;
+	}
+
+	std::string_view BakedModelFile::String(BakedString const& string) const
+	{
+		return std::string_view(reinterpret_cast<Char const*>(file.Data() + header->strings.offset + string.offset), string.length);
+	}
+
+	DecodedTextureView BakedModelFile::Texture(BakedTexture const& texture) const
+	{
+		DecodedTextureView view{};
+		view.width = texture.width;
+		view.height = texture.height;
+		view.format = static_cast<DecodedTextureFormat>(texture.format);
+		view.mips = Section<TextureMip>(header->texture_mips).subspan(texture.first_mip, texture.mip_count);
+		view.data = file.Data() + header->texture_data.offset + texture.data_offset;
+		return view;
+	}
+
+	Bool BakedModelFile::Validate() const
+	{
+		if (header->magic != BAKED_MODEL_MAGIC || header->version != BAKED_MODEL_VERSION) return false;
+
+		Uint64 const file_size = file.Size();
+		for (BakedSection const& section : { header->vertices, header->indices, header->materials, header->nodes,
+											 header->textures, header->texture_mips, header->texture_data, header->strings, header->sources })
+		{
+			if (!IsSectionInFile(section, file_size)) return false;
+		}
+		if (header->vertex_stride == 0 || header->vertices.size % header->vertex_stride != 0) return false;
+		if (!IsRecordSection<Uint32>(header->indices) || !IsRecordSection<BakedMaterial>(header->materials) || !IsRecordSection<BakedNode>(header->nodes) ||
+			!IsRecordSection<BakedTexture>(header->textures) || !IsRecordSection<TextureMip>(header->texture_mips) ||
+			!IsRecordSection<BakedSource>(header->sources)) return false;
+
+		auto IsStringValid = [this](BakedString const& string)
+		{
+			return string.offset <= header->strings.size && string.length <= header->strings.size - string.offset;
+		};
+
+		std::span<BakedTexture const> textures = Textures();
+		std::span<TextureMip const> texture_mips = Section<TextureMip>(header->texture_mips);
+		for (BakedTexture const& texture : textures)
+		{
+			if (!IsStringValid(texture.name)) return false;
+			if (texture.first_mip > texture_mips.size() || texture.mip_count > texture_mips.size() - texture.first_mip) return false;
+			if (texture.mip_count == 0) continue;
+			//mips are uploaded with the pitch and size of the format, anything else would read past the data
+			if (texture.format >= static_cast<Uint32>(DecodedTextureFormat::Count)) return false;
+			if (texture.width == 0 || texture.height == 0 || texture.mip_count > MipmapLevels(texture.width, texture.height)) return false;
+			Uint32 const bytes_per_pixel = DecodedTextureBytesPerPixel(static_cast<DecodedTextureFormat>(texture.format));
+			for (Uint32 i = 0; i < texture.mip_count; ++i)
+			{
+				TextureMip const& mip = texture_mips[texture.first_mip + i];
+				if (mip.width != std::max(texture.width >> i, 1u) || mip.height != std::max(texture.height >> i, 1u)) return false;
+				if (mip.pitch != mip.width * bytes_per_pixel) return false;
+				Uint64 const mip_offset = texture.data_offset + mip.offset;
+				if (mip_offset < texture.data_offset || mip_offset > header->texture_data.size || mip.size > header->texture_data.size - mip_offset) return false;
+				if (Uint64(mip.pitch) * mip.height > mip.size) return false;
+			}
+		}
+		for (BakedSource const& source : Sources())
+		{
+			if (!IsStringValid(source.path)) return false;
+		}
+
+		std::span<BakedMaterial const> materials = Materials();
+		for (BakedMaterial const& material : materials)
+		{
+			for (Int32 texture : material.textures)
+			{
+				if (texture != BAKED_NONE && (texture < 0 || static_cast<Uint64>(texture) >= textures.size())) return false;
+			}
+		}
+
+		std::span<BakedNode const> nodes = Nodes();
+		for (Uint64 i = 0; i < nodes.size(); ++i)
+		{
+			BakedNode const& node = nodes[i];
+			if (node.parent < BAKED_NONE || node.parent >= static_cast<Int64>(i)) return false;
+			if (node.material != BAKED_NONE && (node.material < 0 || static_cast<Uint64>(node.material) >= materials.size())) return false;
+			if (!IsStringValid(node.name)) return false;
+			if (node.flags & BakedNodeFlag_Mesh)
+			{
+				if (Uint64(node.start_index_location) + node.indices_count > IndexCount()) return false;
+				if (node.base_vertex_location < 0 || Uint64(node.base_vertex_location) + node.vertex_count > VertexCount()) return false;
+			}
+		}
+		return true;
+	}
+}
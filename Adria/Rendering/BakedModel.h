@@ -0,0 +1,178 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TextureStreamer.h"
+#include "Utilities/MemoryMappedFile.h"
+
+namespace adria
+{
+	struct ModelParameters;
+
+	//Baked model package: everything ImportModel_GLTF produces in one versioned file, so loading it skips tinygltf, mesh optimization
+	//and texture decoding. The header is followed by sections of the POD records below at 16 byte aligned offsets, a mapped file
+	//is used in place and its vertex, index and mip blobs go straight into resource creation.
+	inline constexpr Uint32 BAKED_MODEL_MAGIC = 0x4C444D41; //'AMDL'
+	inline constexpr Uint32 BAKED_MODEL_VERSION = 2;
+	inline constexpr Int32 BAKED_NONE = -1;
+
+	struct BakedSection
+	{
+		Uint64 offset;
+		Uint64 size;
+	};
+
+	struct BakedModelHeader
+	{
+		Uint32 magic;
+		Uint32 version;
+		Uint64 key;				  //BakedModelKey of the parameters the model was baked with
+		Uint32 vertex_stride;
+		Uint32 padding;
+		BakedSection vertices;
+		BakedSection indices;
+		BakedSection materials;
+		BakedSection nodes;
+		BakedSection textures;
+		BakedSection texture_mips;
+		BakedSection texture_data;
+		BakedSection strings;
+		BakedSection sources;
+	};
+
+	struct BakedString
+	{
+		Uint32 offset;
+		Uint32 length;
+	};
+
+	//a file the model was baked from, the package is stale once any of them changed
+	struct BakedSource
+	{
+		BakedString path;
+		Int64 write_time;
+		Uint64 size;
+	};
+
+	enum BakedTextureSlot : Uint32
+	{
+		BakedTextureSlot_Albedo,
+		BakedTextureSlot_Normal,
+		BakedTextureSlot_MetallicRoughness,
+		BakedTextureSlot_Emissive,
+		BakedTextureSlot_Count
+	};
+
+	struct BakedMaterial
+	{
+		Int32 textures[BakedTextureSlot_Count]; //indices into the texture table or BAKED_NONE
+		Float albedo_factor;
+		Float metallic_factor;
+		Float roughness_factor;
+		Float emissive_factor;
+		Float alpha_cutoff;
+		Uint32 alpha_mode;
+		Uint32 double_sided;
+		Uint32 shader;
+	};
+
+	enum BakedNodeFlag : Uint32
+	{
+		BakedNodeFlag_None = 0,
+		BakedNodeFlag_Mesh = 1 << 0,
+		BakedNodeFlag_Transform = 1 << 1,
+		BakedNodeFlag_AABB = 1 << 2,
+		BakedNodeFlag_Quantized = 1 << 3
+	};
+
+	//one entity, parents come before their children
+	struct BakedNode
+	{
+		Int32 parent;
+		Int32 material;
+		Uint32 flags;
+		BakedString name;
+		Matrix transform;
+		Vector3 aabb_center;
+		Vector3 aabb_extents;
+		Vector3 position_offset;
+		Vector3 position_scale;
+		Uint32 topology;
+		Uint32 indices_count;
+		Uint32 start_index_location;
+		Int32 base_vertex_location;
+		Uint32 vertex_count;
+	};
+
+	//textures keep the name they were loaded with, so they are shared with the TextureManager like imported ones
+	struct BakedTexture
+	{
+		BakedString name;
+		Uint32 width;
+		Uint32 height;
+		Uint32 format; //DecodedTextureFormat
+		Uint32 first_mip; //mip records of the texture are texture_mips[first_mip, first_mip + mip_count)
+		Uint32 mip_count;
+		Uint32 padding;
+		Uint64 data_offset; //into the texture data section, mip offsets are relative to it
+	};
+
+	//what the importer hands to WriteBakedModel, textures are decoded and mipped while writing
+	struct BakedModelDesc
+	{
+		Uint64 key = 0;
+		std::vector<std::string> source_paths; //the glTF file and its buffers, texture_paths are sources too
+		void const* vertices = nullptr;
+		Uint64 vertex_count = 0;
+		Uint32 vertex_stride = 0;
+		Uint32 const* indices = nullptr;
+		Uint64 index_count = 0;
+		std::vector<BakedMaterial> materials;
+		std::vector<BakedNode> nodes;
+		std::vector<std::string> node_names;
+		std::vector<std::string> texture_paths;
+	};
+
+	Uint64 BakedModelKey(ModelParameters const& params);
+	std::string BakedModelPath(ModelParameters const& params);
+
+	Bool WriteBakedModel(std::string const& path, BakedModelDesc const& desc);
+
+	//maps a package and validates every section and index in it, the accessors are only meaningful for a valid file
+	class BakedModelFile
+	{
+	public:
+		explicit BakedModelFile(std::string const& path);
+
+		Bool IsValid() const { return header != nullptr; }
+		//true when the write time or size of a source file differs from when it was baked, or the file was added or removed
+		Bool IsStale() const;
+		BakedModelHeader const& Header() const { return *header; }
+
+		void const* Vertices() const { return file.Data() + header->vertices.offset; }
+		Uint64 VertexCount() const { return header->vertices.size / header->vertex_stride; }
+		Uint32 const* Indices() const { return Section<Uint32>(header->indices).data(); }
+		Uint64 IndexCount() const { return header->indices.size / sizeof(Uint32); }
+		std::span<BakedMaterial const> Materials() const { return Section<BakedMaterial>(header->materials); }
+		std::span<BakedNode const> Nodes() const { return Section<BakedNode>(header->nodes); }
+		std::span<BakedTexture const> Textures() const { return Section<BakedTexture>(header->textures); }
+		std::span<BakedSource const> Sources() const { return Section<BakedSource>(header->sources); }
+
+		std::string_view String(BakedString const& string) const;
+		DecodedTextureView Texture(BakedTexture const& texture) const;
+
+	private:
+		MemoryMappedFile file;
+		BakedModelHeader const* header = nullptr;
+
+	private:
+		Bool Validate() const;
+
+		template<typename T>
+		std::span<T const> Section(BakedSection const& section) const
+		{
+			return std::span<T const>(reinterpret_cast<T const*>(file.Data() + section.offset), section.size / sizeof(T));
+		}
+	};
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include "ClusterBinner.h"
+#include "LightTable.h"
+#include "Camera.h"
+#include "Enums.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 ROW_COUNT = ClusterBinner::CLUSTER_SIZE_Y * ClusterBinner::CLUSTER_SIZE_Z;
+		constexpr Uint32 LIGHT_GRAIN_SIZE = 256;
+
+		Bool SphereIntersectsAABB(Vector4 const& center, Float radius, ClusterAABB const& aabb)
+		{
+			Float const dx = std::clamp(center.x, aabb.min_point.x, aabb.max_point.x) - center.x;
+			Float const dy = std::clamp(center.y, aabb.min_point.y, aabb.max_point.y) - center.y;
+			Float const dz = std::clamp(center.z, aabb.min_point.z, aabb.max_point.z) - center.z;
+			return dx * dx + dy * dy + dz * dz <= radius * radius;
+		}
+
+		//cone against the bounding sphere of the cluster, only rejects clusters completely outside of the outer cone
+		Bool ConeIntersectsAABB(LightSBuffer const& light, ClusterAABB const& aabb)
+		{
+			Float const dir_length = std::sqrt(light.direction.x * light.direction.x + light.direction.y * light.direction.y + light.direction.z * light.direction.z);
+			if (dir_length == 0.0f || light.outer_cosine <= 0.0f) return true;
+
+			Float const extent_x = 0.5f * (aabb.max_point.x - aabb.min_point.x);
+			Float const extent_y = 0.5f * (aabb.max_point.y - aabb.min_point.y);
+			Float const extent_z = 0.5f * (aabb.max_point.z - aabb.min_point.z);
+			Float const radius = std::sqrt(extent_x * extent_x + extent_y * extent_y + extent_z * extent_z);
+
+			Float const vx = aabb.min_point.x + extent_x - light.position.x;
+			Float const vy = aabb.min_point.y + extent_y - light.position.y;
+			Float const vz = aabb.min_point.z + extent_z - light.position.z;
+			Float const v_length_sq = vx * vx + vy * vy + vz * vz;
+			Float const v_axis = (vx * light.direction.x + vy * light.direction.y + vz * light.direction.z) / dir_length;
+
+			Float const outer_sine = std::sqrt(1.0f - light.outer_cosine * light.outer_cosine);
+			Float const closest_distance = light.outer_cosine * std::sqrt((std::max)(v_length_sq - v_axis * v_axis, 0.0f)) - v_axis * outer_sine;
+			if (closest_distance > radius) return false;
+			if (v_axis > radius + light.range) return false;
+			if (v_axis < -radius) return false;
+			return true;
+		}
+	}
+
+	ClusterBinner::ClusterBinner(GfxDevice* gfx) : gfx(gfx)
+	{
+		clusters.resize(CLUSTER_COUNT);
+		row_bounds.resize(ROW_COUNT);
+		slice_lights.resize(CLUSTER_SIZE_Z);
+		row_candidates.resize(ROW_COUNT);
+		row_lights.resize(ROW_COUNT);
+		row_max_lights.resize(ROW_COUNT);
+		light_grids.resize(CLUSTER_COUNT);
+	}
+
+	Bool ClusterBinner::LightIntersectsCluster(LightSBuffer const& light, ClusterAABB const& cluster)
+	{
+		if (!light.active || light.casts_shadows) return false;
+		LightType const type = static_cast<LightType>(light.type);
+		if (type == LightType::Directional) return true;
+		if (!SphereIntersectsAABB(light.position, light.range, cluster)) return false;
+		return type != LightType::Spot || ConeIntersectsAABB(light, cluster);
+	}
+
+	void ClusterBinner::Bin(Camera const& camera, Uint32 _width, Uint32 _height, LightTable const& lights)
+	{
+		BuildClusters(camera, _width, _height);
+
+		LightSBuffer const* light_data = lights.Data();
+		Uint32 const light_count = lights.Size();
+
+		//depth slices of every light, first > last for lights the clustered pass does not shade
+		light_slices.resize(light_count);
+		g_JobSystem.ParallelFor(light_count, LIGHT_GRAIN_SIZE, [&](Uint32 i)
+			{
+				LightSBuffer const& light = light_data[i];
+				std::pair<Uint32, Uint32>& slices = light_slices[i];
+				slices = { 1, 0 };
+				if (!light.active || light.casts_shadows) return;
+				if (static_cast<LightType>(light.type) == LightType::Directional)
+				{
+					slices = { 0, CLUSTER_SIZE_Z - 1 };
+					return;
+				}
+
+				Float const min_z = light.position.z - light.range;
+				Float const max_z = light.position.z + light.range;
+				if (max_z < slice_depths[0] || min_z > slice_depths[CLUSTER_SIZE_Z]) return;
+				//first slice whose far depth is not in front of the sphere, last slice whose near depth is not behind it
+				Float const* first = std::lower_bound(slice_depths + 1, slice_depths + CLUSTER_SIZE_Z + 1, min_z);
+				Float const* last = std::upper_bound(slice_depths, slice_depths + CLUSTER_SIZE_Z, max_z);
+				slices = { Uint32(first - slice_depths - 1), Uint32(last - slice_depths - 1) };
+			});
+
+		Uint32 binned_lights = 0;
+		for (auto& slice : slice_lights) slice.clear();
+		for (Uint32 i = 0; i < light_count; ++i)
+		{
+			auto const [first, last] = light_slices[i];
+			if (first > last) continue;
+			for (Uint32 z = first; z <= last; ++z) slice_lights[z].push_back(i);
+			++binned_lights;
+		}
+
+		//one job per row of clusters, lights stay sorted by index within every cluster
+		g_JobSystem.ParallelFor(ROW_COUNT, 1, [&](Uint32 row)
+			{
+				Uint32 const z = row / CLUSTER_SIZE_Y;
+				Uint32 const y = row % CLUSTER_SIZE_Y;
+				std::vector<Uint32>& candidates = row_candidates[row];
+				std::vector<Uint32>& binned = row_lights[row];
+				candidates.clear();
+				binned.clear();
+
+				for (Uint32 light_index : slice_lights[z])
+				{
+					LightSBuffer const& light = light_data[light_index];
+					if (static_cast<LightType>(light.type) == LightType::Directional || SphereIntersectsAABB(light.position, light.range, row_bounds[row]))
+						candidates.push_back(light_index);
+				}
+
+				Uint32 max_lights = 0;
+				for (Uint32 x = 0; x < CLUSTER_SIZE_X; ++x)
+				{
+					Uint32 const cluster_index = ClusterIndex(x, y, z);
+					ClusterAABB const& cluster = clusters[cluster_index];
+					Uint32 const offset = static_cast<Uint32>(binned.size());
+					for (Uint32 light_index : candidates)
+					{
+						if (LightIntersectsCluster(light_data[light_index], cluster)) binned.push_back(light_index);
+					}
+					light_grids[cluster_index] = LightGrid{ offset, static_cast<Uint32>(binned.size()) - offset };
+					max_lights = (std::max)(max_lights, light_grids[cluster_index].light_count);
+				}
+				row_max_lights[row] = max_lights;
+			});
+
+		Uint32 light_index_count = 0;
+		Uint32 row_offsets[ROW_COUNT];
+		for (Uint32 row = 0; row < ROW_COUNT; ++row)
+		{
+			row_offsets[row] = light_index_count;
+			light_index_count += static_cast<Uint32>(row_lights[row].size());
+		}
+		light_index_list.resize(light_index_count);
+
+		g_JobSystem.ParallelFor(ROW_COUNT, 1, [&](Uint32 row)
+			{
+				Uint32 const z = row / CLUSTER_SIZE_Y;
+				Uint32 const y = row % CLUSTER_SIZE_Y;
+				std::copy(row_lights[row].begin(), row_lights[row].end(), light_index_list.begin() + row_offsets[row]);
+				for (Uint32 x = 0; x < CLUSTER_SIZE_X; ++x) light_grids[ClusterIndex(x, y, z)].offset += row_offsets[row];
+			});
+
+		stats.binned_lights = binned_lights;
+		stats.light_indices = light_index_count;
+		stats.max_cluster_lights = *std::max_element(row_max_lights.begin(), row_max_lights.end());
+	}
+
+	void ClusterBinner::Upload()
+	{
+		if (!gfx) return;
+
+		if (!light_grid_buffer)
+		{
+			light_grid_buffer = std::make_unique<GfxBuffer>(gfx, StructuredBufferDesc<LightGrid>(CLUSTER_COUNT, false, true));
+			light_grid_buffer->CreateSRV();
+		}
+		Uint32 const light_index_count = static_cast<Uint32>(light_index_list.size());
+		if (light_index_count > light_list_capacity || !light_list_buffer)
+		{
+			Uint32 new_capacity = (std::max)(light_list_capacity, CLUSTER_COUNT);
+			while (new_capacity < light_index_count) new_capacity *= 2;
+			light_list_capacity = new_capacity;
+			light_list_buffer = std::make_unique<GfxBuffer>(gfx, StructuredBufferDesc<Uint32>(light_list_capacity, false, true));
+			light_list_buffer->CreateSRV();
+		}
+
+		light_grid_buffer->Update(light_grids.data(), light_grids.size() * sizeof(LightGrid));
+		if (light_index_count > 0) light_list_buffer->Update(light_index_list.data(), light_index_count * sizeof(Uint32));
+	}
+
+	void ClusterBinner::BuildClusters(Camera const& camera, Uint32 _width, Uint32 _height)
+	{
+		Matrix const camera_projection = camera.Proj();
+		if (clusters_valid && camera_projection == projection && camera.Near() == near_plane && camera.Far() == far_plane
+			&& _width == width && _height == height) return;
+
+		projection = camera_projection;
+		near_plane = camera.Near();
+		far_plane = camera.Far();
+		width = _width;
+		height = _height;
+		clusters_valid = true;
+
+		for (Uint32 z = 0; z <= CLUSTER_SIZE_Z; ++z)
+		{
+			slice_depths[z] = near_plane * std::pow(far_plane / near_plane, z / Float(CLUSTER_SIZE_Z));
+		}
+		slice_depths[CLUSTER_SIZE_Z] = far_plane;
+
+		//tiles have the size the lighting pass divides pixel positions by, so the last ones can reach past the screen
+		Matrix const inverse_projection = projection.Invert();
+		Float const tile_width = std::ceil(width / Float(CLUSTER_SIZE_X)) / width;
+		Float const tile_height = std::ceil(height / Float(CLUSTER_SIZE_Y)) / height;
+		auto ViewRay = [&](Float u, Float v)
+		{
+			Vector4 const clip(u * 2.0f - 1.0f, 1.0f - v * 2.0f, 1.0f, 1.0f);
+			Vector4 const view = Vector4::Transform(clip, inverse_projection);
+			return std::pair<Float, Float>(view.x / view.z, view.y / view.z);
+		};
+
+		for (Uint32 y = 0; y < CLUSTER_SIZE_Y; ++y)
+		{
+			for (Uint32 x = 0; x < CLUSTER_SIZE_X; ++x)
+			{
+				auto const [min_ray_x, min_ray_y] = ViewRay(x * tile_width, y * tile_height);
+				auto const [max_ray_x, max_ray_y] = ViewRay((x + 1) * tile_width, (y + 1) * tile_height);
+				for (Uint32 z = 0; z < CLUSTER_SIZE_Z; ++z)
+				{
+					Float const cluster_near = slice_depths[z];
+					Float const cluster_far = slice_depths[z + 1];
+					ClusterAABB& cluster = clusters[ClusterIndex(x, y, z)];
+					cluster.min_point = Vector4((std::min)({ min_ray_x * cluster_near, min_ray_x * cluster_far, max_ray_x * cluster_near, max_ray_x * cluster_far }),
+												(std::min)({ min_ray_y * cluster_near, min_ray_y * cluster_far, max_ray_y * cluster_near, max_ray_y * cluster_far }),
+												cluster_near, 0.0f);
+					cluster.max_point = Vector4((std::max)({ min_ray_x * cluster_near, min_ray_x * cluster_far, max_ray_x * cluster_near, max_ray_x * cluster_far }),
+												(std::max)({ min_ray_y * cluster_near, min_ray_y * cluster_far, max_ray_y * cluster_near, max_ray_y * cluster_far }),
+												cluster_far, 0.0f);
+				}
+			}
+		}
+
+		for (Uint32 row = 0; row < ROW_COUNT; ++row)
+		{
+			Uint32 const z = row / CLUSTER_SIZE_Y;
+			Uint32 const y = row % CLUSTER_SIZE_Y;
+			ClusterAABB& bounds = row_bounds[row];
+			bounds = clusters[ClusterIndex(0, y, z)];
+			for (Uint32 x = 1; x < CLUSTER_SIZE_X; ++x)
+			{
+				ClusterAABB const& cluster = clusters[ClusterIndex(x, y, z)];
+				bounds.min_point = Vector4::Min(bounds.min_point, cluster.min_point);
+				bounds.max_point = Vector4::Max(bounds.max_point, cluster.max_point);
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "ConstantBuffers.h"
+#include "Graphics/GfxBuffer.h"
+
+namespace adria
+{
+	class Camera;
+	class LightTable;
+
+	struct ClusterBinnerStats
+	{
+		Uint32 binned_lights = 0;
+		Uint32 light_indices = 0;
+		Uint32 max_cluster_lights = 0;
+	};
+
+	//CPU alternative to the cluster building and culling compute passes. The froxel grid has logarithmic depth slices like the GPU one,
+	//lights are bucketed by the depth slices they overlap and every row of clusters is binned by one job. The light index list
+	//is compacted and has no per cluster limit, its buffer grows by doubling.
+	class ClusterBinner
+	{
+	public:
+		static constexpr Uint32 CLUSTER_SIZE_X = 16;
+		static constexpr Uint32 CLUSTER_SIZE_Y = 16;
+		static constexpr Uint32 CLUSTER_SIZE_Z = 16;
+		static constexpr Uint32 CLUSTER_COUNT = CLUSTER_SIZE_X * CLUSTER_SIZE_Y * CLUSTER_SIZE_Z;
+
+		//without a device the binner only does the CPU work
+		explicit ClusterBinner(GfxDevice* gfx = nullptr);
+
+		void Bin(Camera const& camera, Uint32 width, Uint32 height, LightTable const& lights);
+		void Upload();
+
+		std::vector<ClusterAABB> const& Clusters() const { return clusters; }
+		std::vector<LightGrid> const& LightGrids() const { return light_grids; }
+		std::vector<Uint32> const& LightIndexList() const { return light_index_list; }
+		GfxBuffer* LightGridBuffer() const { return light_grid_buffer.get(); }
+		GfxBuffer* LightListBuffer() const { return light_list_buffer.get(); }
+		ClusterBinnerStats const& GetStats() const { return stats; }
+
+		static Uint32 ClusterIndex(Uint32 x, Uint32 y, Uint32 z)
+		{
+			return x + CLUSTER_SIZE_X * y + CLUSTER_SIZE_X * CLUSTER_SIZE_Y * z;
+		}
+		//the exact test the binner ends with, light positions and directions are in view space
+		static Bool LightIntersectsCluster(LightSBuffer const& light, ClusterAABB const& cluster);
+
+	private:
+		GfxDevice* gfx;
+		std::unique_ptr<GfxBuffer> light_grid_buffer;
+		std::unique_ptr<GfxBuffer> light_list_buffer;
+		Uint32 light_list_capacity = 0;
+
+		Matrix projection;
+		Float slice_depths[CLUSTER_SIZE_Z + 1] = {};
+		Float near_plane = 0.0f;
+		Float far_plane = 0.0f;
+		Uint32 width = 0;
+		Uint32 height = 0;
+		Bool clusters_valid = false;
+		std::vector<ClusterAABB> clusters;
+		std::vector<ClusterAABB> row_bounds;
+
+		std::vector<std::pair<Uint32, Uint32>> light_slices;
+		std::vector<std::vector<Uint32>> slice_lights;
+		std::vector<std::vector<Uint32>> row_candidates;
+		std::vector<std::vector<Uint32>> row_lights;
+		std::vector<Uint32> row_max_lights;
+
+		std::vector<LightGrid> light_grids;
+		std::vector<Uint32> light_index_list;
+		ClusterBinnerStats stats;
+
+	private:
+		void BuildClusters(Camera const& camera, Uint32 width, Uint32 height);
+	};
+}
@@ -4,6 +4,7 @@
 #include "Terrain.h"
 #include "TextureManager.h"
 #include "Math/Constants.h"
+#include "Math/VertexCompression.h"
 #include "Graphics/GfxVertexFormat.h"
 #include "Graphics/GfxBuffer.h"
 #include "Graphics/GfxStates.h"
@@ -19,14 +20,21 @@ namespace adria
 	{
 		Matrix starting_transform = Matrix::Identity;
 		Matrix current_transform = Matrix::Identity;
+
+		//cached by the renderer, code writing current_transform through a reference has to touch the Transform
+		Matrix world_transform = Matrix::Identity;
+		Matrix inverse_world_transform = Matrix::Identity;
+		Bool world_changed = false;
 	};
 
+	//intrusive first child/next sibling links, use the functions in Hierarchy.h to modify them
 	struct COMPONENT Relationship
 	{
-		static constexpr size_t MAX_CHILDREN = 2048;
 		tecs::entity parent = tecs::null_entity;
+		tecs::entity first_child = tecs::null_entity;
+		tecs::entity prev_sibling = tecs::null_entity;
+		tecs::entity next_sibling = tecs::null_entity;
 		Uint32 children_count = 0;
-		tecs::entity children[MAX_CHILDREN] = { tecs::null_entity };
 	};
 
 	struct COMPONENT Mesh
@@ -50,6 +58,9 @@ namespace adria
 
 		GfxPrimitiveTopology topology = GfxPrimitiveTopology::TriangleList;
 
+		//set when the vertex buffer holds CompressedVertex, the mesh then needs the compressed shader programs
+		std::optional<VertexQuantization> quantization;
+
 		void Draw(GfxCommandContext* context) const;
 		void Draw(GfxCommandContext* context, GfxPrimitiveTopology override_topology) const;
 	};
@@ -58,6 +58,10 @@ namespace adria
 	{
 		Matrix model;
 		Matrix transposed_inverse_model;
+		Vector3 position_offset;
+		Float _padd0;
+		Vector3 position_scale;
+		Float _padd1;
 	};
 
 	DECLSPEC_ALIGN(16) struct MaterialCBuffer
@@ -48,6 +48,7 @@ namespace adria
 		PS_Decal,
 		PS_DecalsModifyNormals,
 		VS_GBufferPBR,
+		VS_GBufferPBR_Compressed,
 		PS_GBufferPBR,
 		PS_GBufferPBR_Mask,
 		VS_GBufferTerrain,
@@ -84,8 +85,10 @@ namespace adria
 		PS_MotionBlur,
 		PS_Fog,
 		VS_Shadow,
+		VS_Shadow_Compressed,
 		PS_Shadow,
 		VS_ShadowTransparent,
+		VS_ShadowTransparent_Compressed,
 		PS_ShadowTransparent,
 		PS_VolumetricLight_Directional,
 		PS_VolumetricLight_Spot,
@@ -137,6 +140,8 @@ namespace adria
 		Billboard,
 		GBufferPBR,
 		GBufferPBR_Mask,
+		GBufferPBR_Compressed,
+		GBufferPBR_Mask_Compressed,
 		GBuffer_Terrain,
 		AmbientPBR,
 		AmbientPBR_AO,
@@ -154,6 +159,8 @@ namespace adria
 		Add,
 		DepthMap,
 		DepthMap_Transparent,
+		DepthMap_Compressed,
+		DepthMap_Transparent_Compressed,
 		Volumetric_Directional,
 		Volumetric_DirectionalCascades,
 		Volumetric_Spot,
@@ -0,0 +1,193 @@
+#include <bit>
+#include <cstring>
+#include "FrustumCuller.h"
+#include "Components.h"
+#include "tecs/registry.h"
+#include "Utilities/JobSystem.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		struct FrustumPlaneSoA
+		{
+			XMVECTOR nx, ny, nz, d;
+			XMVECTOR abs_nx, abs_ny, abs_nz;
+		};
+
+		inline Uint32 MoveMask(FXMVECTOR v)
+		{
+#if defined(_XM_SSE_INTRINSICS_)
+			return static_cast<Uint32>(_mm_movemask_ps(v));
+#else
+			XMUINT4 u;
+			XMStoreUInt4(&u, v);
+			return (u.x >> 31) | ((u.y >> 31) << 1) | ((u.z >> 31) << 2) | ((u.w >> 31) << 3);
+#endif
+		}
+	}
+
+	void FrustumCuller::Gather(tecs::registry& reg)
+	{
+		Clear();
+		auto aabb_view = reg.view<AABB>();
+		Reserve(static_cast<Uint32>(aabb_view.size()));
+		for (auto e : aabb_view)
+		{
+			auto const& aabb = aabb_view.get(e);
+			if (aabb.skip_culling || reg.has<Light>(e)) continue;
+			Add(e, aabb.bounding_box);
+		}
+	}
+
+	void FrustumCuller::Add(tecs::entity e, BoundingBox const& bounding_box)
+	{
+		if (count % SIMD_WIDTH == 0)
+		{
+			Uint64 const padded_count = count + SIMD_WIDTH;
+			center_x.resize(padded_count, 0.0f);
+			center_y.resize(padded_count, 0.0f);
+			center_z.resize(padded_count, 0.0f);
+			extents_x.resize(padded_count, 0.0f);
+			extents_y.resize(padded_count, 0.0f);
+			extents_z.resize(padded_count, 0.0f);
+		}
+		center_x[count] = bounding_box.Center.x;
+		center_y[count] = bounding_box.Center.y;
+		center_z[count] = bounding_box.Center.z;
+		extents_x[count] = bounding_box.Extents.x;
+		extents_y[count] = bounding_box.Extents.y;
+		extents_z[count] = bounding_box.Extents.z;
+		entities.push_back(e);
+		++count;
+	}
+
+	void FrustumCuller::Clear()
+	{
+		center_x.clear();
+		center_y.clear();
+		center_z.clear();
+		extents_x.clear();
+		extents_y.clear();
+		extents_z.clear();
+		entities.clear();
+		count = 0;
+	}
+
+	template<typename F>
+	void FrustumCuller::CullImpl(F&& test, std::vector<Uint32>& visible) const
+	{
+		static_assert(CHUNK_SIZE % SIMD_WIDTH == 0);
+		visible.resize(count);
+		if (count == 0) return;
+
+		Uint32 const chunk_count = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		chunk_visible_counts.resize(chunk_count);
+
+		//every chunk writes its visible indices at its own offset, gaps are squeezed out afterwards
+		g_JobSystem.ParallelFor(chunk_count, 1, [&](Uint32 chunk)
+			{
+				Uint32 const begin = chunk * CHUNK_SIZE;
+				Uint32 const end = (std::min)(begin + CHUNK_SIZE, count);
+				Uint32* chunk_visible = visible.data() + begin;
+				Uint32 visible_count = 0;
+				for (Uint32 i = begin; i < end; i += SIMD_WIDTH)
+				{
+					Uint32 mask = test(i);
+					if (end - i < SIMD_WIDTH) mask &= (1u << (end - i)) - 1;
+					while (mask)
+					{
+						chunk_visible[visible_count++] = i + static_cast<Uint32>(std::countr_zero(mask));
+						mask &= mask - 1;
+					}
+				}
+				chunk_visible_counts[chunk] = visible_count;
+			});
+
+		Uint32 total_visible = 0;
+		for (Uint32 chunk = 0; chunk < chunk_count; ++chunk)
+		{
+			Uint32 const begin = chunk * CHUNK_SIZE;
+			if (total_visible != begin) std::memmove(visible.data() + total_visible, visible.data() + begin, chunk_visible_counts[chunk] * sizeof(Uint32));
+			total_visible += chunk_visible_counts[chunk];
+		}
+		visible.resize(total_visible);
+	}
+
+	void FrustumCuller::Cull(BoundingFrustum const& frustum, std::vector<Uint32>& visible) const
+	{
+		XMVECTOR planes[6];
+		frustum.GetPlanes(&planes[0], &planes[1], &planes[2], &planes[3], &planes[4], &planes[5]);
+
+		FrustumPlaneSoA soa_planes[6];
+		for (Uint32 i = 0; i < 6; ++i)
+		{
+			soa_planes[i].nx = XMVectorSplatX(planes[i]);
+			soa_planes[i].ny = XMVectorSplatY(planes[i]);
+			soa_planes[i].nz = XMVectorSplatZ(planes[i]);
+			soa_planes[i].d  = XMVectorSplatW(planes[i]);
+			soa_planes[i].abs_nx = XMVectorAbs(soa_planes[i].nx);
+			soa_planes[i].abs_ny = XMVectorAbs(soa_planes[i].ny);
+			soa_planes[i].abs_nz = XMVectorAbs(soa_planes[i].nz);
+		}
+
+		//frustum planes point outwards, a box is rejected if it is completely in front of any plane
+		CullImpl([&](Uint32 i)
+			{
+				XMVECTOR const cx = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_x[i]));
+				XMVECTOR const cy = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_y[i]));
+				XMVECTOR const cz = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_z[i]));
+				XMVECTOR const ex = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_x[i]));
+				XMVECTOR const ey = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_y[i]));
+				XMVECTOR const ez = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_z[i]));
+
+				XMVECTOR outside = XMVectorFalseInt();
+				for (FrustumPlaneSoA const& plane : soa_planes)
+				{
+					XMVECTOR distance = XMVectorMultiplyAdd(plane.nx, cx, XMVectorMultiplyAdd(plane.ny, cy, XMVectorMultiplyAdd(plane.nz, cz, plane.d)));
+					XMVECTOR radius = XMVectorMultiplyAdd(plane.abs_nx, ex, XMVectorMultiplyAdd(plane.abs_ny, ey, XMVectorMultiply(plane.abs_nz, ez)));
+					outside = XMVectorOrInt(outside, XMVectorGreater(distance, radius));
+				}
+				return ~MoveMask(outside) & 0xf;
+			}, visible);
+	}
+
+	void FrustumCuller::Cull(BoundingBox const& box, std::vector<Uint32>& visible) const
+	{
+		XMVECTOR const box_cx = XMVectorReplicate(box.Center.x);
+		XMVECTOR const box_cy = XMVectorReplicate(box.Center.y);
+		XMVECTOR const box_cz = XMVectorReplicate(box.Center.z);
+		XMVECTOR const box_ex = XMVectorReplicate(box.Extents.x);
+		XMVECTOR const box_ey = XMVectorReplicate(box.Extents.y);
+		XMVECTOR const box_ez = XMVectorReplicate(box.Extents.z);
+
+		CullImpl([&](Uint32 i)
+			{
+				XMVECTOR const cx = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_x[i]));
+				XMVECTOR const cy = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_y[i]));
+				XMVECTOR const cz = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&center_z[i]));
+				XMVECTOR const ex = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_x[i]));
+				XMVECTOR const ey = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_y[i]));
+				XMVECTOR const ez = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&extents_z[i]));
+
+				XMVECTOR overlap = XMVectorLessOrEqual(XMVectorAbs(XMVectorSubtract(cx, box_cx)), XMVectorAdd(ex, box_ex));
+				overlap = XMVectorAndInt(overlap, XMVectorLessOrEqual(XMVectorAbs(XMVectorSubtract(cy, box_cy)), XMVectorAdd(ey, box_ey)));
+				overlap = XMVectorAndInt(overlap, XMVectorLessOrEqual(XMVectorAbs(XMVectorSubtract(cz, box_cz)), XMVectorAdd(ez, box_ez)));
+				return MoveMask(overlap);
+			}, visible);
+	}
+
+	void FrustumCuller::Reserve(Uint32 new_count)
+	{
+		Uint64 const padded_count = (new_count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+		center_x.reserve(padded_count);
+		center_y.reserve(padded_count);
+		center_z.reserve(padded_count);
+		extents_x.reserve(padded_count);
+		extents_y.reserve(padded_count);
+		extents_z.reserve(padded_count);
+		entities.reserve(new_count);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include "tecs/entity.h"
+
+namespace adria
+{
+	namespace tecs
+	{
+		class registry;
+	}
+
+	//Keeps the cullable bounding boxes of the scene in packed SoA arrays and tests them four at a time.
+	class FrustumCuller
+	{
+		static constexpr Uint32 SIMD_WIDTH = 4;
+		static constexpr Uint32 CHUNK_SIZE = 1024;
+
+	public:
+		FrustumCuller() = default;
+
+		//entities with skip_culling and lights are left out, their visibility is never touched
+		void Gather(tecs::registry& reg);
+		void Add(tecs::entity e, BoundingBox const& bounding_box);
+		void Clear();
+
+		void Cull(BoundingFrustum const& frustum, std::vector<Uint32>& visible) const;
+		void Cull(BoundingBox const& box, std::vector<Uint32>& visible) const;
+
+		Uint32 Size() const { return count; }
+		tecs::entity GetEntity(Uint32 i) const { return entities[i]; }
+
+	private:
+		std::vector<Float> center_x;
+		std::vector<Float> center_y;
+		std::vector<Float> center_z;
+		std::vector<Float> extents_x;
+		std::vector<Float> extents_y;
+		std::vector<Float> extents_z;
+		std::vector<tecs::entity> entities;
+		Uint32 count = 0;
+
+		mutable std::vector<Uint32> chunk_visible_counts;
+
+	private:
+		template<typename F>
+		void CullImpl(F&& test, std::vector<Uint32>& visible) const;
+		void Reserve(Uint32 new_count);
+	};
+}
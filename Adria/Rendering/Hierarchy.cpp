@@ -0,0 +1,69 @@
+#include "Hierarchy.h"
+#include "Core/Logger.h"
+
+namespace adria
+{
+	namespace
+	{
+		//layout of Relationship when every entity embedded a fixed array of children
+		struct FixedArrayRelationship
+		{
+			tecs::entity parent;
+			Uint32 children_count;
+			tecs::entity children[2048];
+		};
+	}
+
+	void AttachChild(tecs::registry& reg, tecs::entity parent, tecs::entity child)
+	{
+		ADRIA_ASSERT(parent != child);
+		if (!reg.has<Relationship>(parent)) reg.emplace<Relationship>(parent);
+		if (!reg.has<Relationship>(child)) reg.emplace<Relationship>(child);
+		if (reg.get<Relationship>(child).parent != tecs::null_entity) DetachChild(reg, child);
+
+		Relationship& parent_relationship = reg.get<Relationship>(parent);
+		Relationship& child_relationship = reg.get<Relationship>(child);
+		child_relationship.parent = parent;
+		child_relationship.prev_sibling = tecs::null_entity;
+		child_relationship.next_sibling = parent_relationship.first_child;
+		if (parent_relationship.first_child != tecs::null_entity) reg.get<Relationship>(parent_relationship.first_child).prev_sibling = child;
+		parent_relationship.first_child = child;
+		++parent_relationship.children_count;
+		reg.touch<Relationship>(child);
+	}
+
+	void DetachChild(tecs::registry& reg, tecs::entity child)
+	{
+		Relationship* child_relationship = reg.get_if<Relationship>(child);
+		if (!child_relationship || child_relationship->parent == tecs::null_entity) return;
+
+		Relationship& parent_relationship = reg.get<Relationship>(child_relationship->parent);
+		if (child_relationship->prev_sibling != tecs::null_entity) reg.get<Relationship>(child_relationship->prev_sibling).next_sibling = child_relationship->next_sibling;
+		else parent_relationship.first_child = child_relationship->next_sibling;
+		if (child_relationship->next_sibling != tecs::null_entity) reg.get<Relationship>(child_relationship->next_sibling).prev_sibling = child_relationship->prev_sibling;
+		--parent_relationship.children_count;
+
+		child_relationship->parent = tecs::null_entity;
+		child_relationship->prev_sibling = tecs::null_entity;
+		child_relationship->next_sibling = tecs::null_entity;
+		reg.touch<Relationship>(child);
+	}
+
+	void DestroyWithDescendants(tecs::registry& reg, tecs::entity root)
+	{
+		DetachChild(reg, root);
+		//the links are walked before anything is destroyed
+		std::vector<tecs::entity> descendants;
+		ForEachDescendantDepthFirst(reg, root, [&](tecs::entity e) { descendants.push_back(e); });
+		for (tecs::entity e : descendants) reg.destroy(e);
+		reg.destroy(root);
+	}
+
+	void LogHierarchyMemoryReport(tecs::registry& reg)
+	{
+		Uint64 const count = reg.size<Relationship>();
+		ADRIA_LOG(INFO, "Hierarchy: %llu entities, %llu bytes per entity (fixed array layout: %llu), %llu KB total (fixed array layout: %llu KB)",
+			count, (Uint64)sizeof(Relationship), (Uint64)sizeof(FixedArrayRelationship),
+			count * sizeof(Relationship) / 1024, count * sizeof(FixedArrayRelationship) / 1024);
+	}
+}
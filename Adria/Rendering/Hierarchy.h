@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include "Components.h"
+#include "tecs/registry.h"
+
+namespace adria
+{
+	//children are prepended, entities without a Relationship get one
+	void AttachChild(tecs::registry& reg, tecs::entity parent, tecs::entity child);
+	void DetachChild(tecs::registry& reg, tecs::entity child);
+	//detaches root from its parent and destroys it with all of its descendants
+	void DestroyWithDescendants(tecs::registry& reg, tecs::entity root);
+	void LogHierarchyMemoryReport(tecs::registry& reg);
+
+	template<typename F>
+	void ForEachChild(tecs::registry& reg, tecs::entity parent, F&& f)
+	{
+		Relationship const* relationship = reg.get_if<Relationship>(parent);
+		if (!relationship) return;
+		for (tecs::entity child = relationship->first_child; child != tecs::null_entity;)
+		{
+			tecs::entity next = reg.get<Relationship>(child).next_sibling;
+			f(child);
+			child = next;
+		}
+	}
+
+	//pre-order traversal of all descendants of root, root itself is not visited
+	template<typename F>
+	void ForEachDescendantDepthFirst(tecs::registry& reg, tecs::entity root, F&& f)
+	{
+		Relationship const* root_relationship = reg.get_if<Relationship>(root);
+		if (!root_relationship) return;
+
+		tecs::entity current = root_relationship->first_child;
+		while (current != tecs::null_entity)
+		{
+			f(current);
+			Relationship const& relationship = reg.get<Relationship>(current);
+			if (relationship.first_child != tecs::null_entity)
+			{
+				current = relationship.first_child;
+				continue;
+			}
+			//leaf, climb until an ancestor below root has a next sibling
+			while (current != root && reg.get<Relationship>(current).next_sibling == tecs::null_entity) current = reg.get<Relationship>(current).parent;
+			current = current == root ? tecs::null_entity : reg.get<Relationship>(current).next_sibling;
+		}
+	}
+
+	template<typename F>
+	void ForEachDescendantBreadthFirst(tecs::registry& reg, tecs::entity root, F&& f)
+	{
+		std::vector<tecs::entity> queue;
+		ForEachChild(reg, root, [&](tecs::entity child) { queue.push_back(child); });
+		for (size_t i = 0; i < queue.size(); ++i)
+		{
+			tecs::entity current = queue[i];
+			f(current);
+			ForEachChild(reg, current, [&](tecs::entity child) { queue.push_back(child); });
+		}
+	}
+}
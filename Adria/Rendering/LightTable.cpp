@@ -0,0 +1,191 @@
+#include <atomic>
+#include "LightTable.h"
+#include "Components.h"
+#include "tecs/registry.h"
+#include "Utilities/JobSystem.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	LightTable::LightTable(GfxDevice* gfx) : gfx(gfx)
+	{
+		Resize(0);
+	}
+
+	void LightTable::Sync(tecs::registry& reg)
+	{
+		stats.synced_lights = 0;
+		Uint64 const tick = reg.tick<Light>();
+		if (tick == synced_tick) return;
+
+		auto light_view = reg.view<Light>();
+		Resize(static_cast<Uint32>(light_view.size()));
+
+		//chunks start at multiples of the grain, so every block is written by one job only
+		std::atomic<Uint32> synced_lights = 0;
+		g_JobSystem.ParallelFor(count, BLOCK_SIZE, [&](Uint32 begin, Uint32 end)
+			{
+				Uint32 chunk_synced_lights = 0;
+				for (Uint32 i = begin; i < end; ++i)
+				{
+					tecs::entity const e = light_view[i];
+					if (!reg.changed_since<Light>(e, synced_tick)) continue;
+
+					Light const& light = light_view.get(e);
+					position_x[i] = light.position.x;
+					position_y[i] = light.position.y;
+					position_z[i] = light.position.z;
+					position_w[i] = light.position.w;
+					direction_x[i] = light.direction.x;
+					direction_y[i] = light.direction.y;
+					direction_z[i] = light.direction.z;
+					direction_w[i] = light.direction.w;
+
+					LightSBuffer& gpu_light = gpu_lights[i];
+					gpu_light.color = light.color * light.energy;
+					gpu_light.range = light.range;
+					gpu_light.type = static_cast<Int32>(light.type);
+					gpu_light.inner_cosine = light.inner_cosine;
+					gpu_light.outer_cosine = light.outer_cosine;
+					gpu_light.active = light.active;
+					gpu_light.casts_shadows = light.casts_shadows;
+					gpu_light.use_cascades = light.use_cascades;
+					changed_blocks[i / BLOCK_SIZE] = 1;
+					++chunk_synced_lights;
+				}
+				synced_lights.fetch_add(chunk_synced_lights, std::memory_order_relaxed);
+			});
+		synced_tick = tick;
+		stats.synced_lights = synced_lights.load();
+	}
+
+	void LightTable::Transform(Matrix const& _view)
+	{
+		Bool const view_changed = !view_valid || _view != view;
+		view = _view;
+		view_valid = true;
+
+		XMVECTOR const m11 = XMVectorReplicate(view._11), m12 = XMVectorReplicate(view._12), m13 = XMVectorReplicate(view._13), m14 = XMVectorReplicate(view._14);
+		XMVECTOR const m21 = XMVectorReplicate(view._21), m22 = XMVectorReplicate(view._22), m23 = XMVectorReplicate(view._23), m24 = XMVectorReplicate(view._24);
+		XMVECTOR const m31 = XMVectorReplicate(view._31), m32 = XMVectorReplicate(view._32), m33 = XMVectorReplicate(view._33), m34 = XMVectorReplicate(view._34);
+		XMVECTOR const m41 = XMVectorReplicate(view._41), m42 = XMVectorReplicate(view._42), m43 = XMVectorReplicate(view._43), m44 = XMVectorReplicate(view._44);
+
+		//row vector times matrix for four lights at once, the result is transposed back to one XMFLOAT4 per light
+		auto TransformFour = [&](Float const* x, Float const* y, Float const* z, Float const* w)
+		{
+			XMVECTOR const vx = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(x));
+			XMVECTOR const vy = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(y));
+			XMVECTOR const vz = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(z));
+			XMVECTOR const vw = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(w));
+			XMMATRIX result;
+			result.r[0] = XMVectorMultiplyAdd(vx, m11, XMVectorMultiplyAdd(vy, m21, XMVectorMultiplyAdd(vz, m31, XMVectorMultiply(vw, m41))));
+			result.r[1] = XMVectorMultiplyAdd(vx, m12, XMVectorMultiplyAdd(vy, m22, XMVectorMultiplyAdd(vz, m32, XMVectorMultiply(vw, m42))));
+			result.r[2] = XMVectorMultiplyAdd(vx, m13, XMVectorMultiplyAdd(vy, m23, XMVectorMultiplyAdd(vz, m33, XMVectorMultiply(vw, m43))));
+			result.r[3] = XMVectorMultiplyAdd(vx, m14, XMVectorMultiplyAdd(vy, m24, XMVectorMultiplyAdd(vz, m34, XMVectorMultiply(vw, m44))));
+			return XMMatrixTranspose(result);
+		};
+
+		std::atomic<Uint32> transformed_lights = 0;
+		Uint32 const block_count = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		g_JobSystem.ParallelFor(block_count, 1, [&](Uint32 block)
+			{
+				if (!view_changed && !changed_blocks[block]) return;
+				changed_blocks[block] = 0;
+				dirty_blocks[block] = 1;
+
+				Uint32 const begin = block * BLOCK_SIZE;
+				Uint32 const end = (std::min)(begin + BLOCK_SIZE, count);
+				for (Uint32 i = begin; i < end; i += SIMD_WIDTH)
+				{
+					XMMATRIX const positions = TransformFour(&position_x[i], &position_y[i], &position_z[i], &position_w[i]);
+					XMMATRIX const directions = TransformFour(&direction_x[i], &direction_y[i], &direction_z[i], &direction_w[i]);
+					Uint32 const lane_count = (std::min)(SIMD_WIDTH, end - i);
+					for (Uint32 lane = 0; lane < lane_count; ++lane)
+					{
+						XMStoreFloat4(&gpu_lights[i + lane].position, positions.r[lane]);
+						XMStoreFloat4(&gpu_lights[i + lane].direction, directions.r[lane]);
+					}
+				}
+				transformed_lights.fetch_add(end - begin, std::memory_order_relaxed);
+			});
+		stats.transformed_lights = transformed_lights.load();
+	}
+
+	void LightTable::Upload()
+	{
+		stats.upload_ranges = 0;
+		stats.uploaded_bytes = 0;
+		//without a device the ranges are only counted
+		if (recreate_buffer)
+		{
+			if (gfx)
+			{
+				buffer = std::make_unique<GfxBuffer>(gfx, StructuredBufferDesc<LightSBuffer>(capacity, false, false), gpu_lights.data());
+				buffer->CreateSRV();
+			}
+			recreate_buffer = false;
+			std::fill(dirty_blocks.begin(), dirty_blocks.end(), 0);
+			stats.upload_ranges = 1;
+			stats.uploaded_bytes = capacity * sizeof(LightSBuffer);
+			return;
+		}
+
+		//neighbouring dirty blocks are uploaded as one range
+		Uint32 const block_count = BlockCount();
+		for (Uint32 block = 0; block < block_count;)
+		{
+			if (!dirty_blocks[block])
+			{
+				++block;
+				continue;
+			}
+			Uint32 const first_light = block * BLOCK_SIZE;
+			while (block < block_count && dirty_blocks[block]) dirty_blocks[block++] = 0;
+			Uint32 const last_light = (std::min)(block * BLOCK_SIZE, capacity);
+
+			Uint64 const size = Uint64(last_light - first_light) * sizeof(LightSBuffer);
+			if (buffer) buffer->UpdateRange(gpu_lights.data() + first_light, first_light * sizeof(LightSBuffer), size);
+			++stats.upload_ranges;
+			stats.uploaded_bytes += size;
+		}
+	}
+
+	void LightTable::Invalidate()
+	{
+		std::fill(dirty_blocks.begin(), dirty_blocks.end(), 1);
+	}
+
+	void LightTable::Resize(Uint32 new_count)
+	{
+		if (new_count > capacity || capacity == 0)
+		{
+			Uint32 new_capacity = (std::max)(capacity, MIN_CAPACITY);
+			while (new_capacity < new_count) new_capacity *= 2;
+			capacity = new_capacity;
+
+			position_x.resize(capacity, 0.0f);
+			position_y.resize(capacity, 0.0f);
+			position_z.resize(capacity, 0.0f);
+			position_w.resize(capacity, 0.0f);
+			direction_x.resize(capacity, 0.0f);
+			direction_y.resize(capacity, 0.0f);
+			direction_z.resize(capacity, 0.0f);
+			direction_w.resize(capacity, 0.0f);
+			gpu_lights.resize(capacity, LightSBuffer{});
+			changed_blocks.resize(BlockCount(), 0);
+			dirty_blocks.resize(BlockCount(), 0);
+			recreate_buffer = true;
+		}
+
+		//removed lights at the end become inactive padding
+		for (Uint32 i = new_count; i < count; ++i)
+		{
+			gpu_lights[i] = LightSBuffer{};
+			dirty_blocks[i / BLOCK_SIZE] = 1;
+		}
+		count = new_count;
+		stats.light_count = count;
+		stats.capacity = capacity;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "ConstantBuffers.h"
+#include "Graphics/GfxBuffer.h"
+
+namespace adria
+{
+	namespace tecs
+	{
+		class registry;
+	}
+
+	struct LightTableStats
+	{
+		Uint32 light_count = 0;
+		Uint32 capacity = 0;
+		Uint32 synced_lights = 0;
+		Uint32 transformed_lights = 0;
+		Uint32 upload_ranges = 0;
+		Uint64 uploaded_bytes = 0;
+	};
+
+	//Persistent light structured buffer that mirrors the Light pool by position. World space positions and directions
+	//are kept in SoA arrays and transformed to view space four lights at a time, only for lights that changed or when the view moved.
+	//The buffer grows by doubling, padding entries are inactive lights, and only blocks with dirty lights are uploaded.
+	class LightTable
+	{
+		static constexpr Uint32 SIMD_WIDTH = 4;
+		static constexpr Uint32 MIN_CAPACITY = 64;
+
+	public:
+		static constexpr Uint32 BLOCK_SIZE = 256;
+
+		//without a device the table only does the CPU work, which is enough to profile it headless
+		explicit LightTable(GfxDevice* gfx = nullptr);
+
+		//copies lights that changed since the last sync, has to run while nothing else writes lights
+		void Sync(tecs::registry& reg);
+		void Transform(Matrix const& view);
+		void Upload();
+		//the whole buffer is uploaded again next time, for code that wrote to it directly
+		void Invalidate();
+
+		Uint32 Size() const { return count; }
+		Uint32 Capacity() const { return capacity; }
+		GfxBuffer* Buffer() const { return buffer.get(); }
+		LightSBuffer const* Data() const { return gpu_lights.data(); }
+		LightTableStats const& GetStats() const { return stats; }
+
+	private:
+		GfxDevice* gfx;
+		std::unique_ptr<GfxBuffer> buffer;
+		Bool recreate_buffer = true;
+
+		std::vector<Float> position_x;
+		std::vector<Float> position_y;
+		std::vector<Float> position_z;
+		std::vector<Float> position_w;
+		std::vector<Float> direction_x;
+		std::vector<Float> direction_y;
+		std::vector<Float> direction_z;
+		std::vector<Float> direction_w;
+		std::vector<Uint8> changed_blocks;
+		std::vector<Uint8> dirty_blocks;
+		std::vector<LightSBuffer> gpu_lights;
+
+		Uint32 count = 0;
+		Uint32 capacity = 0;
+		Uint64 synced_tick = 0;
+		Matrix view;
+		Bool view_valid = false;
+		LightTableStats stats;
+
+	private:
+		void Resize(Uint32 new_count);
+		Uint32 BlockCount() const { return (capacity + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+	};
+}
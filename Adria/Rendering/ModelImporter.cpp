@@ -9,18 +9,25 @@
 #include "tiny_obj_loader.h"
 
 #include "ModelImporter.h"
+#include "BakedModel.h"
+#include "Hierarchy.h"
 #include "TextureManager.h"
 #include "Core/Logger.h"
+#include "Core/CpuProfiler.h"
 #include "tecs/registry.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxVertexFormat.h"
 #include "Math/BoundingVolumeHelpers.h"
 #include "Math/ComputeTangentFrame.h"
+#include "Math/MeshOptimizer.h"
+#include "Math/VertexCompression.h"
 #include "Utilities/FilesUtil.h"
 #include "Utilities/Random.h"
 #include "Utilities/Heightmap.h"
 #include "Utilities/Image.h"
+#include "Utilities/JobSystem.h"
 #include "Utilities/StringUtil.h"
+#include "Utilities/Timer.h"
 
 using namespace DirectX;
 namespace adria 
@@ -112,6 +119,96 @@ namespace adria
 
     using namespace tecs;
 
+	namespace
+	{
+		void LogMeshOptimizationStats(std::string const& mesh_name, MeshOptimizationStats const& stats)
+		{
+			ADRIA_LOG(INFO, "%s: vertices %u -> %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", mesh_name.c_str(),
+				stats.vertices_before, stats.vertices_after, stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr);
+		}
+		void LogVertexCompressionReport(std::string const& mesh_name, VertexCompressionReport const& report)
+		{
+			ADRIA_LOG(INFO, "%s: vertex memory %.1f KB -> %.1f KB, max error position %g, uv %g, normal %.4f deg, tangent %.4f deg, bitangent %.4f deg", mesh_name.c_str(),
+				report.bytes_before / 1024.0, report.bytes_after / 1024.0, report.max_position_error, report.max_uv_error,
+				report.max_normal_error, report.max_tangent_error, report.max_bitangent_error);
+		}
+
+		//materials, nodes and texture table of an imported model, node 0 is the root and every entity is one of its children
+		BakedModelDesc MakeBakedModelDesc(registry& reg, std::string const& model_name, std::vector<entity> const& entities,
+			std::unordered_map<TextureHandle, std::string> const& texture_paths)
+		{
+			BakedModelDesc desc{};
+			std::unordered_map<TextureHandle, Int32> texture_indices;
+			auto BakeTexture = [&](TextureHandle handle) -> Int32
+			{
+				auto path_it = texture_paths.find(handle);
+				if (path_it == texture_paths.end()) return BAKED_NONE;
+				auto [it, inserted] = texture_indices.try_emplace(handle, static_cast<Int32>(desc.texture_paths.size()));
+				if (inserted) desc.texture_paths.push_back(path_it->second);
+				return it->second;
+			};
+
+			BakedNode& root = desc.nodes.emplace_back();
+			root.parent = BAKED_NONE;
+			root.material = BAKED_NONE;
+			root.flags = BakedNodeFlag_Transform;
+			root.transform = Matrix::Identity;
+			desc.node_names.push_back(model_name);
+
+			for (entity e : entities)
+			{
+				BakedNode node{};
+				node.parent = 0;
+				node.material = BAKED_NONE;
+				node.flags = BakedNodeFlag_Mesh;
+
+				Mesh const& mesh = reg.get<Mesh>(e);
+				node.topology = static_cast<Uint32>(mesh.topology);
+				node.indices_count = mesh.indices_count;
+				node.start_index_location = mesh.start_index_location;
+				node.base_vertex_location = mesh.base_vertex_location;
+				node.vertex_count = mesh.vertex_count;
+				if (mesh.quantization)
+				{
+					node.flags |= BakedNodeFlag_Quantized;
+					node.position_offset = mesh.quantization->position_offset;
+					node.position_scale = mesh.quantization->position_scale;
+				}
+				if (Material const* material = reg.get_if<Material>(e))
+				{
+					BakedMaterial& baked_material = desc.materials.emplace_back();
+					baked_material.textures[BakedTextureSlot_Albedo] = BakeTexture(material->albedo_texture);
+					baked_material.textures[BakedTextureSlot_Normal] = BakeTexture(material->normal_texture);
+					baked_material.textures[BakedTextureSlot_MetallicRoughness] = BakeTexture(material->metallic_roughness_texture);
+					baked_material.textures[BakedTextureSlot_Emissive] = BakeTexture(material->emissive_texture);
+					baked_material.albedo_factor = material->albedo_factor;
+					baked_material.metallic_factor = material->metallic_factor;
+					baked_material.roughness_factor = material->roughness_factor;
+					baked_material.emissive_factor = material->emissive_factor;
+					baked_material.alpha_cutoff = material->alpha_cutoff;
+					baked_material.alpha_mode = static_cast<Uint32>(material->alpha_mode);
+					baked_material.double_sided = material->double_sided;
+					baked_material.shader = static_cast<Uint32>(material->shader);
+					node.material = static_cast<Int32>(desc.materials.size() - 1);
+				}
+				if (Transform const* transform = reg.get_if<Transform>(e))
+				{
+					node.flags |= BakedNodeFlag_Transform;
+					node.transform = transform->starting_transform;
+				}
+				if (AABB const* aabb = reg.get_if<AABB>(e))
+				{
+					node.flags |= BakedNodeFlag_AABB;
+					node.aabb_center = aabb->bounding_box.Center;
+					node.aabb_extents = aabb->bounding_box.Extents;
+				}
+				desc.nodes.push_back(node);
+				desc.node_names.push_back(reg.get<Tag>(e).name);
+			}
+			return desc;
+		}
+	}
+
     std::vector<entity> ModelImporter::LoadGrid(GridParameters const& params, std::vector<TexturedNormalVertex>* vertices_out)
     {
         if (params.heightmap)
@@ -277,6 +374,7 @@ namespace adria
         std::vector<tinyobj::material_t> const& materials = reader.GetMaterials();
 		std::vector<entity> entities{};
         std::vector<std::string> diffuse_textures;
+		std::vector<std::vector<TexturedNormalVertex>> shape_vertices(shapes.size());
 		for (size_t s = 0; s < shapes.size(); s++)
 		{
             std::vector<TexturedNormalVertex> vertices{};
@@ -331,15 +429,38 @@ namespace adria
                 index_offset += fv;
 			}
 
+			shape_vertices[s] = std::move(vertices);
+		}
+
+		//tinyobj emits a vertex per face corner, welding gives the shapes an index buffer
+		std::vector<std::vector<Uint32>> shape_indices(shapes.size());
+		std::vector<MeshOptimizationStats> shape_stats(shapes.size());
+		g_JobSystem.ParallelFor(static_cast<Uint32>(shapes.size()), 1, [&](Uint32 s)
+			{
+				shape_stats[s] = OptimizeMesh(shape_vertices[s], shape_indices[s]);
+			});
+
+		for (size_t s = 0; s < shapes.size(); s++)
+		{
+			std::vector<TexturedNormalVertex> const& vertices = shape_vertices[s];
+			std::vector<Uint32> const& indices = shape_indices[s];
+			entity e = entities[s];
+
 			std::shared_ptr<GfxBuffer> vb = std::make_shared<GfxBuffer>(gfx, VertexBufferDesc(vertices.size(), sizeof(TexturedNormalVertex)), vertices.data());
+			std::shared_ptr<GfxBuffer> ib = std::make_shared<GfxBuffer>(gfx, IndexBufferDesc(indices.size(), false), indices.data());
 
 			Mesh mesh_component{};
 			mesh_component.base_vertex_location = 0;
 			mesh_component.vertex_count = static_cast<Uint32>(vertices.size());
+			mesh_component.start_index_location = 0;
+			mesh_component.indices_count = static_cast<Uint32>(indices.size());
             mesh_component.vertex_buffer = vb;
+			mesh_component.index_buffer = ib;
 			reg.emplace<Mesh>(e, mesh_component);
 
-			reg.emplace<Tag>(e, model_name + " mesh" + std::to_string(as_integer(e)));
+			std::string mesh_name = model_name + " mesh" + std::to_string(get_index(e));
+			LogMeshOptimizationStats(mesh_name, shape_stats[s]);
+			reg.emplace<Tag>(e, std::move(mesh_name));
 
 			if (diffuse_textures_out)
 			{
@@ -359,6 +480,7 @@ namespace adria
 
 	std::vector<entity> ModelImporter::ImportModel_GLTF(ModelParameters const& params)
 	{
+		AdriaCpuProfileScope("ModelImporter::ImportModel_GLTF");
 		tinygltf::TinyGLTF loader;
 		tinygltf::Model model;
 		std::string err;
@@ -381,10 +503,30 @@ namespace adria
 			return {};
 		}
 
+		struct PrimitiveGeometry
+		{
+			entity e;
+			Mesh mesh;
+			std::vector<CompleteVertex> vertices;
+			std::vector<Uint32> indices;
+			std::optional<MeshOptimizationStats> stats;
+			std::vector<CompressedVertex> compressed_vertices;
+			std::optional<VertexCompressionReport> compression;
+		};
+		std::vector<PrimitiveGeometry> primitives{};
 		std::vector<CompleteVertex> vertices{};
+		std::vector<CompressedVertex> compressed_vertices{};
 		std::vector<Uint32> indices{};
 		std::vector<entity> entities{};
 		std::unordered_map<std::string, std::vector<entity>> mesh_name_to_entities_map;
+		//the baked model stores textures by the path they were loaded from
+		std::unordered_map<TextureHandle, std::string> texture_paths;
+		auto LoadMaterialTexture = [&texture_paths](std::string const& path, TexturePlaceholder placeholder = TexturePlaceholder::White)
+		{
+			TextureHandle handle = g_TextureManager.LoadTexture(ToWideString(path), placeholder);
+			texture_paths.try_emplace(handle, path);
+			return handle;
+		};
 		for (auto& mesh : model.meshes)
 		{
 			std::vector<entity>& mesh_entities = mesh_name_to_entities_map[mesh.name];
@@ -405,7 +547,7 @@ namespace adria
 					tinygltf::Texture const& base_texture = model.textures[pbr_metallic_roughness.baseColorTexture.index];
 					tinygltf::Image const& base_image = model.images[base_texture.source];
 					std::string texbase = params.textures_path + base_image.uri;
-					material.albedo_texture = g_TextureManager.LoadTexture(ToWideString(texbase));
+					material.albedo_texture = LoadMaterialTexture(texbase);
 					material.albedo_factor = (Float)pbr_metallic_roughness.baseColorFactor[0];
 				}
 				if (pbr_metallic_roughness.metallicRoughnessTexture.index >= 0)
@@ -413,7 +555,7 @@ namespace adria
 					tinygltf::Texture const& metallic_roughness_texture = model.textures[pbr_metallic_roughness.metallicRoughnessTexture.index];
 					tinygltf::Image const& metallic_roughness_image = model.images[metallic_roughness_texture.source];
 					std::string texmetallicroughness = params.textures_path + metallic_roughness_image.uri;
-					material.metallic_roughness_texture = g_TextureManager.LoadTexture(ToWideString(texmetallicroughness));
+					material.metallic_roughness_texture = LoadMaterialTexture(texmetallicroughness, TexturePlaceholder::MetallicRoughness);
 					material.metallic_factor = (Float)pbr_metallic_roughness.metallicFactor;
 					material.roughness_factor = (Float)pbr_metallic_roughness.roughnessFactor;
 				}
@@ -422,14 +564,14 @@ namespace adria
 					tinygltf::Texture const& normal_texture = model.textures[gltf_material.normalTexture.index];
 					tinygltf::Image const& normal_image = model.images[normal_texture.source];
 					std::string texnormal = params.textures_path + normal_image.uri;
-					material.normal_texture = g_TextureManager.LoadTexture(ToWideString(texnormal));
+					material.normal_texture = LoadMaterialTexture(texnormal, TexturePlaceholder::FlatNormal);
 				}
 				if (gltf_material.emissiveTexture.index >= 0)
 				{
 					tinygltf::Texture const& emissive_texture = model.textures[gltf_material.emissiveTexture.index];
 					tinygltf::Image const& emissive_image = model.images[emissive_texture.source];
 					std::string texemissive = params.textures_path + emissive_image.uri;
-					material.emissive_texture = g_TextureManager.LoadTexture(ToWideString(texemissive));
+					material.emissive_texture = LoadMaterialTexture(texemissive, TexturePlaceholder::Black);
 					material.emissive_factor = (Float)gltf_material.emissiveFactor[0];
 				}
 				material.shader = ShaderProgram::GBufferPBR;
@@ -450,14 +592,17 @@ namespace adria
 					material.alpha_mode = MaterialAlphaMode::Mask;
 					material.shader = ShaderProgram::GBufferPBR_Mask;
 				}
+				if (params.compress_vertices)
+				{
+					material.shader = material.shader == ShaderProgram::GBufferPBR ? ShaderProgram::GBufferPBR_Compressed : ShaderProgram::GBufferPBR_Mask_Compressed;
+				}
 
 				reg.emplace<Material>(e, material);
 				reg.emplace<Deferred>(e);
 
-				Mesh mesh_component{};
-				mesh_component.indices_count = static_cast<Uint32>(index_accessor.count);
-				mesh_component.start_index_location = static_cast<Uint32>(indices.size());
-				mesh_component.base_vertex_location = static_cast<Uint32>(vertices.size());
+				PrimitiveGeometry& geometry = primitives.emplace_back();
+				geometry.e = e;
+				Mesh& mesh_component = geometry.mesh;
 				switch (primitive.mode)
 				{
 				case TINYGLTF_MODE_POINTS:
@@ -484,36 +629,34 @@ namespace adria
 				tinygltf::Buffer const& buffer = model.buffers[bufferView.buffer];
 
 				int stride = accessor.ByteStride(bufferView);
-				Uint32 vertex_offset = mesh_component.base_vertex_location;
-				Uint32 index_count = mesh_component.indices_count;
-				Uint32 index_offset = mesh_component.start_index_location;
-				indices.reserve(indices.size() + index_count);
+				Uint32 index_count = static_cast<Uint32>(index_accessor.count);
+				geometry.indices.reserve(index_count);
 				unsigned char const* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
 				if (stride == 1)
 				{
 					for (size_t i = 0; i < index_count; i += 3)
 					{
-						indices.push_back(data[i + 0]);
-						indices.push_back(data[i + 1]);
-						indices.push_back(data[i + 2]);
+						geometry.indices.push_back(data[i + 0]);
+						geometry.indices.push_back(data[i + 1]);
+						geometry.indices.push_back(data[i + 2]);
 					}
 				}
 				else if (stride == 2)
 				{
 					for (size_t i = 0; i < index_count; i += 3)
 					{
-						indices.push_back(((Uint16*)data)[i + 0]);
-						indices.push_back(((Uint16*)data)[i + 1]);
-						indices.push_back(((Uint16*)data)[i + 2]);
+						geometry.indices.push_back(((Uint16*)data)[i + 0]);
+						geometry.indices.push_back(((Uint16*)data)[i + 1]);
+						geometry.indices.push_back(((Uint16*)data)[i + 2]);
 					}
 				}
 				else if (stride == 4)
 				{
 					for (size_t i = 0; i < index_count; i += 3)
 					{
-						indices.push_back(((Uint32*)data)[i + 0]);
-						indices.push_back(((Uint32*)data)[i + 1]);
-						indices.push_back(((Uint32*)data)[i + 2]);
+						geometry.indices.push_back(((Uint32*)data)[i + 0]);
+						geometry.indices.push_back(((Uint32*)data)[i + 1]);
+						geometry.indices.push_back(((Uint32*)data)[i + 2]);
 					}
 				}
 				else ADRIA_ASSERT(false);
@@ -609,8 +752,6 @@ namespace adria
 				if (tangents.size() != vertex_count) tangents.resize(vertex_count);
 				if (bitangents.size() != vertex_count) bitangents.resize(vertex_count);
 
-				mesh_component.vertex_count = (Uint32)vertex_count;
-				reg.emplace<Mesh>(e, mesh_component);
 				if (has_tangents)
 				{
 					for (Uint64 i = 0; i < vertex_count; ++i)
@@ -627,10 +768,10 @@ namespace adria
 					//	tangents.data(), bitangents.data());
 				}
 
-				vertices.reserve(vertices.size() + vertex_count);
+				geometry.vertices.reserve(vertex_count);
 				for (Uint64 i = 0; i < vertex_count; ++i)
 				{
-					vertices.emplace_back(
+					geometry.vertices.emplace_back(
 						positions[i],
 						uvs[i],
 						normals[i],
@@ -641,6 +782,35 @@ namespace adria
 			}
 		}
 
+		g_JobSystem.ParallelFor(static_cast<Uint32>(primitives.size()), 1, [&](Uint32 i)
+			{
+				PrimitiveGeometry& geometry = primitives[i];
+				if (geometry.mesh.topology == GfxPrimitiveTopology::TriangleList) geometry.stats = OptimizeMesh(geometry.vertices, geometry.indices);
+				//all primitives share one vertex buffer so either all or none get compressed
+				if (params.compress_vertices)
+				{
+					VertexQuantization const quantization = ComputeVertexQuantization(geometry.vertices.data(), geometry.vertices.size());
+					geometry.compressed_vertices.resize(geometry.vertices.size());
+					geometry.compression = CompressVertices(geometry.vertices.data(), geometry.vertices.size(), quantization, geometry.compressed_vertices.data());
+					geometry.mesh.quantization = quantization;
+				}
+			});
+		for (Uint64 i = 0; i < primitives.size(); ++i)
+		{
+			PrimitiveGeometry& geometry = primitives[i];
+			geometry.mesh.indices_count = static_cast<Uint32>(geometry.indices.size());
+			geometry.mesh.start_index_location = static_cast<Uint32>(indices.size());
+			geometry.mesh.base_vertex_location = static_cast<Uint32>(vertices.size());
+			geometry.mesh.vertex_count = static_cast<Uint32>(geometry.vertices.size());
+			indices.insert(indices.end(), geometry.indices.begin(), geometry.indices.end());
+			vertices.insert(vertices.end(), geometry.vertices.begin(), geometry.vertices.end());
+			compressed_vertices.insert(compressed_vertices.end(), geometry.compressed_vertices.begin(), geometry.compressed_vertices.end());
+			reg.emplace<Mesh>(geometry.e, geometry.mesh);
+			if (geometry.stats) LogMeshOptimizationStats(model_name + " submesh" + std::to_string(i), *geometry.stats);
+			if (geometry.compression) LogVertexCompressionReport(model_name + " submesh" + std::to_string(i), *geometry.compression);
+		}
+		primitives.clear();
+
 		std::function<void(int, Matrix const&)> LoadNode;
 		LoadNode = [&](int node_index, Matrix const& parent_transform)
 			{
@@ -727,20 +897,20 @@ namespace adria
 			LoadNode(scene.nodes[i], params.model_matrix);
 		}
 
-		std::shared_ptr<GfxBuffer> vb = std::make_shared<GfxBuffer>(gfx, VertexBufferDesc(vertices.size(), sizeof(CompleteVertex)), vertices.data());
+		if (params.compress_vertices)
+		{
+			ADRIA_LOG(INFO, "GLTF Mesh %s vertex memory %.1f KB -> %.1f KB", model_name.c_str(),
+				vertices.size() * sizeof(CompleteVertex) / 1024.0, compressed_vertices.size() * sizeof(CompressedVertex) / 1024.0);
+		}
+		//the full vertices are still needed above for the bounding boxes
+		std::shared_ptr<GfxBuffer> vb = params.compress_vertices ?
+			std::make_shared<GfxBuffer>(gfx, VertexBufferDesc(compressed_vertices.size(), sizeof(CompressedVertex)), compressed_vertices.data()) :
+			std::make_shared<GfxBuffer>(gfx, VertexBufferDesc(vertices.size(), sizeof(CompleteVertex)), vertices.data());
 		std::shared_ptr<GfxBuffer> ib = std::make_shared<GfxBuffer>(gfx, IndexBufferDesc(indices.size(), false), indices.data());
 
 		entity root = reg.create();
 		reg.emplace<Transform>(root);
 		reg.emplace<Tag>(root, model_name);
-		Relationship relationship;
-		relationship.children_count = (Uint32)entities.size();
-		ADRIA_ASSERT(relationship.children_count <= Relationship::MAX_CHILDREN);
-		for (size_t i = 0; i < relationship.children_count; ++i)
-		{
-			relationship.children[i] = entities[i];
-		}
-		reg.add<Relationship>(root, relationship);
 
 		size_t i = 0;
 		for (entity e : entities)
@@ -749,10 +919,151 @@ namespace adria
 			mesh.vertex_buffer = vb;
 			mesh.index_buffer = ib;
 			reg.emplace<Tag>(e, model_name + " submesh" + std::to_string(i++));
-			reg.emplace<Relationship>(e, root);
 		}
+		//children are prepended, attach in reverse to keep the submesh order
+		for (auto it = entities.rbegin(); it != entities.rend(); ++it) AttachChild(reg, root, *it);
 		
 		ADRIA_LOG(INFO, "GLTF Mesh %s successfully loaded!", params.model_path.c_str());
+		LogHierarchyMemoryReport(reg);
+
+		if (params.bake)
+		{
+			AdriaTimer bake_timer;
+			BakedModelDesc desc = MakeBakedModelDesc(reg, model_name, entities, texture_paths);
+			desc.key = BakedModelKey(params);
+			desc.source_paths.push_back(params.model_path);
+			for (tinygltf::Buffer const& buffer : model.buffers)
+			{
+				//embedded buffers are part of the glTF file
+				if (!buffer.uri.empty() && !buffer.uri.starts_with("data:")) desc.source_paths.push_back(GetParentPath(params.model_path) + "/" + buffer.uri);
+			}
+			if (params.compress_vertices)
+			{
+				desc.vertices = compressed_vertices.data();
+				desc.vertex_count = compressed_vertices.size();
+				desc.vertex_stride = sizeof(CompressedVertex);
+			}
+			else
+			{
+				desc.vertices = vertices.data();
+				desc.vertex_count = vertices.size();
+				desc.vertex_stride = sizeof(CompleteVertex);
+			}
+			desc.indices = indices.data();
+			desc.index_count = indices.size();
+
+			std::string const baked_path = BakedModelPath(params);
+			if (WriteBakedModel(baked_path, desc))
+			{
+				ADRIA_LOG(INFO, "GLTF Mesh %s baked to %s in %.3f s", model_name.c_str(), baked_path.c_str(), bake_timer.ElapsedInSeconds());
+			}
+			else ADRIA_LOG(WARNING, "Failed to bake GLTF Mesh %s to %s", model_name.c_str(), baked_path.c_str());
+		}
+		return entities;
+	}
+
+	std::vector<entity> ModelImporter::LoadModel_Baked(ModelParameters const& params)
+	{
+		AdriaCpuProfileScope("ModelImporter::LoadModel_Baked");
+		std::string const baked_path = BakedModelPath(params);
+		if (!FileExists(baked_path)) return {};
+		BakedModelFile file(baked_path);
+		if (!file.IsValid())
+		{
+			ADRIA_LOG(WARNING, "Baked model %s is invalid and will be ignored", baked_path.c_str());
+			return {};
+		}
+		BakedModelHeader const& header = file.Header();
+		if (header.key != BakedModelKey(params) || file.IsStale())
+		{
+			ADRIA_LOG(INFO, "Baked model %s is stale", baked_path.c_str());
+			return {};
+		}
+
+		//both buffers are created straight from the mapped file
+		std::shared_ptr<GfxBuffer> vb = std::make_shared<GfxBuffer>(gfx, VertexBufferDesc(file.VertexCount(), header.vertex_stride), file.Vertices());
+		std::shared_ptr<GfxBuffer> ib = std::make_shared<GfxBuffer>(gfx, IndexBufferDesc(file.IndexCount(), false), file.Indices());
+
+		std::span<BakedTexture const> baked_textures = file.Textures();
+		std::vector<TextureHandle> textures(baked_textures.size(), INVALID_TEXTURE_HANDLE);
+		auto GetTexture = [&](Int32 index, TexturePlaceholder placeholder) -> TextureHandle
+		{
+			if (index == BAKED_NONE) return INVALID_TEXTURE_HANDLE;
+			TextureHandle& handle = textures[index];
+			if (handle != INVALID_TEXTURE_HANDLE) return handle;
+
+			BakedTexture const& baked_texture = baked_textures[index];
+			std::wstring name = ToWideString(std::string(file.String(baked_texture.name)));
+			//textures that failed to decode while baking are loaded like imported ones
+			handle = baked_texture.mip_count > 0 ? g_TextureManager.LoadTexture(name, file.Texture(baked_texture)) : g_TextureManager.LoadTexture(name, placeholder);
+			return handle;
+		};
+
+		std::span<BakedMaterial const> materials = file.Materials();
+		std::span<BakedNode const> nodes = file.Nodes();
+		std::vector<entity> node_entities(nodes.size());
+		std::vector<entity> entities;
+		for (Uint64 i = 0; i < nodes.size(); ++i)
+		{
+			BakedNode const& node = nodes[i];
+			entity e = reg.create();
+			node_entities[i] = e;
+			if (node.flags & BakedNodeFlag_Mesh)
+			{
+				Mesh mesh{};
+				mesh.vertex_buffer = vb;
+				mesh.index_buffer = ib;
+				mesh.topology = static_cast<GfxPrimitiveTopology>(node.topology);
+				mesh.indices_count = node.indices_count;
+				mesh.start_index_location = node.start_index_location;
+				mesh.base_vertex_location = node.base_vertex_location;
+				mesh.vertex_count = node.vertex_count;
+				if (node.flags & BakedNodeFlag_Quantized)
+				{
+					mesh.quantization = VertexQuantization{ .position_offset = node.position_offset, .position_scale = node.position_scale };
+				}
+				reg.emplace<Mesh>(e, mesh);
+				entities.push_back(e);
+			}
+			if (node.material != BAKED_NONE)
+			{
+				BakedMaterial const& baked_material = materials[node.material];
+				Material material{};
+				material.albedo_texture = GetTexture(baked_material.textures[BakedTextureSlot_Albedo], TexturePlaceholder::White);
+				material.normal_texture = GetTexture(baked_material.textures[BakedTextureSlot_Normal], TexturePlaceholder::FlatNormal);
+				material.metallic_roughness_texture = GetTexture(baked_material.textures[BakedTextureSlot_MetallicRoughness], TexturePlaceholder::MetallicRoughness);
+				material.emissive_texture = GetTexture(baked_material.textures[BakedTextureSlot_Emissive], TexturePlaceholder::Black);
+				material.albedo_factor = baked_material.albedo_factor;
+				material.metallic_factor = baked_material.metallic_factor;
+				material.roughness_factor = baked_material.roughness_factor;
+				material.emissive_factor = baked_material.emissive_factor;
+				material.alpha_cutoff = baked_material.alpha_cutoff;
+				material.alpha_mode = static_cast<MaterialAlphaMode>(baked_material.alpha_mode);
+				material.double_sided = baked_material.double_sided != 0;
+				material.shader = static_cast<ShaderProgram>(baked_material.shader);
+				reg.emplace<Material>(e, material);
+				reg.emplace<Deferred>(e);
+			}
+			if (node.flags & BakedNodeFlag_Transform) reg.emplace<Transform>(e, node.transform, node.transform);
+			if (node.flags & BakedNodeFlag_AABB)
+			{
+				AABB aabb{};
+				aabb.bounding_box = BoundingBox(node.aabb_center, node.aabb_extents);
+				aabb.light_visible = true;
+				aabb.camera_visible = true;
+				aabb.UpdateBuffer(gfx);
+				reg.emplace<AABB>(e, aabb);
+			}
+			reg.emplace<Tag>(e, std::string(file.String(node.name)));
+		}
+		//children are prepended, attach in reverse to keep the node order
+		for (Uint64 i = nodes.size(); i-- > 0;)
+		{
+			if (nodes[i].parent != BAKED_NONE) AttachChild(reg, node_entities[nodes[i].parent], node_entities[i]);
+		}
+
+		ADRIA_LOG(INFO, "Baked GLTF Mesh %s successfully loaded!", baked_path.c_str());
+		LogHierarchyMemoryReport(reg);
 		return entities;
 	}
     entity ModelImporter::LoadSkybox(SkyboxParameters const& params)
@@ -918,7 +1229,7 @@ namespace adria
         {
             reg.emplace<Material>(ocean_chunk, ocean_material);
             reg.emplace<Ocean>(ocean_chunk, ocean_component);
-            reg.emplace<Tag>(ocean_chunk, "Ocean Chunk" + std::to_string(as_integer(ocean_chunk)));
+            reg.emplace<Tag>(ocean_chunk, "Ocean Chunk" + std::to_string(get_index(ocean_chunk)));
         }
 
         return ocean_chunks;
@@ -949,7 +1260,7 @@ namespace adria
 		for (auto terrain_chunk : terrain_chunks)
 		{
 			reg.emplace<TerrainComponent>(terrain_chunk, terrain_component);
-			reg.emplace<Tag>(terrain_chunk, "Terrain Chunk" + std::to_string(as_integer(terrain_chunk)));
+			reg.emplace<Tag>(terrain_chunk, "Terrain Chunk" + std::to_string(get_index(terrain_chunk)));
 		}
 
 		return terrain_chunks;
@@ -1142,7 +1453,7 @@ namespace adria
 	{
         Decal decal{};
         if(!params.albedo_texture_path.empty()) decal.albedo_decal_texture = g_TextureManager.LoadTexture(params.albedo_texture_path);
-        if(!params.normal_texture_path.empty()) decal.normal_decal_texture = g_TextureManager.LoadTexture(params.normal_texture_path);
+        if(!params.normal_texture_path.empty()) decal.normal_decal_texture = g_TextureManager.LoadTexture(params.normal_texture_path, TexturePlaceholder::FlatNormal);
 
 		Vector3 P = params.position;
 		Vector3 N = params.normal;
@@ -42,6 +42,9 @@ namespace adria
         std::string model_path = "";
         std::string textures_path = "";
         Matrix model_matrix = Matrix::Identity;
+        Bool compress_vertices = false; //CompressedVertex instead of CompleteVertex, see Math/VertexCompression.h
+        Bool bake = false; //write a baked model package after importing, see BakedModel.h
+        std::string baked_dir = ""; //where packages are written and looked up, paths::BakedDir if empty
 	};
     struct SkyboxParameters
     {
@@ -157,6 +160,8 @@ namespace adria
         ModelImporter(tecs::registry& reg, GfxDevice* gfx);
 
         [[maybe_unused]] std::vector<tecs::entity> ImportModel_GLTF(ModelParameters const&);
+        //loads the package baked for these parameters, returns no entities if there is none or it is stale
+        [[maybe_unused]] std::vector<tecs::entity> LoadModel_Baked(ModelParameters const&);
 
         [[maybe_unused]] tecs::entity LoadSkybox(SkyboxParameters const&);
         [[maybe_unused]] tecs::entity LoadLight(LightParameters const&);
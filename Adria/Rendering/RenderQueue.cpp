@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstring>
+#include "RenderQueue.h"
+#include "Components.h"
+#include "Utilities/HashUtil.h"
+
+namespace adria
+{
+
+	Uint64 RenderQueue::MaterialKeyHash::operator()(MaterialKey const& key) const
+	{
+		size_t seed = 0;
+		for (Uint64 texture : key.textures) HashCombine(seed, texture);
+		for (Float factor : key.factors) HashCombine(seed, factor);
+		return seed;
+	}
+
+	void RenderQueue::Begin(Float _depth_range)
+	{
+		depth_range = std::max(_depth_range, 1e-4f);
+		items.clear();
+		entries.clear();
+		//emptying the material table is a new frame number, unless the number wraps around
+		material_count = 0;
+		if (++material_frame == 0)
+		{
+			for (MaterialSlot& slot : material_slots) slot.frame = 0;
+			material_frame = 1;
+		}
+	}
+
+	Uint32 RenderQueue::GetMaterialId(Material const& material)
+	{
+		MaterialKey key{};
+		key.textures[0] = material.albedo_texture;
+		key.textures[1] = material.normal_texture;
+		key.textures[2] = material.metallic_roughness_texture;
+		key.textures[3] = material.emissive_texture;
+		key.factors[0] = material.albedo_factor;
+		key.factors[1] = material.metallic_factor;
+		key.factors[2] = material.roughness_factor;
+		key.factors[3] = material.emissive_factor;
+		key.factors[4] = material.alpha_cutoff;
+
+		//at most half full, so probes stay short and always end at an empty slot
+		if ((material_count + 1) * 2 > material_slots.size()) GrowMaterialSlots();
+		MaterialSlot& slot = FindMaterialSlot(key);
+		if (slot.frame != material_frame)
+		{
+			slot.key = key;
+			slot.id = material_count++;
+			slot.frame = material_frame;
+		}
+		ADRIA_ASSERT(slot.id < (1u << MATERIAL_BITS));
+		return slot.id;
+	}
+
+	void RenderQueue::Push(RenderQueuePass pass, RenderQueueItem const& item)
+	{
+		entries.push_back(SortEntry{ .key = EncodeKey(pass, item), .item = static_cast<Uint32>(items.size()) });
+		items.push_back(item);
+	}
+
+	void RenderQueue::Sort()
+	{
+		RadixSort();
+	}
+
+	Uint64 RenderQueue::EncodeKey(RenderQueuePass pass, RenderQueueItem const& item) const
+	{
+		Float const normalized_depth = std::clamp(item.depth / depth_range, 0.0f, 1.0f);
+		Uint64 const depth = static_cast<Uint64>(normalized_depth * Float((1u << DEPTH_BITS) - 1));
+
+		Uint64 key = 0;
+		key |= (static_cast<Uint64>(pass) << PASS_SHIFT) & FieldMask(PASS_SHIFT, PASS_BITS);
+		key |= (static_cast<Uint64>(item.shader_program) << SHADER_PROGRAM_SHIFT) & FieldMask(SHADER_PROGRAM_SHIFT, SHADER_PROGRAM_BITS);
+		key |= (static_cast<Uint64>(item.double_sided) << RASTER_STATE_SHIFT) & FieldMask(RASTER_STATE_SHIFT, RASTER_STATE_BITS);
+		key |= (static_cast<Uint64>(item.material_id) << MATERIAL_SHIFT) & FieldMask(MATERIAL_SHIFT, MATERIAL_BITS);
+		key |= (depth << DEPTH_SHIFT) & FieldMask(DEPTH_SHIFT, DEPTH_BITS);
+		return key;
+	}
+
+	RenderQueue::MaterialSlot& RenderQueue::FindMaterialSlot(MaterialKey const& key)
+	{
+		Uint64 const mask = material_slots.size() - 1;
+		for (Uint64 i = MaterialKeyHash{}(key) & mask;; i = (i + 1) & mask)
+		{
+			MaterialSlot& slot = material_slots[i];
+			if (slot.frame != material_frame || slot.key == key) return slot;
+		}
+	}
+
+	void RenderQueue::GrowMaterialSlots()
+	{
+		std::vector<MaterialSlot> old_slots(std::max(material_slots.size() * 2, MIN_MATERIAL_SLOTS));
+		old_slots.swap(material_slots);
+		for (MaterialSlot const& old_slot : old_slots)
+		{
+			if (old_slot.frame == material_frame) FindMaterialSlot(old_slot.key) = old_slot;
+		}
+	}
+
+	//LSD radix sort on 8 bit digits, digits that are equal for every key are skipped
+	void RenderQueue::RadixSort()
+	{
+		Uint64 const count = entries.size();
+		if (count < 2) return;
+		scratch.resize(count);
+
+		Uint32 histograms[8][256];
+		std::memset(histograms, 0, sizeof(histograms));
+		for (SortEntry const& entry : entries)
+		{
+			for (Uint32 digit = 0; digit < 8; ++digit) ++histograms[digit][(entry.key >> (digit * 8)) & 0xff];
+		}
+
+		SortEntry* src = entries.data();
+		SortEntry* dst = scratch.data();
+		for (Uint32 digit = 0; digit < 8; ++digit)
+		{
+			Uint32* histogram = histograms[digit];
+			Uint32 const first_bucket = (src[0].key >> (digit * 8)) & 0xff;
+			if (histogram[first_bucket] == count) continue;
+
+			Uint32 offset = 0;
+			for (Uint32 bucket = 0; bucket < 256; ++bucket)
+			{
+				Uint32 const bucket_count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucket_count;
+			}
+			for (Uint64 i = 0; i < count; ++i)
+			{
+				Uint32 const bucket = (src[i].key >> (digit * 8)) & 0xff;
+				dst[histogram[bucket]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+		if (src != entries.data()) std::memcpy(entries.data(), src, count * sizeof(SortEntry));
+	}
+}
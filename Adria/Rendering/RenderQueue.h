@@ -0,0 +1,169 @@
+#pragma once
+#include <vector>
+#include "Enums.h"
+#include "tecs/entity.h"
+
+namespace adria
+{
+	struct Material;
+
+	enum RenderQueuePass : Uint8
+	{
+		RenderQueuePass_GBuffer,
+		RenderQueuePass_Count
+	};
+
+	enum RenderQueueStateChange : Uint8
+	{
+		RenderQueueStateChange_None = 0x0,
+		RenderQueueStateChange_ShaderProgram = 0x1,
+		RenderQueueStateChange_RasterState = 0x2,
+		RenderQueueStateChange_Material = 0x4
+	};
+
+	struct RenderQueueItem
+	{
+		tecs::entity entity;
+		ShaderProgram shader_program;
+		Bool double_sided;
+		Uint32 material_id;
+		Float depth;
+	};
+
+	//binds and cbuffer updates are counted against submitting every draw with full state
+	struct RenderQueueStats
+	{
+		Uint32 draws = 0;
+		Uint32 shader_program_binds = 0;
+		Uint32 raster_state_binds = 0;
+		Uint32 material_binds = 0;
+		Uint32 cbuffer_updates = 0;
+
+		Uint32 binds_saved = 0;
+		Uint32 cbuffer_updates_saved = 0;
+	};
+
+	//Encodes pass, shader program, raster state, material and depth into 64-bit keys and radix sorts them.
+	//Submission reports only the state that differs from the previously submitted item.
+	class RenderQueue
+	{
+		static constexpr Uint32 PASS_BITS = 4;
+		static constexpr Uint32 SHADER_PROGRAM_BITS = 8;
+		static constexpr Uint32 RASTER_STATE_BITS = 2;
+		static constexpr Uint32 MATERIAL_BITS = 24;
+		static constexpr Uint32 DEPTH_BITS = 24;
+
+		static constexpr Uint32 DEPTH_SHIFT = 0;
+		static constexpr Uint32 MATERIAL_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+		static constexpr Uint32 RASTER_STATE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+		static constexpr Uint32 SHADER_PROGRAM_SHIFT = RASTER_STATE_SHIFT + RASTER_STATE_BITS;
+		static constexpr Uint32 PASS_SHIFT = SHADER_PROGRAM_SHIFT + SHADER_PROGRAM_BITS;
+		static_assert(PASS_SHIFT + PASS_BITS <= 64);
+		static_assert(RenderQueuePass_Count <= (1u << PASS_BITS));
+		//Unknown is the last program, a program past the field would be masked into the key of another one
+		static_assert(static_cast<Uint32>(ShaderProgram::Unknown) < (1u << SHADER_PROGRAM_BITS));
+
+		struct SortEntry
+		{
+			Uint64 key;
+			Uint32 item;
+		};
+
+		struct MaterialKey
+		{
+			Uint64 textures[4];
+			Float factors[5];
+			Bool operator==(MaterialKey const&) const = default;
+		};
+		struct MaterialKeyHash
+		{
+			Uint64 operator()(MaterialKey const& key) const;
+		};
+		//slots of an open addressing table kept over frames, a slot is empty unless it was filled in the current frame
+		struct MaterialSlot
+		{
+			MaterialKey key;
+			Uint32 id;
+			Uint32 frame = 0;
+		};
+		static constexpr Uint64 MIN_MATERIAL_SLOTS = 256;
+
+	public:
+		RenderQueue() = default;
+
+		void Begin(Float depth_range);
+
+		//materials with identical textures and factors share an id for the current frame
+		Uint32 GetMaterialId(Material const& material);
+		void Push(RenderQueuePass pass, RenderQueueItem const& item);
+		void Sort();
+
+		//f(RenderQueueItem const&, Uint8 state_changes) for every item of the pass, in key order
+		template<typename F>
+		void Submit(RenderQueuePass pass, F&& f)
+		{
+			RenderQueueStats& pass_stats = stats[pass];
+			pass_stats = {};
+
+			Uint64 previous_key = 0;
+			Bool first = true;
+			for (SortEntry const& entry : entries)
+			{
+				if (GetPass(entry.key) != pass) continue;
+
+				Uint8 changes = RenderQueueStateChange_None;
+				Uint64 const state_diff = first ? ~0ull : (entry.key ^ previous_key);
+				if (state_diff & FieldMask(SHADER_PROGRAM_SHIFT, SHADER_PROGRAM_BITS)) changes |= RenderQueueStateChange_ShaderProgram;
+				if (state_diff & FieldMask(RASTER_STATE_SHIFT, RASTER_STATE_BITS))	   changes |= RenderQueueStateChange_RasterState;
+				if (state_diff & FieldMask(MATERIAL_SHIFT, MATERIAL_BITS))			   changes |= RenderQueueStateChange_Material;
+				first = false;
+				previous_key = entry.key;
+
+				f(items[entry.item], changes);
+				RecordStats(pass_stats, changes);
+			}
+			pass_stats.binds_saved = 3 * pass_stats.draws - (pass_stats.shader_program_binds + pass_stats.raster_state_binds + pass_stats.material_binds);
+			pass_stats.cbuffer_updates_saved = 2 * pass_stats.draws - pass_stats.cbuffer_updates;
+		}
+
+		RenderQueueStats const& GetStats(RenderQueuePass pass) const { return stats[pass]; }
+		Uint64 Size() const { return entries.size(); }
+
+	private:
+		std::vector<RenderQueueItem> items;
+		std::vector<SortEntry> entries;
+		std::vector<SortEntry> scratch;
+		std::vector<MaterialSlot> material_slots;
+		Uint32 material_count = 0;
+		Uint32 material_frame = 1;
+		Float depth_range = 1.0f;
+		RenderQueueStats stats[RenderQueuePass_Count];
+
+	private:
+		Uint64 EncodeKey(RenderQueuePass pass, RenderQueueItem const& item) const;
+		void RadixSort();
+		MaterialSlot& FindMaterialSlot(MaterialKey const& key);
+		void GrowMaterialSlots();
+
+		static constexpr Uint64 FieldMask(Uint32 shift, Uint32 bits)
+		{
+			return ((1ull << bits) - 1) << shift;
+		}
+		static constexpr RenderQueuePass GetPass(Uint64 key)
+		{
+			return static_cast<RenderQueuePass>((key >> PASS_SHIFT) & ((1ull << PASS_BITS) - 1));
+		}
+		static void RecordStats(RenderQueueStats& pass_stats, Uint8 changes)
+		{
+			++pass_stats.draws;
+			++pass_stats.cbuffer_updates;
+			if (changes & RenderQueueStateChange_ShaderProgram) ++pass_stats.shader_program_binds;
+			if (changes & RenderQueueStateChange_RasterState) ++pass_stats.raster_state_binds;
+			if (changes & RenderQueueStateChange_Material)
+			{
+				++pass_stats.material_binds;
+				++pass_stats.cbuffer_updates;
+			}
+		}
+	};
+}
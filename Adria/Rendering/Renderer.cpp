@@ -6,6 +6,7 @@
 #include "SkyModel.h"
 #include "Core/Logger.h"
 #include "Core/Paths.h"
+#include "Core/CpuProfiler.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxCommandContext.h"
 #include "Graphics/GfxStates.h"
@@ -14,6 +15,8 @@
 #include "Math/Halton.h"
 #include "Utilities/Random.h"
 #include "Utilities/StringUtil.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/FrameArena.h"
 #include "DDSTextureLoader.h"
 
 using namespace DirectX;
@@ -28,6 +31,7 @@ namespace adria
 		constexpr Uint32 SHADOW_CUBE_SIZE = 512;
 		constexpr Uint32 SHADOW_CASCADE_SIZE = 2048;
 		constexpr Uint32 CASCADE_COUNT = 4;
+		constexpr Uint32 CULLING_GRAIN_SIZE = 256;
 
 		std::pair<Matrix, Matrix> LightViewProjection_Directional(Light const& light, Camera const& camera, BoundingBox& cull_box)
 		{
@@ -277,12 +281,26 @@ namespace adria
 			return gauss;
 		}
 
+		//meshes with CompressedVertex vertices need the dequantization and their own programs
+		void SetObjectQuantization(ObjectCBuffer& object_cbuf_data, Mesh const& mesh)
+		{
+			if (!mesh.quantization) return;
+			object_cbuf_data.position_offset = mesh.quantization->position_offset;
+			object_cbuf_data.position_scale = mesh.quantization->position_scale;
+		}
+		ShaderProgram GetShadowProgram(Mesh const& mesh, Bool transparent)
+		{
+			if (mesh.quantization) return transparent ? ShaderProgram::DepthMap_Transparent_Compressed : ShaderProgram::DepthMap_Compressed;
+			return transparent ? ShaderProgram::DepthMap_Transparent : ShaderProgram::DepthMap;
+		}
 	}
 
 	Renderer::Renderer(registry& reg, GfxDevice* gfx, Uint32 width, Uint32 height)
-		: width(width), height(height), reg(reg), gfx(gfx), particle_renderer(gfx), picker(gfx)
+		: width(width), height(height), reg(reg), gfx(gfx), particle_renderer(gfx), picker(gfx), update_systems(reg), light_table(gfx), cluster_binner(gfx), transform_hierarchy(reg)
 	{
 		g_GfxProfiler.Initialize(gfx);
+		scene_bvh_removed = &reg.on_removed<AABB>();
+		RegisterUpdateSystems();
 		CreateRenderStates();
 		CreateBuffers();
 		CreateSamplers();
@@ -294,16 +312,18 @@ namespace adria
 	Renderer::~Renderer()
 	{
 		for (auto& clouds_texture : clouds_textures) clouds_texture->Release();
+		reg.disconnect(*scene_bvh_removed);
 		g_GfxProfiler.Destroy();
 	}
 
 	void Renderer::Update(Float dt)
 	{
+		AdriaCpuProfileScope("Renderer::Update");
 		current_dt = dt;
+		update_systems.run();
 		UpdateLights();
 		UpdateTerrainData();
 		UpdateVoxelData();
-		CameraFrustumCulling();
 		UpdateCBuffers(dt);
 		UpdateWeather(dt);
 		UpdateOcean(dt);
@@ -315,6 +335,7 @@ namespace adria
 	}
 	void Renderer::Render(RendererSettings const& _settings)
 	{
+		AdriaCpuProfileScope("Renderer::Render");
 		renderer_settings = _settings;
 		if (renderer_settings.ibl && !ibl_textures_generated) CreateIBLTextures();
 
@@ -399,6 +420,7 @@ namespace adria
 		if (current_scene_viewport.scene_viewport_focused)
 		{
 			pick_in_current_frame = true;
+			if (camera) PickEntity();
 		}
 	}
 
@@ -408,8 +430,10 @@ namespace adria
 	}
 	void Renderer::Tick(Camera const* _camera)
 	{
+		AdriaCpuProfileScope("Renderer::Tick");
 		BindGlobals();
 		g_GfxProfiler.NewFrame();
+		cbuffer_ring->NewFrame(gfx->GetCommandContext());
 
 		camera = _camera;
 		frame_cbuf_data.global_ambient = Vector4{ renderer_settings.ambient_color[0], renderer_settings.ambient_color[1], renderer_settings.ambient_color[2], 1.0f };
@@ -460,34 +484,21 @@ namespace adria
 	{
 		return last_picking_data;
 	}
-	std::vector<Timestamp> Renderer::GetProfilerResults()
+	RenderQueueStats const& Renderer::GetRenderQueueStats(RenderQueuePass pass) const
+	{
+		return render_queue.GetStats(pass);
+	}
+	GfxTimingHistory& Renderer::GetGpuTimingHistory()
 	{
-		return g_GfxProfiler.GetProfilingResults();
+		return g_GfxProfiler.GetTimingHistory();
 	}
 
 	void Renderer::LoadTextures()
 	{
-		TextureHandle tex_handle{};
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare0.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare1.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare2.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare3.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare4.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare5.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
-
-		tex_handle = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare6.jpg");
-		lens_flare_textures.push_back(g_TextureManager.GetTextureView(tex_handle));
+		for (Uint32 i = 0; i < lens_flare_handles.size(); ++i)
+		{
+			lens_flare_handles[i] = g_TextureManager.LoadTexture(paths::TexturesDir + "lensflare/flare" + std::to_string(i) + ".jpg");
+		}
 
 		clouds_textures.resize(3);
 
@@ -528,6 +539,16 @@ namespace adria
 		voxel_cbuffer = std::make_unique<GfxConstantBuffer<VoxelCBuffer>>(gfx);
 		terrain_cbuffer = std::make_unique<GfxConstantBuffer<TerrainCBuffer>>(gfx);
 
+		//the constant buffers updated many times per frame go through the upload ring
+		cbuffer_ring = std::make_unique<GfxConstantBufferRing>(gfx, CBUFFER_RING_SIZE);
+		if (cbuffer_ring->IsSupported())
+		{
+			object_cbuffer->SetUploadRing(cbuffer_ring.get());
+			material_cbuffer->SetUploadRing(cbuffer_ring.get());
+			shadow_cbuffer->SetUploadRing(cbuffer_ring.get());
+			light_cbuffer->SetUploadRing(cbuffer_ring.get());
+		}
+
 		GfxBufferDesc bokeh_indirect_draw_buffer_desc{};
 		bokeh_indirect_draw_buffer_desc.size = 4 * sizeof(Uint32);
 		bokeh_indirect_draw_buffer_desc.misc_flags = GfxBufferMiscFlag::IndirectArgs;
@@ -1427,41 +1448,23 @@ namespace adria
 		}
 	}
 
+	void Renderer::RegisterUpdateSystems()
+	{
+		//cpu only systems, everything touching the command context runs afterwards on the main thread
+		update_systems.add("Transforms", access_set{}.read<Relationship>().write<Transform>(), [this]() { UpdateTransforms(); });
+		update_systems.add("Lights", access_set{}.read<Light>(), [this]() { GatherLights(); });
+		update_systems.add("Scene BVH", access_set{}.read<AABB, Light>(), [this]() { UpdateSceneBVH(); });
+		update_systems.add("Frustum Culling", access_set{}.read<Light>().write<AABB>(), [this]() { CameraFrustumCulling(); });
+	}
+	void Renderer::GatherLights()
+	{
+		light_table.Sync(reg);
+		light_table.Transform(camera->View());
+	}
 	void Renderer::UpdateLights()
 	{
-		Uint32 current_light_count = (Uint32)reg.size<Light>();
-		static Uint32 light_count = 0;
-		Bool light_count_changed = current_light_count != light_count;
-		if (light_count_changed)
-		{
-			light_count = current_light_count;
-			if (light_count == 0) return;
-			lights = std::make_unique<GfxBuffer>(gfx, StructuredBufferDesc<LightSBuffer>(light_count, false, true));
-			lights->CreateSRV();
-		}
-
-		std::vector<LightSBuffer> lights_data{};
-
-		auto light_view = reg.view<Light>();
-		for (auto e : light_view)
-		{
-			LightSBuffer light_data{};
-			auto& light = light_view.get(e);
-
-			light_data.color = light.color * light.energy;
-			light_data.position  = Vector4::Transform(light.position, camera->View());
-			light_data.direction = Vector4::Transform(light.direction, camera->View());
-			light_data.range = light.range;
-			light_data.type = static_cast<Int32>(light.type);
-			light_data.inner_cosine = light.inner_cosine;
-			light_data.outer_cosine = light.outer_cosine;
-			light_data.active = light.active;
-			light_data.casts_shadows = light.casts_shadows;
-			
-			lights_data.push_back(light_data);
-		}
-		lights->Update(lights_data.data(), lights_data.size() * sizeof(LightSBuffer));
-
+		AdriaCpuProfileScope("Renderer::UpdateLights");
+		light_table.Upload();
 	}
 	void Renderer::UpdateTerrainData()
 	{
@@ -1497,39 +1500,108 @@ namespace adria
 
 		voxel_cbuffer->Update(gfx->GetCommandContext(), voxel_cbuf_data);
 	}
-	void Renderer::CameraFrustumCulling()
+	void Renderer::UpdateTransforms()
 	{
-		BoundingFrustum camera_frustum = camera->Frustum();
-		auto aabb_view = reg.view<AABB>();
-		for (auto e : aabb_view)
+		AdriaCpuProfileScope("Renderer::UpdateTransforms");
+		transform_hierarchy.Update();
+	}
+	void Renderer::UpdateSceneBVH()
+	{
+		AdriaCpuProfileScope("Renderer::UpdateSceneBVH");
+		for (entity e : *scene_bvh_removed)
 		{
-			auto& aabb = aabb_view.get(e);
-			if (aabb.skip_culling) continue;
-			aabb.camera_visible = camera_frustum.Intersects(aabb.bounding_box) || reg.has<Light>(e); //dont cull lights for now
+			if (auto it = scene_bvh_proxies.find(e); it != scene_bvh_proxies.end())
+			{
+				scene_bvh.Remove(it->second);
+				scene_bvh_proxies.erase(it);
+			}
 		}
+		scene_bvh_removed->clear();
+
+		//new and moved boxes only, code writing bounding boxes through references has to touch the AABB
+		reg.view<AABB>().each_changed(scene_bvh_tick, [&](entity e, AABB& aabb)
+			{
+				Bool const culled = !aabb.skip_culling && !reg.has<Light>(e);
+				auto it = scene_bvh_proxies.find(e);
+				if (it == scene_bvh_proxies.end())
+				{
+					if (culled) scene_bvh_proxies.emplace(e, scene_bvh.Insert(aabb.bounding_box, static_cast<Uint64>(e)));
+				}
+				else if (!culled)
+				{
+					scene_bvh.Remove(it->second);
+					scene_bvh_proxies.erase(it);
+				}
+				else scene_bvh.Move(it->second, aabb.bounding_box);
+			});
+		scene_bvh_tick = reg.tick<AABB>();
+	}
+	void Renderer::CameraFrustumCulling()
+	{
+		AdriaCpuProfileScope("Renderer::CameraFrustumCulling");
+		frustum_culler.Gather(reg);
+		frustum_culler.Cull(camera->Frustum(), visible_indices);
+
+		auto aabb_view = reg.view<AABB>();
+		g_JobSystem.ParallelFor(frustum_culler.Size(), CULLING_GRAIN_SIZE, [&](Uint32 i)
+			{
+				AABB& aabb = aabb_view.get(frustum_culler.GetEntity(i));
+				aabb.camera_visible = false;
+				aabb.light_visible = false;
+			});
+		g_JobSystem.ParallelFor((Uint32)visible_indices.size(), CULLING_GRAIN_SIZE, [&](Uint32 i)
+			{
+				aabb_view.get(frustum_culler.GetEntity(visible_indices[i])).camera_visible = true;
+			});
+		light_visible_entities.clear();
 	}
 	void Renderer::LightFrustumCulling(LightType type)
 	{
-		auto visibility_view = reg.view<AABB>();
-		for (auto e : visibility_view)
+		AdriaCpuProfileScope("Renderer::LightFrustumCulling");
+		auto aabb_view = reg.view<AABB>();
+		for (entity e : light_visible_entities) aabb_view.get(e).light_visible = false;
+		light_visible_entities.clear();
+
+		auto AddVisible = [this](Uint64 user_data) { light_visible_entities.push_back(static_cast<entity>(user_data)); };
+		switch (type)
 		{
-			if (reg.has<Light>(e)) continue; 
-			auto& aabb = visibility_view.get(e);
-			if (aabb.skip_culling) continue;
+		case LightType::Directional:
+			scene_bvh.Query(light_bounding_box, AddVisible);
+			break;
+		case LightType::Spot:
+		case LightType::Point:
+			scene_bvh.Query(light_bounding_frustum, AddVisible);
+			break;
+		default:
+			ADRIA_ASSERT(false);
+		}
+		for (entity e : light_visible_entities) aabb_view.get(e).light_visible = true;
+	}
+	void Renderer::PickEntity()
+	{
+		Float const mouse_x = frame_cbuf_data.mouse_normalized_coords_x;
+		Float const mouse_y = frame_cbuf_data.mouse_normalized_coords_y;
+		if (mouse_x < 0.0f || mouse_x > 1.0f || mouse_y < 0.0f || mouse_y > 1.0f) return;
+
+		Vector3 const ndc(2.0f * mouse_x - 1.0f, 1.0f - 2.0f * mouse_y, 0.5f);
+		Vector3 const ray_origin = camera->Position();
+		Vector3 const ray_target = Vector3::Transform(ndc, camera->ViewProj().Invert());
 
-			switch (type)
+		//a box around the camera is only picked when nothing in front of it is hit
+		last_picked_entity = null_entity;
+		entity enclosing_entity = null_entity;
+		Float nearest_distance = camera->Far();
+		scene_bvh.RayCast(ray_origin, ray_target - ray_origin, nearest_distance, [&](Uint64 user_data, Float distance)
 			{
-			case LightType::Directional:
-				aabb.light_visible = light_bounding_box.Intersects(aabb.bounding_box);
-				break;
-			case LightType::Spot:
-			case LightType::Point:
-				aabb.light_visible = light_bounding_frustum.Intersects(aabb.bounding_box);
-				break;
-			default:
-				ADRIA_ASSERT(false);
-			}
-		}
+				if (distance > 0.0f)
+				{
+					last_picked_entity = static_cast<entity>(user_data);
+					nearest_distance = distance;
+				}
+				else if (enclosing_entity == null_entity) enclosing_entity = static_cast<entity>(user_data);
+				return nearest_distance;
+			});
+		if (last_picked_entity == null_entity) last_picked_entity = enclosing_entity;
 	}
 
 	void Renderer::PassPicking()
@@ -1547,96 +1619,73 @@ namespace adria
 		AdriaGfxScopedAnnotation(command_context, "GBuffer Pass");
 
 		command_context->UnsetShaderResourcesRO(GfxShaderStage::PS, 0, (Uint32)gbuffer.size() + 1);
-		struct BatchParams
-		{
-			ShaderProgram shader_program;
-			Bool double_sided;
-			auto operator<=>(BatchParams const&) const = default;
-		};
-		std::map<BatchParams, std::vector<entity>> batched_entities;
-
-		auto gbuffer_view = reg.view<Mesh, Transform, Material, Deferred, AABB>();
-		for (auto e : gbuffer_view)
-		{
-			auto [mesh, transform, material, aabb] = gbuffer_view.get<Mesh, Transform, Material, AABB>(e);
-			if (!aabb.camera_visible) continue;
-
-			BatchParams params{};
-			params.double_sided = material.double_sided;
-			params.shader_program = material.alpha_mode == MaterialAlphaMode::Opaque ? ShaderProgram::GBufferPBR : ShaderProgram::GBufferPBR_Mask;
-			batched_entities[params].push_back(e);
-		}
+		auto gbuffer_view = reg.group<Mesh, Transform, Material, Deferred, AABB>();
+		Vector3 const camera_position = camera->Position();
+		Bool const texture_feedback = g_TextureManager.IsStreaming();
+		Float const pixels_per_unit = height / (2.0f * std::tan(camera->Fov() * 0.5f));
+		render_queue.Begin(camera->Far());
+		gbuffer_view.each([&](entity e, Mesh& mesh, Transform&, Material& material, Deferred&, AABB& aabb)
+		{
+			if (!aabb.camera_visible) return;
+
+			RenderQueueItem item{};
+			item.entity = e;
+			item.double_sided = material.double_sided;
+			if (mesh.quantization) item.shader_program = material.alpha_mode == MaterialAlphaMode::Opaque ? ShaderProgram::GBufferPBR_Compressed : ShaderProgram::GBufferPBR_Mask_Compressed;
+			else item.shader_program = material.alpha_mode == MaterialAlphaMode::Opaque ? ShaderProgram::GBufferPBR : ShaderProgram::GBufferPBR_Mask;
+			item.material_id = render_queue.GetMaterialId(material);
+			item.depth = Vector3::Distance(camera_position, Vector3(aabb.bounding_box.Center));
+			render_queue.Push(RenderQueuePass_GBuffer, item);
+
+			//texels needed are approximated by the projected size of the bounding box
+			if (texture_feedback)
+			{
+				Float const diameter = 2.0f * Vector3(aabb.bounding_box.Extents).Length();
+				Uint32 const screen_size = static_cast<Uint32>(diameter * pixels_per_unit / std::max(item.depth, camera->Near()));
+				g_TextureManager.RequestSize(material.albedo_texture, screen_size);
+				g_TextureManager.RequestSize(material.normal_texture, screen_size);
+				g_TextureManager.RequestSize(material.metallic_roughness_texture, screen_size);
+				g_TextureManager.RequestSize(material.emissive_texture, screen_size);
+			}
+		});
+		render_queue.Sort();
 		
 		command_context->BeginRenderPass(gbuffer_pass);
 		{
-			for (auto const& [params, entities] : batched_entities)
+			auto SetMaterialTexture = [&](Uint32 slot, TextureHandle handle)
 			{
-				ShaderManager::GetShaderProgram(params.shader_program)->Bind(command_context);
-				if (params.double_sided) command_context->SetRasterizerState(cull_none.get()); 
-				for (auto e : entities)
-				{
-					auto [mesh, transform, material] = gbuffer_view.get<Mesh, Transform, Material>(e);
+				command_context->SetShaderResourceRO(GfxShaderStage::PS, slot, handle != INVALID_TEXTURE_HANDLE ? g_TextureManager.GetTextureView(handle) : nullptr);
+			};
 
-					Matrix parent_transform = Matrix::Identity;
-					if (Relationship* relationship = reg.get_if<Relationship>(e))
-					{
-						if (auto* root_transform = reg.get_if<Transform>(relationship->parent)) parent_transform = root_transform->current_transform;
-					}
-					
-					object_cbuf_data.model = transform.current_transform * parent_transform;
-					object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
-					object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
+			render_queue.Submit(RenderQueuePass_GBuffer, [&](RenderQueueItem const& item, Uint8 changes)
+			{
+				auto [mesh, transform, material] = gbuffer_view.get<Mesh, Transform, Material>(item.entity);
 
+				if (changes & RenderQueueStateChange_ShaderProgram) ShaderManager::GetShaderProgram(item.shader_program)->Bind(command_context);
+				if (changes & RenderQueueStateChange_RasterState) command_context->SetRasterizerState(item.double_sided ? cull_none.get() : nullptr);
+				if (changes & RenderQueueStateChange_Material)
+				{
 					material_cbuf_data.albedo_factor = material.albedo_factor;
 					material_cbuf_data.metallic_factor = material.metallic_factor;
 					material_cbuf_data.roughness_factor = material.roughness_factor;
 					material_cbuf_data.emissive_factor = material.emissive_factor;
 					material_cbuf_data.alpha_cutoff = material.alpha_cutoff;
-					material_cbuffer->Update(gfx->GetCommandContext(), material_cbuf_data);
-
-					static GfxShaderResourceRO const null_view = nullptr;
-
-					if (material.albedo_texture != INVALID_TEXTURE_HANDLE)
-					{
-						auto view = g_TextureManager.GetTextureView(material.albedo_texture);
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_DIFFUSE, view);
-					}
-
-					if (material.metallic_roughness_texture != INVALID_TEXTURE_HANDLE)
-					{
-						auto view = g_TextureManager.GetTextureView(material.metallic_roughness_texture);
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_ROUGHNESS_METALLIC, view);
-					}
-					else
-					{
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_ROUGHNESS_METALLIC, nullptr);
-					}
+					material_cbuffer->Update(command_context, material_cbuf_data);
 
-					if (material.normal_texture != INVALID_TEXTURE_HANDLE)
-					{
-						auto view = g_TextureManager.GetTextureView(material.normal_texture);
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_NORMAL, view);
-
-					}
-					else
-					{
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_NORMAL, nullptr);
-					}
+					if (material.albedo_texture != INVALID_TEXTURE_HANDLE) SetMaterialTexture(TEXTURE_SLOT_DIFFUSE, material.albedo_texture);
+					SetMaterialTexture(TEXTURE_SLOT_ROUGHNESS_METALLIC, material.metallic_roughness_texture);
+					SetMaterialTexture(TEXTURE_SLOT_NORMAL, material.normal_texture);
+					SetMaterialTexture(TEXTURE_SLOT_EMISSIVE, material.emissive_texture);
+				}
 
-					if (material.emissive_texture != INVALID_TEXTURE_HANDLE)
-					{
-						auto view = g_TextureManager.GetTextureView(material.emissive_texture);
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_EMISSIVE, view);
-					}
-					else
-					{
-						command_context->SetShaderResourceRO(GfxShaderStage::PS, TEXTURE_SLOT_EMISSIVE, nullptr);
-					}
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
+				SetObjectQuantization(object_cbuf_data, mesh);
+				object_cbuffer->Update(command_context, object_cbuf_data);
 
-					mesh.Draw(command_context);
-				}
-				if (params.double_sided) command_context->SetRasterizerState(nullptr);
-			}
+				mesh.Draw(command_context);
+			});
+			command_context->SetRasterizerState(nullptr);
 			
 			auto terrain_view = reg.view<Mesh, Transform, AABB, TerrainComponent>();
 			ShaderManager::GetShaderProgram(ShaderProgram::GBuffer_Terrain)->Bind(command_context);
@@ -1646,8 +1695,8 @@ namespace adria
 
 				if (!aabb.camera_visible) continue;
 
-				object_cbuf_data.model = transform.current_transform;
-				object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert().Transpose();
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform.Transpose();
 				object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 
 				if (terrain.grass_texture != INVALID_TEXTURE_HANDLE)
@@ -1686,8 +1735,8 @@ namespace adria
 				auto [mesh, transform, aabb, material] = foliage_view.get<Mesh, Transform, AABB, Material>(e);
 				if (!aabb.camera_visible) continue;
 
-				object_cbuf_data.model = transform.current_transform;
-				object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert().Transpose();
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform.Transpose();
 				object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 
 				if (material.albedo_texture != INVALID_TEXTURE_HANDLE)
@@ -1936,7 +1985,7 @@ namespace adria
 		shader_views[2] = depth_target->SRV();
 		command_context->SetShaderResourcesRO(GfxShaderStage::CS, 0, shader_views);
 
-		GfxShaderResourceRO lights_srv = lights->SRV();
+		GfxShaderResourceRO lights_srv = light_table.Buffer()->SRV();
 		command_context->SetShaderResourceRO(GfxShaderStage::CS, 3, lights_srv);
 		GfxShaderResourceRW texture_uav = uav_target->UAV();
 		command_context->SetShaderResourceRW(0, texture_uav);
@@ -1973,7 +2022,7 @@ namespace adria
 		command_context->ClearReadWriteDescriptorFloat(debug_uav, black);
 		command_context->ClearReadWriteDescriptorFloat(texture_uav, black);
 
-		std::vector<Light> volumetric_lights{};
+		FrameVector<Light> volumetric_lights(g_FrameArena.Resource());
 
 		auto light_view = reg.view<Light>();
 		for (auto e : light_view)
@@ -2014,32 +2063,44 @@ namespace adria
 		AdriaGfxProfileCondScope(command_context, "Deferred Clustered Lighting Pass", profiling_enabled);
 		AdriaGfxScopedAnnotation(command_context, "Deferred Clustered Lighting Pass");
 
-		if (recreate_clusters)
+		GfxBuffer* cluster_light_list = light_list.get();
+		GfxBuffer* cluster_light_grid = light_grid.get();
+		if (renderer_settings.cpu_light_binning)
 		{
-			GfxShaderResourceRW clusters_uav = clusters->UAV();
-			command_context->SetShaderResourceRW(0, clusters_uav);
-			
-			ShaderManager::GetShaderProgram(ShaderProgram::ClusterBuilding)->Bind(command_context);
-			command_context->Dispatch(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z);
-			ShaderManager::GetShaderProgram(ShaderProgram::ClusterBuilding)->Unbind(command_context);
+			cluster_binner.Bin(*camera, width, height, light_table);
+			cluster_binner.Upload();
+			cluster_light_list = cluster_binner.LightListBuffer();
+			cluster_light_grid = cluster_binner.LightGridBuffer();
+		}
+		else
+		{
+			if (recreate_clusters)
+			{
+				GfxShaderResourceRW clusters_uav = clusters->UAV();
+				command_context->SetShaderResourceRW(0, clusters_uav);
+				
+				ShaderManager::GetShaderProgram(ShaderProgram::ClusterBuilding)->Bind(command_context);
+				command_context->Dispatch(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z);
+				ShaderManager::GetShaderProgram(ShaderProgram::ClusterBuilding)->Unbind(command_context);
 
-			GfxShaderResourceRW null_uav = nullptr;
-			command_context->SetShaderResourceRW(0, nullptr);
+				GfxShaderResourceRW null_uav = nullptr;
+				command_context->SetShaderResourceRW(0, nullptr);
 
-			recreate_clusters = false;
-		}
+				recreate_clusters = false;
+			}
 
-		GfxShaderResourceRO srvs[] = { clusters->SRV(), lights->SRV() };
-		command_context->SetShaderResourcesRO(GfxShaderStage::CS, 0, srvs);
-		GfxShaderResourceRW uavs[] = { light_counter->UAV(), light_list->UAV(), light_grid->UAV() };
-		command_context->SetShaderResourcesRW(0, uavs);
+			GfxShaderResourceRO srvs[] = { clusters->SRV(), light_table.Buffer()->SRV() };
+			command_context->SetShaderResourcesRO(GfxShaderStage::CS, 0, srvs);
+			GfxShaderResourceRW uavs[] = { light_counter->UAV(), light_list->UAV(), light_grid->UAV() };
+			command_context->SetShaderResourcesRW(0, uavs);
 
-		ShaderManager::GetShaderProgram(ShaderProgram::ClusterCulling)->Bind(command_context);
-		command_context->Dispatch(CLUSTER_SIZE_X / 16, CLUSTER_SIZE_Y / 16, CLUSTER_SIZE_Z / 4);
-		ShaderManager::GetShaderProgram(ShaderProgram::ClusterCulling)->Unbind(command_context);
+			ShaderManager::GetShaderProgram(ShaderProgram::ClusterCulling)->Bind(command_context);
+			command_context->Dispatch(CLUSTER_SIZE_X / 16, CLUSTER_SIZE_Y / 16, CLUSTER_SIZE_Z / 4);
+			ShaderManager::GetShaderProgram(ShaderProgram::ClusterCulling)->Unbind(command_context);
 
-		command_context->UnsetShaderResourcesRO(GfxShaderStage::CS, 0, ARRAYSIZE(srvs));
-		command_context->UnsetShaderResourcesRW(0, ARRAYSIZE(uavs));
+			command_context->UnsetShaderResourcesRO(GfxShaderStage::CS, 0, ARRAYSIZE(srvs));
+			command_context->UnsetShaderResourcesRW(0, ARRAYSIZE(uavs));
+		}
 
 		command_context->SetBlendState(additive_blend.get());
 
@@ -2049,9 +2110,9 @@ namespace adria
 			shader_views[0] = gbuffer[GBufferSlot_NormalMetallic]->SRV();
 			shader_views[1] = gbuffer[GBufferSlot_DiffuseRoughness]->SRV();
 			shader_views[2] = depth_target->SRV();
-			shader_views[3] = lights->SRV();
-			shader_views[4] = light_list->SRV();
-			shader_views[5] = light_grid->SRV();
+			shader_views[3] = light_table.Buffer()->SRV();
+			shader_views[4] = cluster_light_list->SRV();
+			shader_views[5] = cluster_light_grid->SRV();
 			command_context->SetShaderResourcesRO(GfxShaderStage::PS, 0, shader_views);
 
 			command_context->SetInputLayout(nullptr);
@@ -2062,7 +2123,7 @@ namespace adria
 			command_context->UnsetShaderResourcesRO(GfxShaderStage::PS, 0, ARRAYSIZE(shader_views));
 
 			//Volumetric lighting for non-shadow casting lights
-			std::vector<Light> volumetric_lights{};
+			FrameVector<Light> volumetric_lights(g_FrameArena.Resource());
 			auto light_view = reg.view<Light>();
 			for (auto e : light_view)
 			{
@@ -2117,7 +2178,7 @@ namespace adria
 		AdriaGfxProfileCondScope(command_context, "Voxelization Pass", profiling_enabled);
 		AdriaGfxScopedAnnotation(command_context, "Voxelization Pass");
 
-		std::vector<LightSBuffer> _lights{};
+		FrameVector<LightSBuffer> _lights(g_FrameArena.Resource());
 		auto light_view = reg.view<Light>();
 		for (auto e : light_view)
 		{
@@ -2138,9 +2199,11 @@ namespace adria
 			if (light.type == LightType::Directional && light.casts_shadows && renderer_settings.voxel_debug)
 				PassShadowMapDirectional(light);
 		}
-		lights->Update(_lights.data(), std::min<Uint64>(_lights.size(), VOXELIZE_MAX_LIGHTS) * sizeof(LightSBuffer));
+		Uint64 const voxelize_light_count = std::min<Uint64>({ _lights.size(), VOXELIZE_MAX_LIGHTS, light_table.Capacity() });
+		light_table.Buffer()->UpdateRange(_lights.data(), 0, voxelize_light_count * sizeof(LightSBuffer));
+		light_table.Invalidate();
 
-		auto voxel_view = reg.view<Mesh, Transform, Material, Deferred, AABB>();
+		auto voxel_view = reg.group<Mesh, Transform, Material, Deferred, AABB>();
 
 		ShaderManager::GetShaderProgram(ShaderProgram::Voxelize)->Bind(command_context);
 		command_context->SetRasterizerState(cull_none.get());
@@ -2149,7 +2212,7 @@ namespace adria
 		GfxShaderResourceRW voxels_uav = voxels->UAV();
 		command_context->GetNative()->OMSetRenderTargetsAndUnorderedAccessViews(0, nullptr, nullptr, 0, 1, &voxels_uav, nullptr);
 
-		GfxShaderResourceRO lights_srv = lights->SRV();
+		GfxShaderResourceRO lights_srv = light_table.Buffer()->SRV();
 		command_context->SetShaderResourceRO(GfxShaderStage::PS, 10, lights_srv);
 
 		for (auto e : voxel_view)
@@ -2158,8 +2221,8 @@ namespace adria
 
 			if (!aabb.camera_visible) continue;
 
-			object_cbuf_data.model = transform.current_transform;
-			object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+			object_cbuf_data.model = transform.world_transform;
+			object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
 			object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 
 			material_cbuf_data.albedo_factor = material.albedo_factor;
@@ -2507,9 +2570,17 @@ namespace adria
 	{
 		GfxCommandContext* command_context = gfx->GetCommandContext();
 		auto shadow_view = reg.view<Mesh, Transform, AABB>();
+		ShaderProgram bound_program = ShaderProgram::Unknown;
+		auto BindShadowProgram = [&](Mesh const& mesh, Bool transparent)
+		{
+			ShaderProgram const program = GetShadowProgram(mesh, transparent);
+			if (program == bound_program) return;
+			ShaderManager::GetShaderProgram(program)->Bind(command_context);
+			bound_program = program;
+		};
+
 		if (!renderer_settings.shadow_transparent)
 		{
-			ShaderManager::GetShaderProgram(ShaderProgram::DepthMap)->Bind(command_context);
 			for (auto e : shadow_view)
 			{
 				auto& aabb = shadow_view.get<AABB>(e);
@@ -2518,14 +2589,10 @@ namespace adria
 					auto const& transform = shadow_view.get<Transform>(e);
 					auto const& mesh = shadow_view.get<Mesh>(e);
 
-					Matrix parent_transform = Matrix::Identity;
-					if (Relationship* relationship = reg.get_if<Relationship>(e))
-					{
-						if (auto* root_transform = reg.get_if<Transform>(relationship->parent)) parent_transform = root_transform->current_transform;
-					}
-
-					object_cbuf_data.model = transform.current_transform * parent_transform;
-					object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+					BindShadowProgram(mesh, false);
+					object_cbuf_data.model = transform.world_transform;
+					object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
+					SetObjectQuantization(object_cbuf_data, mesh);
 					object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 					mesh.Draw(command_context);
 				}
@@ -2533,7 +2600,7 @@ namespace adria
 		}
 		else
 		{
-			std::vector<entity> potentially_transparent, not_transparent;
+			FrameVector<entity> potentially_transparent(g_FrameArena.Resource()), not_transparent(g_FrameArena.Resource());
 			for (auto e : shadow_view)
 			{
 				auto const& aabb = shadow_view.get<AABB>(e);
@@ -2549,25 +2616,19 @@ namespace adria
 				}
 			}
 
-			ShaderManager::GetShaderProgram(ShaderProgram::DepthMap)->Bind(command_context);
 			for (auto e : not_transparent)
 			{
 				auto& transform = shadow_view.get<Transform>(e);
 				auto& mesh = shadow_view.get<Mesh>(e);
 
-				Matrix parent_transform = Matrix::Identity;
-				if (Relationship* relationship = reg.get_if<Relationship>(e))
-				{
-					if (auto* root_transform = reg.get_if<Transform>(relationship->parent)) parent_transform = root_transform->current_transform;
-				}
-
-				object_cbuf_data.model = transform.current_transform * parent_transform;
-				object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+				BindShadowProgram(mesh, false);
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
+				SetObjectQuantization(object_cbuf_data, mesh);
 				object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 				mesh.Draw(command_context);
 			}
 
-			ShaderManager::GetShaderProgram(ShaderProgram::DepthMap_Transparent)->Bind(command_context);
 			for (auto e : potentially_transparent)
 			{
 				auto& transform = shadow_view.get<Transform>(e);
@@ -2576,14 +2637,10 @@ namespace adria
 				ADRIA_ASSERT(material != nullptr);
 				ADRIA_ASSERT(material->albedo_texture != INVALID_TEXTURE_HANDLE);
 
-				Matrix parent_transform = Matrix::Identity;
-				if (Relationship* relationship = reg.get_if<Relationship>(e))
-				{
-					if (auto* root_transform = reg.get_if<Transform>(relationship->parent)) parent_transform = root_transform->current_transform;
-				}
-
-				object_cbuf_data.model = transform.current_transform * parent_transform;
-				object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+				BindShadowProgram(mesh, true);
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
+				SetObjectQuantization(object_cbuf_data, mesh);
 				object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 
 				auto view = g_TextureManager.GetTextureView(material->albedo_texture);
@@ -2712,8 +2769,8 @@ namespace adria
 
 			if (aabb.camera_visible)
 			{
-				object_cbuf_data.model = transform.current_transform;
-				object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+				object_cbuf_data.model = transform.world_transform;
+				object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
 				object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 				
 				material_cbuf_data.diffuse = material.diffuse;
@@ -2802,8 +2859,8 @@ namespace adria
 
 			ShaderManager::GetShaderProgram(material.shader)->Bind(command_context);
 
-			object_cbuf_data.model = transform.current_transform;
-			object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+			object_cbuf_data.model = transform.world_transform;
+			object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
 			object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 				
 			material_cbuf_data.diffuse = material.diffuse;
@@ -2851,6 +2908,8 @@ namespace adria
 		{
 			GfxShaderResourceRO depth_srv_array[1] = { depth_target->SRV() };
 			command_context->SetShaderResourceRO(GfxShaderStage::GS, 7, depth_target->SRV());
+			std::array<GfxShaderResourceRO, LENS_FLARE_TEXTURE_COUNT> lens_flare_textures{};
+			for (Uint32 i = 0; i < lens_flare_textures.size(); ++i) lens_flare_textures[i] = g_TextureManager.GetTextureView(lens_flare_handles[i]);
 			command_context->SetShaderResourcesRO(GfxShaderStage::GS, 0, lens_flare_textures);
 			command_context->SetShaderResourcesRO(GfxShaderStage::PS, 0, lens_flare_textures);
 
@@ -3261,8 +3320,8 @@ namespace adria
 			auto [transform, mesh, material] = reg.get<Transform, Mesh, Material>(sun);
 			ShaderManager::GetShaderProgram(ShaderProgram::Sun)->Bind(command_context);
 
-			object_cbuf_data.model = transform.current_transform;
-			object_cbuf_data.transposed_inverse_model = object_cbuf_data.model.Invert();
+			object_cbuf_data.model = transform.world_transform;
+			object_cbuf_data.transposed_inverse_model = transform.inverse_world_transform;
 			object_cbuffer->Update(gfx->GetCommandContext(), object_cbuf_data);
 			material_cbuf_data.diffuse = material.diffuse;
 			material_cbuf_data.albedo_factor = material.albedo_factor;
@@ -1,17 +1,25 @@
 #pragma once
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include "Picker.h"
 #include "ParticleRenderer.h"
 #include "RendererSettings.h"
 #include "SceneViewport.h"
 #include "ConstantBuffers.h"
 #include "TextureManager.h"
+#include "FrustumCuller.h"
+#include "LightTable.h"
+#include "ClusterBinner.h"
+#include "RenderQueue.h"
+#include "TransformHierarchy.h"
 #include "Graphics/GfxConstantBuffer.h"
 #include "Graphics/GfxRenderPass.h"
 #include "Graphics/GfxProfiler.h"
 #include "Graphics/GfxBuffer.h"
+#include "Math/DynamicBVH.h"
 #include "tecs/Registry.h"
+#include "tecs/scheduler.h"
 
 namespace adria
 {
@@ -25,6 +33,7 @@ namespace adria
 	class Camera;
 	class Input;
 	struct Light;
+	struct Transform;
 	struct RenderState;
 
 	class Renderer
@@ -34,10 +43,12 @@ namespace adria
 		static constexpr Uint32 RESOLUTION = 512;
 		static constexpr Uint32 VOXEL_RESOLUTION = 128;
 		static constexpr Uint32 VOXELIZE_MAX_LIGHTS = 8;
-		static constexpr Uint32 CLUSTER_SIZE_X = 16;
-		static constexpr Uint32 CLUSTER_SIZE_Y = 16;
-		static constexpr Uint32 CLUSTER_SIZE_Z = 16;
+		static constexpr Uint32 CLUSTER_SIZE_X = ClusterBinner::CLUSTER_SIZE_X;
+		static constexpr Uint32 CLUSTER_SIZE_Y = ClusterBinner::CLUSTER_SIZE_Y;
+		static constexpr Uint32 CLUSTER_SIZE_Z = ClusterBinner::CLUSTER_SIZE_Z;
 		static constexpr Uint32 CLUSTER_MAX_LIGHTS = 128;
+		static constexpr Uint32 LENS_FLARE_TEXTURE_COUNT = 7;
+		static constexpr Uint64 CBUFFER_RING_SIZE = 8 << 20;
 		static constexpr GfxFormat GBUFFER_FORMAT[GBufferSlot_Count] = { GfxFormat::R8G8B8A8_UNORM, GfxFormat::R8G8B8A8_UNORM, GfxFormat::R8G8B8A8_UNORM };
 
 	public:
@@ -60,7 +71,12 @@ namespace adria
 
 		GfxTexture const* GetOffscreenTexture() const;
 		PickingData GetLastPickingData() const;
-		std::vector<Timestamp> GetProfilerResults();
+		tecs::entity GetLastPickedEntity() const { return last_picked_entity; }
+		GfxTimingHistory& GetGpuTimingHistory();
+		RenderQueueStats const& GetRenderQueueStats(RenderQueuePass pass) const;
+		LightTableStats const& GetLightTableStats() const { return light_table.GetStats(); }
+		ClusterBinnerStats const& GetClusterBinnerStats() const { return cluster_binner.GetStats(); }
+		GfxConstantBufferRingStats const& GetConstantBufferRingStats() const { return cbuffer_ring->GetStats(); }
 
 	private:
 		Uint32 width, height;
@@ -77,6 +93,23 @@ namespace adria
 		PickingData last_picking_data;
 		Float current_dt = 0.0f;
 
+		tecs::system_scheduler update_systems;
+		LightTable light_table;
+		ClusterBinner cluster_binner;
+
+		TransformHierarchy transform_hierarchy;
+
+		FrustumCuller frustum_culler;
+		RenderQueue render_queue;
+		std::vector<Uint32> visible_indices;
+
+		DynamicBVH scene_bvh;
+		std::unordered_map<tecs::entity, Int32> scene_bvh_proxies;
+		tecs::observer* scene_bvh_removed = nullptr;
+		Uint64 scene_bvh_tick = 0;
+		std::vector<tecs::entity> light_visible_entities;
+		tecs::entity last_picked_entity = tecs::null_entity;
+
 		//textures
 		std::vector<std::unique_ptr<GfxTexture>> gbuffer;
 		std::unique_ptr<GfxTexture> depth_target;
@@ -146,7 +179,7 @@ namespace adria
 		BoundingFrustum light_bounding_frustum;
 		std::optional<BoundingSphere> scene_bounding_sphere = std::nullopt;
 		std::array<Vector4, SSAO_KERNEL_SIZE> ssao_kernel{};
-		std::vector<GfxShaderResourceRO> lens_flare_textures;
+		std::array<TextureHandle, LENS_FLARE_TEXTURE_COUNT> lens_flare_handles{};
 		std::vector<GfxShaderResourceRO> clouds_textures;
 		TextureHandle lut_tony_mcmapface_handle = INVALID_TEXTURE_HANDLE;
 		TextureHandle hex_bokeh_handle = INVALID_TEXTURE_HANDLE;
@@ -159,6 +192,7 @@ namespace adria
 		//////////////////////////////////////////////////////////////////
 
 		//constant buffers
+		std::unique_ptr<GfxConstantBufferRing> cbuffer_ring = nullptr;
 		FrameCBuffer frame_cbuf_data{};
 		std::unique_ptr<GfxConstantBuffer<FrameCBuffer>> frame_cbuffer = nullptr;
 		LightCBuffer light_cbuf_data{};
@@ -180,7 +214,6 @@ namespace adria
 		TerrainCBuffer terrain_cbuf_data{};
 		std::unique_ptr<GfxConstantBuffer<TerrainCBuffer>> terrain_cbuffer = nullptr;
 
-		std::unique_ptr<GfxBuffer>  lights = nullptr;
 		std::unique_ptr<GfxBuffer>	voxels = nullptr;
 		std::unique_ptr<GfxBuffer>  clusters = nullptr;
 		std::unique_ptr<GfxBuffer>	light_counter = nullptr;
@@ -231,11 +264,16 @@ namespace adria
 		void UpdateOcean(Float dt);
 		void UpdateWeather(Float dt);
 		void UpdateParticles(Float dt);
+		void RegisterUpdateSystems();
+		void GatherLights();
 		void UpdateLights();
 		void UpdateTerrainData();
 		void UpdateVoxelData();
+		void UpdateTransforms();
+		void UpdateSceneBVH();
 		void CameraFrustumCulling();
 		void LightFrustumCulling(LightType type);
+		void PickEntity();
 		
 		void PassPicking();
 		void PassGBuffer();
@@ -77,6 +77,7 @@ namespace adria
 		Int32 visualize_max_lights = 16;
 		//clustered deferred
 		Bool use_clustered_deferred = false;
+		Bool cpu_light_binning = false;
 		//voxel gi
 		Bool voxel_gi = false;
 		Bool voxel_debug = false;
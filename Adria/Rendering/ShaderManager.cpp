@@ -2,11 +2,12 @@
 #include <set>
 #include <memory>
 #include <string_view>
-#include <execution>
+#include <algorithm>
 #include <filesystem>
 #include "ShaderManager.h"
 #include "Core/Logger.h"
 #include "Core/Paths.h"
+#include "Core/CpuProfiler.h"
 #include "Graphics/GfxShaderProgram.h"
 #include "Graphics/GfxShaderCompiler.h"
 #include "Graphics/GfxDevice.h"
@@ -49,11 +50,14 @@ namespace adria
 			case VS_Decal:
 			case VS_GBufferTerrain:
 			case VS_GBufferPBR:
+			case VS_GBufferPBR_Compressed:
 			case VS_FullscreenQuad:
 			case VS_LensFlare:
 			case VS_Bokeh:
 			case VS_Shadow:
+			case VS_Shadow_Compressed:
 			case VS_ShadowTransparent:
+			case VS_ShadowTransparent_Compressed:
 			case VS_Ocean:
 			case VS_OceanLOD:
 			case VS_Foliage:
@@ -217,7 +221,9 @@ namespace adria
 			case PS_FilmEffects:
 				return "Postprocess/FilmEffects.hlsl";
 			case VS_Shadow:
+			case VS_Shadow_Compressed:
 			case VS_ShadowTransparent:
+			case VS_ShadowTransparent_Compressed:
 			case PS_Shadow:
 			case PS_ShadowTransparent:
 				return "Misc/Shadow.hlsl";
@@ -262,6 +268,7 @@ namespace adria
 			case DS_OceanLOD:
 				return "Ocean/OceanLod.hlsl";
 			case VS_GBufferPBR:
+			case VS_GBufferPBR_Compressed:
 			case PS_GBufferPBR:
 			case PS_GBufferPBR_Mask:
 				return "GBuffer/GBuffer.hlsl";
@@ -306,7 +313,9 @@ namespace adria
 			switch (shader)
 			{
 			case VS_Shadow: 
+			case VS_Shadow_Compressed:
 			case VS_ShadowTransparent:
+			case VS_ShadowTransparent_Compressed:
 				return "ShadowVS";
 			case PS_Shadow: 
 			case PS_ShadowTransparent:
@@ -408,6 +417,7 @@ namespace adria
 			case PS_Texture:
 				return "TexturePS";
 			case VS_GBufferPBR:
+			case VS_GBufferPBR_Compressed:
 				return "GBufferVS";
 			case PS_GBufferPBR:
 			case PS_GBufferPBR_Mask:
@@ -501,6 +511,11 @@ namespace adria
 			case VS_ShadowTransparent:
 			case PS_ShadowTransparent:
 				return { {"TRANSPARENT", "1"} };
+			case VS_Shadow_Compressed:
+			case VS_GBufferPBR_Compressed:
+				return { {"COMPRESSED", "1"} };
+			case VS_ShadowTransparent_Compressed:
+				return { {"TRANSPARENT", "1"}, {"COMPRESSED", "1"} };
 			case CS_BlurVertical:
 				return { { "VERTICAL", "1" } };
 			case PS_GBufferPBR_Mask:
@@ -510,7 +525,7 @@ namespace adria
 			}
 		}
 
-		void CompileShader(ShaderId shader, Bool first_compile = false)
+		GfxShaderDesc GetShaderDesc(ShaderId shader)
 		{
 			GfxShaderDesc input{ .entrypoint = GetEntryPoint(shader) };
 #if _DEBUG
@@ -521,11 +536,11 @@ namespace adria
 			input.source_file = paths::ShaderDir + GetShaderSource(shader);
 			input.stage = GetStage(shader);
 			input.macros = GetShaderMacros(shader);
+			return input;
+		}
 
-			GfxShaderCompileOutput output{};
-			Bool result = GfxShaderCompiler::CompileShader(input, output);
-			if (!result) return;
-
+		void CreateShader(ShaderId shader, GfxShaderDesc const& input, GfxShaderCompileOutput const& output, Bool first_compile)
+		{
 			switch (input.stage)
 			{
 			case GfxShaderStage::VS:
@@ -562,6 +577,23 @@ namespace adria
 				file_shader_map[fs::path(include)].insert(shader);
 			}
 		}
+		void CompileShader(ShaderId shader, Bool first_compile = false)
+		{
+			GfxShaderDesc input = GetShaderDesc(shader);
+			GfxShaderCompileOutput output{};
+			if (!GfxShaderCompiler::CompileShader(input, output)) return;
+			CreateShader(shader, input, output, first_compile);
+		}
+		//reflection would assume 32 bit floats for the packed CompressedVertex attributes
+		GfxInputLayoutDesc GetCompressedVertexLayoutDesc()
+		{
+			GfxInputLayoutDesc desc{};
+			desc.elements.push_back({ .semantic_name = "POSITION", .format = GfxFormat::R16G16B16A16_UNORM });
+			desc.elements.push_back({ .semantic_name = "TEX", .format = GfxFormat::R16G16_FLOAT });
+			desc.elements.push_back({ .semantic_name = "NORMAL", .format = GfxFormat::R16G16_SNORM });
+			desc.elements.push_back({ .semantic_name = "TANGENT", .format = GfxFormat::R16G16_SNORM });
+			return desc;
+		}
 		void CreateAllPrograms()
 		{
 			using UnderlyingType = std::underlying_type_t<ShaderId>;
@@ -570,7 +602,16 @@ namespace adria
 				ShaderId shader = (ShaderId)s;
 				if (GetStage(shader) != GfxShaderStage::VS) continue;
 				
-				input_layout_map[shader] = std::make_unique<GfxInputLayout>(device, vs_shader_map[shader]->GetBytecode());
+				switch (shader)
+				{
+				case VS_GBufferPBR_Compressed:
+				case VS_Shadow_Compressed:
+				case VS_ShadowTransparent_Compressed:
+					input_layout_map[shader] = std::make_unique<GfxInputLayout>(device, vs_shader_map[shader]->GetBytecode(), GetCompressedVertexLayoutDesc());
+					break;
+				default:
+					input_layout_map[shader] = std::make_unique<GfxInputLayout>(device, vs_shader_map[shader]->GetBytecode());
+				}
 			}
 
 			gfx_shader_program_map[ShaderProgram::Skybox].SetVertexShader(vs_shader_map[VS_Sky].get()).SetPixelShader(ps_shader_map[PS_Skybox].get()).SetInputLayout(input_layout_map[VS_Sky].get());
@@ -585,6 +626,8 @@ namespace adria
 			gfx_shader_program_map[ShaderProgram::GBuffer_Terrain].SetVertexShader(vs_shader_map[VS_GBufferTerrain].get()).SetPixelShader(ps_shader_map[PS_GBufferTerrain].get()).SetInputLayout(input_layout_map[VS_GBufferTerrain].get());
 			gfx_shader_program_map[ShaderProgram::GBufferPBR].SetVertexShader(vs_shader_map[VS_GBufferPBR].get()).SetPixelShader(ps_shader_map[PS_GBufferPBR].get()).SetInputLayout(input_layout_map[VS_GBufferPBR].get());
 			gfx_shader_program_map[ShaderProgram::GBufferPBR_Mask].SetVertexShader(vs_shader_map[VS_GBufferPBR].get()).SetPixelShader(ps_shader_map[PS_GBufferPBR_Mask].get()).SetInputLayout(input_layout_map[VS_GBufferPBR].get());
+			gfx_shader_program_map[ShaderProgram::GBufferPBR_Compressed].SetVertexShader(vs_shader_map[VS_GBufferPBR_Compressed].get()).SetPixelShader(ps_shader_map[PS_GBufferPBR].get()).SetInputLayout(input_layout_map[VS_GBufferPBR_Compressed].get());
+			gfx_shader_program_map[ShaderProgram::GBufferPBR_Mask_Compressed].SetVertexShader(vs_shader_map[VS_GBufferPBR_Compressed].get()).SetPixelShader(ps_shader_map[PS_GBufferPBR_Mask].get()).SetInputLayout(input_layout_map[VS_GBufferPBR_Compressed].get());
 			gfx_shader_program_map[ShaderProgram::AmbientPBR].SetVertexShader(vs_shader_map[VS_FullscreenQuad].get()).SetPixelShader(ps_shader_map[PS_AmbientPBR].get()).SetInputLayout(input_layout_map[VS_FullscreenQuad].get());
 			gfx_shader_program_map[ShaderProgram::AmbientPBR_AO].SetVertexShader(vs_shader_map[VS_FullscreenQuad].get()).SetPixelShader(ps_shader_map[PS_AmbientPBR_AO].get()).SetInputLayout(input_layout_map[VS_FullscreenQuad].get());
 			gfx_shader_program_map[ShaderProgram::AmbientPBR_IBL].SetVertexShader(vs_shader_map[VS_FullscreenQuad].get()).SetPixelShader(ps_shader_map[PS_AmbientPBR_IBL].get()).SetInputLayout(input_layout_map[VS_FullscreenQuad].get());
@@ -616,6 +659,8 @@ namespace adria
 
 			gfx_shader_program_map[ShaderProgram::DepthMap].SetVertexShader(vs_shader_map[VS_Shadow].get()).SetPixelShader(ps_shader_map[PS_Shadow].get()).SetInputLayout(input_layout_map[VS_Shadow].get());
 			gfx_shader_program_map[ShaderProgram::DepthMap_Transparent].SetVertexShader(vs_shader_map[VS_ShadowTransparent].get()).SetPixelShader(ps_shader_map[PS_ShadowTransparent].get()).SetInputLayout(input_layout_map[VS_ShadowTransparent].get());
+			gfx_shader_program_map[ShaderProgram::DepthMap_Compressed].SetVertexShader(vs_shader_map[VS_Shadow_Compressed].get()).SetPixelShader(ps_shader_map[PS_Shadow].get()).SetInputLayout(input_layout_map[VS_Shadow_Compressed].get());
+			gfx_shader_program_map[ShaderProgram::DepthMap_Transparent_Compressed].SetVertexShader(vs_shader_map[VS_ShadowTransparent_Compressed].get()).SetPixelShader(ps_shader_map[PS_ShadowTransparent].get()).SetInputLayout(input_layout_map[VS_ShadowTransparent_Compressed].get());
 
 			gfx_shader_program_map[ShaderProgram::Volumetric_Directional].SetVertexShader(vs_shader_map[VS_FullscreenQuad].get()).SetPixelShader(ps_shader_map[PS_VolumetricLight_Directional].get()).SetInputLayout(input_layout_map[VS_FullscreenQuad].get());
 			gfx_shader_program_map[ShaderProgram::Volumetric_DirectionalCascades].SetVertexShader(vs_shader_map[VS_FullscreenQuad].get()).SetPixelShader(ps_shader_map[PS_VolumetricLight_DirectionalWithCascades].get()).SetInputLayout(input_layout_map[VS_FullscreenQuad].get());
@@ -658,20 +703,20 @@ namespace adria
 		}
 		void CompileAllShaders()
 		{
+			AdriaCpuProfileScope("ShaderManager::CompileAllShaders");
 			Timer t;
 			ADRIA_LOG(INFO, "Compiling all shaders...");
-			using UnderlyingType = std::underlying_type_t<ShaderId>;
 
-			std::vector<UnderlyingType> shaders(ShaderId_Count);
-			std::iota(std::begin(shaders), std::end(shaders), 0);
-			std::for_each(
-				std::execution::seq,
-				std::begin(shaders),
-				std::end(shaders),
-				[](UnderlyingType s)
-				{
-					CompileShader((ShaderId)s, true);
-				});
+			std::vector<GfxShaderDesc> inputs(ShaderId_Count);
+			std::vector<GfxShaderCompileOutput> outputs(ShaderId_Count);
+			for (Uint32 s = 0; s < ShaderId_Count; ++s) inputs[s] = GetShaderDesc((ShaderId)s);
+
+			std::vector<Uint64> failed_shaders = GfxShaderCompiler::CompileShaders(inputs, outputs);
+			for (Uint32 s = 0; s < ShaderId_Count; ++s)
+			{
+				if (std::find(failed_shaders.begin(), failed_shaders.end(), s) != failed_shaders.end()) continue;
+				CreateShader((ShaderId)s, inputs[s], outputs[s], true);
+			}
 			CreateAllPrograms();
 			ADRIA_LOG(INFO, "Compilation done in %f seconds!", t.ElapsedInSeconds());
 		}
@@ -688,6 +733,7 @@ namespace adria
 	{
 		device = _device;
 		file_watcher = std::make_unique<FileWatcher>();
+		GfxShaderCompiler::Initialize();
 		CompileAllShaders();
 		file_watcher->AddPathToWatch(paths::ShaderDir);
 		std::ignore = file_watcher->GetFileModifiedEvent().Add(OnShaderFileChanged);
@@ -696,6 +742,7 @@ namespace adria
 	{
 		device = nullptr;
 		file_watcher = nullptr;
+		GfxShaderCompiler::Destroy();
 		auto FreeContainer = []<typename T>(T& container) 
 		{
 			container.clear();
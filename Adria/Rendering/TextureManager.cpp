@@ -66,6 +66,19 @@ namespace adria
 			while ((width | height) >> levels) ++levels;
 			return levels;
 		}
+		constexpr DXGI_FORMAT GetDXGIFormat(DecodedTextureFormat format)
+		{
+			switch (format)
+			{
+			case DecodedTextureFormat::RGBA32F:
+				return DXGI_FORMAT_R32G32B32A32_FLOAT;
+			case DecodedTextureFormat::RGBA16:
+				return DXGI_FORMAT_R16G16B16A16_UNORM;
+			case DecodedTextureFormat::RGBA8:
+			default:
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+		}
 	}
 
 
@@ -73,14 +86,45 @@ void TextureManager::Initialize(GfxDevice* _gfx)
 {
 	gfx = _gfx;
 	mipmaps = true;
+	streamer = std::make_unique<TextureStreamer>();
+
+	Uint32 const placeholder_colors[] = { 0xffffffff, 0xff000000, 0xffff8080, 0xff008000 };
+	static_assert(std::size(placeholder_colors) == (Uint64)TexturePlaceholder::Count);
+	for (Uint64 i = 0; i < placeholder_views.size(); ++i)
+	{
+		D3D11_TEXTURE2D_DESC desc{};
+		desc.Width = 1;
+		desc.Height = 1;
+		desc.MipLevels = 1;
+		desc.ArraySize = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.Usage = D3D11_USAGE_IMMUTABLE;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+		D3D11_SUBRESOURCE_DATA data{};
+		data.pSysMem = &placeholder_colors[i];
+		data.SysMemPitch = sizeof(Uint32);
+
+		Ref<ID3D11Texture2D> placeholder_texture = nullptr;
+		GFX_CHECK_HR(gfx->GetDevice()->CreateTexture2D(&desc, &data, placeholder_texture.GetAddressOf()));
+		GFX_CHECK_HR(gfx->GetDevice()->CreateShaderResourceView(placeholder_texture.Get(), nullptr, placeholder_views[i].GetAddressOf()));
+	}
 }
 
 void TextureManager::Destroy()
 {
+	streamer = nullptr;
+	streamed_textures.clear();
+	mip_uploads.clear();
+	texture_map.clear();
+	loaded_textures.clear();
+	handle = INVALID_TEXTURE_HANDLE;
+	for (auto& placeholder_view : placeholder_views) placeholder_view = nullptr;
 	gfx = nullptr;
 }
 
-TextureHandle TextureManager::LoadTexture(std::wstring const& name)
+TextureHandle TextureManager::LoadTexture(std::wstring const& name, TexturePlaceholder placeholder)
 {
 	TextureFormat format = GetTextureFormat(name);
 
@@ -88,17 +132,17 @@ TextureHandle TextureManager::LoadTexture(std::wstring const& name)
 	{
 	case TextureFormat::DDS:
 		return LoadDDSTexture(name);
+	case TextureFormat::TIFF:
+	case TextureFormat::ICO:
+		return LoadWICTexture(name);
 	case TextureFormat::BMP:
 	case TextureFormat::PNG:
 	case TextureFormat::JPG:
-	case TextureFormat::TIFF:
 	case TextureFormat::GIF:
-	case TextureFormat::ICO:
-		return LoadWICTexture(name);
 	case TextureFormat::TGA:
 	case TextureFormat::HDR:
 	case TextureFormat::PIC:
-		return LoadTexture_HDR_TGA_PIC(ToString(name));
+		return LoadStreamedTexture(name, placeholder);
 	case TextureFormat::NotSupported:
 	default:
 		ADRIA_ASSERT(false && "Unsupported Texture Format!");
@@ -107,9 +151,41 @@ TextureHandle TextureManager::LoadTexture(std::wstring const& name)
 	return INVALID_TEXTURE_HANDLE;
 }
 
-TextureHandle TextureManager::LoadTexture(std::string const& name)
+TextureHandle TextureManager::LoadTexture(std::string const& name, TexturePlaceholder placeholder)
+{
+	return LoadTexture(ToWideString(name), placeholder);
+}
+
+TextureHandle TextureManager::LoadTexture(std::wstring const& name, DecodedTextureView const& texture)
 {
-	return LoadTexture(ToWideString(name));
+	if (auto it = loaded_textures.find(name); it != loaded_textures.end()) return it->second;
+
+	std::vector<D3D11_SUBRESOURCE_DATA> mip_data(texture.mips.size());
+	for (Uint32 i = 0; i < mip_data.size(); ++i)
+	{
+		mip_data[i].pSysMem = texture.MipData(i);
+		mip_data[i].SysMemPitch = texture.mips[i].pitch;
+	}
+
+	D3D11_TEXTURE2D_DESC desc{};
+	desc.Width = texture.width;
+	desc.Height = texture.height;
+	desc.MipLevels = static_cast<Uint32>(texture.mips.size());
+	desc.ArraySize = 1;
+	desc.Format = GetDXGIFormat(texture.format);
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	Ref<ID3D11Texture2D> tex_ptr = nullptr;
+	GFX_CHECK_HR(gfx->GetDevice()->CreateTexture2D(&desc, mip_data.data(), tex_ptr.GetAddressOf()));
+	GfxShaderResourceRORef view_ptr = nullptr;
+	GFX_CHECK_HR(gfx->GetDevice()->CreateShaderResourceView(tex_ptr.Get(), nullptr, view_ptr.GetAddressOf()));
+
+	++handle;
+	loaded_textures.insert({ name, handle });
+	texture_map.insert({ handle, view_ptr });
+	return handle;
 }
 
 TextureHandle TextureManager::LoadCubeMap(std::wstring const& name)
@@ -264,7 +340,7 @@ TextureHandle TextureManager::LoadCubeMap(std::array<std::string, 6> const& cube
 
 	desc.Width = images[0].Width();
 	desc.Height = images[0].Height();
-	desc.Format = images[0].IsHDR() ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+	desc.Format = images[0].IsHDR() ? DXGI_FORMAT_R32G32B32A32_FLOAT : images[0].Is16Bit() ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
 	desc.MipLevels = mipmaps ? MipmapLevels(desc.Width, desc.Height) : 1;
 
 	Ref<ID3D11Texture2D> tex_ptr = nullptr;
@@ -306,6 +382,12 @@ void TextureManager::SetMipMaps(Bool _mipmaps)
 	mipmaps = _mipmaps;
 }
 
+void TextureManager::Update()
+{
+	streamer->Schedule(upload_budget, mip_uploads);
+	for (TextureMipUpload const& upload : mip_uploads) UploadMip(upload);
+}
+
 TextureHandle TextureManager::LoadDDSTexture(std::wstring const& name)
 {
 	ID3D11Device* device = gfx->GetDevice();
@@ -364,57 +446,49 @@ TextureHandle TextureManager::LoadWICTexture(std::wstring const& name)
 	else return it->second;
 }
 
-TextureHandle TextureManager::LoadTexture_HDR_TGA_PIC(std::string const& name)
+TextureHandle TextureManager::LoadStreamedTexture(std::wstring const& name, TexturePlaceholder placeholder)
 {
-	ID3D11Device* device = gfx->GetDevice();
-	ID3D11DeviceContext* context = gfx->GetContext();
-
-	std::wstring wide_name = ToWideString(name);
-	if (auto it = loaded_textures.find(wide_name); it == loaded_textures.end())
+	if (auto it = loaded_textures.find(name); it == loaded_textures.end())
 	{
 		++handle;
-		Image img(name, 4);
+		streamer->Request(handle, ToString(name), mipmaps);
+		loaded_textures.insert({ name, handle });
+		texture_map.insert({ handle, placeholder_views[(Uint64)placeholder] });
+		return handle;
+	}
+	else return it->second;
+}
+
+void TextureManager::UploadMip(TextureMipUpload const& upload)
+{
+	ID3D11DeviceContext* context = gfx->GetContext();
+	DecodedTexture const& texture = *upload.texture;
+	if (upload.first_upload)
+	{
+		//all mips are allocated up front, sampling is clamped to the uploaded ones
 		D3D11_TEXTURE2D_DESC desc{};
-		desc.Width = img.Width();
-		desc.Height = img.Height();
-		desc.MipLevels = mipmaps ? 0 : 1;
+		desc.Width = texture.width;
+		desc.Height = texture.height;
+		desc.MipLevels = static_cast<Uint32>(texture.mips.size());
 		desc.ArraySize = 1;
-		desc.Format = img.IsHDR() ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.Format = GetDXGIFormat(texture.format);
 		desc.SampleDesc.Count = 1;
 		desc.Usage = D3D11_USAGE_DEFAULT;
 		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-		if (mipmaps)
-		{
-			desc.BindFlags |= D3D11_BIND_RENDER_TARGET;
-			desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
-		}
 
 		Ref<ID3D11Texture2D> tex_ptr = nullptr;
-
-		HRESULT hr = device->CreateTexture2D(&desc, nullptr, tex_ptr.GetAddressOf());
-		GFX_CHECK_HR(hr);
-
-		D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc{};
-		srv_desc.Format = desc.Format;
-		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		srv_desc.Texture2D.MostDetailedMip = 0;
-		srv_desc.Texture2D.MipLevels = -1;
+		GFX_CHECK_HR(gfx->GetDevice()->CreateTexture2D(&desc, nullptr, tex_ptr.GetAddressOf()));
 
 		Ref<ID3D11ShaderResourceView> view_ptr = nullptr;
-		hr = device->CreateShaderResourceView(tex_ptr.Get(), &srv_desc, view_ptr.GetAddressOf());
-		GFX_CHECK_HR(hr);
-		context->UpdateSubresource(tex_ptr.Get(), 0, nullptr, img.Data<void>(), img.Pitch(), 0);
-		if (mipmaps)
-		{
-			context->GenerateMips(view_ptr.Get());
-		}
-		loaded_textures.insert({ wide_name, handle });
-		texture_map.insert({ handle, view_ptr });
+		GFX_CHECK_HR(gfx->GetDevice()->CreateShaderResourceView(tex_ptr.Get(), nullptr, view_ptr.GetAddressOf()));
 
-		return handle;
+		texture_map[upload.handle] = view_ptr;
+		streamed_textures[upload.handle] = tex_ptr;
 	}
-	else return it->second;
-
 
+	ID3D11Texture2D* tex_ptr = streamed_textures[upload.handle].Get();
+	context->UpdateSubresource(tex_ptr, upload.mip, nullptr, texture.MipData(upload.mip), texture.mips[upload.mip].pitch, 0);
+	context->SetResourceMinLOD(tex_ptr, static_cast<Float>(upload.mip));
+	if (upload.mip == 0) streamed_textures.erase(upload.handle);
 }
 }
\ No newline at end of file
@@ -2,14 +2,22 @@
 #include <string>
 #include <array>
 #include <unordered_map>
+#include "TextureStreamer.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxView.h"
 #include "Utilities/Singleton.h"
 
 namespace adria
 {
-	using TextureHandle = Uint64;
-	inline constexpr TextureHandle const INVALID_TEXTURE_HANDLE = Uint64(-1);
+	//bound instead of a streamed texture until its first mip is uploaded
+	enum class TexturePlaceholder : Uint8
+	{
+		White,
+		Black,				//emissive, nothing glows before its texture arrives
+		FlatNormal,
+		MetallicRoughness,	//non-metal with mid roughness, white would turn the surface into rough metal
+		Count
+	};
 
 	class TextureManager : public Singleton<TextureManager>
 	{
@@ -19,14 +27,23 @@ namespace adria
 		void Initialize(GfxDevice* gfx);
 		void Destroy();
 
-		ADRIA_NODISCARD TextureHandle LoadTexture(std::wstring const& name);
-		ADRIA_NODISCARD TextureHandle LoadTexture(std::string const& name);
+		ADRIA_NODISCARD TextureHandle LoadTexture(std::wstring const& name, TexturePlaceholder placeholder = TexturePlaceholder::White);
+		ADRIA_NODISCARD TextureHandle LoadTexture(std::string const& name, TexturePlaceholder placeholder = TexturePlaceholder::White);
+		//creates the texture from already decoded mips, e.g. ones mapped from a baked model, without streaming
+		ADRIA_NODISCARD TextureHandle LoadTexture(std::wstring const& name, DecodedTextureView const& texture);
 		ADRIA_NODISCARD TextureHandle LoadCubeMap(std::wstring const& name);
 		ADRIA_NODISCARD TextureHandle LoadCubeMap(std::array<std::string, 6> const& cubemap_textures);
 
 		GfxShaderResourceRO GetTextureView(TextureHandle tex_handle) const;
 		void SetMipMaps(Bool mipmaps);
 
+		//uploads decoded mips of streamed textures within the per frame byte budget
+		void Update();
+		void SetUploadBudget(Uint64 bytes) { upload_budget = bytes; }
+		void RequestSize(TextureHandle tex_handle, Uint32 size) { streamer->RequestSize(tex_handle, size); }
+		Bool IsStreaming() const { return streamer->HasPendingWork(); }
+		TextureStreamerStats const& GetStreamingStats() const { return streamer->GetStats(); }
+
 	private:
 		GfxDevice* gfx;
 		Bool mipmaps = true;
@@ -34,6 +51,12 @@ namespace adria
 		std::unordered_map<TextureHandle, GfxShaderResourceRORef> texture_map{};
 		std::unordered_map<std::wstring, TextureHandle> loaded_textures{};
 
+		std::unique_ptr<TextureStreamer> streamer;
+		Uint64 upload_budget = 16 * 1024 * 1024;
+		std::vector<TextureMipUpload> mip_uploads;
+		std::unordered_map<TextureHandle, Ref<ID3D11Texture2D>> streamed_textures{};
+		std::array<GfxShaderResourceRORef, (Uint64)TexturePlaceholder::Count> placeholder_views{};
+
 	private:
 		TextureManager() = default;
 		TextureManager(TextureManager const&) = delete;
@@ -42,7 +65,8 @@ namespace adria
 
 		TextureHandle LoadDDSTexture(std::wstring const& name);
 		TextureHandle LoadWICTexture(std::wstring const& name);
-		TextureHandle LoadTexture_HDR_TGA_PIC(std::string const& name);
+		TextureHandle LoadStreamedTexture(std::wstring const& name, TexturePlaceholder placeholder);
+		void UploadMip(TextureMipUpload const& upload);
 	};
 	#define g_TextureManager TextureManager::Get()
 }
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include "TextureStreamer.h"
+#include "Core/Logger.h"
+#include "Utilities/Image.h"
+#include "Utilities/FrameArena.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 MipmapLevels(Uint32 width, Uint32 height)
+		{
+			Uint32 levels = 1U;
+			while ((width | height) >> levels) ++levels;
+			return levels;
+		}
+
+		template<typename T>
+		void DownsampleMip(T const* src, TextureMip const& src_mip, T* dst, TextureMip const& dst_mip)
+		{
+			for (Uint32 y = 0; y < dst_mip.height; ++y)
+			{
+				Uint32 const y0 = std::min(2 * y, src_mip.height - 1);
+				Uint32 const y1 = std::min(2 * y + 1, src_mip.height - 1);
+				T const* row0 = src + Uint64(y0) * src_mip.width * 4;
+				T const* row1 = src + Uint64(y1) * src_mip.width * 4;
+				T* dst_row = dst + Uint64(y) * dst_mip.width * 4;
+				for (Uint32 x = 0; x < dst_mip.width; ++x)
+				{
+					Uint32 const x0 = std::min(2 * x, src_mip.width - 1) * 4;
+					Uint32 const x1 = std::min(2 * x + 1, src_mip.width - 1) * 4;
+					for (Uint32 c = 0; c < 4; ++c)
+					{
+						if constexpr (std::is_integral_v<T>)
+						{
+							Uint32 const sum = Uint32(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+							dst_row[x * 4 + c] = static_cast<T>((sum + 2) / 4);
+						}
+						else
+						{
+							dst_row[x * 4 + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	Bool DecodeTexture(std::string const& path, Bool mipmaps, DecodedTexture& texture)
+	{
+		Image image(path, 4);
+		if (image.Data<Uint8>() == nullptr) return false;
+
+		texture.width = image.Width();
+		texture.height = image.Height();
+		texture.format = image.IsHDR() ? DecodedTextureFormat::RGBA32F : image.Is16Bit() ? DecodedTextureFormat::RGBA16 : DecodedTextureFormat::RGBA8;
+
+		Uint32 const bytes_per_pixel = image.BytesPerPixel();
+		Uint32 const mip_count = mipmaps ? MipmapLevels(texture.width, texture.height) : 1;
+		texture.mips.resize(mip_count);
+		Uint64 offset = 0;
+		for (Uint32 mip = 0; mip < mip_count; ++mip)
+		{
+			TextureMip& texture_mip = texture.mips[mip];
+			texture_mip.width = std::max(texture.width >> mip, 1u);
+			texture_mip.height = std::max(texture.height >> mip, 1u);
+			texture_mip.pitch = texture_mip.width * bytes_per_pixel;
+			texture_mip.offset = offset;
+			texture_mip.size = Uint64(texture_mip.pitch) * texture_mip.height;
+			offset += texture_mip.size;
+		}
+
+		texture.data.resize(offset);
+		std::memcpy(texture.data.data(), image.Data<Uint8>(), texture.mips[0].size);
+		for (Uint32 mip = 1; mip < mip_count; ++mip)
+		{
+			TextureMip const& src_mip = texture.mips[mip - 1];
+			TextureMip const& dst_mip = texture.mips[mip];
+			switch (texture.format)
+			{
+			case DecodedTextureFormat::RGBA32F:
+				DownsampleMip(reinterpret_cast<Float const*>(texture.data.data() + src_mip.offset), src_mip,
+							  reinterpret_cast<Float*>(texture.data.data() + dst_mip.offset), dst_mip);
+				break;
+			case DecodedTextureFormat::RGBA16:
+				DownsampleMip(reinterpret_cast<Uint16 const*>(texture.data.data() + src_mip.offset), src_mip,
+							  reinterpret_cast<Uint16*>(texture.data.data() + dst_mip.offset), dst_mip);
+				break;
+			case DecodedTextureFormat::RGBA8:
+			default:
+				DownsampleMip(texture.data.data() + src_mip.offset, src_mip, texture.data.data() + dst_mip.offset, dst_mip);
+			}
+		}
+		return true;
+	}
+
+	TextureStreamer::TextureStreamer(DecodeFunction decode) : decode(std::move(decode)) {}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		WaitForDecodes();
+	}
+
+	void TextureStreamer::Request(TextureHandle handle, std::string const& path, Bool mipmaps, Uint32 requested_size)
+	{
+		ADRIA_ASSERT(!textures.contains(handle));
+		auto streaming_texture = std::make_unique<StreamingTexture>();
+		streaming_texture->handle = handle;
+		streaming_texture->path = path;
+		streaming_texture->mipmaps = mipmaps;
+		streaming_texture->requested_size = requested_size;
+
+		StreamingTexture* texture = streaming_texture.get();
+		textures[handle] = std::move(streaming_texture);
+		failed_textures.erase(handle);
+		++decoding_count;
+
+		g_JobSystem.Submit([this, texture]()
+		{
+			texture->decode_succeeded = decode(texture->path, texture->mipmaps, texture->texture);
+			std::lock_guard lock(decoded_mutex);
+			decoded_textures.push_back(texture);
+		}, decode_counter);
+	}
+
+	void TextureStreamer::RequestSize(TextureHandle handle, Uint32 requested_size)
+	{
+		if (auto it = textures.find(handle); it != textures.end())
+		{
+			it->second->requested_size = std::max(it->second->requested_size, requested_size);
+		}
+	}
+
+	void TextureStreamer::Schedule(Uint64 byte_budget, std::vector<TextureMipUpload>& uploads)
+	{
+		uploads.clear();
+		retired_textures.clear();
+		CollectDecodedTextures();
+
+		struct Candidate
+		{
+			StreamingTexture* texture;
+			Bool required;
+			Uint32 mip_size;
+		};
+		auto IsLowerPriority = [](Candidate const& a, Candidate const& b)
+		{
+			if (a.required != b.required) return b.required;
+			if (a.mip_size != b.mip_size) return a.mip_size > b.mip_size;
+			if (a.texture->requested_size != b.texture->requested_size) return a.texture->requested_size < b.texture->requested_size;
+			return a.texture->handle > b.texture->handle;
+		};
+		auto MakeCandidate = [](StreamingTexture* texture)
+		{
+			TextureMip const& mip = texture->texture.mips[texture->resident_mip - 1];
+			Uint32 const mip_size = std::max(mip.width, mip.height);
+			Bool const first_upload = texture->resident_mip == texture->texture.mips.size();
+			return Candidate{ .texture = texture, .required = first_upload || mip_size <= texture->requested_size, .mip_size = mip_size };
+		};
+
+		std::priority_queue<Candidate, FrameVector<Candidate>, decltype(IsLowerPriority)> candidates(IsLowerPriority, FrameVector<Candidate>(g_FrameArena.Resource()));
+		for (auto const& [handle, texture] : textures)
+		{
+			if (texture->decoded) candidates.push(MakeCandidate(texture.get()));
+		}
+
+		Uint64 uploaded_bytes = 0;
+		while (!candidates.empty())
+		{
+			StreamingTexture* texture = candidates.top().texture;
+			Uint32 const mip = texture->resident_mip - 1;
+			Uint64 const mip_bytes = texture->texture.mips[mip].size;
+			if (!uploads.empty() && uploaded_bytes + mip_bytes > byte_budget) break;
+			candidates.pop();
+
+			uploads.push_back(TextureMipUpload{ .handle = texture->handle, .mip = mip,
+				.first_upload = texture->resident_mip == texture->texture.mips.size(), .texture = &texture->texture });
+			uploaded_bytes += mip_bytes;
+			texture->resident_mip = mip;
+			if (mip > 0) candidates.push(MakeCandidate(texture));
+		}
+
+		//fully resident textures keep their pixels alive until the caller is done with this frame's uploads
+		for (TextureMipUpload const& upload : uploads)
+		{
+			if (upload.mip != 0) continue;
+			auto it = textures.find(upload.handle);
+			retired_textures.push_back(std::move(it->second));
+			textures.erase(it);
+		}
+
+		stats.pending_decodes = decoding_count;
+		stats.pending_uploads = static_cast<Uint32>(textures.size()) - decoding_count;
+		stats.uploaded_mips = static_cast<Uint32>(uploads.size());
+		stats.uploaded_bytes = uploaded_bytes;
+	}
+
+	void TextureStreamer::WaitForDecodes()
+	{
+		g_JobSystem.Wait(decode_counter);
+	}
+
+	void TextureStreamer::CollectDecodedTextures()
+	{
+		std::vector<StreamingTexture*> collected;
+		{
+			std::lock_guard lock(decoded_mutex);
+			collected.swap(decoded_textures);
+		}
+
+		for (StreamingTexture* texture : collected)
+		{
+			--decoding_count;
+			if (!texture->decode_succeeded || texture->texture.mips.empty())
+			{
+				ADRIA_LOG(ERROR, "Decoding texture %s unsuccessful", texture->path.c_str());
+				++stats.failed_decodes;
+				failed_textures.insert(texture->handle);
+				textures.erase(texture->handle);
+				continue;
+			}
+			texture->decoded = true;
+			texture->resident_mip = static_cast<Uint32>(texture->texture.mips.size());
+			stats.decoded_bytes += texture->texture.data.size();
+		}
+	}
+}
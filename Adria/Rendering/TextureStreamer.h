@@ -0,0 +1,145 @@
+#pragma once
+#include <string>
+#include <span>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	using TextureHandle = Uint64;
+	inline constexpr TextureHandle const INVALID_TEXTURE_HANDLE = Uint64(-1);
+
+	struct TextureMip
+	{
+		Uint32 width;
+		Uint32 height;
+		Uint32 pitch;
+		Uint64 offset;
+		Uint64 size;
+	};
+
+	//values are stored in baked models
+	enum class DecodedTextureFormat : Uint32
+	{
+		RGBA8,
+		RGBA32F,
+		RGBA16,
+		Count
+	};
+
+	constexpr Uint32 DecodedTextureBytesPerPixel(DecodedTextureFormat format)
+	{
+		switch (format)
+		{
+		case DecodedTextureFormat::RGBA32F: return 16;
+		case DecodedTextureFormat::RGBA16:	return 8;
+		case DecodedTextureFormat::RGBA8:
+		default:
+			return 4;
+		}
+	}
+
+	//pixels of every mip level in one allocation, mip 0 first
+	struct DecodedTexture
+	{
+		Uint32 width = 0;
+		Uint32 height = 0;
+		DecodedTextureFormat format = DecodedTextureFormat::RGBA8;
+		std::vector<TextureMip> mips;
+		std::vector<Uint8> data;
+
+		void const* MipData(Uint32 mip) const { return data.data() + mips[mip].offset; }
+	};
+
+	//same layout as DecodedTexture over memory owned by someone else, e.g. a mapped baked model
+	struct DecodedTextureView
+	{
+		Uint32 width = 0;
+		Uint32 height = 0;
+		DecodedTextureFormat format = DecodedTextureFormat::RGBA8;
+		std::span<TextureMip const> mips;
+		Uint8 const* data = nullptr;
+
+		void const* MipData(Uint32 mip) const { return data + mips[mip].offset; }
+	};
+
+	//decodes an image file with stb_image and builds its mip chain with a box filter
+	Bool DecodeTexture(std::string const& path, Bool mipmaps, DecodedTexture& texture);
+
+	struct TextureMipUpload
+	{
+		TextureHandle handle;
+		Uint32 mip;
+		Bool first_upload;
+		DecodedTexture const* texture;
+	};
+
+	struct TextureStreamerStats
+	{
+		Uint32 pending_decodes = 0;
+		Uint32 pending_uploads = 0;
+		Uint32 failed_decodes = 0;
+		Uint32 uploaded_mips = 0;
+		Uint64 uploaded_bytes = 0;
+		Uint64 decoded_bytes = 0;
+	};
+
+	//Device independent half of texture streaming: decodes requested textures on the job system and decides
+	//which mip levels get uploaded each frame. Mips are uploaded coarsest first, so a texture becomes visible at low resolution
+	//after its first upload. Mips up to the requested size of a texture are scheduled before detail nobody asked for yet.
+	class TextureStreamer
+	{
+		struct StreamingTexture
+		{
+			TextureHandle handle;
+			std::string path;
+			Bool mipmaps;
+			Bool decoded = false;
+			Uint32 requested_size;
+			Uint32 resident_mip = 0; //first uploaded mip, mip count while nothing is uploaded
+			Bool decode_succeeded = false; //written by the decode job
+			DecodedTexture texture;
+		};
+
+	public:
+		using DecodeFunction = std::function<Bool(std::string const&, Bool, DecodedTexture&)>;
+
+		explicit TextureStreamer(DecodeFunction decode = DecodeTexture);
+		~TextureStreamer();
+
+		//until a size is requested only the coarsest mip is prioritized
+		void Request(TextureHandle handle, std::string const& path, Bool mipmaps, Uint32 requested_size = 0);
+		//raises the size a texture is needed at, mips up to this size are prioritized
+		void RequestSize(TextureHandle handle, Uint32 requested_size);
+
+		//returns mips to upload this frame within byte_budget, at least one mip is returned if anything is pending.
+		//every returned mip has to be uploaded before the next call, texture pointers stay valid until then.
+		void Schedule(Uint64 byte_budget, std::vector<TextureMipUpload>& uploads);
+		void WaitForDecodes();
+
+		Bool IsStreaming(TextureHandle handle) const { return textures.contains(handle); }
+		Bool HasPendingWork() const { return !textures.empty(); }
+		Bool HasFailed(TextureHandle handle) const { return failed_textures.contains(handle); }
+		TextureStreamerStats const& GetStats() const { return stats; }
+
+	private:
+		DecodeFunction decode;
+		std::unordered_map<TextureHandle, std::unique_ptr<StreamingTexture>> textures;
+		std::vector<std::unique_ptr<StreamingTexture>> retired_textures;
+		std::unordered_set<TextureHandle> failed_textures;
+		TextureStreamerStats stats;
+		Uint32 decoding_count = 0;
+
+		JobCounter decode_counter;
+		std::mutex decoded_mutex;
+		std::vector<StreamingTexture*> decoded_textures;
+
+	private:
+		void CollectDecodedTextures();
+	};
+}
@@ -0,0 +1,82 @@
+#include "TransformHierarchy.h"
+#include "Components.h"
+#include "tecs/registry.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 TRANSFORM_GRAIN_SIZE = 128;
+	}
+
+	TransformHierarchy::TransformHierarchy(tecs::registry& reg) : reg(reg)
+	{
+		added_transforms = &reg.on_added<Transform>();
+		removed_transforms = &reg.on_removed<Transform>();
+	}
+
+	TransformHierarchy::~TransformHierarchy()
+	{
+		reg.disconnect(*added_transforms);
+		reg.disconnect(*removed_transforms);
+	}
+
+	Bool TransformHierarchy::Update()
+	{
+		Bool const hierarchy_changed = !levels_valid || !added_transforms->empty() || !removed_transforms->empty()
+			|| reg.tick<Relationship>() != relationship_tick;
+		if (!hierarchy_changed && reg.tick<Transform>() == transform_tick) return false;
+		if (hierarchy_changed) Rebuild();
+
+		//a changed hierarchy can move any entity under another parent, so every world transform is recomputed
+		Uint64 const since = hierarchy_changed ? 0 : transform_tick;
+		auto transform_view = reg.view<Transform>();
+		//every level only reads the previous one, so the entities of a level can be updated in parallel
+		for (auto const& level : levels)
+		{
+			g_JobSystem.ParallelFor((Uint32)level.size(), TRANSFORM_GRAIN_SIZE, [&](Uint32 i)
+				{
+					Node const& node = level[i];
+					Transform& transform = transform_view.get(node.entity);
+					Transform const* parent = node.parent != tecs::null_entity ? &transform_view.get(node.parent) : nullptr;
+					transform.world_changed = reg.changed_since<Transform>(node.entity, since) || (parent && parent->world_changed);
+					if (!transform.world_changed) return;
+
+					transform.world_transform = parent ? transform.current_transform * parent->world_transform : transform.current_transform;
+					transform.inverse_world_transform = transform.world_transform.Invert();
+				});
+		}
+		transform_tick = reg.tick<Transform>();
+		return true;
+	}
+
+	void TransformHierarchy::Rebuild()
+	{
+		for (auto& level : levels) level.clear();
+
+		auto transform_view = reg.view<Transform>();
+		for (auto e : transform_view)
+		{
+			tecs::entity parent = tecs::null_entity;
+			Uint64 depth = 0;
+			for (tecs::entity ancestor = e;; ++depth)
+			{
+				Relationship const* relationship = reg.get_if<Relationship>(ancestor);
+				if (!relationship || relationship->parent == tecs::null_entity || !reg.valid(relationship->parent)) break;
+				if (!reg.has<Transform>(relationship->parent)) break;
+				if (depth == 0) parent = relationship->parent;
+				ancestor = relationship->parent;
+			}
+			if (levels.size() <= depth) levels.resize(depth + 1);
+			levels[depth].push_back(Node{ e, parent });
+		}
+		while (!levels.empty() && levels.back().empty()) levels.pop_back();
+
+		added_transforms->clear();
+		removed_transforms->clear();
+		relationship_tick = reg.tick<Relationship>();
+		levels_valid = true;
+		++rebuild_count;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include "tecs/entity.h"
+
+namespace adria
+{
+	namespace tecs
+	{
+		class registry;
+		class observer;
+	}
+
+	//Keeps the entities with a Transform bucketed by their depth in the hierarchy and refreshes the world transforms of the
+	//touched ones and their descendants, one level after the other. The buckets are only rebuilt when a Transform is added
+	//or removed or a Relationship changes, a frame without a touched Transform does nothing.
+	class TransformHierarchy
+	{
+		struct Node
+		{
+			tecs::entity entity;
+			tecs::entity parent;
+		};
+
+	public:
+		explicit TransformHierarchy(tecs::registry& reg);
+		~TransformHierarchy();
+
+		//returns false if nothing changed since the last update
+		Bool Update();
+
+		Uint32 GetLevelCount() const { return static_cast<Uint32>(levels.size()); }
+		Uint64 GetRebuildCount() const { return rebuild_count; }
+
+	private:
+		tecs::registry& reg;
+		std::vector<std::vector<Node>> levels;
+		tecs::observer* added_transforms = nullptr;
+		tecs::observer* removed_transforms = nullptr;
+		Uint64 transform_tick = 0;
+		Uint64 relationship_tick = 0;
+		Uint64 rebuild_count = 0;
+		Bool levels_valid = false;
+
+	private:
+		void Rebuild();
+	};
+}
@@ -27,6 +27,10 @@ struct ObjectData
 {
     row_major matrix model;
     row_major matrix transposedInverseModel;
+    float3 positionOffset;
+    float  _padd0;
+    float3 positionScale;
+    float  _padd1;
 };
 
 struct ShadowData
@@ -1,5 +1,17 @@
 #include <Common.hlsli>
+#if COMPRESSED
+#include <Util/VertexCompressionUtil.hlsli>
+#endif
 
+#if COMPRESSED
+struct VSInput
+{
+    float4 Position : POSITION; 
+    float2 Uvs      : TEX;
+    float2 Normal   : NORMAL;
+    float2 Tan      : TANGENT;
+};
+#else
 struct VSInput
 {
     float3 Position : POSITION; 
@@ -8,6 +20,7 @@ struct VSInput
     float3 Tan      : TANGENT;
     float3 Bitan    : BITANGENT;
 };
+#endif
 
 struct VSToPS
 {
@@ -24,16 +37,28 @@ struct VSToPS
 VSToPS GBufferVS(VSInput input)
 {
     VSToPS Output = (VSToPS)0;
+
+#if COMPRESSED
+    float3 position = DequantizePosition(input.Position.xyz);
+    float3 normal = OctahedralDecode(input.Normal);
+    float3 tangent = OctahedralDecode(input.Tan);
+    float3 bitangent = cross(normal, tangent) * TangentHandedness(input.Position.w);
+#else
+    float3 position = input.Position;
+    float3 normal = input.Normal;
+    float3 tangent = input.Tan;
+    float3 bitangent = input.Bitan;
+#endif
     
-    float4 pos = mul(float4(input.Position, 1.0), objectData.model);
+    float4 pos = mul(float4(position, 1.0), objectData.model);
     Output.Position = mul(pos, frameData.viewprojection);
     Output.Position.xy += frameData.cameraJitter * Output.Position.w;
     Output.Uvs = input.Uvs;
 
-    float3 worldSpaceNormal = mul(input.Normal, (float3x3) objectData.transposedInverseModel);
+    float3 worldSpaceNormal = mul(normal, (float3x3) objectData.transposedInverseModel);
     Output.NormalVS = mul(worldSpaceNormal, (float3x3) transpose(frameData.inverseView));
-    Output.TangentWS = mul(input.Tan, (float3x3) objectData.model);
-    Output.BitangentWS = mul(input.Bitan, (float3x3) objectData.model);
+    Output.TangentWS = mul(tangent, (float3x3) objectData.model);
+    Output.BitangentWS = mul(bitangent, (float3x3) objectData.model);
     Output.NormalWS = worldSpaceNormal;
 
     return Output;
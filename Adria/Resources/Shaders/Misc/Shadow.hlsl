@@ -1,10 +1,17 @@
 #include <Common.hlsli>
+#if COMPRESSED
+#include <Util/VertexCompressionUtil.hlsli>
+#endif
 
 Texture2D DiffuseTx : register(t0);
 
 struct VSInput
 {
+#if COMPRESSED
+    float4 Pos : POSITION;
+#else
     float3 Pos : POSITION;
+#endif
 #if TRANSPARENT
     float2 TexCoords : TEX;
 #endif
@@ -22,7 +29,11 @@ struct VSToPS
 VSToPS ShadowVS(VSInput input)
 {
     VSToPS output;
+#if COMPRESSED
+    float4 pos = float4(DequantizePosition(input.Pos.xyz), 1.0f);
+#else
     float4 pos = float4(input.Pos, 1.0f);
+#endif
     pos = mul(pos, objectData.model);
     pos = mul(pos, shadowData.lightViewProjection);
     output.Pos = pos;
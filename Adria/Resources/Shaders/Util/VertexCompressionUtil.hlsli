@@ -0,0 +1,27 @@
+#ifndef _VERTEX_COMPRESSION_UTIL_
+#define _VERTEX_COMPRESSION_UTIL_
+
+#include <Common.hlsli>
+
+//decoding side of Math/VertexCompression.cpp
+
+float3 OctahedralDecode(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+float3 DequantizePosition(float3 position)
+{
+    return objectData.positionOffset + position * objectData.positionScale;
+}
+
+//w of the unorm position is 0 or 1
+float TangentHandedness(float w)
+{
+    return w * 2.0f - 1.0f;
+}
+
+#endif
@@ -0,0 +1,298 @@
+#include <fstream>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Core/Paths.h"
+#include "Graphics/GfxDevice.h"
+#include "Rendering/BakedModel.h"
+#include "Rendering/ModelImporter.h"
+#include "Rendering/TextureManager.h"
+#include "tecs/registry.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/Image.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		struct ModelStartup
+		{
+			Uint64 entity_count = 0;
+			Float entities_s = 0.0f;  //until every entity and buffer is created
+			Float textures_s = 0.0f;  //until every texture mip is uploaded
+		};
+
+		std::vector<std::string> FindGLTFModels()
+		{
+			std::vector<std::string> models;
+			std::error_code error;
+			for (auto const& entry : fs::recursive_directory_iterator(paths::ModelsDir, error))
+			{
+				if (entry.is_regular_file() && GetExtension(entry.path().string()) == ".gltf") models.push_back(entry.path().string());
+			}
+			return models;
+		}
+
+		//every run gets a fresh registry and texture manager, so textures of an earlier run are not reused
+		template<typename LoadFunction>
+		ModelStartup MeasureStartup(GfxDevice* gfx, LoadFunction&& load)
+		{
+			tecs::registry reg;
+			ModelImporter importer(reg, gfx);
+			g_TextureManager.Initialize(gfx);
+			g_TextureManager.SetUploadBudget(Uint64(-1));
+
+			ModelStartup startup{};
+			AdriaTimer timer;
+			startup.entity_count = load(importer).size();
+			startup.entities_s = timer.ElapsedInSeconds();
+			while (g_TextureManager.IsStreaming()) g_TextureManager.Update();
+			startup.textures_s = timer.ElapsedInSeconds();
+
+			g_TextureManager.Destroy();
+			return startup;
+		}
+
+		//an empty directory under the system temporary directory
+		std::string MakeTempDir(std::string const& name)
+		{
+			fs::path const dir = fs::temp_directory_path() / name;
+			std::error_code error;
+			fs::remove_all(dir, error);
+			fs::create_directories(dir, error);
+			return dir.string() + "/";
+		}
+
+		std::vector<Uint8> ReadBytes(std::string const& path)
+		{
+			std::ifstream is(path, std::ios::binary);
+			return std::vector<Uint8>(std::istreambuf_iterator<Char>(is), std::istreambuf_iterator<Char>());
+		}
+
+		void WriteBytes(std::string const& path, std::vector<Uint8> const& bytes)
+		{
+			std::ofstream os(path, std::ios::binary | std::ios::trunc);
+			os.write(reinterpret_cast<Char const*>(bytes.data()), bytes.size());
+		}
+
+		//a quad under a root node with one textured material, its sources are a fake glTF, a buffer file and an 8x4 PNG
+		struct TestModel
+		{
+			std::string dir;
+			std::string gltf_path;
+			std::string buffer_path;
+			std::string texture_path;
+			std::string missing_texture_path;
+			std::vector<Uint8> pixels;
+			Float vertices[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+			Uint32 indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+			explicit TestModel(std::string const& dir_name) : dir(MakeTempDir(dir_name))
+			{
+				gltf_path = dir + "model.gltf";
+				buffer_path = dir + "model.bin";
+				texture_path = dir + "albedo.png";
+				missing_texture_path = dir + "missing.png";
+				WriteBytes(gltf_path, std::vector<Uint8>(64, 'g'));
+				WriteBytes(buffer_path, std::vector<Uint8>(128, 'b'));
+				for (Uint32 i = 0; i < 8 * 4; ++i) pixels.insert(pixels.end(), { Uint8(i * 8), Uint8(255 - i), Uint8(i), 255 });
+				WriteImagePNG(texture_path.c_str(), pixels, 8, 4);
+			}
+
+			BakedModelDesc Desc() const
+			{
+				BakedModelDesc desc{};
+				desc.key = 42;
+				desc.source_paths = { gltf_path, buffer_path };
+				desc.vertices = vertices;
+				desc.vertex_count = 4;
+				desc.vertex_stride = sizeof(vertices[0]);
+				desc.indices = indices;
+				desc.index_count = 6;
+
+				BakedMaterial& material = desc.materials.emplace_back();
+				material.textures[BakedTextureSlot_Albedo] = 0;
+				material.textures[BakedTextureSlot_Normal] = 1;
+				material.textures[BakedTextureSlot_MetallicRoughness] = BAKED_NONE;
+				material.textures[BakedTextureSlot_Emissive] = BAKED_NONE;
+				material.albedo_factor = 0.5f;
+				material.alpha_cutoff = 0.25f;
+				material.double_sided = 1;
+
+				BakedNode& root = desc.nodes.emplace_back();
+				root.parent = BAKED_NONE;
+				root.material = BAKED_NONE;
+				root.flags = BakedNodeFlag_Transform;
+				BakedNode& quad = desc.nodes.emplace_back();
+				quad.parent = 0;
+				quad.material = 0;
+				quad.flags = BakedNodeFlag_Mesh;
+				quad.indices_count = 6;
+				quad.vertex_count = 4;
+				desc.node_names = { "root", "quad" };
+				desc.texture_paths = { texture_path, missing_texture_path };
+				return desc;
+			}
+		};
+	}
+
+	//startup of every glTF model in the resources through the importer and through its baked package, on the null device.
+	//files are read from a warm OS cache in both runs, so this is the cost of parsing, optimizing and decoding that baking removes.
+	ADRIA_BENCHMARK(BakedModel_Startup)
+	{
+		TestJobSystemScope job_system_scope;
+		GfxDevice gfx(test_context.GetWindow(), true);
+
+		std::vector<std::string> const models = FindGLTFModels();
+		if (models.empty())
+		{
+			ADRIA_LOG(WARNING, "No glTF models found in %s!", paths::ModelsDir.c_str());
+			return;
+		}
+
+		//packages go to a temporary directory, so the benchmark doesn't replace the ones the engine loads
+		std::string const baked_dir = MakeTempDir("AdriaBakedModelStartup");
+		Float imported_total_s = 0.0f, baked_total_s = 0.0f;
+		for (std::string const& model_path : models)
+		{
+			ModelParameters params{};
+			params.model_path = model_path;
+			params.textures_path = GetParentPath(model_path) + "\\";
+			params.baked_dir = baked_dir;
+
+			ModelStartup const imported = MeasureStartup(&gfx, [&](ModelImporter& importer) { return importer.ImportModel_GLTF(params); });
+			ModelParameters bake_params = params;
+			bake_params.bake = true;
+			MeasureStartup(&gfx, [&](ModelImporter& importer) { return importer.ImportModel_GLTF(bake_params); });
+			ModelStartup const baked = MeasureStartup(&gfx, [&](ModelImporter& importer) { return importer.LoadModel_Baked(params); });
+
+			ADRIA_CHECK(baked.entity_count == imported.entity_count);
+			imported_total_s += imported.textures_s;
+			baked_total_s += baked.textures_s;
+			ADRIA_LOG(INFO, "%s, %llu entities: imported %.3f s (%.3f s with textures), baked %.3f s (%.3f s with textures)", model_path.c_str(),
+				imported.entity_count, imported.entities_s, imported.textures_s, baked.entities_s, baked.textures_s);
+		}
+		ADRIA_LOG(INFO, "%llu models: imported %.3f s, baked %.3f s (%.1fx)", (Uint64)models.size(), imported_total_s, baked_total_s,
+			imported_total_s / (std::max)(baked_total_s, 1e-3f));
+		std::error_code error;
+		fs::remove_all(baked_dir, error);
+	}
+
+	//everything written comes back from the mapped package, a texture that failed to decode is kept without mips
+	ADRIA_TEST(BakedModel_RoundTrip)
+	{
+		TestJobSystemScope job_system_scope;
+		TestModel model("AdriaBakedModelRoundTrip");
+		std::string const package_path = model.dir + "model.bin.baked";
+		ADRIA_CHECK(WriteBakedModel(package_path, model.Desc()));
+
+		BakedModelFile file(package_path);
+		ADRIA_CHECK(file.IsValid());
+		if (!file.IsValid()) return;
+		ADRIA_CHECK(!file.IsStale() && file.Header().key == 42 && file.Header().version == BAKED_MODEL_VERSION);
+		ADRIA_CHECK(file.VertexCount() == 4 && std::memcmp(file.Vertices(), model.vertices, sizeof(model.vertices)) == 0);
+		ADRIA_CHECK(file.IndexCount() == 6 && std::memcmp(file.Indices(), model.indices, sizeof(model.indices)) == 0);
+
+		ADRIA_CHECK(file.Materials().size() == 1);
+		BakedMaterial const& material = file.Materials()[0];
+		ADRIA_CHECK(material.textures[BakedTextureSlot_Albedo] == 0 && material.textures[BakedTextureSlot_Emissive] == BAKED_NONE);
+		ADRIA_CHECK(material.albedo_factor == 0.5f && material.alpha_cutoff == 0.25f && material.double_sided == 1);
+
+		ADRIA_CHECK(file.Nodes().size() == 2);
+		ADRIA_CHECK(file.String(file.Nodes()[0].name) == "root" && file.String(file.Nodes()[1].name) == "quad");
+		ADRIA_CHECK(file.Nodes()[1].parent == 0 && file.Nodes()[1].flags == BakedNodeFlag_Mesh && file.Nodes()[1].indices_count == 6);
+
+		ADRIA_CHECK(file.Textures().size() == 2);
+		BakedTexture const& texture = file.Textures()[0];
+		ADRIA_CHECK(file.String(texture.name) == model.texture_path && texture.mip_count == 4);
+		DecodedTextureView const view = file.Texture(texture);
+		ADRIA_CHECK(view.width == 8 && view.height == 4 && view.format == DecodedTextureFormat::RGBA8);
+		ADRIA_CHECK(view.mips[3].width == 1 && view.mips[3].height == 1 && view.mips[1].pitch == 16);
+		ADRIA_CHECK(std::memcmp(view.MipData(0), model.pixels.data(), model.pixels.size()) == 0);
+		ADRIA_CHECK(file.String(file.Textures()[1].name) == model.missing_texture_path && file.Textures()[1].mip_count == 0);
+
+		//the glTF, its buffer and both textures, the missing one too
+		ADRIA_CHECK(file.Sources().size() == 4 && file.String(file.Sources()[1].path) == model.buffer_path);
+		ADRIA_CHECK(file.Sources()[1].size == 128 && file.Sources()[3].size == 0);
+	}
+
+	//a change to any source makes the package stale: size, write time, a removed file or one that appears
+	ADRIA_TEST(BakedModel_Staleness)
+	{
+		TestJobSystemScope job_system_scope;
+		TestModel model("AdriaBakedModelStaleness");
+		std::string const package_path = model.dir + "model.bin.baked";
+		auto IsStale = [&]()
+		{
+			BakedModelFile file(package_path);
+			return file.IsValid() && file.IsStale();
+		};
+		auto Rebake = [&]()
+		{
+			WriteBakedModel(package_path, model.Desc());
+			return !IsStale();
+		};
+
+		ADRIA_CHECK(Rebake());
+		WriteBytes(model.buffer_path, std::vector<Uint8>(129, 'b'));
+		ADRIA_CHECK(IsStale());
+
+		ADRIA_CHECK(Rebake());
+		fs::last_write_time(model.texture_path, fs::last_write_time(model.texture_path) + std::chrono::hours(1));
+		ADRIA_CHECK(IsStale());
+
+		ADRIA_CHECK(Rebake());
+		fs::remove(model.gltf_path);
+		ADRIA_CHECK(IsStale());
+		WriteBytes(model.gltf_path, std::vector<Uint8>(64, 'g'));
+
+		ADRIA_CHECK(Rebake());
+		WriteImagePNG(model.missing_texture_path.c_str(), model.pixels, 8, 4);
+		ADRIA_CHECK(IsStale());
+	}
+
+	//damaged records are rejected when the package is mapped, before anything is created from it
+	ADRIA_TEST(BakedModel_Rejection)
+	{
+		TestJobSystemScope job_system_scope;
+		TestModel model("AdriaBakedModelRejection");
+		std::string const package_path = model.dir + "model.bin.baked";
+		ADRIA_CHECK(WriteBakedModel(package_path, model.Desc()));
+		std::vector<Uint8> const bytes = ReadBytes(package_path);
+
+		std::string const corrupted_path = model.dir + "corrupted.bin.baked";
+		auto IsValidAfter = [&](auto&& corrupt)
+		{
+			std::vector<Uint8> corrupted = bytes;
+			BakedModelHeader& header = *reinterpret_cast<BakedModelHeader*>(corrupted.data());
+			BakedTexture* textures = reinterpret_cast<BakedTexture*>(corrupted.data() + header.textures.offset);
+			TextureMip* mips = reinterpret_cast<TextureMip*>(corrupted.data() + header.texture_mips.offset);
+			BakedNode* nodes = reinterpret_cast<BakedNode*>(corrupted.data() + header.nodes.offset);
+			BakedMaterial* materials = reinterpret_cast<BakedMaterial*>(corrupted.data() + header.materials.offset);
+			BakedSource* sources = reinterpret_cast<BakedSource*>(corrupted.data() + header.sources.offset);
+			corrupt(corrupted, header, textures, mips, nodes, materials, sources);
+			WriteBytes(corrupted_path, corrupted);
+			return BakedModelFile(corrupted_path).IsValid();
+		};
+
+		ADRIA_CHECK(IsValidAfter([](auto&...) {}));
+		ADRIA_CHECK(!IsValidAfter([](auto&, BakedModelHeader& header, auto&...) { header.magic = 0; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, BakedModelHeader& header, auto&...) { header.version = BAKED_MODEL_VERSION - 1; }));
+		ADRIA_CHECK(!IsValidAfter([](std::vector<Uint8>& corrupted, BakedModelHeader& header, auto&...) { header.vertices.size = corrupted.size(); }));
+		ADRIA_CHECK(!IsValidAfter([](std::vector<Uint8>& corrupted, auto&...) { corrupted.resize(corrupted.size() - 1); }));
+
+		//texture records have to match what DecodeTexture produces for their size and format
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, BakedTexture* textures, auto&...) { textures[0].format = static_cast<Uint32>(DecodedTextureFormat::Count); }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, BakedTexture* textures, auto&...) { textures[0].format = static_cast<Uint32>(DecodedTextureFormat::RGBA16); }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, BakedTexture* textures, auto&...) { textures[0].width = 16; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, BakedTexture* textures, auto&...) { textures[0].mip_count = 5; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, TextureMip* mips, auto&...) { mips[1].width = 8; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, TextureMip* mips, auto&...) { mips[0].pitch -= 4; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, TextureMip* mips, auto&...) { mips[3].offset += 1024; }));
+
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, auto&, BakedNode* nodes, auto&...) { nodes[0].parent = 1; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, auto&, BakedNode* nodes, auto&...) { nodes[1].indices_count = 7; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, auto&, auto&, BakedMaterial* materials, auto&) { materials[0].textures[BakedTextureSlot_Emissive] = 2; }));
+		ADRIA_CHECK(!IsValidAfter([](auto&, auto&, auto&, auto&, auto&, auto&, BakedSource* sources) { sources[0].path.length = 1 << 20; }));
+	}
+}
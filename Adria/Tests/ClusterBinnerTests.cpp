@@ -0,0 +1,190 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Rendering/ClusterBinner.h"
+#include "Rendering/LightTable.h"
+#include "Rendering/Camera.h"
+#include "Rendering/Components.h"
+#include "tecs/registry.h"
+#include "Utilities/Random.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		struct BinnerTestScene
+		{
+			Uint32 light_count;
+			Float extent;
+			Float max_range;
+			Float fov;
+			Float aspect_ratio;
+			Float near_plane;
+			Float far_plane;
+			Uint32 width;
+			Uint32 height;
+		};
+
+		Camera MakeCamera(BinnerTestScene const& scene)
+		{
+			CameraParameters parameters{};
+			parameters.aspect_ratio = scene.aspect_ratio;
+			parameters.near_plane = scene.near_plane;
+			parameters.far_plane = scene.far_plane;
+			parameters.fov = scene.fov;
+			parameters.position = Vector3(0.0f, 0.0f, 0.0f);
+			parameters.look_at = Vector3(0.0f, 0.0f, 1.0f);
+			return Camera(parameters);
+		}
+
+		//mostly point and spot lights in front of the camera, a few directional, inactive and shadow casting ones the binner skips
+		void AddRandomLights(tecs::registry& reg, BinnerTestScene const& scene, Uint32 seed)
+		{
+			RealRandomGenerator<Float> position(-scene.extent, scene.extent, std::mt19937{ seed });
+			RealRandomGenerator<Float> depth(-20.0f, 2.0f * scene.extent, std::mt19937{ seed + 1 });
+			RealRandomGenerator<Float> range(0.5f, scene.max_range, std::mt19937{ seed + 2 });
+			RealRandomGenerator<Float> cosine(0.2f, 0.97f, std::mt19937{ seed + 3 });
+			RealRandomGenerator<Float> chance(0.0f, 1.0f, std::mt19937{ seed + 4 });
+			for (Uint32 i = 0; i < scene.light_count; ++i)
+			{
+				Light light{};
+				light.position = Vector4(position(), position(), depth(), 1.0f);
+				light.direction = Vector4(position(), position(), position(), 0.0f);
+				light.range = range();
+				Float const type = chance();
+				light.type = type < 0.01f ? LightType::Directional : type < 0.6f ? LightType::Point : LightType::Spot;
+				light.outer_cosine = cosine();
+				light.active = chance() > 0.05f;
+				light.casts_shadows = chance() < 0.05f;
+				reg.emplace<Light>(reg.create(), light);
+			}
+		}
+
+		//every cluster lists exactly the lights that pass the exact test against it, in table order
+		Bool MatchesBruteForce(ClusterBinner const& binner, LightTable const& table)
+		{
+			Uint64 index_count = 0;
+			for (Uint32 cluster = 0; cluster < ClusterBinner::CLUSTER_COUNT; ++cluster)
+			{
+				std::vector<Uint32> expected;
+				for (Uint32 i = 0; i < table.Size(); ++i)
+				{
+					if (ClusterBinner::LightIntersectsCluster(table.Data()[i], binner.Clusters()[cluster])) expected.push_back(i);
+				}
+				LightGrid const& grid = binner.LightGrids()[cluster];
+				if (grid.light_count != expected.size() || grid.offset + grid.light_count > binner.LightIndexList().size()) return false;
+				if (!std::equal(expected.begin(), expected.end(), binner.LightIndexList().begin() + grid.offset)) return false;
+				index_count += grid.light_count;
+			}
+			return index_count == binner.GetStats().light_indices;
+		}
+
+		//a point reached by a light has to find the light in the cluster the lighting pass picks for its pixel
+		Bool CoversShadedPoints(ClusterBinner const& binner, LightTable const& table, Camera const& camera, BinnerTestScene const& scene, Uint32 seed)
+		{
+			RealRandomGenerator<Float> random(0.0f, 1.0f, std::mt19937{ seed });
+			Matrix const inverse_projection = camera.Proj().Invert();
+			Float const near_plane = camera.Near(), far_plane = camera.Far();
+			Uint32 const tile_width = (Uint32)std::ceil(scene.width / Float(ClusterBinner::CLUSTER_SIZE_X));
+			Uint32 const tile_height = (Uint32)std::ceil(scene.height / Float(ClusterBinner::CLUSTER_SIZE_Y));
+			for (Uint32 sample = 0; sample < 20000; ++sample)
+			{
+				Float const pixel_x = random() * scene.width;
+				Float const pixel_y = random() * scene.height;
+				Float const depth = near_plane * std::pow(far_plane / near_plane, random());
+				Vector4 const ray = Vector4::Transform(Vector4(pixel_x / scene.width * 2.0f - 1.0f, 1.0f - pixel_y / scene.height * 2.0f, 1.0f, 1.0f), inverse_projection);
+				Vector3 const point(ray.x / ray.z * depth, ray.y / ray.z * depth, depth);
+
+				//same slice and tile as the lighting shader
+				Uint32 const slice = (Uint32)(std::max)((std::log2(depth) - std::log2(near_plane)) * ClusterBinner::CLUSTER_SIZE_Z / std::log2(far_plane / near_plane), 0.0f);
+				if (slice >= ClusterBinner::CLUSTER_SIZE_Z) continue;
+				LightGrid const& grid = binner.LightGrids()[ClusterBinner::ClusterIndex((Uint32)pixel_x / tile_width, (Uint32)pixel_y / tile_height, slice)];
+				auto const first = binner.LightIndexList().begin() + grid.offset;
+				auto const last = first + grid.light_count;
+
+				for (Uint32 i = 0; i < table.Size(); ++i)
+				{
+					LightSBuffer const& light = table.Data()[i];
+					if (!light.active || light.casts_shadows || light.type == static_cast<Int32>(LightType::Directional)) continue;
+					Vector3 const to_point = point - Vector3(light.position.x, light.position.y, light.position.z);
+					Float const distance = to_point.Length();
+					if (distance > light.range * 0.999f) continue;
+					if (light.type == static_cast<Int32>(LightType::Spot))
+					{
+						Vector3 const direction(light.direction.x, light.direction.y, light.direction.z);
+						if (to_point.Dot(direction) / (direction.Length() * distance) <= light.outer_cosine + 1e-4f) continue;
+					}
+					if (!std::binary_search(first, last, i)) return false;
+				}
+			}
+			return true;
+		}
+
+		void BuildTable(tecs::registry& reg, LightTable& table)
+		{
+			table.Sync(reg);
+			table.Transform(Matrix::Identity);
+		}
+	}
+
+	ADRIA_TEST(ClusterBinner_MatchesBruteForce)
+	{
+		TestJobSystemScope job_system_scope;
+		//few large lights, many lights spread far, many small lights close by, and an odd resolution
+		BinnerTestScene const scenes[] =
+		{
+			{ 200, 50.0f, 20.0f, 1.0f, 16.0f / 9.0f, 0.1f, 200.0f, 1920, 1080 },
+			{ 2000, 300.0f, 40.0f, 1.4f, 4.0f / 3.0f, 1.0f, 1000.0f, 1280, 1000 },
+			{ 5000, 30.0f, 5.0f, 0.7f, 1.0f, 0.5f, 100.0f, 1000, 1000 },
+			{ 50, 10.0f, 200.0f, 1.2f, 2.0f, 0.1f, 500.0f, 333, 177 },
+		};
+		Uint32 seed = 11;
+		for (BinnerTestScene const& scene : scenes)
+		{
+			tecs::registry reg;
+			AddRandomLights(reg, scene, seed++);
+			LightTable table;
+			BuildTable(reg, table);
+			Camera const camera = MakeCamera(scene);
+
+			ClusterBinner binner;
+			binner.Bin(camera, scene.width, scene.height, table);
+			ADRIA_CHECK(binner.Clusters().size() == ClusterBinner::CLUSTER_COUNT && binner.LightGrids().size() == ClusterBinner::CLUSTER_COUNT);
+			ADRIA_CHECK(MatchesBruteForce(binner, table));
+			ADRIA_CHECK(CoversShadedPoints(binner, table, camera, scene, seed++));
+
+			//binning again with the same clusters gives the same lists
+			std::vector<Uint32> const light_index_list(binner.LightIndexList().begin(), binner.LightIndexList().begin() + binner.GetStats().light_indices);
+			binner.Bin(camera, scene.width, scene.height, table);
+			ADRIA_CHECK(std::equal(light_index_list.begin(), light_index_list.end(), binner.LightIndexList().begin()));
+		}
+	}
+
+	ADRIA_BENCHMARK(ClusterBinner_20kLights)
+	{
+		constexpr Uint32 ITERATIONS = 20;
+		TestJobSystemScope job_system_scope;
+		BinnerTestScene const scene{ 20000, 400.0f, 15.0f, 1.0f, 16.0f / 9.0f, 0.5f, 800.0f, 1920, 1080 };
+		tecs::registry reg;
+		AddRandomLights(reg, scene, 7);
+		LightTable table;
+		BuildTable(reg, table);
+		Camera const camera = MakeCamera(scene);
+
+		ClusterBinner binner;
+		binner.Bin(camera, scene.width, scene.height, table);
+		Timer<std::chrono::microseconds> bin_timer;
+		for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration) binner.Bin(camera, scene.width, scene.height, table);
+		Float const bin_ms = bin_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+		//what the compute culling pass does: every light against every cluster
+		Timer<std::chrono::microseconds> brute_force_timer;
+		ADRIA_CHECK(MatchesBruteForce(binner, table));
+		Float const brute_force_ms = brute_force_timer.Elapsed() / 1000.0f;
+
+		ClusterBinnerStats const& stats = binner.GetStats();
+		ADRIA_LOG(INFO, "%u lights on %u threads: binner %.3f ms, per cluster brute force %.1f ms (%.1fx), %u binned, %u indices, at most %u per cluster",
+			scene.light_count, std::thread::hardware_concurrency(), bin_ms, brute_force_ms, brute_force_ms / (std::max)(bin_ms, 1e-3f),
+			stats.binned_lights, stats.light_indices, stats.max_cluster_lights);
+	}
+}
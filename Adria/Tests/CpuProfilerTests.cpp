@@ -0,0 +1,179 @@
+#include <fstream>
+#include <sstream>
+#include "TestRegistry.h"
+#include "Core/CpuProfiler.h"
+#include "Core/Logger.h"
+#include "Core/Paths.h"
+#include "Utilities/JsonUtil.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		//complete events of the trace, without the thread name metadata
+		std::vector<json> ReadTraceEvents(std::string const& path, std::map<Uint32, std::string>* thread_names = nullptr)
+		{
+			std::ifstream is(path);
+			std::stringstream ss;
+			ss << is.rdbuf();
+			json trace = json::parse(ss.str(), nullptr, false);
+			std::vector<json> events;
+			if (trace.is_discarded()) return events;
+			for (json const& event : trace["traceEvents"])
+			{
+				if (event["ph"] == "X") events.push_back(event);
+				else if (thread_names) (*thread_names)[event["tid"].get<Uint32>()] = event["args"]["name"].get<std::string>();
+			}
+			return events;
+		}
+
+		Bool Contains(json const& outer, json const& inner)
+		{
+			Float64 const outer_begin = outer["ts"].get<Float64>(), inner_begin = inner["ts"].get<Float64>();
+			return outer_begin <= inner_begin && inner_begin + inner["dur"].get<Float64>() <= outer_begin + outer["dur"].get<Float64>() + 1e-3;
+		}
+	}
+
+	//scopes record their depth on the thread and the frame they ended in, a scope ends after the ones nested in it
+	ADRIA_TEST(CpuProfiler_Nesting)
+	{
+		std::string const trace_path = paths::SavedDir + "CpuProfilerNestingTest.json";
+		g_CpuProfiler.StartCapture(2, trace_path);
+		for (Uint32 frame = 0; frame < 2; ++frame)
+		{
+			AdriaCpuProfileScope("Outer");
+			{
+				AdriaCpuProfileScope("Middle");
+				AdriaCpuProfileScope("Inner");
+			}
+			AdriaCpuProfileScope("Sibling");
+		}
+		g_CpuProfiler.NewFrame();
+		ADRIA_CHECK(g_CpuProfiler.IsCapturing());
+		{
+			AdriaCpuProfileScope("Outer");
+		}
+		g_CpuProfiler.NewFrame();
+		ADRIA_CHECK(!g_CpuProfiler.IsCapturing());
+		{
+			AdriaCpuProfileScope("NotCaptured");
+		}
+
+		std::vector<json> const events = ReadTraceEvents(trace_path);
+		std::vector<std::string> names;
+		for (json const& event : events) names.push_back(event["name"].get<std::string>());
+		std::vector<std::string> const expected_names = { "Inner", "Middle", "Sibling", "Outer", "Inner", "Middle", "Sibling", "Outer", "Frame", "Outer", "Frame" };
+		ADRIA_CHECK(names == expected_names);
+		if (names != expected_names) return;
+
+		Uint32 const expected_depths[] = { 2, 1, 1, 0, 2, 1, 1, 0, 0, 0, 0 };
+		Uint32 const expected_frames[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 };
+		Bool depths_valid = true, frames_valid = true;
+		for (Uint64 i = 0; i < events.size(); ++i)
+		{
+			depths_valid = depths_valid && events[i]["args"]["depth"].get<Uint32>() == expected_depths[i];
+			frames_valid = frames_valid && events[i]["args"]["frame"].get<Uint32>() == expected_frames[i];
+		}
+		ADRIA_CHECK(depths_valid && frames_valid);
+		ADRIA_CHECK(Contains(events[1], events[0]) && Contains(events[3], events[1]) && Contains(events[3], events[2]));
+		ADRIA_CHECK(Contains(events[8], events[3]) && Contains(events[8], events[7]) && Contains(events[10], events[9]));
+		ADRIA_CHECK(events[0]["cat"] == "cpu" && events[8]["cat"] == "frame" && events[0]["tid"] == events[8]["tid"]);
+	}
+
+	//every thread records into its own buffer, depths are counted per thread and each buffer is named after its thread
+	ADRIA_TEST(CpuProfiler_Threads)
+	{
+		constexpr Uint32 THREAD_COUNT = 4;
+		constexpr Uint32 SCOPES_PER_THREAD = 100;
+		std::string const trace_path = paths::SavedDir + "CpuProfilerThreadsTest.json";
+		g_CpuProfiler.StartCapture(1, trace_path);
+		{
+			AdriaCpuProfileScope("Spawn");
+			std::vector<std::thread> threads;
+			for (Uint32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threads.emplace_back([i]()
+					{
+						g_CpuProfiler.SetThreadName("Test Thread " + std::to_string(i));
+						//thread i records i + 1 scopes per iteration, nested i deep
+						for (Uint32 j = 0; j < SCOPES_PER_THREAD; ++j)
+						{
+							AdriaCpuProfileScope("Job");
+							if (i > 0) { AdriaCpuProfileScope("Work"); if (i > 1) { AdriaCpuProfileScope("Work"); if (i > 2) { AdriaCpuProfileScope("Work"); } } }
+						}
+					});
+			}
+			for (std::thread& thread : threads) thread.join();
+		}
+		g_CpuProfiler.NewFrame();
+		ADRIA_CHECK(!g_CpuProfiler.IsCapturing());
+
+		std::map<Uint32, std::string> thread_names;
+		std::vector<json> const events = ReadTraceEvents(trace_path, &thread_names);
+		std::map<std::string, Uint32> scope_counts;
+		std::map<std::string, Uint32> max_depths;
+		Uint32 spawn_tid = ~0u;
+		for (json const& event : events)
+		{
+			Uint32 const tid = event["tid"].get<Uint32>();
+			std::string const& thread_name = thread_names[tid];
+			if (event["name"] == "Spawn") spawn_tid = tid;
+			if (event["name"] == "Job" || event["name"] == "Work")
+			{
+				++scope_counts[thread_name];
+				max_depths[thread_name] = (std::max)(max_depths[thread_name], event["args"]["depth"].get<Uint32>());
+			}
+		}
+		Bool threads_valid = scope_counts.size() == THREAD_COUNT;
+		for (Uint32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			std::string const thread_name = "Test Thread " + std::to_string(i);
+			threads_valid = threads_valid && scope_counts[thread_name] == (i + 1) * SCOPES_PER_THREAD && max_depths[thread_name] == i;
+		}
+		ADRIA_CHECK(threads_valid);
+		//the spawning thread's open scope doesn't nest the scopes of other threads
+		ADRIA_CHECK(spawn_tid != ~0u && !thread_names[spawn_tid].starts_with("Test Thread"));
+	}
+
+	//cost of a scope while capturing and while not, a capture is split so that no scope is dropped
+	ADRIA_BENCHMARK(CpuProfiler_ScopeCost)
+	{
+		constexpr Uint32 SCOPES_PER_CAPTURE = 60000;
+		constexpr Uint32 CAPTURE_COUNT = 16;
+		constexpr Float TARGET_NS = 50.0f;
+
+		Timer<std::chrono::nanoseconds> timer;
+		for (Uint32 i = 0; i < SCOPES_PER_CAPTURE * CAPTURE_COUNT; ++i)
+		{
+			AdriaCpuProfileScope("Idle");
+		}
+		Float const idle_ns = (Float)timer.Mark() / (SCOPES_PER_CAPTURE * CAPTURE_COUNT);
+
+		//a recorded scope reads the clock twice, which is most of its cost on some machines
+		Int64 clock_sum = 0;
+		for (Uint32 i = 0; i < SCOPES_PER_CAPTURE * CAPTURE_COUNT; ++i) clock_sum += CpuProfiler::Now();
+		Float const clock_ns = (Float)timer.Mark() / (SCOPES_PER_CAPTURE * CAPTURE_COUNT);
+
+		//the first capture of a thread allocates its buffer and is not measured
+		std::string const trace_path = paths::SavedDir + "CpuProfilerBenchmark.json";
+		Float64 capturing_ns = 0.0;
+		for (Uint32 capture = 0; capture <= CAPTURE_COUNT; ++capture)
+		{
+			g_CpuProfiler.StartCapture(1, trace_path);
+			timer.Mark();
+			for (Uint32 i = 0; i < SCOPES_PER_CAPTURE; ++i)
+			{
+				AdriaCpuProfileScope("Scope");
+			}
+			if (capture > 0) capturing_ns += timer.Mark();
+			g_CpuProfiler.StopCapture();
+		}
+		Float const scope_ns = (Float)(capturing_ns / (SCOPES_PER_CAPTURE * CAPTURE_COUNT));
+
+		ADRIA_CHECK(ReadTraceEvents(trace_path).size() == SCOPES_PER_CAPTURE && clock_sum != 0);
+		ADRIA_LOG(INFO, "CPU profile scope: %.1f ns while capturing, %.1f ns while not (target %.0f ns), a clock read takes %.1f ns",
+			scope_ns, idle_ns, TARGET_NS, clock_ns);
+		if (scope_ns > TARGET_NS) ADRIA_LOG(WARNING, "CPU profile scope costs %.1f ns, over the %.0f ns target", scope_ns, TARGET_NS);
+	}
+}
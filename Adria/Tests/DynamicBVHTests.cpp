@@ -0,0 +1,283 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Math/DynamicBVH.h"
+#include "Utilities/Random.h"
+#include "Utilities/Timer.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint64 NO_HIT = ~0ull;
+
+		//boxes[i] is the tight box of proxies[i], removed boxes have proxies[i] == NULL_NODE
+		struct BVHTestScene
+		{
+			DynamicBVH bvh;
+			std::vector<BoundingBox> boxes;
+			std::vector<Int32> proxies;
+		};
+
+		BoundingBox RandomBox(RealRandomGenerator<Float>& position, RealRandomGenerator<Float>& extent)
+		{
+			return BoundingBox(Vector3(position(), position(), position()), Vector3(extent(), extent(), extent()));
+		}
+
+		void BuildScene(BVHTestScene& scene, Uint32 count, Uint32 seed)
+		{
+			RealRandomGenerator<Float> position(-500.0f, 500.0f, std::mt19937{ seed });
+			RealRandomGenerator<Float> extent(0.1f, 10.0f, std::mt19937{ seed + 1 });
+			scene.boxes.resize(count);
+			scene.proxies.resize(count);
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				scene.boxes[i] = RandomBox(position, extent);
+				scene.proxies[i] = scene.bvh.Insert(scene.boxes[i], i);
+			}
+		}
+
+		BoundingFrustum MakeFrustum(Vector3 const& eye, Vector3 const& target)
+		{
+			Matrix const view = XMMatrixLookAtLH(eye, target, Vector3::Up);
+			BoundingFrustum frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 300.0f));
+			frustum.Transform(frustum, view.Invert());
+			return frustum;
+		}
+
+		template<typename V>
+		std::vector<Uint64> QueryBVH(BVHTestScene const& scene, V const& volume)
+		{
+			std::vector<Uint64> result;
+			scene.bvh.Query(volume, [&](Uint64 user_data) { result.push_back(user_data); });
+			std::sort(result.begin(), result.end());
+			return result;
+		}
+
+		template<typename V>
+		std::vector<Uint64> QueryBruteForce(BVHTestScene const& scene, V const& volume)
+		{
+			std::vector<Uint64> result;
+			for (Uint64 i = 0; i < scene.boxes.size(); ++i)
+			{
+				if (scene.proxies[i] != DynamicBVH::NULL_NODE && volume.Contains(scene.boxes[i]) != DISJOINT) result.push_back(i);
+			}
+			return result;
+		}
+
+		Uint64 RayCastBVH(BVHTestScene const& scene, Vector3 const& origin, Vector3 const& direction, Float max_distance, Float& hit_distance)
+		{
+			Uint64 hit = NO_HIT;
+			hit_distance = max_distance;
+			scene.bvh.RayCast(origin, direction, max_distance, [&](Uint64 user_data, Float distance)
+				{
+					if (distance < hit_distance)
+					{
+						hit = user_data;
+						hit_distance = distance;
+					}
+					return hit_distance;
+				});
+			return hit;
+		}
+
+		Uint64 RayCastBruteForce(BVHTestScene const& scene, Vector3 const& origin, Vector3 const& direction, Float max_distance, Float& hit_distance)
+		{
+			XMVECTOR const ray_direction = XMVector3Normalize(direction);
+			Uint64 hit = NO_HIT;
+			hit_distance = max_distance;
+			for (Uint64 i = 0; i < scene.boxes.size(); ++i)
+			{
+				Float distance = 0.0f;
+				if (scene.proxies[i] == DynamicBVH::NULL_NODE || !scene.boxes[i].Intersects(origin, ray_direction, distance)) continue;
+				distance = (std::max)(distance, 0.0f);
+				if (distance < hit_distance)
+				{
+					hit = i;
+					hit_distance = distance;
+				}
+			}
+			return hit;
+		}
+
+		//every query type against a linear scan over the tight boxes
+		void CheckQueries(TestContext& test_context, BVHTestScene const& scene, Uint32 seed)
+		{
+			RealRandomGenerator<Float> position(-500.0f, 500.0f, std::mt19937{ seed });
+			RealRandomGenerator<Float> size(5.0f, 150.0f, std::mt19937{ seed + 1 });
+			for (Uint32 i = 0; i < 16; ++i)
+			{
+				BoundingFrustum const frustum = MakeFrustum(Vector3(position(), position(), position()), Vector3(position(), position(), position()));
+				ADRIA_CHECK(QueryBVH(scene, frustum) == QueryBruteForce(scene, frustum));
+
+				BoundingBox const box(Vector3(position(), position(), position()), Vector3(size(), size(), size()));
+				ADRIA_CHECK(QueryBVH(scene, box) == QueryBruteForce(scene, box));
+
+				BoundingSphere const sphere(Vector3(position(), position(), position()), size());
+				ADRIA_CHECK(QueryBVH(scene, sphere) == QueryBruteForce(scene, sphere));
+
+				Vector3 const origin(position(), position(), position());
+				Vector3 const direction = Vector3(position(), position(), position()) - origin;
+				Float bvh_distance = 0.0f, brute_force_distance = 0.0f;
+				Uint64 const bvh_hit = RayCastBVH(scene, origin, direction, 2000.0f, bvh_distance);
+				Uint64 const brute_force_hit = RayCastBruteForce(scene, origin, direction, 2000.0f, brute_force_distance);
+				//two boxes at the same distance may both be the closest one, so only the distances have to agree
+				ADRIA_CHECK((bvh_hit == NO_HIT) == (brute_force_hit == NO_HIT));
+				ADRIA_CHECK(bvh_distance == brute_force_distance);
+
+				//from inside a box, which is hit at distance 0
+				Uint64 const inside = i * 7919 % scene.boxes.size();
+				if (scene.proxies[inside] == DynamicBVH::NULL_NODE) continue;
+				Uint64 const inside_hit = RayCastBVH(scene, scene.boxes[inside].Center, direction, 2000.0f, bvh_distance);
+				ADRIA_CHECK(inside_hit != NO_HIT && bvh_distance == 0.0f);
+				ADRIA_CHECK(RayCastBruteForce(scene, scene.boxes[inside].Center, direction, 2000.0f, brute_force_distance) != NO_HIT && brute_force_distance == 0.0f);
+			}
+		}
+
+		//AVL style rotations keep the tree within a small factor of the optimal height
+		Bool IsBalanced(DynamicBVH const& bvh)
+		{
+			Uint32 const count = bvh.GetProxyCount();
+			if (count < 2) return true;
+			Int32 const optimal_height = (Int32)std::ceil(std::log2((Float)count));
+			return bvh.GetHeight() <= 2 * optimal_height + 1;
+		}
+	}
+
+	ADRIA_TEST(DynamicBVH_MatchesBruteForce)
+	{
+		for (Uint32 count : { 1u, 2u, 17u, 5000u })
+		{
+			BVHTestScene scene;
+			BuildScene(scene, count, count + 3);
+			ADRIA_CHECK(scene.bvh.GetProxyCount() == count);
+			ADRIA_CHECK(IsBalanced(scene.bvh));
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				ADRIA_CHECK(scene.bvh.GetUserData(scene.proxies[i]) == i);
+				ADRIA_CHECK(scene.bvh.GetFatBox(scene.proxies[i]).Contains(scene.boxes[i]) == CONTAINS);
+			}
+			CheckQueries(test_context, scene, count);
+		}
+	}
+
+	//picking from inside a large box: the box is reported at distance 0 without ending the traversal, so the nearest box in front is found
+	ADRIA_TEST(DynamicBVH_RayCastFromInside)
+	{
+		BVHTestScene scene;
+		scene.boxes = { BoundingBox(Vector3(0.0f, 0.0f, 0.0f), Vector3(100.0f, 100.0f, 100.0f)), BoundingBox(Vector3(0.0f, 0.0f, 80.0f), Vector3(1.0f, 1.0f, 1.0f)),
+						BoundingBox(Vector3(0.0f, 0.0f, 50.0f), Vector3(1.0f, 1.0f, 1.0f)), BoundingBox(Vector3(0.0f, 0.0f, -50.0f), Vector3(1.0f, 1.0f, 1.0f)),
+						BoundingBox(Vector3(40.0f, 0.0f, 30.0f), Vector3(1.0f, 1.0f, 1.0f)) };
+		for (Uint64 i = 0; i < scene.boxes.size(); ++i) scene.proxies.push_back(scene.bvh.Insert(scene.boxes[i], i));
+
+		Vector3 const origin(0.0f, 0.0f, 0.0f), direction(0.0f, 0.0f, 1.0f);
+		std::vector<std::pair<Uint64, Float>> reported;
+		Uint64 nearest = NO_HIT;
+		Float nearest_distance = 1000.0f;
+		scene.bvh.RayCast(origin, direction, nearest_distance, [&](Uint64 user_data, Float distance)
+			{
+				reported.emplace_back(user_data, distance);
+				if (distance > 0.0f && distance < nearest_distance)
+				{
+					nearest = user_data;
+					nearest_distance = distance;
+				}
+				return nearest_distance;
+			});
+		ADRIA_CHECK(nearest == 2 && nearest_distance == 49.0f);
+		ADRIA_CHECK(std::find(reported.begin(), reported.end(), std::pair<Uint64, Float>(0, 0.0f)) != reported.end());
+		Bool behind_reported = false;
+		for (auto const& [user_data, distance] : reported) behind_reported = behind_reported || user_data == 3 || user_data == 4 || distance < 0.0f;
+		ADRIA_CHECK(!behind_reported);
+
+		//a callback returning 0 keeps looking for other boxes around the origin, a negative one stops
+		Float hit_distance = 0.0f;
+		ADRIA_CHECK(RayCastBVH(scene, origin, direction, 1000.0f, hit_distance) == 0 && hit_distance == 0.0f);
+		Uint32 callbacks = 0;
+		scene.bvh.RayCast(origin, direction, 1000.0f, [&](Uint64, Float) { ++callbacks; return -1.0f; });
+		ADRIA_CHECK(callbacks == 1);
+	}
+
+	ADRIA_TEST(DynamicBVH_MoveAndRemove)
+	{
+		constexpr Uint32 COUNT = 5000;
+		BVHTestScene scene;
+		BuildScene(scene, COUNT, 11);
+
+		RealRandomGenerator<Float> jitter(-0.05f, 0.05f, std::mt19937{ 12 });
+		RealRandomGenerator<Float> position(-500.0f, 500.0f, std::mt19937{ 13 });
+		RealRandomGenerator<Float> extent(0.1f, 10.0f, std::mt19937{ 14 });
+		//small moves stay inside the fat box, teleports have to reinsert the leaf
+		Uint32 reinserted = 0;
+		for (Uint32 frame = 0; frame < 10; ++frame)
+		{
+			for (Uint32 i = 0; i < COUNT; ++i)
+			{
+				if (i % 10 == frame) scene.boxes[i] = RandomBox(position, extent);
+				else scene.boxes[i].Center = Vector3(scene.boxes[i].Center) + Vector3(jitter(), jitter(), jitter());
+				reinserted += scene.bvh.Move(scene.proxies[i], scene.boxes[i]);
+				ADRIA_CHECK(scene.bvh.GetFatBox(scene.proxies[i]).Contains(scene.boxes[i]) == CONTAINS);
+			}
+		}
+		ADRIA_CHECK(reinserted >= COUNT * 9 / 10);
+		ADRIA_CHECK(IsBalanced(scene.bvh));
+		CheckQueries(test_context, scene, 21);
+
+		for (Uint32 i = 0; i < COUNT; i += 2)
+		{
+			scene.bvh.Remove(scene.proxies[i]);
+			scene.proxies[i] = DynamicBVH::NULL_NODE;
+		}
+		ADRIA_CHECK(scene.bvh.GetProxyCount() == COUNT / 2);
+		CheckQueries(test_context, scene, 22);
+
+		//freed nodes are reused by new proxies
+		for (Uint32 i = 0; i < COUNT; i += 2)
+		{
+			scene.boxes[i] = RandomBox(position, extent);
+			scene.proxies[i] = scene.bvh.Insert(scene.boxes[i], i);
+		}
+		ADRIA_CHECK(scene.bvh.GetProxyCount() == COUNT);
+		ADRIA_CHECK(IsBalanced(scene.bvh));
+		CheckQueries(test_context, scene, 23);
+
+		scene.bvh.Clear();
+		std::fill(scene.proxies.begin(), scene.proxies.end(), DynamicBVH::NULL_NODE);
+		ADRIA_CHECK(scene.bvh.GetProxyCount() == 0 && scene.bvh.GetHeight() == 0);
+		CheckQueries(test_context, scene, 24);
+	}
+
+	ADRIA_BENCHMARK(DynamicBVH_Queries)
+	{
+		constexpr Uint32 ITERATIONS = 20;
+		for (Uint32 count : { 10000u, 100000u, 1000000u })
+		{
+			BVHTestScene scene;
+			Timer<std::chrono::microseconds> build_timer;
+			BuildScene(scene, count, 5);
+			Float const build_ms = build_timer.Elapsed() / 1000.0f;
+
+			//a narrow frustum sees a small part of the scene, which is where the tree pays off
+			BoundingFrustum const frustum = MakeFrustum(Vector3(0.0f, 0.0f, -600.0f), Vector3(0.0f, 0.0f, 0.0f));
+			Uint64 brute_force_visible = 0;
+			Timer<std::chrono::microseconds> brute_force_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration) brute_force_visible += QueryBruteForce(scene, frustum).size();
+			Float const brute_force_ms = brute_force_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+			Uint64 bvh_visible = 0;
+			Timer<std::chrono::microseconds> bvh_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration) scene.bvh.Query(frustum, [&](Uint64) { ++bvh_visible; });
+			Float const bvh_ms = bvh_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+			Float hit_distance = 0.0f;
+			Timer<std::chrono::microseconds> ray_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration) RayCastBVH(scene, Vector3(0.0f, 0.0f, -600.0f), Vector3(0.01f, 0.02f, 1.0f), 2000.0f, hit_distance);
+			Float const ray_ms = ray_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+			ADRIA_CHECK(bvh_visible == brute_force_visible);
+			ADRIA_LOG(INFO, "%u boxes: build %.3f ms, height %d, frustum brute force %.3f ms, BVH %.3f ms (%llu visible, %.1fx), ray cast %.4f ms",
+				count, build_ms, scene.bvh.GetHeight(), brute_force_ms, bvh_ms, bvh_visible / ITERATIONS, brute_force_ms / (std::max)(bvh_ms, 1e-3f), ray_ms);
+		}
+	}
+}
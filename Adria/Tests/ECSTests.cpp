@@ -0,0 +1,561 @@
+#include <map>
+#include <set>
+#include <random>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "tecs/registry.h"
+#include "tecs/scheduler.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		struct IntComponent { Int32 value; };
+		struct FloatComponent { Float value; };
+		struct OtherIntComponent { Int32 value; };
+		struct UnownedComponent { Int32 value; };
+
+		//component data sized like the renderer's, which is what a group iterating packed arrays pays off for
+		struct TransformComponent { Float matrix[16]; };
+		struct MaterialComponent { Float values[12]; };
+		struct BoundsComponent { Float values[8]; Bool visible; };
+		struct MeshComponent { Float values[32]; };
+		struct TagComponent {};
+
+		//tecs runs par_each and scheduler batches through the job system, as the engine sets it up
+		struct TecsJobSystemScope
+		{
+			TestJobSystemScope job_system_scope;
+
+			TecsJobSystemScope()
+			{
+				tecs::set_parallel_for([](size_t count, size_t grain, void* context, tecs::parallel_body body)
+					{
+						g_JobSystem.ParallelFor((Uint32)count, (Uint32)grain, [context, body](Uint32 begin, Uint32 end) { body(context, begin, end); });
+					});
+			}
+			~TecsJobSystemScope()
+			{
+				tecs::set_parallel_for(nullptr);
+			}
+		};
+
+		//every entity in the view is in the group and the group's arrays stay aligned with each other
+		Bool GroupMatchesView(tecs::registry& reg, tecs::group_view<IntComponent, FloatComponent, OtherIntComponent>& group)
+		{
+			std::set<tecs::entity> expected, members;
+			for (tecs::entity e : reg.view<IntComponent, FloatComponent, OtherIntComponent>()) expected.insert(e);
+			for (tecs::entity e : group) members.insert(e);
+			if (expected != members || group.size() != expected.size()) return false;
+
+			Bool aligned = true;
+			group.each([&](tecs::entity e, IntComponent& a, FloatComponent& b, OtherIntComponent& c)
+				{
+					Int32 const index = (Int32)tecs::get_index(e);
+					aligned = aligned && a.value == index && (Int32)b.value == index && c.value == index && &reg.get<IntComponent>(e) == &a;
+				});
+			return aligned;
+		}
+	}
+
+	ADRIA_TEST(ECS_GroupMatchesView)
+	{
+		tecs::registry reg;
+		std::mt19937 rng(1);
+		std::vector<tecs::entity> entities;
+		for (Int32 i = 0; i < 2000; ++i)
+		{
+			tecs::entity e = reg.create();
+			entities.push_back(e);
+			if (rng() % 2) reg.emplace<IntComponent>(e, i);
+			if (rng() % 3) reg.emplace<FloatComponent>(e, (Float)i);
+			if (rng() % 2) reg.emplace<OtherIntComponent>(e, i);
+		}
+
+		auto group = reg.group<IntComponent, FloatComponent, OtherIntComponent>();
+		ADRIA_CHECK(GroupMatchesView(reg, group));
+
+		//random churn of owned and unowned components and entity destruction
+		for (Uint32 iteration = 0; iteration < 20000; ++iteration)
+		{
+			tecs::entity e = entities[rng() % entities.size()];
+			if (!reg.valid(e)) continue;
+			Int32 const index = (Int32)tecs::get_index(e);
+			switch (rng() % 7)
+			{
+			case 0: if (!reg.has<IntComponent>(e)) reg.emplace<IntComponent>(e, index); break;
+			case 1: if (reg.has<IntComponent>(e)) reg.remove<IntComponent>(e); break;
+			case 2: if (!reg.has<FloatComponent>(e)) reg.add<FloatComponent>(e, FloatComponent{ (Float)index }); break;
+			case 3: if (reg.has<OtherIntComponent>(e)) reg.remove<OtherIntComponent>(e); break;
+			case 4: if (!reg.has<OtherIntComponent>(e)) reg.emplace<OtherIntComponent>(e, index); break;
+			case 5: if (rng() % 20 == 0) reg.destroy(e); break;
+			case 6: if (!reg.has<UnownedComponent>(e)) reg.emplace<UnownedComponent>(e, index); break;
+			}
+			if (iteration % 1000 == 0) ADRIA_CHECK(GroupMatchesView(reg, group));
+		}
+		ADRIA_CHECK(GroupMatchesView(reg, group));
+
+		//asking again returns a view of the same group
+		auto same_group = reg.group<IntComponent, FloatComponent, OtherIntComponent>();
+		ADRIA_CHECK(same_group.size() == group.size());
+
+		reg.clear<FloatComponent>();
+		ADRIA_CHECK(group.size() == 0);
+		ADRIA_CHECK(GroupMatchesView(reg, group));
+	}
+
+	ADRIA_TEST(ECS_GroupLifetime)
+	{
+		tecs::registry reg;
+		for (Int32 i = 0; i < 100; ++i)
+		{
+			tecs::entity e = reg.create();
+			reg.emplace<IntComponent>(e, i);
+			if (i % 2) reg.emplace<FloatComponent>(e, (Float)i);
+			if (i % 3) reg.emplace<OtherIntComponent>(e, i);
+		}
+
+		//creating the group only reorders the pools, no component was added
+		tecs::observer& added = reg.on_added<IntComponent>();
+		tecs::observer& float_added = reg.on_added<FloatComponent>();
+		auto group = reg.group<IntComponent, FloatComponent, OtherIntComponent>();
+		ADRIA_CHECK(group.size() == 33);
+		ADRIA_CHECK(added.empty() && float_added.empty());
+		ADRIA_CHECK(GroupMatchesView(reg, group));
+
+		tecs::entity const e = reg.create();
+		reg.emplace<FloatComponent>(e, (Float)tecs::get_index(e));
+		reg.emplace<OtherIntComponent>(e, (Int32)tecs::get_index(e));
+		reg.emplace<IntComponent>(e, (Int32)tecs::get_index(e));
+		ADRIA_CHECK(added.size() == 1 && added.contains(e) && float_added.size() == 1);
+		ADRIA_CHECK(group.size() == 34 && group.contains(e));
+
+		//clearing the registry empties the group, the view created before keeps working
+		reg.clear();
+		ADRIA_CHECK(group.size() == 0 && group.begin() == group.end());
+		for (Int32 i = 0; i < 10; ++i)
+		{
+			tecs::entity f = reg.create();
+			reg.emplace<IntComponent>(f, i);
+			reg.emplace<FloatComponent>(f, (Float)i);
+			reg.emplace<OtherIntComponent>(f, i);
+		}
+		ADRIA_CHECK(group.size() == 10);
+		ADRIA_CHECK(GroupMatchesView(reg, group));
+		ADRIA_CHECK((reg.group<IntComponent, FloatComponent, OtherIntComponent>().size() == 10));
+	}
+
+	ADRIA_TEST(ECS_ObserverRecycledEntities)
+	{
+		tecs::registry reg;
+		tecs::observer& added = reg.on_added<IntComponent>();
+		tecs::observer& removed = reg.on_removed<IntComponent>();
+		std::vector<tecs::entity> entities;
+		for (Int32 i = 0; i < 8; ++i)
+		{
+			entities.push_back(reg.create());
+			reg.emplace<IntComponent>(entities.back(), i);
+		}
+
+		//the destroyed entity stays listed when its slot is reused by an entity that changes too
+		tecs::entity const destroyed = entities[3];
+		reg.destroy(destroyed);
+		ADRIA_CHECK(removed.size() == 1 && removed.contains(destroyed));
+		tecs::entity const recycled = reg.create();
+		ADRIA_CHECK(tecs::get_index(recycled) == tecs::get_index(destroyed));
+		reg.emplace<IntComponent>(recycled, 3);
+		ADRIA_CHECK(added.size() == 9 && added.contains(recycled) && added.contains(destroyed));
+		reg.remove<IntComponent>(recycled);
+		ADRIA_CHECK(removed.size() == 2 && removed.contains(recycled) && removed.contains(destroyed));
+		reg.emplace<IntComponent>(recycled, 3);
+		reg.remove<IntComponent>(recycled);
+		ADRIA_CHECK(added.size() == 9 && removed.size() == 2);
+
+		//every entity is listed once
+		for (tecs::entity e : entities) if (reg.valid(e)) reg.remove<IntComponent>(e);
+		ADRIA_CHECK(removed.size() == 9);
+		std::set<tecs::entity> const listed(removed.begin(), removed.end());
+		ADRIA_CHECK(listed.size() == 9 && listed.contains(recycled) && listed.contains(destroyed));
+		for (tecs::entity e : listed) ADRIA_CHECK(removed.contains(e));
+		ADRIA_CHECK(!removed.contains(reg.create()));
+
+		added.clear();
+		removed.clear();
+		ADRIA_CHECK(added.empty() && removed.empty());
+		reg.destroy(recycled);
+		reg.emplace<IntComponent>(reg.create(), 0);
+		ADRIA_CHECK(added.size() == 1 && removed.empty());
+	}
+
+	//what the renderer does with its scene BVH: proxies keyed by entity, dropped on removal and created for new components
+	ADRIA_TEST(ECS_ObserverConsumerSeesRecycledRemoval)
+	{
+		tecs::registry reg;
+		tecs::observer& added = reg.on_added<IntComponent>();
+		tecs::observer& removed = reg.on_removed<IntComponent>();
+		std::map<tecs::entity, Int32> proxies;
+		auto Sync = [&]()
+			{
+				for (tecs::entity e : removed) proxies.erase(e);
+				for (tecs::entity e : added)
+				{
+					if (reg.valid(e) && reg.has<IntComponent>(e)) proxies[e] = reg.get<IntComponent>(e).value;
+				}
+				added.clear();
+				removed.clear();
+			};
+		auto MatchesRegistry = [&]()
+			{
+				if (proxies.size() != reg.size<IntComponent>()) return false;
+				for (auto const& [e, value] : proxies)
+				{
+					if (!reg.valid(e) || !reg.has<IntComponent>(e) || reg.get<IntComponent>(e).value != value) return false;
+				}
+				return true;
+			};
+
+		std::vector<tecs::entity> entities;
+		for (Int32 i = 0; i < 4; ++i) reg.emplace<IntComponent>(entities.emplace_back(reg.create()), i);
+		Sync();
+		ADRIA_CHECK(MatchesRegistry());
+
+		//destroyed and recycled twice between two syncs, the consumer has to see both removals and the last insertion
+		tecs::entity const destroyed = entities[1];
+		reg.destroy(destroyed);
+		tecs::entity const first_recycled = reg.create();
+		reg.emplace<IntComponent>(first_recycled, 10);
+		reg.destroy(first_recycled);
+		tecs::entity const second_recycled = reg.create();
+		reg.emplace<IntComponent>(second_recycled, 20);
+		ADRIA_CHECK(tecs::get_index(second_recycled) == tecs::get_index(destroyed));
+		ADRIA_CHECK(removed.contains(destroyed) && removed.contains(first_recycled));
+		ADRIA_CHECK(added.contains(first_recycled) && added.contains(second_recycled));
+		Sync();
+		ADRIA_CHECK(MatchesRegistry() && !proxies.contains(destroyed) && proxies.contains(second_recycled));
+
+		//the same for a component that is removed from the recycled entity before the sync
+		reg.destroy(entities[2]);
+		tecs::entity const recycled = reg.create();
+		reg.emplace<IntComponent>(recycled, 30);
+		reg.remove<IntComponent>(recycled);
+		Sync();
+		ADRIA_CHECK(MatchesRegistry() && !proxies.contains(entities[2]) && proxies.size() == 3);
+	}
+
+	ADRIA_TEST(ECS_EntityRecycling)
+	{
+		tecs::registry reg;
+		tecs::entity const first = reg.create();
+		tecs::entity const second = reg.create();
+		tecs::entity const third = reg.create();
+		reg.emplace<IntComponent>(second, 2);
+		ADRIA_CHECK(tecs::get_index(second) == 1 && tecs::get_version(second) == 0);
+
+		//the slot comes back with the next version, the old handle and its components are gone
+		reg.destroy(second);
+		ADRIA_CHECK(!reg.valid(second) && reg.alive() == 2 && reg.size() == 3);
+		tecs::entity const recycled = reg.create();
+		ADRIA_CHECK(tecs::get_index(recycled) == 1 && tecs::get_version(recycled) == 1);
+		ADRIA_CHECK(reg.valid(recycled) && !reg.valid(second));
+		ADRIA_CHECK(!reg.has<IntComponent>(recycled) && reg.size<IntComponent>() == 0);
+		ADRIA_CHECK(reg.alive() == 3 && reg.size() == 3);
+
+		//the last released slot is reused first
+		reg.destroy(first);
+		reg.destroy(third);
+		ADRIA_CHECK(reg.alive() == 1);
+		tecs::entity const reused_third = reg.create();
+		tecs::entity const reused_first = reg.create();
+		ADRIA_CHECK(tecs::get_index(reused_third) == 2 && tecs::get_version(reused_third) == 1);
+		ADRIA_CHECK(tecs::get_index(reused_first) == 0 && tecs::get_version(reused_first) == 1);
+		ADRIA_CHECK(reg.create() == tecs::make_entity(3));
+
+		//every reuse of a slot bumps its version, so no earlier handle becomes valid again
+		std::vector<tecs::entity> handles{ reused_first };
+		for (Uint32 i = 0; i < 100; ++i)
+		{
+			reg.destroy(handles.back());
+			handles.push_back(reg.create());
+			reg.emplace<IntComponent>(handles.back(), (Int32)i);
+		}
+		ADRIA_CHECK(tecs::get_index(handles.back()) == 0 && tecs::get_version(handles.back()) == 101);
+		ADRIA_CHECK(std::none_of(handles.begin(), handles.end() - 1, [&](tecs::entity e) { return reg.valid(e); }));
+		ADRIA_CHECK(reg.get<IntComponent>(handles.back()).value == 99);
+		ADRIA_CHECK(reg.size<IntComponent>() == 1 && reg.alive() == 4 && reg.size() == 4);
+	}
+
+	//10M entity lifetimes through a fixed number of live entities: slots and sparse pages are reused, so memory stays flat
+	ADRIA_TEST(ECS_CreateDestroySoak)
+	{
+		constexpr Uint32 LIVE_COUNT = 10000;
+		constexpr Uint32 LIFETIME_COUNT = 10000000;
+		tecs::registry reg;
+		std::mt19937 rng(4);
+		std::vector<tecs::entity> live(LIVE_COUNT);
+		for (tecs::entity& e : live)
+		{
+			e = reg.create();
+			reg.emplace<IntComponent>(e, 0);
+			reg.emplace<FloatComponent>(e, 0.0f);
+		}
+		Uint64 const int_pages = reg.page_count<IntComponent>();
+		Uint64 const float_pages = reg.page_count<FloatComponent>();
+		ADRIA_CHECK(int_pages == (LIVE_COUNT + tecs::sparse_set::page_size - 1) / tecs::sparse_set::page_size);
+
+		Bool recycled = true;
+		for (Uint32 i = 0; i < LIFETIME_COUNT; ++i)
+		{
+			tecs::entity& e = live[rng() % LIVE_COUNT];
+			tecs::entity const destroyed = e;
+			reg.destroy(destroyed);
+			e = reg.create();
+			reg.emplace<IntComponent>(e, (Int32)i);
+			if (i % 2) reg.emplace<FloatComponent>(e, (Float)i);
+			recycled = recycled && tecs::get_index(e) == tecs::get_index(destroyed) && tecs::get_version(e) == tecs::get_version(destroyed) + 1;
+		}
+		ADRIA_CHECK(recycled);
+		ADRIA_CHECK(reg.size() == LIVE_COUNT && reg.alive() == LIVE_COUNT);
+		ADRIA_CHECK(reg.size<IntComponent>() == LIVE_COUNT && reg.size<FloatComponent>() <= LIVE_COUNT);
+		ADRIA_CHECK(reg.page_count<IntComponent>() == int_pages && reg.page_count<FloatComponent>() <= float_pages);
+
+		//a burst of entities grows the pools, compact gives the pages back once the burst is destroyed
+		std::vector<tecs::entity> burst(20 * LIVE_COUNT);
+		for (tecs::entity& e : burst)
+		{
+			e = reg.create();
+			reg.emplace<IntComponent>(e, 0);
+		}
+		ADRIA_CHECK(reg.page_count<IntComponent>() > int_pages);
+		for (tecs::entity e : burst) reg.destroy(e);
+		reg.compact();
+		ADRIA_CHECK(reg.page_count<IntComponent>() == int_pages);
+		ADRIA_CHECK(reg.alive() == LIVE_COUNT && reg.size<IntComponent>() == LIVE_COUNT);
+		Bool live_intact = true;
+		for (tecs::entity e : live) live_intact = live_intact && reg.valid(e) && reg.has<IntComponent>(e);
+		ADRIA_CHECK(live_intact);
+	}
+
+	ADRIA_TEST(ECS_ParEachVisitsEveryEntityOnce)
+	{
+		TecsJobSystemScope tecs_job_system_scope;
+		tecs::registry reg;
+		std::mt19937 rng(2);
+		constexpr Uint32 ENTITY_COUNT = 20000;
+		for (Uint32 i = 0; i < ENTITY_COUNT; ++i)
+		{
+			tecs::entity e = reg.create();
+			reg.emplace<IntComponent>(e, 0);
+			if (rng() % 3) reg.emplace<FloatComponent>(e, 0.0f);
+			if (rng() % 2) reg.emplace<OtherIntComponent>(e, 0);
+		}
+		//destroyed entities leave holes in the sparse pages that the chunks must not visit
+		for (Uint32 i = 0; i < ENTITY_COUNT; i += 7) reg.destroy(tecs::make_entity(i));
+
+		//visits counts the calls per entity index, the same entity in two chunks would count twice
+		std::vector<std::atomic<Uint32>> visits(ENTITY_COUNT);
+		auto CheckVisits = [&](auto&& expected)
+			{
+				Bool visited_once = true;
+				for (Uint32 i = 0; i < ENTITY_COUNT; ++i)
+				{
+					tecs::entity e = reg.valid(tecs::make_entity(i)) ? tecs::make_entity(i) : tecs::null_entity;
+					Uint32 const expected_visits = e != tecs::null_entity && expected(e) ? 1 : 0;
+					visited_once = visited_once && visits[i].exchange(0) == expected_visits;
+				}
+				return visited_once;
+			};
+
+		//grains below, at and above the entity count, the last ones run serially
+		for (Uint64 grain : { 1ull, 64ull, 1000ull, 1ull * ENTITY_COUNT, 4ull * ENTITY_COUNT })
+		{
+			reg.view<IntComponent>().par_each([&](tecs::entity e, IntComponent& a) { ++a.value; ++visits[tecs::get_index(e)]; }, grain);
+			ADRIA_CHECK(CheckVisits([&](tecs::entity e) { return reg.has<IntComponent>(e); }));
+
+			reg.view<IntComponent, FloatComponent, OtherIntComponent>().par_each([&](tecs::entity e) { ++visits[tecs::get_index(e)]; }, grain);
+			ADRIA_CHECK(CheckVisits([&](tecs::entity e) { return reg.all_of<IntComponent, FloatComponent, OtherIntComponent>(e); }));
+
+			Uint64 chunked_size = 0;
+			for (auto const& chunk : reg.view<IntComponent>().split(grain))
+			{
+				chunked_size += std::distance(chunk.begin(), chunk.end());
+				ADRIA_CHECK(chunk.begin() != chunk.end());
+			}
+			ADRIA_CHECK(chunked_size == reg.size<IntComponent>());
+		}
+		Bool all_updated = true;
+		for (tecs::entity e : reg.view<IntComponent>()) all_updated = all_updated && reg.get<IntComponent>(e).value == 5;
+		ADRIA_CHECK(all_updated);
+
+		auto group = reg.group<IntComponent, FloatComponent>();
+		for (Uint64 grain : { 1ull, 100ull, 4ull * ENTITY_COUNT })
+		{
+			group.par_each([&](tecs::entity e, IntComponent&, FloatComponent& b) { b.value += 1.0f; ++visits[tecs::get_index(e)]; }, grain);
+			ADRIA_CHECK(CheckVisits([&](tecs::entity e) { return reg.all_of<IntComponent, FloatComponent>(e); }));
+		}
+
+		//without a parallel_for everything runs on the calling thread
+		tecs::set_parallel_for(nullptr);
+		std::thread::id const caller = std::this_thread::get_id();
+		Bool on_caller = true;
+		reg.view<IntComponent>().par_each([&](tecs::entity e) { on_caller = on_caller && std::this_thread::get_id() == caller; ++visits[tecs::get_index(e)]; }, 1);
+		ADRIA_CHECK(on_caller);
+		ADRIA_CHECK(CheckVisits([&](tecs::entity e) { return reg.has<IntComponent>(e); }));
+	}
+
+	ADRIA_TEST(ECS_SchedulerConflicts)
+	{
+		tecs::access_set const read_int = tecs::access_set().read<IntComponent>();
+		tecs::access_set const read_int_float = tecs::access_set().read<IntComponent, FloatComponent>();
+		tecs::access_set const write_int = tecs::access_set().write<IntComponent>();
+		tecs::access_set const write_float = tecs::access_set().write<FloatComponent>();
+		tecs::access_set const structural = tecs::access_set().structural();
+		ADRIA_CHECK(!read_int.conflicts_with(read_int_float));
+		ADRIA_CHECK(read_int.conflicts_with(write_int) && write_int.conflicts_with(read_int));
+		ADRIA_CHECK(write_int.conflicts_with(write_int));
+		ADRIA_CHECK(!write_int.conflicts_with(write_float));
+		ADRIA_CHECK(read_int_float.conflicts_with(write_float));
+		ADRIA_CHECK(structural.conflicts_with(read_int) && read_int.conflicts_with(structural));
+		ADRIA_CHECK(structural.conflicts_with(tecs::access_set()));
+		ADRIA_CHECK(!tecs::access_set().conflicts_with(tecs::access_set()));
+		//reading and writing the same component in one set is a write
+		ADRIA_CHECK(tecs::access_set().read<IntComponent>().write<IntComponent>().conflicts_with(read_int));
+
+		TecsJobSystemScope tecs_job_system_scope;
+		tecs::registry reg;
+		constexpr Int32 ENTITY_COUNT = 10000;
+		for (Int32 i = 0; i < ENTITY_COUNT; ++i)
+		{
+			tecs::entity e = reg.create();
+			reg.emplace<IntComponent>(e, i);
+			reg.emplace<FloatComponent>(e, 0.0f);
+			reg.emplace<OtherIntComponent>(e, 0);
+		}
+
+		//the scheduler only sees the declared accesses, the systems log what they ran after to check the order
+		std::mutex order_mutex;
+		std::vector<std::string> order;
+		auto Ran = [&](std::string const& name) { std::lock_guard lock(order_mutex); order.push_back(name); };
+		auto IndexOf = [&](std::string const& name) { return std::find(order.begin(), order.end(), name) - order.begin(); };
+
+		tecs::system_scheduler scheduler(reg);
+		scheduler.add("double_int", tecs::access_set().write<IntComponent>(), [&]()
+			{
+				for (tecs::entity e : reg.view<IntComponent>()) reg.get<IntComponent>(e).value *= 2;
+				Ran("double_int");
+			});
+		scheduler.add("clear_unowned", tecs::access_set().write<UnownedComponent>(), [&]() { reg.clear<UnownedComponent>(); Ran("clear_unowned"); });
+		scheduler.add("int_to_float", tecs::access_set().read<IntComponent>().write<FloatComponent>(), [&]()
+			{
+				for (tecs::entity e : reg.view<IntComponent, FloatComponent>()) reg.get<FloatComponent>(e).value = (Float)reg.get<IntComponent>(e).value;
+				Ran("int_to_float");
+			});
+		scheduler.add("int_to_other", tecs::access_set().read<IntComponent>().write<OtherIntComponent>(), [&]()
+			{
+				for (tecs::entity e : reg.view<IntComponent, OtherIntComponent>()) reg.get<OtherIntComponent>(e).value = reg.get<IntComponent>(e).value + 1;
+				Ran("int_to_other");
+			});
+		scheduler.add("increment_int", tecs::access_set().write<IntComponent>(), [&]()
+			{
+				for (tecs::entity e : reg.view<IntComponent>()) reg.get<IntComponent>(e).value += 1;
+				Ran("increment_int");
+			});
+		scheduler.add("spawn", tecs::access_set().structural(), [&]() { reg.emplace<UnownedComponent>(reg.create(), 0); Ran("spawn"); });
+
+		//batches: {double_int, clear_unowned}, {int_to_float, int_to_other}, {increment_int}, {spawn}
+		ADRIA_CHECK(scheduler.size() == 6);
+		ADRIA_CHECK(scheduler.batch_count() == 4);
+		auto const conflicts = scheduler.conflicts();
+		auto Conflicting = [&](std::string const& first, std::string const& second)
+			{
+				return std::find(conflicts.begin(), conflicts.end(), std::make_pair(first, second)) != conflicts.end();
+			};
+		ADRIA_CHECK(Conflicting("double_int", "int_to_float") && Conflicting("int_to_other", "increment_int"));
+		ADRIA_CHECK(Conflicting("clear_unowned", "spawn") && Conflicting("int_to_float", "spawn"));
+		ADRIA_CHECK(!Conflicting("double_int", "clear_unowned") && !Conflicting("int_to_float", "int_to_other"));
+		ADRIA_CHECK(!Conflicting("int_to_float", "double_int"));
+		//every structural system conflicts with every other, 5 more pairs from the component accesses
+		ADRIA_CHECK(conflicts.size() == 5 + 5);
+
+		for (Uint32 run = 0; run < 10; ++run)
+		{
+			order.clear();
+			scheduler.run();
+			ADRIA_CHECK(order.size() == 6);
+			ADRIA_CHECK(IndexOf("double_int") < IndexOf("int_to_float") && IndexOf("double_int") < IndexOf("int_to_other"));
+			ADRIA_CHECK(IndexOf("int_to_float") < IndexOf("increment_int") && IndexOf("int_to_other") < IndexOf("increment_int"));
+			ADRIA_CHECK(IndexOf("increment_int") < IndexOf("spawn") && IndexOf("clear_unowned") < IndexOf("spawn"));
+		}
+
+		//the same systems run serially in registration order give the same components
+		Bool same_as_serial = true;
+		for (tecs::entity e : reg.view<IntComponent, FloatComponent, OtherIntComponent>())
+		{
+			Int32 value = (Int32)tecs::get_index(e), float_value = 0, other_value = 0;
+			for (Uint32 run = 0; run < 10; ++run)
+			{
+				value *= 2;
+				float_value = other_value = value;
+				++other_value;
+				value += 1;
+			}
+			auto [a, b, c] = reg.get<IntComponent, FloatComponent, OtherIntComponent>(e);
+			same_as_serial = same_as_serial && a.value == value && b.value == (Float)float_value && c.value == other_value;
+		}
+		ADRIA_CHECK(same_as_serial);
+		ADRIA_CHECK(reg.size<UnownedComponent>() == 1);
+	}
+
+	ADRIA_BENCHMARK(ECS_GroupVsViewIteration)
+	{
+		constexpr Uint32 ITERATIONS = 20;
+		for (Uint32 count : { 100000u, 1000000u })
+		{
+			tecs::registry reg;
+			std::mt19937 rng(3);
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				tecs::entity e = reg.create();
+				if (rng() % 4) reg.emplace<MeshComponent>(e);
+				if (rng() % 3) reg.emplace<BoundsComponent>(e);
+				reg.emplace<TransformComponent>(e);
+				reg.emplace<MaterialComponent>(e);
+				if (rng() % 2) reg.emplace<TagComponent>(e);
+			}
+
+			auto view = reg.view<TransformComponent, MeshComponent, MaterialComponent, TagComponent, BoundsComponent>();
+			Float view_sum = 0.0f;
+			Timer<std::chrono::microseconds> view_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration)
+			{
+				for (tecs::entity e : view)
+				{
+					auto [transform, mesh, material, bounds] = view.get<TransformComponent, MeshComponent, MaterialComponent, BoundsComponent>(e);
+					view_sum += transform.matrix[0] + mesh.values[0] + material.values[0] + bounds.values[0] + 1.0f;
+				}
+			}
+			Float const view_ms = view_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+			//the first group call sorts the owned pools, which is a one time cost
+			Timer<std::chrono::microseconds> build_timer;
+			auto group = reg.group<TransformComponent, MeshComponent, MaterialComponent, TagComponent, BoundsComponent>();
+			Float const build_ms = build_timer.Elapsed() / 1000.0f;
+
+			Float group_sum = 0.0f;
+			Timer<std::chrono::microseconds> group_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration)
+			{
+				group.each([&](tecs::entity, TransformComponent& transform, MeshComponent& mesh, MaterialComponent& material, TagComponent&, BoundsComponent& bounds)
+					{
+						group_sum += transform.matrix[0] + mesh.values[0] + material.values[0] + bounds.values[0] + 1.0f;
+					});
+			}
+			Float const group_ms = group_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+			ADRIA_CHECK(view_sum == group_sum);
+			ADRIA_LOG(INFO, "%u entities, %llu with all 5 components: view %.3f ms, group %.3f ms (%.1fx), group creation %.3f ms",
+				count, (Uint64)group.size(), view_ms, group_ms, view_ms / (std::max)(group_ms, 1e-3f), build_ms);
+		}
+	}
+}
@@ -0,0 +1,144 @@
+#include <atomic>
+#include "TestRegistry.h"
+#include "Rendering/Components.h"
+#include "Rendering/RenderQueue.h"
+#include "Utilities/FrameArena.h"
+#include "Utilities/HeapCounter.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		Bool IsAligned(void* p, Uint64 alignment)
+		{
+			return reinterpret_cast<Uint64>(p) % alignment == 0;
+		}
+
+		//what a frame does with the arena and the render queue: a few hundred draws over a handful of materials
+		void RunFrame(FrameArena& arena, RenderQueue& render_queue, Uint32 draw_count)
+		{
+			FrameVector<Uint32> visible(arena.Resource());
+			for (Uint32 i = 0; i < draw_count; ++i) visible.push_back(i);
+
+			render_queue.Begin(100.0f);
+			for (Uint32 i : visible)
+			{
+				Material material{};
+				material.albedo_texture = i % 7;
+				material.roughness_factor = (i % 3) * 0.5f;
+				RenderQueueItem item{};
+				item.shader_program = (i % 2) ? ShaderProgram::GBufferPBR : ShaderProgram::GBufferPBR_Mask;
+				item.double_sided = i % 5 == 0;
+				item.material_id = render_queue.GetMaterialId(material);
+				item.depth = (Float)((i * 37) % 100);
+				render_queue.Push(RenderQueuePass_GBuffer, item);
+			}
+			render_queue.Sort();
+			Uint32 draws = 0;
+			render_queue.Submit(RenderQueuePass_GBuffer, [&](RenderQueueItem const&, Uint8) { ++draws; });
+			arena.Reset();
+		}
+	}
+
+	ADRIA_TEST(FrameArena_ResetReuse)
+	{
+		FrameArena arena;
+		Uint8* first = static_cast<Uint8*>(arena.Allocate(100));
+		void* aligned = arena.Allocate(16, 256);
+		Uint64* values = arena.Allocate<Uint64>(10);
+		ADRIA_CHECK(first != nullptr && IsAligned(first, alignof(std::max_align_t)));
+		ADRIA_CHECK(IsAligned(aligned, 256) && IsAligned(values, alignof(Uint64)));
+		arena.Reset();
+		FrameArenaStats stats = arena.GetStats();
+		ADRIA_CHECK(stats.thread_count == 1 && stats.block_allocations == 1 && stats.used_bytes >= 196 && stats.used_bytes < 512);
+
+		//the next frame starts at the beginning of the same block
+		ADRIA_CHECK(arena.Allocate(100) == first);
+		arena.Reset();
+		stats = arena.GetStats();
+		ADRIA_CHECK(stats.block_allocations == 0 && stats.total_block_allocations == 1 && stats.used_bytes == 100);
+
+		//a frame bigger than the block overflows once, the regrown block fits the same frame from then on
+		for (Uint32 i = 0; i < 3; ++i) arena.Allocate(512 * 1024);
+		arena.Reset();
+		stats = arena.GetStats();
+		ADRIA_CHECK(stats.block_allocations == 2 && stats.capacity_bytes >= 3 * 512 * 1024 && stats.peak_bytes >= 3 * 512 * 1024);
+		for (Uint32 i = 0; i < 3; ++i) arena.Allocate(512 * 1024);
+		arena.Reset();
+		stats = arena.GetStats();
+		ADRIA_CHECK(stats.block_allocations == 0 && stats.total_block_allocations == 3);
+	}
+
+	ADRIA_TEST(FrameArena_Instances)
+	{
+		//arenas on the same thread have their own blocks, resetting one leaves the other alone
+		FrameArena arena, other_arena;
+		Uint64* value = arena.Allocate<Uint64>();
+		Uint64* other_value = other_arena.Allocate<Uint64>();
+		*value = 1;
+		*other_value = 2;
+		ADRIA_CHECK(value != other_value);
+		other_arena.Reset();
+		ADRIA_CHECK(other_arena.GetStats().used_bytes == sizeof(Uint64) && other_arena.GetStats().thread_count == 1);
+		ADRIA_CHECK(other_arena.Allocate<Uint64>() == other_value && *value == 1);
+		arena.Reset();
+		ADRIA_CHECK(arena.GetStats().used_bytes == sizeof(Uint64) && arena.GetStats().thread_count == 1);
+
+		//a later arena never gets the blocks of a destroyed one
+		Uint64* destroyed_value = nullptr;
+		{
+			FrameArena destroyed_arena;
+			destroyed_value = destroyed_arena.Allocate<Uint64>();
+			destroyed_arena.Reset();
+		}
+		FrameArena new_arena;
+		new_arena.Allocate<Uint64>();
+		new_arena.Reset();
+		ADRIA_CHECK(new_arena.GetStats().block_allocations == 1 && destroyed_value != nullptr);
+	}
+
+	ADRIA_TEST(FrameArena_Threads)
+	{
+		TestJobSystemScope job_system_scope(4);
+		FrameArena arena;
+		std::atomic<Uint32> misaligned = 0;
+		for (Uint32 frame = 0; frame < 4; ++frame)
+		{
+			g_JobSystem.ParallelFor(1024, 16, [&](Uint32 i)
+				{
+					Uint64* value = arena.Allocate<Uint64>();
+					*value = i;
+					if (!IsAligned(value, alignof(Uint64))) misaligned.fetch_add(1, std::memory_order_relaxed);
+				});
+			arena.Reset();
+			FrameArenaStats const& stats = arena.GetStats();
+			ADRIA_CHECK(stats.used_bytes == 1024 * sizeof(Uint64));
+			ADRIA_CHECK(stats.thread_count >= 1 && stats.thread_count <= g_JobSystem.GetWorkerCount());
+		}
+		ADRIA_CHECK(misaligned == 0);
+	}
+
+	//once the arena and the render queue have grown to the frame, a frame doesn't call operator new
+	ADRIA_TEST(FrameArena_SteadyStateHeapAllocations)
+	{
+		FrameArena arena;
+		RenderQueue render_queue;
+		for (Uint32 frame = 0; frame < 4; ++frame) RunFrame(arena, render_queue, 500);
+
+		Uint64 const heap_allocation_count = GetHeapAllocationCount();
+		Uint64 frame_heap_allocations = 0;
+		for (Uint32 frame = 0; frame < 8; ++frame)
+		{
+			RunFrame(arena, render_queue, 500);
+			frame_heap_allocations += arena.GetStats().heap_allocations + arena.GetStats().block_allocations;
+		}
+		ADRIA_CHECK(frame_heap_allocations == 0);
+		ADRIA_CHECK(GetHeapAllocationCount() == heap_allocation_count);
+
+		//the counter sees allocations that bypass the arena
+		std::unique_ptr<Uint64> allocation = std::make_unique<Uint64>(0);
+		arena.Reset();
+		ADRIA_CHECK(arena.GetStats().heap_allocations == 1 && allocation != nullptr);
+	}
+}
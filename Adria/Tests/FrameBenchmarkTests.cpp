@@ -0,0 +1,38 @@
+#include "TestRegistry.h"
+#include "Core/Engine.h"
+#include "Core/FrameBenchmark.h"
+#include "Core/Paths.h"
+#include "Utilities/FilesUtil.h"
+
+namespace adria
+{
+	//what -bench_frame does, with a few frames: a headless engine on the hidden window renders the default scene,
+	//every measured frame is recorded and the last stream decodes back into commands
+	ADRIA_TEST(FrameBenchmark_Smoke)
+	{
+		constexpr Uint32 FRAME_COUNT = 8;
+		EngineInit engine_init{};
+		engine_init.window = test_context.GetWindow();
+		engine_init.scene_file = "sponza.json";
+		engine_init.headless = true;
+		Engine engine(engine_init);
+
+		FrameBenchmark benchmark(engine);
+		FrameBenchmarkReport const report = benchmark.Run(RendererSettings{}, FRAME_COUNT, 2);
+		ADRIA_CHECK(report.frame_ms.size() == FRAME_COUNT);
+		ADRIA_CHECK(report.stats.commands > 0 && report.stats.draws > 0);
+		ADRIA_CHECK(!report.passes.empty() && !report.last_frame_stream.empty());
+		Bool passes_valid = true;
+		for (FrameBenchmarkPass const& pass : report.passes) passes_valid = passes_valid && pass.frame_count > 0 && pass.frame_count <= FRAME_COUNT;
+		ADRIA_CHECK(passes_valid);
+
+		std::vector<GfxRecordedCommand> commands;
+		ADRIA_CHECK(GfxCommandRecorder::Decode(report.last_frame_stream, commands));
+		ADRIA_CHECK(!commands.empty());
+
+		std::string const stream_path = paths::SavedDir + "BenchFrameTest.cmds";
+		ADRIA_CHECK(FrameBenchmark::WriteStream(report, stream_path));
+		ADRIA_CHECK(fs::file_size(stream_path) == report.last_frame_stream.size());
+		FrameBenchmark::Log(report);
+	}
+}
@@ -0,0 +1,151 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Rendering/FrustumCuller.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/Random.h"
+#include "Utilities/Timer.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		//plane distances closer than this to the box radius are left to rounding and not checked
+		constexpr Float PLANE_EPSILON = 1e-3f;
+
+		void AddRandomBoxes(FrustumCuller& culler, std::vector<BoundingBox>& boxes, Uint32 count, Uint32 seed)
+		{
+			RealRandomGenerator<Float> position(-500.0f, 500.0f, std::mt19937{ seed });
+			RealRandomGenerator<Float> extent(0.1f, 10.0f, std::mt19937{ seed + 1 });
+			boxes.resize(count);
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				boxes[i] = BoundingBox(Vector3(position(), position(), position()), Vector3(extent(), extent(), extent()));
+				culler.Add(tecs::make_entity(i), boxes[i]);
+			}
+		}
+
+		BoundingFrustum MakeFrustum(Vector3 const& eye, Vector3 const& target)
+		{
+			Matrix const view = XMMatrixLookAtLH(eye, target, Vector3::Up);
+			BoundingFrustum frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 300.0f));
+			frustum.Transform(frustum, view.Invert());
+			return frustum;
+		}
+
+		enum class PlaneTestResult
+		{
+			Inside,
+			Outside,
+			Ambiguous
+		};
+
+		//scalar version of the culler's plane test
+		PlaneTestResult PlaneTest(XMFLOAT4 const (&planes)[6], BoundingBox const& box)
+		{
+			Bool ambiguous = false;
+			for (XMFLOAT4 const& plane : planes)
+			{
+				Float const distance = plane.x * box.Center.x + plane.y * box.Center.y + plane.z * box.Center.z + plane.w;
+				Float const radius = std::abs(plane.x) * box.Extents.x + std::abs(plane.y) * box.Extents.y + std::abs(plane.z) * box.Extents.z;
+				if (distance > radius + PLANE_EPSILON) return PlaneTestResult::Outside;
+				if (distance > radius - PLANE_EPSILON) ambiguous = true;
+			}
+			return ambiguous ? PlaneTestResult::Ambiguous : PlaneTestResult::Inside;
+		}
+
+		Bool BoxTest(BoundingBox const& a, BoundingBox const& b)
+		{
+			return std::abs(a.Center.x - b.Center.x) <= a.Extents.x + b.Extents.x &&
+				   std::abs(a.Center.y - b.Center.y) <= a.Extents.y + b.Extents.y &&
+				   std::abs(a.Center.z - b.Center.z) <= a.Extents.z + b.Extents.z;
+		}
+
+		Bool IsStrictlyIncreasing(std::vector<Uint32> const& indices, Uint32 count)
+		{
+			for (Uint64 i = 0; i < indices.size(); ++i)
+			{
+				if (indices[i] >= count || (i > 0 && indices[i] <= indices[i - 1])) return false;
+			}
+			return true;
+		}
+	}
+
+	ADRIA_TEST(FrustumCuller_MatchesScalarReference)
+	{
+		TestJobSystemScope job_system_scope;
+		//odd counts leave a partial SIMD batch, the large one spans many chunks
+		for (Uint32 count : { 0u, 1u, 3u, 5u, 1023u, 100003u })
+		{
+			FrustumCuller culler;
+			std::vector<BoundingBox> boxes;
+			AddRandomBoxes(culler, boxes, count, count + 7);
+			ADRIA_CHECK(culler.Size() == count);
+
+			BoundingFrustum const frustum = MakeFrustum(Vector3(0.0f, 20.0f, -50.0f), Vector3(10.0f, 0.0f, 100.0f));
+			XMVECTOR plane_vectors[6];
+			frustum.GetPlanes(&plane_vectors[0], &plane_vectors[1], &plane_vectors[2], &plane_vectors[3], &plane_vectors[4], &plane_vectors[5]);
+			XMFLOAT4 planes[6];
+			for (Uint32 i = 0; i < 6; ++i) XMStoreFloat4(&planes[i], plane_vectors[i]);
+
+			std::vector<Uint32> visible;
+			culler.Cull(frustum, visible);
+			ADRIA_CHECK(IsStrictlyIncreasing(visible, count));
+
+			std::vector<Bool> is_visible(count, false);
+			for (Uint32 i : visible) if (i < count) is_visible[i] = true;
+			Uint32 mismatches = 0;
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				PlaneTestResult const expected = PlaneTest(planes, boxes[i]);
+				if (expected == PlaneTestResult::Inside && !is_visible[i]) ++mismatches;
+				if (expected == PlaneTestResult::Outside && is_visible[i]) ++mismatches;
+			}
+			ADRIA_CHECK(mismatches == 0);
+
+			BoundingBox const light_box(Vector3(25.0f, -10.0f, 40.0f), Vector3(120.0f, 60.0f, 80.0f));
+			culler.Cull(light_box, visible);
+			ADRIA_CHECK(IsStrictlyIncreasing(visible, count));
+			std::vector<Uint32> expected_visible;
+			for (Uint32 i = 0; i < count; ++i) if (BoxTest(boxes[i], light_box)) expected_visible.push_back(i);
+			ADRIA_CHECK(visible == expected_visible);
+			for (Uint32 i : visible) ADRIA_CHECK(culler.GetEntity(i) == tecs::make_entity(i));
+		}
+	}
+
+	ADRIA_BENCHMARK(FrustumCuller_MillionBoxes)
+	{
+		constexpr Uint32 BOX_COUNT = 1000000;
+		constexpr Uint32 ITERATIONS = 20;
+		FrustumCuller culler;
+		std::vector<BoundingBox> boxes;
+		AddRandomBoxes(culler, boxes, BOX_COUNT, 1234);
+		BoundingFrustum const frustum = MakeFrustum(Vector3(0.0f, 0.0f, -400.0f), Vector3(0.0f, 0.0f, 0.0f));
+
+		//what camera culling did before: one DirectXMath test per box
+		Uint64 scalar_visible = 0;
+		Timer<std::chrono::microseconds> scalar_timer;
+		for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration)
+		{
+			for (BoundingBox const& box : boxes) scalar_visible += frustum.Intersects(box);
+		}
+		Float const scalar_ms = scalar_timer.Elapsed() / 1000.0f / ITERATIONS;
+
+		std::vector<Uint32> visible;
+		Float soa_ms[2] = {};
+		for (Uint32 thread_count : { 1u, 0u })
+		{
+			TestJobSystemScope job_system_scope(thread_count);
+			culler.Cull(frustum, visible);
+			Timer<std::chrono::microseconds> soa_timer;
+			for (Uint32 iteration = 0; iteration < ITERATIONS; ++iteration) culler.Cull(frustum, visible);
+			soa_ms[thread_count == 0] = soa_timer.Elapsed() / 1000.0f / ITERATIONS;
+		}
+
+		ADRIA_CHECK(!visible.empty());
+		ADRIA_LOG(INFO, "%u boxes: DirectXMath per box %.3f ms (%llu visible), SoA on two threads %.3f ms, SoA on %u threads %.3f ms (%llu visible, %.1fx)",
+			BOX_COUNT, scalar_ms, scalar_visible / ITERATIONS, soa_ms[0], std::thread::hardware_concurrency(), soa_ms[1], (Uint64)visible.size(),
+			scalar_ms / (std::max)(soa_ms[1], 1e-3f));
+	}
+}
@@ -0,0 +1,105 @@
+#include <set>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Graphics/GfxDevice.h"
+#include "Graphics/GfxConstantBufferRing.h"
+#include "Utilities/RingAllocator.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint64 RING_SIZE = 64 * 1024;
+		constexpr Uint32 ALIGNMENT = GfxConstantBufferRing::ALIGNMENT;
+	}
+
+	//a fenced frame keeps its part of the ring until the fence of that frame is released
+	ADRIA_TEST(RingAllocator_FrameRelease)
+	{
+		RingAllocator ring(4096);
+		//alignment padding is owned by the frame like the allocations
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 0);
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 1024);
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 2048);
+		ADRIA_CHECK(ring.UsedSize() == 3048);
+		ring.FinishCurrentFrame(0);
+
+		//past the capacity while frame 0 is in flight
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 3072);
+		ADRIA_CHECK(ring.Allocate(1000, 256) == INVALID_OFFSET);
+		ring.FinishCurrentFrame(1);
+
+		//releasing frame 0 frees the start of the ring, the next allocation wraps and owns the skipped end
+		ring.ReleaseCompletedFrames(0);
+		ADRIA_CHECK(ring.UsedSize() == 1024);
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 0);
+		ADRIA_CHECK(ring.UsedSize() == 2048);
+		ADRIA_CHECK(ring.Allocate(2000, 256) == 1024);
+		//frame 1 still holds 3048 to 4072
+		ADRIA_CHECK(ring.Allocate(256, 256) == INVALID_OFFSET);
+		ring.FinishCurrentFrame(2);
+
+		ring.ReleaseCompletedFrames(1);
+		ADRIA_CHECK(ring.UsedSize() == 3048);
+		ring.ReleaseCompletedFrames(1);
+		ADRIA_CHECK(ring.UsedSize() == 3048);
+		ring.ReleaseCompletedFrames(2);
+		ADRIA_CHECK(ring.Empty());
+		ADRIA_CHECK(ring.Allocate(1000, 256) == 3072);
+	}
+
+	//the null device executes nothing, so every frame is released when the next one begins
+	ADRIA_TEST(GfxConstantBufferRing_NullDevice)
+	{
+		GfxDevice gfx(test_context.GetWindow(), true);
+		GfxCommandContext* context = gfx.GetCommandContext();
+		GfxConstantBufferRing ring(&gfx, RING_SIZE);
+		std::vector<Uint8> data(1024, 0xab);
+		if (!ring.IsSupported())
+		{
+			ADRIA_LOG(WARNING, "The null device doesn't support constant buffer offsetting, only the fallback is tested");
+			ADRIA_CHECK(ring.Upload(context, data.data(), 16, 16) == INVALID_OFFSET);
+			return;
+		}
+		ADRIA_CHECK(ring.GetStats().capacity == RING_SIZE);
+
+		//offsets are aligned and cover the bound size, not only the data
+		ADRIA_CHECK(ring.Upload(context, data.data(), 16, 16) == 0);
+		ADRIA_CHECK(ring.Upload(context, data.data(), 100, 256) == 256);
+		ADRIA_CHECK(ring.Upload(context, data.data(), 300, 300) == 512);
+		ADRIA_CHECK(ring.Upload(context, data.data(), 16, 1024) == 1024);
+		ring.NewFrame(context);
+		GfxConstantBufferRingStats stats = ring.GetStats();
+		ADRIA_CHECK(stats.frame_uploads == 4 && stats.frame_bytes == 2048 && stats.frame_fallbacks == 0);
+
+		//the released frame leaves the ring at 2048, filling it wraps to the start and stops at the full capacity
+		std::set<OffsetType> offsets;
+		Bool aligned = true, wrapped = false;
+		OffsetType previous_offset = 0;
+		while (true)
+		{
+			OffsetType const offset = ring.Upload(context, data.data(), ALIGNMENT, ALIGNMENT);
+			if (offset == INVALID_OFFSET)
+			{
+				ring.AddFallback();
+				break;
+			}
+			aligned = aligned && offset % ALIGNMENT == 0 && offset + ALIGNMENT <= RING_SIZE;
+			wrapped = wrapped || offset < previous_offset;
+			previous_offset = offset;
+			offsets.insert(offset);
+		}
+		ADRIA_CHECK(aligned && wrapped);
+		ADRIA_CHECK(offsets.size() == RING_SIZE / ALIGNMENT && *offsets.begin() == 0);
+		ring.NewFrame(context);
+		stats = ring.GetStats();
+		ADRIA_CHECK(stats.frame_uploads == RING_SIZE / ALIGNMENT && stats.frame_bytes == RING_SIZE);
+		ADRIA_CHECK(stats.frame_fallbacks == 1 && stats.total_fallbacks == 1 && stats.high_water_mark == RING_SIZE);
+
+		//the full frame was released as well
+		ADRIA_CHECK(ring.Upload(context, data.data(), 1024, 1024) == 2048);
+		ring.NewFrame(context);
+		stats = ring.GetStats();
+		ADRIA_CHECK(stats.frame_uploads == 1 && stats.frame_fallbacks == 0 && stats.total_fallbacks == 1);
+	}
+}
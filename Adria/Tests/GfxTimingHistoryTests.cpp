@@ -0,0 +1,118 @@
+#include <fstream>
+#include <sstream>
+#include "TestRegistry.h"
+#include "Core/Paths.h"
+#include "Graphics/GfxTimingHistory.h"
+#include "Utilities/JsonUtil.h"
+
+namespace adria
+{
+	namespace
+	{
+		std::string ReadFile(std::string const& path)
+		{
+			std::ifstream is(path);
+			std::stringstream ss;
+			ss << is.rdbuf();
+			return ss.str();
+		}
+	}
+
+	ADRIA_TEST(GfxTimingHistory_Percentiles)
+	{
+		GfxTimingHistory history;
+		Uint32 const ramp = history.RegisterScope("Ramp");
+		Uint32 const shuffled = history.RegisterScope("Shuffled");
+		ADRIA_CHECK(history.RegisterScope("Ramp") == ramp && history.GetScopeCount() == 2);
+
+		//0 to 999 overflows the ring, the full window holds 488 to 999
+		for (Uint32 frame = 0; frame < 1000; ++frame) history.AddSample(ramp, frame, (Float)frame);
+		GfxTimingStats stats = history.GetStats(ramp);
+		ADRIA_CHECK(stats.sample_count == GfxTimingHistory::HISTORY_SIZE && history.GetLastFrame(ramp) == 999);
+		ADRIA_CHECK(stats.last == 999.0f && stats.max == 999.0f && stats.mean == 743.5f);
+		ADRIA_CHECK(stats.p50 == 744.0f && stats.p95 == 973.0f && stats.p99 == 994.0f);
+		//a smaller window takes the newest samples
+		stats = history.GetStats(ramp, 10);
+		ADRIA_CHECK(stats.sample_count == 10 && stats.last == 999.0f && stats.mean == 994.5f && stats.p50 == 995.0f);
+
+		//percentiles don't depend on the order the samples came in
+		for (Uint32 frame = 0; frame < 100; ++frame) history.AddSample(shuffled, frame, (Float)((frame * 37) % 100));
+		stats = history.GetStats(shuffled, 100);
+		ADRIA_CHECK(stats.sample_count == 100 && stats.last == (Float)((99 * 37) % 100));
+		ADRIA_CHECK(stats.mean == 49.5f && stats.p50 == 50.0f && stats.p95 == 94.0f && stats.p99 == 98.0f && stats.max == 99.0f);
+
+		ADRIA_CHECK(history.GetStats(history.RegisterScope("Empty")).sample_count == 0);
+		history.Clear();
+		ADRIA_CHECK(history.GetStats(ramp).sample_count == 0 && history.GetScopeCount() == 3);
+	}
+
+	ADRIA_TEST(GfxTimingHistory_BudgetAlerts)
+	{
+		GfxTimingHistory history;
+		Uint32 const scope = history.RegisterScope("Pass");
+		std::vector<GfxBudgetExceeded> alerts;
+		history.GetBudgetExceededEvent().Add([&](GfxBudgetExceeded const& alert) { alerts.push_back(alert); });
+
+		//no budget, no alerts
+		for (Uint32 frame = 0; frame < 100; ++frame) history.AddSample(scope, frame, 10.0f);
+		ADRIA_CHECK(alerts.empty() && history.GetStats(scope).over_budget_count == 0);
+
+		//a saw tooth from 0 to 1.98 ms is over 1.5 ms from the 76th to the 99th frame of every period, one alert per period
+		history.Clear();
+		history.SetBudget(scope, 1.5f);
+		for (Uint32 frame = 0; frame < 1000; ++frame) history.AddSample(scope, frame, (frame % 100) / 50.0f);
+		ADRIA_CHECK(alerts.size() == 10);
+		Bool alerts_valid = true;
+		for (Uint64 i = 0; i < alerts.size(); ++i)
+		{
+			alerts_valid = alerts_valid && alerts[i].frame == i * 100 + 76 && alerts[i].time_ms == 1.52f && alerts[i].budget_ms == 1.5f;
+			alerts_valid = alerts_valid && std::string(alerts[i].name) == "Pass";
+		}
+		ADRIA_CHECK(alerts_valid);
+		//the last 512 samples are frames 488 to 999, five full periods and the last twelve over budget frames of the one before
+		ADRIA_CHECK(history.GetStats(scope).over_budget_count == 5 * 24 + 12);
+
+		//exactly the budget is within it, and a new budget starts over
+		alerts.clear();
+		history.AddSample(scope, 1000, 1.5f);
+		history.AddSample(scope, 1001, 1.6f);
+		history.SetBudget(scope, 1.0f);
+		history.AddSample(scope, 1002, 1.6f);
+		ADRIA_CHECK(alerts.size() == 2 && alerts[1].frame == 1002 && alerts[1].budget_ms == 1.0f);
+		history.SetBudget(scope, 0.0f);
+		history.AddSample(scope, 1003, 100.0f);
+		ADRIA_CHECK(alerts.size() == 2);
+	}
+
+	ADRIA_TEST(GfxTimingHistory_Dumps)
+	{
+		//scope names come from pass names, which may contain anything
+		Char const* names[] = { "GBuffer Pass", "Quote \"Pass\"", "Comma, Pass", "Back\\slash", "New\nLine\tTab" };
+		GfxTimingHistory history;
+		for (Char const* name : names)
+		{
+			Uint32 const scope = history.RegisterScope(name);
+			for (Uint32 frame = 0; frame < 10; ++frame) history.AddSample(scope, frame, frame * 0.5f);
+		}
+
+		std::string const json_path = paths::SavedDir + "GfxTimingHistoryTest.json";
+		ADRIA_CHECK(history.WriteJson(json_path));
+		json dump = json::parse(ReadFile(json_path), nullptr, false);
+		ADRIA_CHECK(!dump.is_discarded() && dump["scopes"].size() == std::size(names));
+		if (!dump.is_discarded() && dump["scopes"].size() == std::size(names))
+		{
+			for (Uint64 i = 0; i < std::size(names); ++i)
+			{
+				ADRIA_CHECK(dump["scopes"][i]["name"].get<std::string>() == names[i]);
+				ADRIA_CHECK(dump["scopes"][i]["samples"].get<Uint32>() == 10 && dump["scopes"][i]["max_ms"].get<Float>() == 4.5f);
+			}
+		}
+
+		std::string const csv_path = paths::SavedDir + "GfxTimingHistoryTest.csv";
+		ADRIA_CHECK(history.WriteCsv(csv_path));
+		std::string const csv = ReadFile(csv_path);
+		ADRIA_CHECK(csv.find("\n\"Quote \"\"Pass\"\"\",10,") != std::string::npos);
+		ADRIA_CHECK(csv.find("\n\"Comma, Pass\",10,") != std::string::npos);
+		ADRIA_CHECK(csv.find("\n\"New\nLine\tTab\",10,") != std::string::npos);
+	}
+}
@@ -0,0 +1,279 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Utilities/Heightmap.h"
+#include "Utilities/SimdNoise.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/Timer.h"
+#include "Cpp/FastNoiseLite.h"
+
+namespace adria
+{
+	namespace
+	{
+		//the four-wide path evaluates the same operations in the same order, only fused multiply-adds may round differently
+		constexpr Float NOISE_TOLERANCE = 1e-5f;
+
+		FastNoiseLite MakeScalarNoise(NoiseDesc const& desc)
+		{
+			FastNoiseLite noise{};
+			switch (desc.noise_type)
+			{
+			case NoiseType::OpenSimplex2:	noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2); break;
+			case NoiseType::OpenSimplex2S:	noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2S); break;
+			case NoiseType::Cellular:		noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2); break;
+			case NoiseType::ValueCubic:		noise.SetNoiseType(FastNoiseLite::NoiseType_ValueCubic); break;
+			case NoiseType::Value:			noise.SetNoiseType(FastNoiseLite::NoiseType_Value); break;
+			case NoiseType::Perlin:
+			default:						noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin); break;
+			}
+			switch (desc.fractal_type)
+			{
+			case FractalType::FBM:		noise.SetFractalType(FastNoiseLite::FractalType_FBm); break;
+			case FractalType::Ridged:	noise.SetFractalType(FastNoiseLite::FractalType_Ridged); break;
+			case FractalType::PingPong:	noise.SetFractalType(FastNoiseLite::FractalType_PingPong); break;
+			case FractalType::None:
+			default:					noise.SetFractalType(FastNoiseLite::FractalType_None); break;
+			}
+			noise.SetSeed(desc.seed);
+			noise.SetFractalOctaves(desc.octaves);
+			noise.SetFractalLacunarity(desc.lacunarity);
+			noise.SetFractalGain(desc.persistence);
+			noise.SetFrequency(desc.frequency);
+			return noise;
+		}
+
+		//single threaded generation with a separate rescale pass, as the heightmap was built before tiling
+		std::vector<Float> GenerateScalarReference(NoiseDesc const& desc)
+		{
+			FastNoiseLite noise = MakeScalarNoise(desc);
+			std::vector<Float> heights(desc.width * desc.depth);
+			Float min_height = std::numeric_limits<Float>::max();
+			Float max_height = std::numeric_limits<Float>::lowest();
+			for (Uint32 z = 0; z < desc.depth; z++)
+			{
+				for (Uint32 x = 0; x < desc.width; x++)
+				{
+					Float const xf = x * desc.noise_scale / desc.width;
+					Float const zf = z * desc.noise_scale / desc.depth;
+					Float const height = noise.GetNoise(xf, zf) * desc.max_height;
+					heights[z * desc.width + x] = height;
+					min_height = std::min(min_height, height);
+					max_height = std::max(max_height, height);
+				}
+			}
+			for (Float& height : heights)
+			{
+				height = (height - min_height) / (max_height - min_height) * 2 * desc.max_height - desc.max_height;
+			}
+			return heights;
+		}
+
+		Float MaxDifference(Heightmap const& heightmap, std::vector<Float> const& reference)
+		{
+			Float max_difference = 0.0f;
+			for (Uint64 z = 0; z < heightmap.Depth(); ++z)
+			{
+				for (Uint64 x = 0; x < heightmap.Width(); ++x)
+				{
+					max_difference = std::max(max_difference, std::abs(heightmap.HeightAt(x, z) - reference[z * heightmap.Width() + x]));
+				}
+			}
+			return max_difference;
+		}
+
+		std::vector<Float> CopyHeights(Heightmap const& heightmap)
+		{
+			std::vector<Float> heights(heightmap.Width() * heightmap.Depth());
+			for (Uint64 z = 0; z < heightmap.Depth(); ++z)
+			{
+				for (Uint64 x = 0; x < heightmap.Width(); ++x) heights[z * heightmap.Width() + x] = heightmap.HeightAt(x, z);
+			}
+			return heights;
+		}
+
+		//thermal erosion as it was before it was vectorized and split into jobs, one cell at a time on one thread
+		void ApplyThermalErosionReference(std::vector<Float>& heights, Int64 width, Int64 depth, ThermalErosionDesc const& desc)
+		{
+			constexpr Int64 offsets[8][2] = { {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}, {-1, -1}, {0, -1}, {1, -1} };
+			auto Contains = [&](Int64 x, Int64 z) { return x >= 0 && z >= 0 && x < width && z < depth; };
+			std::vector<Float> factors(heights.size()), eroded(heights.size());
+			for (Int32 k = 0; k < desc.iterations; ++k)
+			{
+				for (Int64 z = 0; z < depth; ++z)
+				{
+					for (Int64 x = 0; x < width; ++x)
+					{
+						Float const h = heights[z * width + x];
+						Float max_diff = 0.0f, total_diff = 0.0f;
+						for (auto const& [dx, dz] : offsets)
+						{
+							if (!Contains(x + dx, z + dz)) continue;
+							Float const d = h - heights[(z + dz) * width + x + dx];
+							if (d > desc.talus)
+							{
+								total_diff += d;
+								max_diff = std::max(max_diff, d);
+							}
+						}
+						factors[z * width + x] = total_diff > 0.0f ? desc.c * (max_diff - desc.talus) / total_diff : 0.0f;
+					}
+				}
+				for (Int64 z = 0; z < depth; ++z)
+				{
+					for (Int64 x = 0; x < width; ++x)
+					{
+						Float const h = heights[z * width + x];
+						Float result = h;
+						for (auto const& [dx, dz] : offsets)
+						{
+							if (!Contains(x + dx, z + dz)) continue;
+							Float const d = heights[(z + dz) * width + x + dx] - h;
+							if (d > desc.talus) result += factors[(z + dz) * width + x + dx] * d;
+						}
+						eroded[z * width + x] = result;
+					}
+				}
+				heights.swap(eroded);
+			}
+		}
+	}
+
+	ADRIA_TEST(Heightmap_SimdNoiseMatchesFastNoiseLite)
+	{
+		for (NoiseType noise_type : { NoiseType::Perlin, NoiseType::OpenSimplex2 })
+		{
+			for (FractalType fractal_type : { FractalType::None, FractalType::FBM })
+			{
+				NoiseDesc desc{ .width = 512, .depth = 512, .max_height = 100, .fractal_type = fractal_type, .noise_type = noise_type };
+				desc.frequency = 0.037f;
+				ADRIA_CHECK(SimdNoise::IsSupported(desc));
+				SimdNoise simd_noise(desc);
+				FastNoiseLite scalar_noise = MakeScalarNoise(desc);
+
+				//negative coordinates and a count that leaves a partial batch
+				Uint32 const count = desc.width - 3;
+				std::vector<Float> xs(desc.width), row(desc.width);
+				for (Uint32 x = 0; x < desc.width; ++x) xs[x] = x * 0.7f - 150.0f;
+
+				Float max_error = 0.0f;
+				for (Uint32 z = 0; z < desc.depth; ++z)
+				{
+					Float const y = z * 0.7f - 150.0f;
+					simd_noise.GetNoiseRow(xs.data(), y, row.data(), count);
+					for (Uint32 x = 0; x < count; ++x) max_error = std::max(max_error, std::abs(row[x] - scalar_noise.GetNoise(xs[x], y)));
+				}
+				ADRIA_CHECK(max_error <= NOISE_TOLERANCE);
+			}
+		}
+
+		NoiseDesc unsupported_desc{ .width = 1, .depth = 1, .max_height = 1, .fractal_type = FractalType::Ridged };
+		ADRIA_CHECK(!SimdNoise::IsSupported(unsupported_desc));
+		unsupported_desc.fractal_type = FractalType::FBM;
+		unsupported_desc.noise_type = NoiseType::Value;
+		ADRIA_CHECK(!SimdNoise::IsSupported(unsupported_desc));
+	}
+
+	ADRIA_TEST(Heightmap_TiledMatchesScalarReference)
+	{
+		TestJobSystemScope job_system_scope;
+		//the unsupported combinations go through FastNoiseLite in every tile
+		std::pair<NoiseType, FractalType> const combinations[] =
+		{
+			{ NoiseType::Perlin, FractalType::None },
+			{ NoiseType::Perlin, FractalType::FBM },
+			{ NoiseType::OpenSimplex2, FractalType::FBM },
+			{ NoiseType::Value, FractalType::Ridged },
+		};
+		//sizes below one tile, not a multiple of the tile height and not a multiple of the SIMD width
+		std::pair<Uint32, Uint32> const sizes[] = { { 1, 1 }, { 5, 3 }, { 67, 33 }, { 257, 129 } };
+		for (auto const& [noise_type, fractal_type] : combinations)
+		{
+			for (auto const& [width, depth] : sizes)
+			{
+				NoiseDesc const desc{ .width = width, .depth = depth, .max_height = 200, .fractal_type = fractal_type, .noise_type = noise_type };
+				Heightmap const heightmap(desc);
+				ADRIA_CHECK(heightmap.Width() == width && heightmap.Depth() == depth);
+				if (width * depth < 2) continue;
+
+				//rescaling amplifies the noise error by max_height over half the noise range
+				ADRIA_CHECK(MaxDifference(heightmap, GenerateScalarReference(desc)) <= 1e-2f);
+
+				//tiles write disjoint rows and reduce min/max per tile, so the result doesn't depend on scheduling
+				Heightmap const second_heightmap(desc);
+				std::vector<Float> first_heights(width * depth);
+				for (Uint32 z = 0; z < depth; ++z) for (Uint32 x = 0; x < width; ++x) first_heights[z * width + x] = heightmap.HeightAt(x, z);
+				ADRIA_CHECK(MaxDifference(second_heightmap, first_heights) == 0.0f);
+			}
+		}
+	}
+
+	//rows not a multiple of the job size or of the SIMD width, so every job and every row tail is exercised
+	ADRIA_TEST(Heightmap_ThermalErosionMatchesScalarReference)
+	{
+		NoiseDesc const desc{ .width = 131, .depth = 75, .max_height = 200, .fractal_type = FractalType::FBM, .noise_type = NoiseType::Perlin };
+		ThermalErosionDesc const thermal_desc{ .iterations = 8, .c = 0.5f, .talus = 0.1f };
+
+		std::vector<std::vector<Float>> results;
+		for (Uint32 thread_count : { 1u, 2u, 8u })
+		{
+			TestJobSystemScope job_system_scope(thread_count);
+			Heightmap heightmap(desc);
+			std::vector<Float> reference = CopyHeights(heightmap);
+			heightmap.ApplyThermalErosion(thermal_desc);
+			ApplyThermalErosionReference(reference, desc.width, desc.depth, thermal_desc);
+			//the vector path adds the same terms in the same order, only fused multiply-adds may round differently
+			ADRIA_CHECK(MaxDifference(heightmap, reference) <= 1e-3f);
+			results.push_back(CopyHeights(heightmap));
+		}
+		//rows are written by exactly one job from the previous iteration's heights, so the worker count can't change a bit
+		ADRIA_CHECK(results[0] == results[1] && results[0] == results[2]);
+	}
+
+	//more drops than one batch, so the result depends on the batches being applied in drop order
+	ADRIA_TEST(Heightmap_HydraulicErosionIsDeterministic)
+	{
+		NoiseDesc const desc{ .width = 131, .depth = 75, .max_height = 200, .fractal_type = FractalType::FBM, .noise_type = NoiseType::Perlin };
+		HydraulicErosionDesc const hydraulic_desc{ .iterations = 40, .drops = 20000, .carrying_capacity = 1.5f, .deposition_speed = 0.03f };
+
+		std::vector<std::vector<Float>> results;
+		for (Uint32 thread_count : { 1u, 2u, 8u })
+		{
+			TestJobSystemScope job_system_scope(thread_count);
+			Heightmap heightmap(desc);
+			std::vector<Float> const noise_heights = CopyHeights(heightmap);
+			heightmap.ApplyHydraulicErosion(hydraulic_desc);
+			ADRIA_CHECK(MaxDifference(heightmap, noise_heights) > 0.0f);
+			results.push_back(CopyHeights(heightmap));
+		}
+		ADRIA_CHECK(results[0] == results[1] && results[0] == results[2]);
+
+		//a different seed moves different droplets
+		TestJobSystemScope job_system_scope;
+		Heightmap heightmap(desc);
+		HydraulicErosionDesc other_desc = hydraulic_desc;
+		other_desc.seed = 7;
+		heightmap.ApplyHydraulicErosion(other_desc);
+		ADRIA_CHECK(CopyHeights(heightmap) != results[0]);
+	}
+
+	ADRIA_BENCHMARK(Heightmap_NoiseGeneration)
+	{
+		TestJobSystemScope job_system_scope;
+		for (Uint32 size : { 1024u, 4096u, 8192u })
+		{
+			NoiseDesc const desc{ .width = size, .depth = size, .max_height = 200, .fractal_type = FractalType::FBM, .noise_type = NoiseType::Perlin };
+
+			Timer<std::chrono::microseconds> scalar_timer;
+			std::vector<Float> reference = GenerateScalarReference(desc);
+			Float const scalar_ms = scalar_timer.Elapsed() / 1000.0f;
+
+			Timer<std::chrono::microseconds> tiled_timer;
+			Heightmap const heightmap(desc);
+			Float const tiled_ms = tiled_timer.Elapsed() / 1000.0f;
+
+			ADRIA_CHECK(MaxDifference(heightmap, reference) <= 1e-2f);
+			ADRIA_LOG(INFO, "%ux%u FBM Perlin: scalar %.1f ms, tiled four-wide on %u threads %.1f ms (%.1fx)", size, size,
+				scalar_ms, std::thread::hardware_concurrency(), tiled_ms, scalar_ms / std::max(tiled_ms, 1e-3f));
+		}
+	}
+}
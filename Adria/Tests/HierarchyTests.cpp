@@ -0,0 +1,130 @@
+#include "TestRegistry.h"
+#include "Rendering/Hierarchy.h"
+#include "Rendering/Components.h"
+#include "tecs/registry.h"
+
+namespace adria
+{
+	namespace
+	{
+		std::vector<tecs::entity> GetChildren(tecs::registry& reg, tecs::entity parent)
+		{
+			std::vector<tecs::entity> children;
+			ForEachChild(reg, parent, [&](tecs::entity child) { children.push_back(child); });
+			return children;
+		}
+
+		//the sibling links agree in both directions and with the parent's count
+		Bool LinksValid(tecs::registry& reg, tecs::entity parent)
+		{
+			Relationship const& relationship = reg.get<Relationship>(parent);
+			tecs::entity previous = tecs::null_entity;
+			Uint32 count = 0;
+			for (tecs::entity child = relationship.first_child; child != tecs::null_entity; child = reg.get<Relationship>(child).next_sibling)
+			{
+				Relationship const& child_relationship = reg.get<Relationship>(child);
+				if (child_relationship.parent != parent || child_relationship.prev_sibling != previous) return false;
+				previous = child;
+				++count;
+			}
+			return count == relationship.children_count;
+		}
+	}
+
+	ADRIA_TEST(Hierarchy_Parenting)
+	{
+		tecs::registry reg;
+		tecs::entity root = reg.create();
+		tecs::entity a = reg.create(), b = reg.create(), c = reg.create();
+		tecs::entity a1 = reg.create(), a2 = reg.create(), b1 = reg.create();
+		AttachChild(reg, root, a);
+		AttachChild(reg, root, b);
+		AttachChild(reg, root, c);
+		AttachChild(reg, a, a1);
+		AttachChild(reg, a, a2);
+		AttachChild(reg, b, b1);
+
+		//children are prepended
+		ADRIA_CHECK((GetChildren(reg, root) == std::vector<tecs::entity>{ c, b, a }));
+		ADRIA_CHECK((GetChildren(reg, a) == std::vector<tecs::entity>{ a2, a1 }));
+		ADRIA_CHECK(LinksValid(reg, root) && LinksValid(reg, a) && LinksValid(reg, b));
+		ADRIA_CHECK(reg.get<Relationship>(root).parent == tecs::null_entity && reg.get<Relationship>(a1).parent == a);
+		ADRIA_CHECK(GetChildren(reg, c).empty() && reg.get<Relationship>(c).children_count == 0);
+
+		std::vector<tecs::entity> depth_first, breadth_first;
+		ForEachDescendantDepthFirst(reg, root, [&](tecs::entity e) { depth_first.push_back(e); });
+		ForEachDescendantBreadthFirst(reg, root, [&](tecs::entity e) { breadth_first.push_back(e); });
+		ADRIA_CHECK((depth_first == std::vector<tecs::entity>{ c, b, b1, a, a2, a1 }));
+		ADRIA_CHECK((breadth_first == std::vector<tecs::entity>{ c, b, a, b1, a2, a1 }));
+	}
+
+	ADRIA_TEST(Hierarchy_Reparenting)
+	{
+		tecs::registry reg;
+		tecs::entity root = reg.create(), other_root = reg.create();
+		tecs::entity a = reg.create(), b = reg.create(), c = reg.create();
+		AttachChild(reg, root, a);
+		AttachChild(reg, root, b);
+		AttachChild(reg, root, c);
+		AttachChild(reg, a, reg.create());
+
+		//moving the middle child relinks its old siblings, the subtree moves along
+		Uint64 const relationship_tick = reg.tick<Relationship>();
+		AttachChild(reg, other_root, b);
+		ADRIA_CHECK(reg.tick<Relationship>() != relationship_tick);
+		ADRIA_CHECK((GetChildren(reg, root) == std::vector<tecs::entity>{ c, a }) && (GetChildren(reg, other_root) == std::vector<tecs::entity>{ b }));
+		ADRIA_CHECK(LinksValid(reg, root) && LinksValid(reg, other_root));
+		AttachChild(reg, other_root, a);
+		ADRIA_CHECK((GetChildren(reg, other_root) == std::vector<tecs::entity>{ a, b }) && reg.get<Relationship>(a).children_count == 1);
+
+		//attaching to the same parent again moves the child to the front
+		AttachChild(reg, other_root, b);
+		ADRIA_CHECK((GetChildren(reg, other_root) == std::vector<tecs::entity>{ b, a }) && LinksValid(reg, other_root));
+
+		//detaching the first and the last child
+		DetachChild(reg, b);
+		DetachChild(reg, c);
+		ADRIA_CHECK((GetChildren(reg, other_root) == std::vector<tecs::entity>{ a }) && GetChildren(reg, root).empty());
+		ADRIA_CHECK(LinksValid(reg, root) && LinksValid(reg, other_root));
+		Relationship const& detached = reg.get<Relationship>(b);
+		ADRIA_CHECK(detached.parent == tecs::null_entity && detached.prev_sibling == tecs::null_entity && detached.next_sibling == tecs::null_entity);
+
+		//detaching an entity without a parent or a Relationship does nothing
+		tecs::entity loose = reg.create();
+		DetachChild(reg, b);
+		DetachChild(reg, loose);
+		ADRIA_CHECK(!reg.has<Relationship>(loose) && LinksValid(reg, other_root));
+	}
+
+	ADRIA_TEST(Hierarchy_DestroyWithDescendants)
+	{
+		tecs::registry reg;
+		tecs::entity root = reg.create();
+		tecs::entity a = reg.create(), b = reg.create();
+		tecs::entity a1 = reg.create(), a2 = reg.create(), a11 = reg.create();
+		AttachChild(reg, root, a);
+		AttachChild(reg, root, b);
+		AttachChild(reg, a, a1);
+		AttachChild(reg, a, a2);
+		AttachChild(reg, a1, a11);
+		reg.emplace<Transform>(a11);
+
+		//the subtree goes, its old siblings and parent stay linked
+		DestroyWithDescendants(reg, a);
+		ADRIA_CHECK(!reg.valid(a) && !reg.valid(a1) && !reg.valid(a2) && !reg.valid(a11));
+		ADRIA_CHECK(reg.valid(root) && reg.valid(b) && reg.alive() == 2);
+		ADRIA_CHECK((GetChildren(reg, root) == std::vector<tecs::entity>{ b }) && LinksValid(reg, root));
+		ADRIA_CHECK(reg.size<Relationship>() == 2 && reg.size<Transform>() == 0);
+
+		//recycled entities start without links
+		tecs::entity recycled = reg.create();
+		ADRIA_CHECK(!reg.has<Relationship>(recycled));
+
+		DestroyWithDescendants(reg, root);
+		ADRIA_CHECK(!reg.valid(root) && !reg.valid(b) && reg.alive() == 1 && reg.size<Relationship>() == 0);
+
+		//an entity outside any hierarchy is only destroyed
+		DestroyWithDescendants(reg, recycled);
+		ADRIA_CHECK(reg.alive() == 0);
+	}
+}
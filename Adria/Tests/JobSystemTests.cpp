@@ -0,0 +1,204 @@
+#include <future>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/ConcurrentQueue.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		//the mutex and condition variable pool the job system replaced, kept as the benchmark baseline
+		class BaselineThreadPool
+		{
+		public:
+			BaselineThreadPool()
+			{
+				Uint32 const thread_count = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+				for (Uint32 i = 0; i < thread_count; ++i) threads.emplace_back(&BaselineThreadPool::ThreadWork, this);
+			}
+			~BaselineThreadPool()
+			{
+				{
+					std::unique_lock<std::mutex> lk(cond_mutex);
+					done = true;
+					cond_var.notify_all();
+				}
+				for (std::thread& thread : threads) thread.join();
+			}
+
+			template<typename F>
+			std::future<void> Submit(F&& f)
+			{
+				auto wrapped_task = std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+				std::future<void> result_future = wrapped_task->get_future();
+				task_queue.Push([wrapped_task]() { (*wrapped_task)(); });
+				cond_var.notify_one();
+				return result_future;
+			}
+
+		private:
+			std::vector<std::thread> threads;
+			ConcurrentQueue<std::function<void()>> task_queue;
+			Bool done = false;
+			std::condition_variable cond_var;
+			std::mutex cond_mutex;
+
+		private:
+			void ThreadWork()
+			{
+				std::function<void()> task;
+				while (true)
+				{
+					Bool pop_success;
+					{
+						std::unique_lock<std::mutex> lk(cond_mutex);
+						while (!done && task_queue.Empty()) cond_var.wait(lk);
+						if (done) return;
+						pop_success = task_queue.TryPop(task);
+					}
+					if (pop_success)
+					{
+						task();
+						task = nullptr;
+					}
+				}
+			}
+		};
+	}
+
+	ADRIA_TEST(JobSystem_ParallelFor)
+	{
+		TestJobSystemScope job_system_scope;
+		constexpr Uint32 COUNT = 1 << 20;
+		std::vector<Uint32> visits(COUNT, 0);
+		g_JobSystem.ParallelFor(COUNT, 1024, [&](Uint32 i) { ++visits[i]; });
+		ADRIA_CHECK(std::all_of(visits.begin(), visits.end(), [](Uint32 visit_count) { return visit_count == 1; }));
+
+		std::atomic<Uint64> sum = 0;
+		g_JobSystem.ParallelFor(COUNT, 333, [&](Uint32 begin, Uint32 end)
+			{
+				Uint64 range_sum = 0;
+				for (Uint32 i = begin; i < end; ++i) range_sum += i;
+				sum.fetch_add(range_sum, std::memory_order_relaxed);
+			});
+		ADRIA_CHECK(sum.load() == (Uint64)COUNT * (COUNT - 1) / 2);
+
+		//nested loops schedule from worker threads
+		std::atomic<Uint32> nested_count = 0;
+		g_JobSystem.ParallelFor(64, 1, [&](Uint32)
+			{
+				g_JobSystem.ParallelFor(1000, 10, [&](Uint32) { nested_count.fetch_add(1, std::memory_order_relaxed); });
+			});
+		ADRIA_CHECK(nested_count.load() == 64 * 1000);
+
+		Uint32 small_count = 0;
+		g_JobSystem.ParallelFor(0, 16, [&](Uint32) { ++small_count; });
+		g_JobSystem.ParallelFor(5, 16, [&](Uint32) { ++small_count; });
+		ADRIA_CHECK(small_count == 5);
+	}
+
+	ADRIA_TEST(JobSystem_ChildJobs)
+	{
+		TestJobSystemScope job_system_scope;
+		//children keep the parent's pool slot alive, so stay below the pool size of a worker
+		constexpr Uint32 CHILD_COUNT = 2000;
+		std::atomic<Uint32> finished_children = 0;
+
+		Job* parent = g_JobSystem.CreateJob([] {});
+		for (Uint32 i = 0; i < CHILD_COUNT; ++i)
+		{
+			g_JobSystem.Run(g_JobSystem.CreateChildJob(parent, [&finished_children] { finished_children.fetch_add(1, std::memory_order_relaxed); }));
+		}
+		JobCounter counter{};
+		g_JobSystem.Run(parent, &counter);
+		g_JobSystem.Wait(counter);
+		ADRIA_CHECK(finished_children.load() == CHILD_COUNT);
+
+		//more jobs than a worker's job pool, the pool slots are recycled while they run
+		JobCounter many_counter{};
+		std::atomic<Uint32> executed = 0;
+		for (Uint32 i = 0; i < 100000; ++i)
+		{
+			g_JobSystem.Submit([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, many_counter);
+		}
+		g_JobSystem.Wait(many_counter);
+		ADRIA_CHECK(executed.load() == 100000);
+	}
+
+	ADRIA_TEST(JobSystem_DequeSteal)
+	{
+		//the owner pushes and pops while thieves steal, every job has to come out exactly once
+		constexpr Uint32 JOB_COUNT = 200000;
+		constexpr Uint32 THIEF_COUNT = 3;
+		std::unique_ptr<Job[]> jobs = std::make_unique<Job[]>(JOB_COUNT);
+		std::vector<std::atomic<Uint32>> taken(JOB_COUNT);
+		auto Take = [&](Job* job) { taken[job - jobs.get()].fetch_add(1, std::memory_order_relaxed); };
+
+		JobDeque deque;
+		std::atomic<Bool> done = false;
+		std::atomic<Uint32> stolen = 0;
+		std::vector<std::thread> thieves;
+		for (Uint32 i = 0; i < THIEF_COUNT; ++i)
+		{
+			thieves.emplace_back([&]()
+				{
+					while (!done.load(std::memory_order_acquire) || deque.Size() > 0)
+					{
+						if (Job* job = deque.Steal())
+						{
+							Take(job);
+							stolen.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				});
+		}
+
+		Uint32 pushed = 0;
+		while (pushed < JOB_COUNT)
+		{
+			Uint32 const batch = (std::min)(JOB_COUNT - pushed, 1000u);
+			if (deque.Size() + batch >= JobDeque::CAPACITY) continue;
+			for (Uint32 i = 0; i < batch; ++i) deque.Push(&jobs[pushed++]);
+			for (Uint32 i = 0; i < batch / 2; ++i) if (Job* job = deque.Pop()) Take(job);
+		}
+		while (Job* job = deque.Pop()) Take(job);
+		done.store(true, std::memory_order_release);
+		for (std::thread& thief : thieves) thief.join();
+
+		ADRIA_CHECK(std::all_of(taken.begin(), taken.end(), [](std::atomic<Uint32> const& count) { return count.load() == 1; }));
+		ADRIA_LOG(INFO, "%u of %u jobs were stolen", stolen.load(), JOB_COUNT);
+	}
+
+	ADRIA_BENCHMARK(JobSystem_TinyTasks)
+	{
+		BaselineThreadPool baseline_pool;
+		TestJobSystemScope job_system_scope;
+
+		for (Uint32 task_count : { 1000u, 100000u, 1000000u })
+		{
+			std::atomic<Uint64> sink = 0;
+			std::vector<std::future<void>> futures;
+			futures.reserve(task_count);
+			Timer<std::chrono::microseconds> baseline_timer;
+			for (Uint32 i = 0; i < task_count; ++i) futures.push_back(baseline_pool.Submit([&sink, i] { sink.fetch_add(i, std::memory_order_relaxed); }));
+			for (std::future<void>& future : futures) future.wait();
+			Float const baseline_ms = baseline_timer.Elapsed() / 1000.0f;
+
+			JobCounter counter{};
+			Timer<std::chrono::microseconds> job_timer;
+			for (Uint32 i = 0; i < task_count; ++i) g_JobSystem.Submit([&sink, i] { sink.fetch_add(i, std::memory_order_relaxed); }, counter);
+			g_JobSystem.Wait(counter);
+			Float const job_ms = job_timer.Elapsed() / 1000.0f;
+
+			Timer<std::chrono::microseconds> parallel_for_timer;
+			g_JobSystem.ParallelFor(task_count, 256, [&sink](Uint32 i) { sink.fetch_add(i, std::memory_order_relaxed); });
+			Float const parallel_for_ms = parallel_for_timer.Elapsed() / 1000.0f;
+
+			ADRIA_CHECK(sink.load() == 3 * ((Uint64)task_count * (task_count - 1) / 2));
+			ADRIA_LOG(INFO, "%u tasks: thread pool %.3f ms, job system %.3f ms (%.1fx), ParallelFor %.3f ms", task_count,
+				baseline_ms, job_ms, baseline_ms / (std::max)(job_ms, 1e-3f), parallel_for_ms);
+		}
+	}
+}
@@ -0,0 +1,222 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Rendering/LightTable.h"
+#include "Rendering/Components.h"
+#include "tecs/registry.h"
+#include "Utilities/JobSystem.h"
+#include "Utilities/Random.h"
+#include "Utilities/Timer.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Float TRANSFORM_TOLERANCE = 1e-3f;
+		constexpr Uint64 BLOCK_BYTES = LightTable::BLOCK_SIZE * sizeof(LightSBuffer);
+
+		Matrix MakeView(Vector3 const& eye)
+		{
+			return XMMatrixLookAtLH(eye, Vector3(0.0f, 0.0f, 0.0f), Vector3::Up);
+		}
+
+		void AddRandomLights(tecs::registry& reg, Uint32 count, Uint32 seed)
+		{
+			RealRandomGenerator<Float> position(-200.0f, 200.0f, std::mt19937{ seed });
+			for (Uint32 i = 0; i < count; ++i)
+			{
+				Light light{};
+				light.position = Vector4(position(), position(), position(), 1.0f);
+				light.direction = Vector4(position(), position(), position(), 0.0f);
+				light.type = LightType::Point;
+				light.range = 10.0f + i % 7;
+				reg.emplace<Light>(reg.create(), light);
+			}
+		}
+
+		//what the renderer did before the table: every light gathered and transformed to view space one at a time
+		void GatherLights(tecs::registry& reg, Matrix const& view, std::vector<LightSBuffer>& lights)
+		{
+			auto light_view = reg.view<Light>();
+			lights.resize(light_view.size());
+			g_JobSystem.ParallelFor((Uint32)light_view.size(), 64, [&](Uint32 i)
+				{
+					Light const& light = light_view.get(light_view[i]);
+					LightSBuffer& light_data = lights[i];
+					light_data = LightSBuffer{};
+					light_data.color = light.color * light.energy;
+					light_data.position = Vector4::Transform(light.position, view);
+					light_data.direction = Vector4::Transform(light.direction, view);
+					light_data.range = light.range;
+					light_data.type = static_cast<Int32>(light.type);
+					light_data.inner_cosine = light.inner_cosine;
+					light_data.outer_cosine = light.outer_cosine;
+					light_data.active = light.active;
+					light_data.casts_shadows = light.casts_shadows;
+					light_data.use_cascades = light.use_cascades;
+				});
+		}
+
+		Bool NearlyEqual(Vector4 const& a, Vector4 const& b)
+		{
+			return std::abs(a.x - b.x) <= TRANSFORM_TOLERANCE && std::abs(a.y - b.y) <= TRANSFORM_TOLERANCE &&
+				   std::abs(a.z - b.z) <= TRANSFORM_TOLERANCE && std::abs(a.w - b.w) <= TRANSFORM_TOLERANCE;
+		}
+
+		//the table holds what a full gather would produce, padding up to the capacity is inactive
+		Bool MatchesGather(tecs::registry& reg, LightTable const& table, Matrix const& view)
+		{
+			std::vector<LightSBuffer> expected;
+			GatherLights(reg, view, expected);
+			if (table.Size() != expected.size()) return false;
+			LightSBuffer const* data = table.Data();
+			for (Uint32 i = 0; i < table.Size(); ++i)
+			{
+				if (!NearlyEqual(data[i].position, expected[i].position) || !NearlyEqual(data[i].direction, expected[i].direction)) return false;
+				if (data[i].color != expected[i].color || data[i].range != expected[i].range || data[i].type != expected[i].type) return false;
+				if (data[i].active != expected[i].active) return false;
+			}
+			for (Uint32 i = table.Size(); i < table.Capacity(); ++i)
+			{
+				if (data[i].active) return false;
+			}
+			return true;
+		}
+
+		void UpdateTable(tecs::registry& reg, LightTable& table, Matrix const& view)
+		{
+			table.Sync(reg);
+			table.Transform(view);
+			table.Upload();
+		}
+	}
+
+	ADRIA_TEST(LightTable_DirtyBlocks)
+	{
+		TestJobSystemScope job_system_scope;
+		tecs::registry reg;
+		AddRandomLights(reg, 1000, 3);
+		Matrix view = MakeView(Vector3(0.0f, 50.0f, -300.0f));
+
+		//without a device the table counts what it would upload
+		LightTable table;
+		UpdateTable(reg, table, view);
+		LightTableStats stats = table.GetStats();
+		ADRIA_CHECK(table.Size() == 1000 && table.Capacity() == 1024);
+		ADRIA_CHECK(stats.synced_lights == 1000 && stats.transformed_lights == 1000);
+		ADRIA_CHECK(stats.upload_ranges == 1 && stats.uploaded_bytes == 1024 * sizeof(LightSBuffer));
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+
+		//nothing changed, nothing is synced, transformed or uploaded
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(stats.synced_lights == 0 && stats.transformed_lights == 0 && stats.upload_ranges == 0 && stats.uploaded_bytes == 0);
+
+		auto light_view = reg.view<Light>();
+		auto ModifyLight = [&](Uint32 i)
+			{
+				Light& light = reg.modify<Light>(light_view[i]);
+				light.position.y += 10.0f;
+				light.energy = 2.0f;
+			};
+
+		//one light dirties its block only
+		ModifyLight(300);
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(stats.synced_lights == 1 && stats.transformed_lights == LightTable::BLOCK_SIZE);
+		ADRIA_CHECK(stats.upload_ranges == 1 && stats.uploaded_bytes == BLOCK_BYTES);
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+
+		//neighbouring dirty blocks merge into one range, the last block is partly padding
+		ModifyLight(10);
+		ModifyLight(260);
+		ModifyLight(999);
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(stats.synced_lights == 3 && stats.transformed_lights == 2 * LightTable::BLOCK_SIZE + 1000 - 3 * LightTable::BLOCK_SIZE);
+		ADRIA_CHECK(stats.upload_ranges == 2 && stats.uploaded_bytes == 3 * BLOCK_BYTES);
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+
+		//a camera move transforms every light but syncs none
+		view = MakeView(Vector3(100.0f, 20.0f, -250.0f));
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(stats.synced_lights == 0 && stats.transformed_lights == 1000);
+		ADRIA_CHECK(stats.upload_ranges == 1 && stats.uploaded_bytes == 1024 * sizeof(LightSBuffer));
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+
+		//the last light moves into the removed one's position, the freed entry at the end becomes padding
+		reg.destroy(light_view[20]);
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(table.Size() == 999 && stats.synced_lights == 1);
+		ADRIA_CHECK(stats.upload_ranges == 2 && stats.uploaded_bytes == 2 * BLOCK_BYTES);
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+
+		table.Invalidate();
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(stats.synced_lights == 0 && stats.upload_ranges == 1 && stats.uploaded_bytes == 1024 * sizeof(LightSBuffer));
+
+		//growing past the capacity recreates the whole buffer
+		AddRandomLights(reg, 100, 4);
+		UpdateTable(reg, table, view);
+		stats = table.GetStats();
+		ADRIA_CHECK(table.Size() == 1099 && table.Capacity() == 2048);
+		ADRIA_CHECK(stats.synced_lights == 100);
+		ADRIA_CHECK(stats.upload_ranges == 1 && stats.uploaded_bytes == 2048 * sizeof(LightSBuffer));
+		ADRIA_CHECK(MatchesGather(reg, table, view));
+	}
+
+	ADRIA_BENCHMARK(LightTable_100kLights)
+	{
+		constexpr Uint32 LIGHT_COUNT = 100000;
+		constexpr Uint32 FRAME_COUNT = 100;
+		TestJobSystemScope job_system_scope;
+		tecs::registry reg;
+		AddRandomLights(reg, LIGHT_COUNT, 5);
+		auto light_view = reg.view<Light>();
+
+		auto CameraView = [](Uint32 frame) { return MakeView(Vector3(200.0f * std::sin(frame * 0.01f), 50.0f, -300.0f)); };
+
+		std::vector<LightSBuffer> gathered_lights;
+		Timer<std::chrono::microseconds> gather_timer;
+		for (Uint32 frame = 0; frame < FRAME_COUNT; ++frame) GatherLights(reg, CameraView(frame), gathered_lights);
+		Float const gather_ms = gather_timer.Elapsed() / 1000.0f / FRAME_COUNT;
+
+		LightTable table;
+		UpdateTable(reg, table, CameraView(0));
+
+		//per frame cost and upload size of a moving camera, one changed light and a static scene
+		auto MeasureFrames = [&](auto&& frame_function, Uint64& uploaded_bytes)
+			{
+				uploaded_bytes = 0;
+				Timer<std::chrono::microseconds> timer;
+				for (Uint32 frame = 0; frame < FRAME_COUNT; ++frame)
+				{
+					frame_function(frame);
+					uploaded_bytes += table.GetStats().uploaded_bytes;
+				}
+				uploaded_bytes /= FRAME_COUNT;
+				return timer.Elapsed() / 1000.0f / FRAME_COUNT;
+			};
+
+		Uint64 camera_bytes = 0, one_light_bytes = 0, static_bytes = 0;
+		Float const camera_ms = MeasureFrames([&](Uint32 frame) { UpdateTable(reg, table, CameraView(frame + 1)); }, camera_bytes);
+		Matrix const fixed_view = CameraView(FRAME_COUNT);
+		Float const one_light_ms = MeasureFrames([&](Uint32 frame)
+			{
+				reg.modify<Light>(light_view[(frame * 7919) % LIGHT_COUNT]).position.y += 1.0f;
+				UpdateTable(reg, table, fixed_view);
+			}, one_light_bytes);
+		Float const static_ms = MeasureFrames([&](Uint32) { UpdateTable(reg, table, fixed_view); }, static_bytes);
+
+		ADRIA_CHECK(MatchesGather(reg, table, fixed_view));
+		ADRIA_LOG(INFO, "%u lights on %u threads: gather every frame %.3f ms (%llu KB uploaded)", LIGHT_COUNT, std::thread::hardware_concurrency(),
+			gather_ms, (Uint64)(LIGHT_COUNT * sizeof(LightSBuffer)) / 1024);
+		ADRIA_LOG(INFO, "light table: camera move %.3f ms (%llu KB), one light changed %.3f ms (%llu KB), static %.3f ms (%llu KB)",
+			camera_ms, camera_bytes / 1024, one_light_ms, one_light_bytes / 1024, static_ms, static_bytes / 1024);
+	}
+}
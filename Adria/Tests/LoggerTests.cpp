@@ -0,0 +1,207 @@
+#include <numeric>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Utilities/ConcurrentQueue.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		//the log manager owns its loggers, messages end up in a vector owned by the test
+		class CaptureLogger : public ILogger
+		{
+		public:
+			explicit CaptureLogger(std::vector<std::string>& messages) : messages(messages) {}
+			virtual void Log(LogLevel level, Char const* entry, Char const* file, uint32_t line) override
+			{
+				messages.emplace_back(entry);
+			}
+		private:
+			std::vector<std::string>& messages;
+		};
+
+		template<typename... Args>
+		std::string Printf(Char const* format, Args... args)
+		{
+			Int32 const length = snprintf(nullptr, 0, format, args...);
+			std::string result(length, '\0');
+			snprintf(result.data(), length + 1, format, args...);
+			return result;
+		}
+
+		//what ADRIA_LOG did before the ring: formats with snprintf on the caller's thread into a mutex queue,
+		//the log thread spins on TryPop
+		class BaselineLogQueue
+		{
+		public:
+			BaselineLogQueue() : log_thread(&BaselineLogQueue::ProcessLogs, this) {}
+			~BaselineLogQueue()
+			{
+				exit.store(true);
+				log_thread.join();
+			}
+
+			template<typename... Args>
+			void Log(Char const* format, Args... args)
+			{
+				Int32 const length = snprintf(nullptr, 0, format, args...);
+				std::unique_ptr<Char[]> buffer = std::make_unique<Char[]>(length + 1);
+				snprintf(buffer.get(), length + 1, format, args...);
+				log_queue.Push(std::string(buffer.get()));
+			}
+
+		private:
+			ConcurrentQueue<std::string> log_queue;
+			std::atomic_bool exit = false;
+			std::thread log_thread;
+
+		private:
+			void ProcessLogs()
+			{
+				std::string message;
+				while (true)
+				{
+					if (log_queue.TryPop(message)) continue;
+					if (exit.load()) return;
+				}
+			}
+		};
+	}
+
+	ADRIA_TEST(Logger_Formatting)
+	{
+		std::vector<std::string> messages;
+		std::vector<std::string> expected;
+		{
+			LogManager log_manager;
+			log_manager.RegisterLogger(new CaptureLogger(messages));
+			auto Log = [&]<typename... Args>(std::string const& expected_message, Char const* format, Args const&... args)
+			{
+				log_manager.LogFormat(LogLevel::LOG_INFO, __FILE__, __LINE__, format, args...);
+				expected.push_back(expected_message);
+			};
+
+			Log("plain message with 100% and no arguments", "plain message with 100% and no arguments");
+			Log(Printf("%d %u %llu %zu %x %X %o %c %%", -5, 7u, 123456789012345ull, (size_t)42, 255, 255, 8, 'Q'),
+				"%d %u %llu %zu %x %X %o %c %%", -5, 7u, 123456789012345ull, (size_t)42, 255, 255, 8, 'Q');
+			Log(Printf("%f %.2f %e %g %10.3f|%-10.1f|", 3.5, 2.345, 1e-7, 0.25, 3.14159, 2.5), "%f %.2f %e %g %10.3f|%-10.1f|", 3.5f, 2.345, 1e-7, 0.25, 3.14159, 2.5);
+			Log(Printf("'%s' %-6s| %6s| %.2s", "str", "ab", "cd", "xyz"), "'%s' %-6s| %6s| %.2s", "str", "ab", "cd", std::string("xyz").c_str());
+			Log(Printf("%d %d", 1, 3), "%d %d", true, LogLevel::LOG_ERROR);
+			Log(Printf("%p", (void*)0x1234), "%p", (void*)0x1234);
+
+			//width and precision taken from the arguments
+			Log(Printf("[%*d] [%-*d] [%*d]", 6, 42, 6, 42, -6, 42), "[%*d] [%-*d] [%*d]", 6, 42, 6, 42, -6, 42);
+			Log(Printf("[%.*f] [%*.*f] [%.*f]", 3, 3.14159, 10, 2, 2.5, -1, 1.5), "[%.*f] [%*.*f] [%.*f]", 3, 3.14159, 10, 2, 2.5, -1, 1.5);
+			Log(Printf("[%*s] [%.*s] [%-*.*s]", 8, "pass", 3, "abcdef", 6, 2, "xyz"), "[%*s] [%.*s] [%-*.*s]", 8, "pass", 3, "abcdef", 6, 2, "xyz");
+			Log(Printf("%*s%s", 4, "", "indented"), "%*s%s", 4, "", "indented");
+
+			//missing arguments keep their spec, mismatched ones are marked
+			Log("missing 1 %d", "missing %d %d", 1);
+			Log("missing %*d", "missing %*d");
+			Log("<invalid log argument> <invalid log argument>", "%d %*d", "text", "width", 5);
+
+			std::string const long_string(2 * LogManager::MAX_PAYLOAD_SIZE, 'x');
+			Log(std::string(LogManager::MAX_PAYLOAD_SIZE - 5, 'x') + " [truncated]", "%s", long_string.c_str());
+		}
+		ADRIA_CHECK(messages.size() == expected.size());
+		for (Uint64 i = 0; i < std::min(messages.size(), expected.size()); ++i)
+		{
+			if (!ADRIA_CHECK(messages[i] == expected[i])) ADRIA_LOG(ERROR, "'%s' != '%s'", messages[i].c_str(), expected[i].c_str());
+		}
+	}
+
+	ADRIA_TEST(Logger_MultipleProducers)
+	{
+		constexpr Uint32 THREAD_COUNT = 16;
+		constexpr Uint32 MESSAGE_COUNT = 5000;
+		for (LogOverflowPolicy policy : { LogOverflowPolicy::Block, LogOverflowPolicy::Drop })
+		{
+			std::vector<std::string> messages;
+			LogStats stats{};
+			{
+				LogManager log_manager;
+				log_manager.SetOverflowPolicy(policy);
+				log_manager.RegisterLogger(new CaptureLogger(messages));
+				std::vector<std::thread> producers;
+				for (Uint32 t = 0; t < THREAD_COUNT; ++t)
+				{
+					producers.emplace_back([&log_manager, t]()
+						{
+							for (Uint32 i = 0; i < MESSAGE_COUNT; ++i) log_manager.LogFormat(LogLevel::LOG_DEBUG, __FILE__, __LINE__, "%u %u %s", t, i, "producer");
+						});
+				}
+				for (std::thread& producer : producers) producer.join();
+				while (log_manager.GetStats().processed + log_manager.GetStats().dropped < THREAD_COUNT * MESSAGE_COUNT) std::this_thread::yield();
+				stats = log_manager.GetStats();
+			}
+
+			//records of one producer come out in the order it pushed them
+			std::vector<Int64> last_index(THREAD_COUNT, -1);
+			Bool ordered = true;
+			for (std::string const& message : messages)
+			{
+				Uint32 t = 0, i = 0;
+				if (sscanf(message.c_str(), "%u %u", &t, &i) != 2 || t >= THREAD_COUNT || (Int64)i <= last_index[t]) ordered = false;
+				else last_index[t] = i;
+			}
+			ADRIA_CHECK(ordered);
+			ADRIA_CHECK(stats.processed == messages.size());
+			ADRIA_CHECK(stats.processed + stats.dropped == THREAD_COUNT * MESSAGE_COUNT);
+			if (policy == LogOverflowPolicy::Block) ADRIA_CHECK(stats.dropped == 0);
+			ADRIA_CHECK(stats.truncated == 0);
+		}
+	}
+
+	ADRIA_BENCHMARK(Logger_ProducerLatency)
+	{
+		constexpr Uint32 THREAD_COUNT = 16;
+		constexpr Uint32 MESSAGE_COUNT = 20000;
+
+		auto MeasureLatency = [&](Char const* name, auto&& log)
+		{
+			std::vector<std::vector<Uint32>> latencies(THREAD_COUNT, std::vector<Uint32>(MESSAGE_COUNT));
+			std::vector<std::thread> producers;
+			for (Uint32 t = 0; t < THREAD_COUNT; ++t)
+			{
+				producers.emplace_back([&, t]()
+					{
+						for (Uint32 i = 0; i < MESSAGE_COUNT; ++i)
+						{
+							auto const start = std::chrono::high_resolution_clock::now();
+							log(t, i);
+							latencies[t][i] = (Uint32)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+						}
+					});
+			}
+			for (std::thread& producer : producers) producer.join();
+
+			std::vector<Uint32> all_latencies;
+			all_latencies.reserve(THREAD_COUNT * MESSAGE_COUNT);
+			for (auto const& thread_latencies : latencies) all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+			std::sort(all_latencies.begin(), all_latencies.end());
+			Uint64 const total = std::accumulate(all_latencies.begin(), all_latencies.end(), 0ull);
+			ADRIA_LOG(INFO, "%s, %u producers: mean %llu ns, p50 %u ns, p99 %u ns, p99.9 %u ns, max %u ns", name, THREAD_COUNT,
+				total / all_latencies.size(), all_latencies[all_latencies.size() / 2], all_latencies[all_latencies.size() * 99 / 100],
+				all_latencies[all_latencies.size() * 999 / 1000], all_latencies.back());
+		};
+
+		{
+			BaselineLogQueue baseline;
+			MeasureLatency("snprintf into a mutex queue", [&](Uint32 t, Uint32 i) { baseline.Log("thread %u message %u value %f name %s", t, i, i * 0.5, "producer"); });
+		}
+		for (LogOverflowPolicy policy : { LogOverflowPolicy::Block, LogOverflowPolicy::Drop })
+		{
+			std::vector<std::string> messages;
+			LogManager log_manager;
+			log_manager.SetOverflowPolicy(policy);
+			log_manager.RegisterLogger(new CaptureLogger(messages));
+			MeasureLatency(policy == LogOverflowPolicy::Block ? "log ring, blocking" : "log ring, dropping", [&](Uint32 t, Uint32 i)
+				{
+					log_manager.LogFormat(LogLevel::LOG_DEBUG, __FILE__, __LINE__, "thread %u message %u value %f name %s", t, i, i * 0.5, "producer");
+				});
+			LogStats const stats = log_manager.GetStats();
+			ADRIA_LOG(INFO, "dropped %llu, blocked %llu, high water %llu of 4096 slots", stats.dropped, stats.blocked, stats.high_water_slots);
+		}
+	}
+}
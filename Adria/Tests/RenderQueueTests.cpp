@@ -0,0 +1,115 @@
+#include <random>
+#include "TestRegistry.h"
+#include "Rendering/RenderQueue.h"
+#include "Rendering/Components.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Float DEPTH_RANGE = 100.0f;
+
+		struct ItemState
+		{
+			ShaderProgram shader_program;
+			Bool double_sided;
+			Uint32 material_id;
+			Float depth;
+
+			auto operator<=>(ItemState const&) const = default;
+		};
+
+		ItemState GetState(RenderQueueItem const& item)
+		{
+			return ItemState{ item.shader_program, item.double_sided, item.material_id, item.depth };
+		}
+	}
+
+	//items come out ordered by shader program, raster state, material and depth, in that order of significance
+	ADRIA_TEST(RenderQueue_SortOrder)
+	{
+		ShaderProgram const programs[] = { ShaderProgram::GBufferPBR_Mask, ShaderProgram::Skybox, ShaderProgram::GBufferPBR };
+		std::vector<RenderQueueItem> pushed;
+		for (ShaderProgram program : programs)
+		{
+			for (Bool double_sided : { true, false })
+			{
+				for (Uint32 material_id : { 2u, 0u, 1u })
+				{
+					for (Float depth : { 75.0f, 0.0f, 25.0f, 50.0f })
+					{
+						pushed.push_back(RenderQueueItem{ .entity = (tecs::entity)pushed.size(), .shader_program = program,
+							.double_sided = double_sided, .material_id = material_id, .depth = depth });
+					}
+				}
+			}
+		}
+		std::shuffle(pushed.begin(), pushed.end(), std::mt19937{ 42 });
+
+		RenderQueue render_queue;
+		render_queue.Begin(DEPTH_RANGE);
+		for (RenderQueueItem const& item : pushed) render_queue.Push(RenderQueuePass_GBuffer, item);
+		render_queue.Sort();
+
+		std::vector<ItemState> expected;
+		for (RenderQueueItem const& item : pushed) expected.push_back(GetState(item));
+		std::sort(expected.begin(), expected.end());
+
+		std::vector<ItemState> submitted;
+		std::vector<Uint8> changes;
+		render_queue.Submit(RenderQueuePass_GBuffer, [&](RenderQueueItem const& item, Uint8 state_changes)
+			{
+				submitted.push_back(GetState(item));
+				changes.push_back(state_changes);
+			});
+		ADRIA_CHECK(submitted == expected);
+
+		//only the state that differs from the previous draw is reported
+		Bool changes_valid = changes.size() == expected.size();
+		for (Uint64 i = 0; changes_valid && i < expected.size(); ++i)
+		{
+			Uint8 expected_changes = RenderQueueStateChange_ShaderProgram | RenderQueueStateChange_RasterState | RenderQueueStateChange_Material;
+			if (i > 0)
+			{
+				expected_changes = RenderQueueStateChange_None;
+				if (expected[i].shader_program != expected[i - 1].shader_program) expected_changes |= RenderQueueStateChange_ShaderProgram;
+				if (expected[i].double_sided != expected[i - 1].double_sided) expected_changes |= RenderQueueStateChange_RasterState;
+				if (expected[i].material_id != expected[i - 1].material_id) expected_changes |= RenderQueueStateChange_Material;
+			}
+			changes_valid = changes[i] == expected_changes;
+		}
+		ADRIA_CHECK(changes_valid);
+
+		RenderQueueStats const& stats = render_queue.GetStats(RenderQueuePass_GBuffer);
+		ADRIA_CHECK(stats.draws == 72 && stats.shader_program_binds == 3 && stats.raster_state_binds == 6 && stats.material_binds == 18);
+		ADRIA_CHECK(stats.binds_saved == 3 * 72 - 27 && stats.cbuffer_updates == 72 + 18);
+	}
+
+	//depth is clamped to the range, equal keys keep the order they were pushed in
+	ADRIA_TEST(RenderQueue_DepthAndStability)
+	{
+		RenderQueue render_queue;
+		render_queue.Begin(DEPTH_RANGE);
+		Float const depths[] = { 2.0f * DEPTH_RANGE, 50.0f, -10.0f, DEPTH_RANGE, 0.0f, 50.0f };
+		for (Uint32 i = 0; i < std::size(depths); ++i)
+		{
+			render_queue.Push(RenderQueuePass_GBuffer, RenderQueueItem{ .entity = (tecs::entity)i, .shader_program = ShaderProgram::GBufferPBR,
+				.double_sided = false, .material_id = 0, .depth = depths[i] });
+		}
+		render_queue.Sort();
+		std::vector<tecs::entity> order;
+		render_queue.Submit(RenderQueuePass_GBuffer, [&](RenderQueueItem const& item, Uint8) { order.push_back(item.entity); });
+		ADRIA_CHECK((order == std::vector<tecs::entity>{ (tecs::entity)2, (tecs::entity)4, (tecs::entity)1, (tecs::entity)5, (tecs::entity)0, (tecs::entity)3 }));
+
+		//material ids are dense per frame and restart with the next one
+		Material material{};
+		Material other_material{};
+		other_material.roughness_factor = 0.5f;
+		render_queue.Begin(DEPTH_RANGE);
+		ADRIA_CHECK(render_queue.Size() == 0);
+		ADRIA_CHECK(render_queue.GetMaterialId(other_material) == 0 && render_queue.GetMaterialId(material) == 1);
+		ADRIA_CHECK(render_queue.GetMaterialId(other_material) == 0);
+		render_queue.Begin(DEPTH_RANGE);
+		ADRIA_CHECK(render_queue.GetMaterialId(material) == 0 && render_queue.GetMaterialId(other_material) == 1);
+	}
+}
@@ -0,0 +1,177 @@
+#include <fstream>
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Core/Paths.h"
+#include "Graphics/GfxShaderCache.h"
+#include "Graphics/GfxNullShaderCompiler.h"
+#include "Utilities/FilesUtil.h"
+#include "Utilities/Timer.h"
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint32 SHADER_FILE_COUNT = 64;
+
+		//scratch shader sources and archive, removed when the test ends
+		struct ShaderCacheTestDir
+		{
+			fs::path dir;
+
+			ShaderCacheTestDir() : dir(fs::temp_directory_path() / "adria_shader_cache_test")
+			{
+				fs::remove_all(dir);
+				fs::create_directories(dir);
+			}
+			~ShaderCacheTestDir()
+			{
+				std::error_code error;
+				fs::remove_all(dir, error);
+			}
+
+			std::string Path(std::string const& file) const { return (dir / file).string(); }
+			void Write(std::string const& file, std::string const& contents) const
+			{
+				std::ofstream(Path(file), std::ios::trunc) << contents;
+			}
+		};
+
+		void WriteShaders(ShaderCacheTestDir const& test_dir, std::string const& common_contents)
+		{
+			test_dir.Write("Common.hlsli", common_contents);
+			for (Uint32 i = 0; i < SHADER_FILE_COUNT; ++i)
+			{
+				test_dir.Write("Shader" + std::to_string(i) + ".hlsl",
+					"#include \"Common.hlsli\"\nfloat4 main() : SV_Target { return COLOR * " + std::to_string(i) + "; }\n");
+			}
+		}
+
+		//every shader twice with different macros, plus an exact duplicate of the first one
+		std::vector<GfxShaderDesc> MakeInputs(ShaderCacheTestDir const& test_dir)
+		{
+			std::vector<GfxShaderDesc> inputs;
+			for (Uint32 i = 0; i < SHADER_FILE_COUNT; ++i)
+			{
+				GfxShaderDesc desc{ .stage = GfxShaderStage::PS, .source_file = test_dir.Path("Shader" + std::to_string(i) + ".hlsl"), .entrypoint = "main" };
+				inputs.push_back(desc);
+				desc.macros.push_back(GfxShaderMacro{ .name = "VARIANT", .value = "1" });
+				inputs.push_back(desc);
+			}
+			inputs.push_back(inputs.front());
+			return inputs;
+		}
+
+		Bool SameBytecode(std::vector<GfxShaderCompileOutput> const& a, std::vector<GfxShaderCompileOutput> const& b)
+		{
+			if (a.size() != b.size()) return false;
+			for (Uint64 i = 0; i < a.size(); ++i)
+			{
+				if (a[i].shader_bytecode.bytecode != b[i].shader_bytecode.bytecode || a[i].hash != b[i].hash) return false;
+			}
+			return true;
+		}
+	}
+
+	ADRIA_TEST(ShaderCache_ColdAndWarm)
+	{
+		TestJobSystemScope job_system_scope;
+		ShaderCacheTestDir test_dir;
+		WriteShaders(test_dir, "#define COLOR float4(1, 0, 0, 1)\n");
+		std::vector<GfxShaderDesc> const inputs = MakeInputs(test_dir);
+		Uint32 const unique_count = (Uint32)inputs.size() - 1;
+		std::string const archive_path = test_dir.Path("shaders.bin");
+		GfxNullShaderCompilerBackend backend;
+
+		std::vector<GfxShaderCompileOutput> cold_outputs(inputs.size());
+		{
+			GfxShaderCache cache;
+			ADRIA_CHECK(!cache.Load(archive_path));
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, inputs, cold_outputs);
+			ADRIA_CHECK(stats.cache_hits == 0 && stats.cache_misses == inputs.size());
+			ADRIA_CHECK(stats.failed_inputs.empty());
+			ADRIA_CHECK(cache.EntryCount() == unique_count);
+			ADRIA_CHECK(cache.IsDirty() && cache.Save() && !cache.IsDirty());
+		}
+		//the includes of every output list the header and the source file itself
+		ADRIA_CHECK(cold_outputs[0].includes.size() == 2);
+		ADRIA_CHECK(cold_outputs[0].shader_bytecode.bytecode != cold_outputs[1].shader_bytecode.bytecode);
+
+		std::vector<GfxShaderCompileOutput> warm_outputs(inputs.size());
+		{
+			GfxShaderCache cache;
+			ADRIA_CHECK(cache.Load(archive_path));
+			ADRIA_CHECK(cache.EntryCount() == unique_count);
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, inputs, warm_outputs);
+			ADRIA_CHECK(stats.cache_hits == inputs.size() && stats.cache_misses == 0);
+			ADRIA_CHECK(!cache.IsDirty());
+		}
+		ADRIA_CHECK(SameBytecode(cold_outputs, warm_outputs));
+
+		//editing a shared include changes every key, the superseded entries are not written back
+		WriteShaders(test_dir, "#define COLOR float4(0, 1, 0, 1)\n");
+		Uint64 const archive_size = fs::file_size(archive_path);
+		std::vector<GfxShaderCompileOutput> edited_outputs(inputs.size());
+		{
+			GfxShaderCache cache;
+			ADRIA_CHECK(cache.Load(archive_path));
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, inputs, edited_outputs);
+			ADRIA_CHECK(stats.cache_hits == 0 && stats.cache_misses == inputs.size());
+			ADRIA_CHECK(cache.EntryCount() == 2 * unique_count);
+			ADRIA_CHECK(cache.Save());
+		}
+		ADRIA_CHECK(!SameBytecode(cold_outputs, edited_outputs));
+		ADRIA_CHECK(fs::file_size(archive_path) == archive_size);
+		{
+			GfxShaderCache cache;
+			ADRIA_CHECK(cache.Load(archive_path));
+			ADRIA_CHECK(cache.EntryCount() == unique_count);
+			std::vector<GfxShaderCompileOutput> outputs(inputs.size());
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, inputs, outputs);
+			ADRIA_CHECK(stats.cache_hits == inputs.size());
+			ADRIA_CHECK(SameBytecode(edited_outputs, outputs));
+		}
+
+		//a shader that can't be preprocessed is reported and doesn't end up in the cache
+		{
+			GfxShaderCache cache;
+			ADRIA_CHECK(cache.Load(archive_path));
+			GfxShaderDesc const missing{ .stage = GfxShaderStage::PS, .source_file = test_dir.Path("Missing.hlsl"), .entrypoint = "main" };
+			GfxShaderCompileOutput output{};
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, std::span(&missing, 1), std::span(&output, 1));
+			ADRIA_CHECK(stats.failed_inputs.size() == 1 && stats.failed_inputs[0] == 0);
+			ADRIA_CHECK(cache.EntryCount() == unique_count);
+		}
+	}
+
+	//startup cost of the engine's shaders through the headless backend: preprocessing and key lookups,
+	//with the null backend standing in for the compiler on a cold cache
+	ADRIA_BENCHMARK(ShaderCache_Startup)
+	{
+		TestJobSystemScope job_system_scope;
+		ShaderCacheTestDir test_dir;
+		std::string const archive_path = test_dir.Path("shaders.bin");
+
+		std::vector<GfxShaderDesc> inputs;
+		for (auto const& file : fs::recursive_directory_iterator(paths::ShaderDir))
+		{
+			if (file.path().extension() != ".hlsl") continue;
+			inputs.push_back(GfxShaderDesc{ .stage = GfxShaderStage::PS, .source_file = file.path().string(), .entrypoint = "main" });
+		}
+		ADRIA_CHECK(!inputs.empty());
+		GfxNullShaderCompilerBackend backend;
+
+		Float startup_ms[2] = {};
+		for (Uint32 run = 0; run < 2; ++run)
+		{
+			Timer<std::chrono::microseconds> timer;
+			GfxShaderCache cache;
+			cache.Load(archive_path);
+			std::vector<GfxShaderCompileOutput> outputs(inputs.size());
+			GfxShaderBatchStats stats = CompileShadersCached(backend, cache, inputs, outputs);
+			if (cache.IsDirty()) cache.Save();
+			startup_ms[run] = timer.Elapsed() / 1000.0f;
+			ADRIA_CHECK(run == 0 || stats.cache_hits + stats.failed_inputs.size() == inputs.size());
+		}
+		ADRIA_LOG(INFO, "%llu shaders: cold cache %.2f ms, warm cache %.2f ms", (Uint64)inputs.size(), startup_ms[0], startup_ms[1]);
+	}
+}
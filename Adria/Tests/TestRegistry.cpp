@@ -0,0 +1,50 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Utilities/Timer.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	Bool TestContext::Check(Bool condition, Char const* expression, Char const* file, Uint32 line)
+	{
+		if (!condition)
+		{
+			++failed_checks;
+			ADRIA_LOG(ERROR, "Check failed: %s (%s:%u)", expression, file, line);
+		}
+		return condition;
+	}
+
+	TestJobSystemScope::TestJobSystemScope(Uint32 thread_count)
+	{
+		g_JobSystem.Initialize(thread_count);
+	}
+
+	TestJobSystemScope::~TestJobSystemScope()
+	{
+		g_JobSystem.Destroy();
+	}
+
+	Uint32 TestRegistry::Run(TestKind kind, std::string const& filter, Window* window) const
+	{
+		Char const* kind_name = kind == TestKind::Test ? "test" : "benchmark";
+		Uint32 run_count = 0, failed_count = 0;
+		for (TestCase const& test_case : tests)
+		{
+			if (test_case.kind != kind) continue;
+			if (filter != "all" && std::string_view(test_case.name).substr(0, filter.size()) != filter) continue;
+
+			ADRIA_LOG(INFO, "Running %s %s", kind_name, test_case.name);
+			TestContext context(window);
+			Timer<std::chrono::milliseconds> timer;
+			test_case.function(context);
+			Bool const passed = context.GetFailedChecks() == 0;
+			if (passed) ADRIA_LOG(INFO, "%s passed in %lld ms", test_case.name, (Int64)timer.Elapsed());
+			else ADRIA_LOG(ERROR, "%s failed %u checks", test_case.name, context.GetFailedChecks());
+			++run_count;
+			if (!passed) ++failed_count;
+		}
+		ADRIA_LOG(INFO, "%u of %u %ss passed", run_count - failed_count, run_count, kind_name);
+		return failed_count;
+	}
+}
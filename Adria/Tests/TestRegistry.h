@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Utilities/Singleton.h"
+
+namespace adria
+{
+	class Window;
+
+	enum class TestKind : Uint8
+	{
+		Test,
+		Benchmark
+	};
+
+	//failed checks are logged and counted, the test keeps running
+	class TestContext
+	{
+	public:
+		explicit TestContext(Window* window) : window(window) {}
+
+		//hidden window for tests that create a headless device or engine
+		Window* GetWindow() const { return window; }
+		Bool Check(Bool condition, Char const* expression, Char const* file, Uint32 line);
+		Uint32 GetFailedChecks() const { return failed_checks; }
+
+	private:
+		Window* window;
+		Uint32 failed_checks = 0;
+	};
+
+	using TestFunction = void(*)(TestContext&);
+
+	struct TestCase
+	{
+		Char const* name;
+		TestKind kind;
+		TestFunction function;
+	};
+
+	//Tests and benchmarks are compiled into the executable and run from the command line with -test or -bench,
+	//filtered by a name prefix ("all" runs everything). Results go to the log.
+	class TestRegistry : public Singleton<TestRegistry>
+	{
+		friend class Singleton<TestRegistry>;
+
+	public:
+		void Register(TestCase const& test_case) { tests.push_back(test_case); }
+		//returns the number of failed tests
+		Uint32 Run(TestKind kind, std::string const& filter, Window* window) const;
+
+	private:
+		std::vector<TestCase> tests;
+
+	private:
+		TestRegistry() = default;
+	};
+	#define g_TestRegistry TestRegistry::Get()
+
+	//tests that schedule jobs outside of an engine own the job system while they run
+	struct TestJobSystemScope
+	{
+		explicit TestJobSystemScope(Uint32 thread_count = 0);
+		~TestJobSystemScope();
+	};
+
+	struct TestRegistrar
+	{
+		TestRegistrar(Char const* name, TestKind kind, TestFunction function)
+		{
+			g_TestRegistry.Register(TestCase{ .name = name, .kind = kind, .function = function });
+		}
+	};
+}
+
+#define _ADRIA_TEST_CASE(name, kind) \
+	static void ADRIA_CONCAT(Test_, name)(adria::TestContext&); \
+	static adria::TestRegistrar const ADRIA_CONCAT(test_registrar_, name)(#name, kind, &ADRIA_CONCAT(Test_, name)); \
+	static void ADRIA_CONCAT(Test_, name)(ADRIA_MAYBE_UNUSED adria::TestContext& test_context)
+
+#define ADRIA_TEST(name)		_ADRIA_TEST_CASE(name, adria::TestKind::Test)
+#define ADRIA_BENCHMARK(name)	_ADRIA_TEST_CASE(name, adria::TestKind::Benchmark)
+#define ADRIA_CHECK(expr)		test_context.Check(static_cast<Bool>(expr), #expr, __FILE__, __LINE__)
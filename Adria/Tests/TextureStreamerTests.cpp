@@ -0,0 +1,139 @@
+#include "TestRegistry.h"
+#include "Rendering/TextureStreamer.h"
+#include "Utilities/FrameArena.h"
+
+namespace adria
+{
+	namespace
+	{
+		//"<size>" decodes to a square RGBA8 texture with its full mip chain, "fail" doesn't decode
+		Bool DecodeStub(std::string const& path, Bool mipmaps, DecodedTexture& texture)
+		{
+			if (path == "fail") return false;
+			Uint32 const size = static_cast<Uint32>(std::stoul(path));
+			texture.width = size;
+			texture.height = size;
+			texture.format = DecodedTextureFormat::RGBA8;
+			Uint64 offset = 0;
+			for (Uint32 mip_size = size; ; mip_size /= 2)
+			{
+				texture.mips.push_back(TextureMip{ .width = mip_size, .height = mip_size, .pitch = mip_size * 4, .offset = offset, .size = Uint64(mip_size) * mip_size * 4 });
+				offset += texture.mips.back().size;
+				if (!mipmaps || mip_size == 1) break;
+			}
+			texture.data.resize(offset);
+			return true;
+		}
+
+		struct ScheduledMip
+		{
+			TextureHandle handle;
+			Uint32 mip_size;
+			Bool operator==(ScheduledMip const&) const = default;
+		};
+
+		std::vector<ScheduledMip> Schedule(TextureStreamer& streamer, Uint64 byte_budget)
+		{
+			std::vector<TextureMipUpload> uploads;
+			streamer.Schedule(byte_budget, uploads);
+			g_FrameArena.Reset();
+			std::vector<ScheduledMip> scheduled;
+			for (TextureMipUpload const& upload : uploads) scheduled.push_back(ScheduledMip{ upload.handle, upload.texture->mips[upload.mip].width });
+			return scheduled;
+		}
+	}
+
+	//first uploads of every texture come before any detail, then mips up to the requested sizes, then the rest coarsest first
+	ADRIA_TEST(TextureStreamer_Priority)
+	{
+		TestJobSystemScope job_system_scope;
+		TextureStreamer streamer(DecodeStub);
+		streamer.Request(1, "64", true);
+		streamer.Request(2, "256", true, 256);
+		streamer.Request(3, "16", true);
+		streamer.WaitForDecodes();
+
+		std::vector<ScheduledMip> const expected =
+		{
+			{ 2, 1 }, { 1, 1 }, { 3, 1 },
+			{ 2, 2 }, { 2, 4 }, { 2, 8 }, { 2, 16 }, { 2, 32 }, { 2, 64 }, { 2, 128 }, { 2, 256 },
+			{ 1, 2 }, { 3, 2 }, { 1, 4 }, { 3, 4 }, { 1, 8 }, { 3, 8 }, { 1, 16 }, { 3, 16 }, { 1, 32 }, { 1, 64 }
+		};
+		ADRIA_CHECK(Schedule(streamer, Uint64(-1)) == expected);
+		ADRIA_CHECK(!streamer.HasPendingWork() && !streamer.IsStreaming(1));
+		ADRIA_CHECK(streamer.GetStats().uploaded_mips == expected.size() && streamer.GetStats().pending_uploads == 0);
+	}
+
+	//a frame stops before the mip that would exceed the budget, but always uploads at least one
+	ADRIA_TEST(TextureStreamer_Budget)
+	{
+		TestJobSystemScope job_system_scope;
+		TextureStreamer streamer(DecodeStub);
+		streamer.Request(1, "64", true, 64);
+		streamer.WaitForDecodes();
+
+		//1x1, 2x2 and 4x4 are 84 bytes, 8x8 would be 340
+		std::vector<TextureMipUpload> uploads;
+		streamer.Schedule(100, uploads);
+		ADRIA_CHECK(uploads.size() == 3 && uploads[0].mip == 6 && uploads[2].mip == 4);
+		ADRIA_CHECK(uploads[0].first_upload && !uploads[1].first_upload && !uploads[2].first_upload);
+		ADRIA_CHECK(streamer.GetStats().uploaded_bytes == 84 && streamer.GetStats().pending_uploads == 1);
+
+		for (Uint32 mip = 4; mip-- > 0;)
+		{
+			ADRIA_CHECK(streamer.IsStreaming(1));
+			streamer.Schedule(100, uploads);
+			ADRIA_CHECK(uploads.size() == 1 && uploads[0].mip == mip && uploads[0].texture->mips[mip].size > 100);
+		}
+		ADRIA_CHECK(!streamer.IsStreaming(1) && !streamer.HasPendingWork());
+		g_FrameArena.Reset();
+
+		//a zero budget uploads one mip per frame
+		streamer.Request(2, "4", true);
+		streamer.Request(3, "4", true);
+		streamer.WaitForDecodes();
+		Uint32 frame_count = 0;
+		for (; streamer.HasPendingWork(); ++frame_count) ADRIA_CHECK(Schedule(streamer, 0).size() == 1);
+		ADRIA_CHECK(frame_count == 6);
+	}
+
+	//each texture goes from its coarsest mip to mip 0 one level at a time, raising the requested size moves its remaining mips ahead
+	ADRIA_TEST(TextureStreamer_Residency)
+	{
+		TestJobSystemScope job_system_scope;
+		TextureStreamer streamer(DecodeStub);
+		streamer.Request(1, "64", true);
+		streamer.Request(2, "64", true);
+		streamer.Request(3, "8", false);
+		streamer.Request(4, "fail", true);
+		streamer.WaitForDecodes();
+
+		std::vector<ScheduledMip> scheduled;
+		for (Uint32 frame = 0; frame < 4; ++frame)
+		{
+			std::vector<ScheduledMip> const frame_mips = Schedule(streamer, 0);
+			scheduled.insert(scheduled.end(), frame_mips.begin(), frame_mips.end());
+		}
+		//a texture without mipmaps is resident after its first upload, a failed decode is never scheduled
+		ADRIA_CHECK((scheduled == std::vector<ScheduledMip>{ { 1, 1 }, { 2, 1 }, { 3, 8 }, { 1, 2 } }));
+		ADRIA_CHECK(!streamer.IsStreaming(3) && streamer.HasFailed(4) && !streamer.IsStreaming(4));
+		ADRIA_CHECK(streamer.GetStats().failed_decodes == 1);
+
+		streamer.RequestSize(2, 64);
+		streamer.RequestSize(1, 2);
+		scheduled.clear();
+		while (streamer.HasPendingWork())
+		{
+			std::vector<ScheduledMip> const frame_mips = Schedule(streamer, 0);
+			scheduled.insert(scheduled.end(), frame_mips.begin(), frame_mips.end());
+		}
+		ADRIA_CHECK((scheduled == std::vector<ScheduledMip>{ { 2, 2 }, { 2, 4 }, { 2, 8 }, { 2, 16 }, { 2, 32 }, { 2, 64 },
+			{ 1, 4 }, { 1, 8 }, { 1, 16 }, { 1, 32 }, { 1, 64 } }));
+
+		//requesting a failed texture again starts over
+		streamer.Request(4, "16", true);
+		ADRIA_CHECK(!streamer.HasFailed(4) && streamer.IsStreaming(4));
+		streamer.WaitForDecodes();
+		ADRIA_CHECK(Schedule(streamer, Uint64(-1)).size() == 5 && !streamer.HasPendingWork());
+	}
+}
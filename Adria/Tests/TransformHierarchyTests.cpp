@@ -0,0 +1,109 @@
+#include "TestRegistry.h"
+#include "Rendering/TransformHierarchy.h"
+#include "Rendering/Hierarchy.h"
+#include "Rendering/Components.h"
+#include "tecs/registry.h"
+#include "Utilities/JobSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		tecs::entity CreateTransform(tecs::registry& reg, Matrix const& local)
+		{
+			tecs::entity e = reg.create();
+			reg.emplace<Transform>(e, local, local);
+			return e;
+		}
+
+		void SetLocal(tecs::registry& reg, tecs::entity e, Matrix const& local)
+		{
+			reg.get<Transform>(e).current_transform = local;
+			reg.touch<Transform>(e);
+		}
+
+		Vector3 WorldPosition(tecs::registry& reg, tecs::entity e)
+		{
+			return reg.get<Transform>(e).world_transform.Translation();
+		}
+	}
+
+	//world transforms are the local ones followed by the parent's, only touched entities and their descendants change
+	ADRIA_TEST(TransformHierarchy_Propagation)
+	{
+		TestJobSystemScope job_system_scope;
+		tecs::registry reg;
+		tecs::entity root = CreateTransform(reg, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f));
+		tecs::entity child = CreateTransform(reg, Matrix::CreateScale(2.0f) * Matrix::CreateTranslation(0.0f, 1.0f, 0.0f));
+		tecs::entity grandchild = CreateTransform(reg, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f));
+		tecs::entity other_root = CreateTransform(reg, Matrix::CreateTranslation(0.0f, 0.0f, 5.0f));
+		AttachChild(reg, root, child);
+		AttachChild(reg, child, grandchild);
+
+		TransformHierarchy hierarchy(reg);
+		ADRIA_CHECK(hierarchy.Update());
+		ADRIA_CHECK(hierarchy.GetLevelCount() == 3 && hierarchy.GetRebuildCount() == 1);
+		ADRIA_CHECK(WorldPosition(reg, root) == Vector3(1.0f, 0.0f, 0.0f));
+		ADRIA_CHECK(WorldPosition(reg, child) == Vector3(1.0f, 1.0f, 0.0f));
+		ADRIA_CHECK(WorldPosition(reg, grandchild) == Vector3(3.0f, 1.0f, 0.0f));
+		ADRIA_CHECK(Vector3::Distance(reg.get<Transform>(grandchild).inverse_world_transform.Translation(), Vector3(-1.5f, -0.5f, 0.0f)) < 1e-5f);
+
+		//nothing touched, nothing done
+		ADRIA_CHECK(!hierarchy.Update());
+
+		SetLocal(reg, root, Matrix::CreateTranslation(0.0f, 0.0f, 1.0f));
+		ADRIA_CHECK(hierarchy.Update());
+		ADRIA_CHECK(hierarchy.GetRebuildCount() == 1);
+		ADRIA_CHECK(WorldPosition(reg, grandchild) == Vector3(2.0f, 1.0f, 1.0f));
+		ADRIA_CHECK(reg.get<Transform>(grandchild).world_changed && !reg.get<Transform>(other_root).world_changed);
+
+		//a touched leaf leaves its ancestors alone
+		SetLocal(reg, grandchild, Matrix::CreateTranslation(0.0f, 2.0f, 0.0f));
+		ADRIA_CHECK(hierarchy.Update());
+		ADRIA_CHECK(!reg.get<Transform>(root).world_changed && !reg.get<Transform>(child).world_changed);
+		ADRIA_CHECK(WorldPosition(reg, grandchild) == Vector3(0.0f, 5.0f, 1.0f));
+		ADRIA_CHECK(!hierarchy.Update() && hierarchy.GetRebuildCount() == 1);
+	}
+
+	//the levels are rebuilt when transforms come and go or the relationships change, never for a touched transform
+	ADRIA_TEST(TransformHierarchy_HierarchyChanges)
+	{
+		TestJobSystemScope job_system_scope;
+		tecs::registry reg;
+		tecs::entity root = CreateTransform(reg, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f));
+		tecs::entity other_root = CreateTransform(reg, Matrix::CreateTranslation(0.0f, 0.0f, 5.0f));
+		tecs::entity child = CreateTransform(reg, Matrix::CreateTranslation(0.0f, 1.0f, 0.0f));
+		AttachChild(reg, root, child);
+		TransformHierarchy hierarchy(reg);
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetLevelCount() == 2);
+
+		//reparenting moves the child under its new parent without touching its Transform
+		AttachChild(reg, other_root, child);
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetRebuildCount() == 2);
+		ADRIA_CHECK(WorldPosition(reg, child) == Vector3(0.0f, 1.0f, 5.0f));
+
+		DetachChild(reg, child);
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetRebuildCount() == 3 && hierarchy.GetLevelCount() == 1);
+		ADRIA_CHECK(WorldPosition(reg, child) == Vector3(0.0f, 1.0f, 0.0f));
+
+		//a new transform is placed at its depth, a parent without a Transform doesn't count as one
+		tecs::entity grandchild = CreateTransform(reg, Matrix::CreateTranslation(0.0f, 0.0f, 1.0f));
+		AttachChild(reg, root, child);
+		AttachChild(reg, child, grandchild);
+		tecs::entity group = reg.create();
+		tecs::entity grouped = CreateTransform(reg, Matrix::CreateTranslation(2.0f, 0.0f, 0.0f));
+		AttachChild(reg, group, grouped);
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetRebuildCount() == 4 && hierarchy.GetLevelCount() == 3);
+		ADRIA_CHECK(WorldPosition(reg, grandchild) == Vector3(1.0f, 1.0f, 1.0f));
+		ADRIA_CHECK(WorldPosition(reg, grouped) == Vector3(2.0f, 0.0f, 0.0f));
+
+		//a destroyed parent leaves its child at the root
+		reg.destroy(child);
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetRebuildCount() == 5 && hierarchy.GetLevelCount() == 1);
+		ADRIA_CHECK(WorldPosition(reg, grandchild) == Vector3(0.0f, 0.0f, 1.0f));
+
+		SetLocal(reg, root, Matrix::CreateTranslation(3.0f, 0.0f, 0.0f));
+		ADRIA_CHECK(hierarchy.Update() && hierarchy.GetRebuildCount() == 5);
+		ADRIA_CHECK(!hierarchy.Update());
+	}
+}
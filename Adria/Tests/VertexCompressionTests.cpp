@@ -0,0 +1,138 @@
+#include "TestRegistry.h"
+#include "Core/Logger.h"
+#include "Math/VertexCompression.h"
+#include "Math/Constants.h"
+#include "Utilities/Random.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		//without quantization only float rounding is lost
+		constexpr Float OCTAHEDRAL_TOLERANCE_DEGREES = 1e-3f;
+		//16 bit snorm octahedral coordinates, the worst case is around 0.004 degrees
+		constexpr Float QUANTIZED_TOLERANCE_DEGREES = 0.01f;
+
+		Float AngleDegrees(Vector3 const& a, Vector3 const& b)
+		{
+			return XMConvertToDegrees(std::atan2(a.Cross(b).Length(), a.Dot(b)));
+		}
+
+		//axes, octant diagonals, the folded edges of the octahedron and an even spread over the sphere
+		std::vector<Vector3> MakeDirections(Uint32 sphere_count)
+		{
+			std::vector<Vector3> directions =
+			{
+				Vector3(1.0f, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f),
+				Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f),
+				Vector3(1.0f, 1.0f, 0.0f), Vector3(-1.0f, 0.0f, 1e-7f), Vector3(0.0f, -1.0f, -1e-7f),
+			};
+			for (Float x : { -1.0f, 1.0f }) for (Float y : { -1.0f, 1.0f }) for (Float z : { -1.0f, 1.0f }) directions.emplace_back(x, y, z);
+
+			Float const golden_angle = pi<Float> * (3.0f - std::sqrt(5.0f));
+			for (Uint32 i = 0; i < sphere_count; ++i)
+			{
+				Float const z = 1.0f - 2.0f * (i + 0.5f) / sphere_count;
+				Float const radius = std::sqrt(1.0f - z * z);
+				directions.emplace_back(radius * std::cos(golden_angle * i), radius * std::sin(golden_angle * i), z);
+			}
+			for (Vector3& direction : directions) direction.Normalize();
+			return directions;
+		}
+
+		CompleteVertex MakeVertex(Vector3 const& position, Vector2 const& uv, Vector3 const& normal, Vector3 const& tangent, Float handedness)
+		{
+			CompleteVertex vertex{};
+			vertex.position = position;
+			vertex.uv = uv;
+			vertex.normal = normal;
+			vertex.tangent = tangent;
+			vertex.bitangent = normal.Cross(tangent) * handedness;
+			return vertex;
+		}
+	}
+
+	ADRIA_TEST(VertexCompression_OctahedralRoundTrip)
+	{
+		std::vector<Vector3> const directions = MakeDirections(100000);
+		Float max_error = 0.0f;
+		Bool in_square = true;
+		for (Vector3 const& direction : directions)
+		{
+			Vector2 const encoded = OctahedralEncode(direction);
+			in_square = in_square && std::abs(encoded.x) <= 1.0f && std::abs(encoded.y) <= 1.0f;
+			max_error = std::max(max_error, AngleDegrees(direction, OctahedralDecode(encoded)));
+		}
+		ADRIA_CHECK(in_square);
+		ADRIA_CHECK(max_error <= OCTAHEDRAL_TOLERANCE_DEGREES);
+
+		//the corners of the square all decode to -z and the center to +z
+		ADRIA_CHECK(AngleDegrees(OctahedralDecode(Vector2(1.0f, 1.0f)), Vector3(0.0f, 0.0f, -1.0f)) <= OCTAHEDRAL_TOLERANCE_DEGREES);
+		ADRIA_CHECK(AngleDegrees(OctahedralDecode(Vector2(-1.0f, 1.0f)), Vector3(0.0f, 0.0f, -1.0f)) <= OCTAHEDRAL_TOLERANCE_DEGREES);
+		ADRIA_CHECK(AngleDegrees(OctahedralDecode(Vector2(0.0f, 0.0f)), Vector3(0.0f, 0.0f, 1.0f)) <= OCTAHEDRAL_TOLERANCE_DEGREES);
+		//a missing normal encodes to the center instead of dividing by zero
+		Vector2 const zero = OctahedralEncode(Vector3(0.0f, 0.0f, 0.0f));
+		ADRIA_CHECK(zero.x == 0.0f && zero.y == 0.0f);
+
+		//the same directions through the 16 bit vertex, tangents are perpendicular to the normals
+		std::vector<CompleteVertex> vertices;
+		for (Uint64 i = 0; i < directions.size(); ++i)
+		{
+			Vector3 const& normal = directions[i];
+			Vector3 const helper = std::abs(normal.y) < 0.99f ? Vector3(0.0f, 1.0f, 0.0f) : Vector3(1.0f, 0.0f, 0.0f);
+			Vector3 tangent = helper.Cross(normal);
+			tangent.Normalize();
+			vertices.push_back(MakeVertex(Vector3(0.0f, 0.0f, 0.0f), Vector2(0.0f, 0.0f), normal, tangent, i % 2 ? 1.0f : -1.0f));
+		}
+		std::vector<CompressedVertex> compressed(vertices.size());
+		VertexCompressionReport const report = CompressVertices(vertices.data(), vertices.size(), ComputeVertexQuantization(vertices.data(), vertices.size()), compressed.data());
+		ADRIA_CHECK(report.max_normal_error <= QUANTIZED_TOLERANCE_DEGREES);
+		ADRIA_CHECK(report.max_tangent_error <= QUANTIZED_TOLERANCE_DEGREES);
+		//the bitangent is rebuilt from both, so it can be off by their sum and keeps the handedness
+		ADRIA_CHECK(report.max_bitangent_error <= 2.0f * QUANTIZED_TOLERANCE_DEGREES);
+	}
+
+	ADRIA_TEST(VertexCompression_QuantizedVertices)
+	{
+		constexpr Uint32 VERTEX_COUNT = 200000;
+		RealRandomGenerator<Float> position(-30.0f, 30.0f, std::mt19937{ 3 });
+		RealRandomGenerator<Float> uv(0.0f, 4.0f, std::mt19937{ 4 });
+		RealRandomGenerator<Float> component(-1.0f, 1.0f, std::mt19937{ 5 });
+		std::vector<CompleteVertex> vertices;
+		vertices.reserve(VERTEX_COUNT);
+		while (vertices.size() < VERTEX_COUNT)
+		{
+			Vector3 normal(component(), component(), component());
+			Vector3 tangent(component(), component(), component());
+			if (normal.Length() < 0.1f) continue;
+			normal.Normalize();
+			tangent -= normal * normal.Dot(tangent);
+			if (tangent.Length() < 0.1f) continue;
+			tangent.Normalize();
+			vertices.push_back(MakeVertex(Vector3(position(), position() * 0.5f, position() * 0.1f), Vector2(uv(), uv()), normal, tangent, component() >= 0.0f ? 1.0f : -1.0f));
+		}
+
+		VertexQuantization const quantization = ComputeVertexQuantization(vertices.data(), vertices.size());
+		std::vector<CompressedVertex> compressed(vertices.size());
+		VertexCompressionReport const report = CompressVertices(vertices.data(), vertices.size(), quantization, compressed.data());
+
+		//half a 16 bit step per axis of the bounds, a half float has 11 significant bits
+		Vector3 const step = quantization.position_scale / 65535.0f;
+		ADRIA_CHECK(report.max_position_error <= 0.5f * step.Length() * 1.01f);
+		ADRIA_CHECK(report.max_uv_error <= 4.0f / 2048.0f);
+		ADRIA_CHECK(report.max_normal_error <= QUANTIZED_TOLERANCE_DEGREES && report.max_tangent_error <= QUANTIZED_TOLERANCE_DEGREES);
+		ADRIA_CHECK(report.max_bitangent_error <= 2.0f * QUANTIZED_TOLERANCE_DEGREES);
+		ADRIA_CHECK(report.bytes_before == VERTEX_COUNT * sizeof(CompleteVertex) && report.bytes_after == VERTEX_COUNT * sizeof(CompressedVertex));
+
+		//a flat mesh has a zero scale on one axis and keeps that coordinate exactly
+		std::vector<CompleteVertex> flat(vertices.begin(), vertices.begin() + 1000);
+		for (CompleteVertex& vertex : flat) vertex.position.y = 2.5f;
+		VertexQuantization const flat_quantization = ComputeVertexQuantization(flat.data(), flat.size());
+		ADRIA_CHECK(flat_quantization.position_scale.y == 0.0f);
+		Bool flat_kept = true;
+		for (CompleteVertex const& vertex : flat) flat_kept = flat_kept && DecompressVertex(CompressVertex(vertex, flat_quantization), flat_quantization).position.y == 2.5f;
+		ADRIA_CHECK(flat_kept);
+	}
+}
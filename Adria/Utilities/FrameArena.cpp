@@ -0,0 +1,95 @@
+#include <atomic>
+#include "FrameArena.h"
+#include "AllocatorUtil.h"
+#include "HeapCounter.h"
+
+namespace adria
+{
+	namespace
+	{
+		Uint64 NextPowerOfTwo(Uint64 value)
+		{
+			Uint64 result = 1;
+			while (result < value) result <<= 1;
+			return result;
+		}
+
+		std::atomic<Uint64> next_arena_id = 0;
+	}
+
+	FrameArena::FrameArena() : resource(*this), id(next_arena_id.fetch_add(1, std::memory_order_relaxed)),
+		last_heap_allocation_count(GetHeapAllocationCount())
+	{
+	}
+
+	void* FrameArena::Allocate(Uint64 size, Uint64 align)
+	{
+		ThreadArena& arena = GetThreadArena();
+		if (arena.block == nullptr)
+		{
+			arena.block_size = DEFAULT_BLOCK_SIZE;
+			arena.block = std::make_unique_for_overwrite<Uint8[]>(arena.block_size);
+			++arena.block_allocations;
+		}
+
+		Uint64 const base = reinterpret_cast<Uint64>(arena.block.get());
+		Uint64 const offset = Align(base + arena.top, align) - base;
+		if (offset + size <= arena.block_size)
+		{
+			arena.top = offset + size;
+			return arena.block.get() + offset;
+		}
+
+		std::unique_ptr<Uint8[]>& overflow_block = arena.overflow_blocks.emplace_back(std::make_unique_for_overwrite<Uint8[]>(size + align));
+		arena.overflow_bytes += size + align;
+		++arena.block_allocations;
+		return reinterpret_cast<void*>(Align(reinterpret_cast<Uint64>(overflow_block.get()), align));
+	}
+
+	void FrameArena::Reset()
+	{
+		std::lock_guard<std::mutex> lock(arenas_mutex);
+		FrameArenaStats frame_stats{};
+		for (std::unique_ptr<ThreadArena> const& arena : arenas)
+		{
+			if (arena->block == nullptr) continue;
+			Uint64 const used_bytes = arena->top + arena->overflow_bytes;
+			if (!arena->overflow_blocks.empty())
+			{
+				arena->block_size = NextPowerOfTwo(used_bytes);
+				arena->block = std::make_unique_for_overwrite<Uint8[]>(arena->block_size);
+				arena->overflow_blocks.clear();
+				arena->overflow_bytes = 0;
+				++arena->block_allocations;
+			}
+			frame_stats.used_bytes += used_bytes;
+			frame_stats.capacity_bytes += arena->block_size;
+			frame_stats.block_allocations += arena->block_allocations;
+			++frame_stats.thread_count;
+			arena->top = 0;
+			arena->block_allocations = 0;
+		}
+		frame_stats.peak_bytes = std::max(stats.peak_bytes, frame_stats.used_bytes);
+		frame_stats.total_block_allocations = stats.total_block_allocations + frame_stats.block_allocations;
+		Uint64 const heap_allocation_count = GetHeapAllocationCount();
+		frame_stats.heap_allocations = heap_allocation_count - last_heap_allocation_count;
+		last_heap_allocation_count = heap_allocation_count;
+		stats = frame_stats;
+	}
+
+	FrameArena::ThreadArena& FrameArena::GetThreadArena()
+	{
+		//the blocks of this thread in every arena it allocated from, ids aren't reused so a destroyed arena is never found again
+		thread_local std::vector<std::pair<Uint64, ThreadArena*>> thread_arenas;
+		for (auto const& [arena_id, arena] : thread_arenas)
+		{
+			if (arena_id == id) return *arena;
+		}
+
+		std::lock_guard<std::mutex> lock(arenas_mutex);
+		ThreadArena* arena = arenas.emplace_back(std::make_unique<ThreadArena>()).get();
+		arena->overflow_blocks.reserve(16);
+		thread_arenas.emplace_back(id, arena);
+		return *arena;
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <memory_resource>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+namespace adria
+{
+	struct FrameArenaStats
+	{
+		Uint64 used_bytes = 0;		//allocated during the last frame, over all threads
+		Uint64 peak_bytes = 0;
+		Uint64 capacity_bytes = 0;	//size of the thread blocks
+		Uint32 thread_count = 0;	//threads that allocated at least once
+		Uint32 block_allocations = 0; //blocks allocated during the last frame, zero once the arena has grown to the frame's needs
+		Uint64 total_block_allocations = 0;
+		Uint64 heap_allocations = 0;  //every operator new call since the previous reset, over all threads and not only the arena's
+	};
+
+	//Memory for data that lives until the end of the frame. Every thread bumps a pointer in its own block, so allocating takes
+	//no locks, and nothing is freed until Reset. When a block runs out the allocation gets its own heap block and at reset
+	//the thread block is regrown to fit the whole frame, so a steady workload stops touching the heap after a few frames.
+	//Every arena keeps its own thread blocks.
+	class FrameArena
+	{
+		static constexpr Uint64 DEFAULT_BLOCK_SIZE = 1 << 20;
+
+		struct ThreadArena
+		{
+			std::unique_ptr<Uint8[]> block;
+			Uint64 block_size = 0;
+			Uint64 top = 0;
+			std::vector<std::unique_ptr<Uint8[]>> overflow_blocks;
+			Uint64 overflow_bytes = 0;
+			Uint32 block_allocations = 0;
+		};
+
+		class MemoryResource : public std::pmr::memory_resource
+		{
+		public:
+			explicit MemoryResource(FrameArena& arena) : arena(arena) {}
+
+		private:
+			FrameArena& arena;
+
+		private:
+			virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override
+			{
+				return arena.Allocate(bytes, alignment);
+			}
+			virtual void do_deallocate(void*, std::size_t, std::size_t) override {}
+			virtual Bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+			{
+				return this == &other;
+			}
+		};
+
+	public:
+		FrameArena();
+		FrameArena(FrameArena const&) = delete;
+		FrameArena& operator=(FrameArena const&) = delete;
+
+		void* Allocate(Uint64 size, Uint64 align = alignof(std::max_align_t));
+		template<typename T>
+		T* Allocate(Uint64 count = 1)
+		{
+			static_assert(std::is_trivially_destructible_v<T>);
+			return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+		}
+
+		//called at the end of the frame, when no other thread is allocating
+		void Reset();
+
+		//adaptor for pmr containers, their memory is released by Reset
+		std::pmr::memory_resource* Resource() { return &resource; }
+		FrameArenaStats const& GetStats() const { return stats; }
+
+	private:
+		MemoryResource resource;
+		std::mutex arenas_mutex;
+		std::vector<std::unique_ptr<ThreadArena>> arenas;
+		FrameArenaStats stats;
+		Uint64 const id;
+		Uint64 last_heap_allocation_count;
+
+	private:
+		ThreadArena& GetThreadArena();
+	};
+	inline FrameArena g_FrameArena{};
+
+	template<typename T>
+	using FrameVector = std::pmr::vector<T>;
+}
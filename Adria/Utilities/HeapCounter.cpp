@@ -0,0 +1,52 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "HeapCounter.h"
+
+namespace adria
+{
+	namespace
+	{
+		std::atomic<Uint64> heap_allocation_count = 0;
+	}
+
+	Uint64 GetHeapAllocationCount()
+	{
+		return heap_allocation_count.load(std::memory_order_relaxed);
+	}
+}
+
+//array and nothrow forms forward to these by default
+void* operator new(std::size_t size)
+{
+	adria::heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size > 0 ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	adria::heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = _aligned_malloc(size > 0 ? size : 1, static_cast<std::size_t>(alignment))) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	_aligned_free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	_aligned_free(p);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace adria
+{
+	//global operator new calls over all threads since startup, the replaced operators live in HeapCounter.cpp
+	Uint64 GetHeapAllocationCount();
+}
@@ -1,7 +1,10 @@
 #include "Heightmap.h"
 #include "Cpp/FastNoiseLite.h"
 #include "Image.h"
-#include "Random.h"
+#include "SimdNoise.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
 
 namespace adria
 {
@@ -44,9 +47,260 @@ namespace adria
 
 		return FastNoiseLite::FractalType_None;
 	}
-	static Float DepositSediment(Float c, Float max_diff, Float talus, Float distance, Float total_diff)
+	namespace
 	{
-		return (distance > talus) ? (c * (max_diff - talus) * (distance / total_diff)) : 0.0f;
+		constexpr Uint64 SIMD_WIDTH = 4;
+		constexpr Uint32 NOISE_ROWS_PER_TILE = 32;
+		constexpr Uint32 THERMAL_ROWS_PER_JOB = 16;
+		constexpr Uint32 HYDRAULIC_BATCH_SIZE = 8192;
+		constexpr Uint32 HYDRAULIC_DROPS_PER_JOB = 128;
+		constexpr Float HYDRAULIC_MIN_SLOPE = 1.15f;
+		constexpr Float HYDRAULIC_OUT_OF_BOUNDS_HEIGHT = 1000.0f;
+
+		//dx, dz
+		constexpr Int64 NEIGHBOR_OFFSETS[8][2] = { {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}, {-1, -1}, {0, -1}, {1, -1} };
+
+		struct HeightGrid
+		{
+			Float const* data;
+			Int64 width;
+			Int64 depth;
+			Int64 pitch;
+
+			Float At(Int64 x, Int64 z) const { return data[z * pitch + x]; }
+			Bool Contains(Int64 x, Int64 z) const { return x >= 0 && z >= 0 && x < width && z < depth; }
+		};
+
+		struct DropletDelta
+		{
+			Uint64 index;
+			Float delta;
+		};
+
+		inline XMVECTOR XM_CALLCONV Load4(Float const* p)
+		{
+			return XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(p));
+		}
+		inline void XM_CALLCONV Store4(Float* p, FXMVECTOR v)
+		{
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(p), v);
+		}
+
+		inline Uint64 SplitMix64(Uint64 x)
+		{
+			x += 0x9e3779b97f4a7c15ull;
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			return x ^ (x >> 31);
+		}
+
+		//fraction of its height difference a cell moves to each lower neighbor whose difference exceeds talus
+		Float ThermalFactor(HeightGrid const& grid, Int64 x, Int64 z, Float c, Float talus)
+		{
+			Float const h = grid.At(x, z);
+			Float max_diff = 0.0f, total_diff = 0.0f;
+			for (auto const& [dx, dz] : NEIGHBOR_OFFSETS)
+			{
+				if (!grid.Contains(x + dx, z + dz)) continue;
+				Float const d = h - grid.At(x + dx, z + dz);
+				if (d > talus)
+				{
+					total_diff += d;
+					max_diff = std::max(max_diff, d);
+				}
+			}
+			return total_diff > 0.0f ? c * (max_diff - talus) / total_diff : 0.0f;
+		}
+
+		Float ThermalDeposit(HeightGrid const& grid, HeightGrid const& factors, Int64 x, Int64 z, Float talus)
+		{
+			Float const h = grid.At(x, z);
+			Float result = h;
+			for (auto const& [dx, dz] : NEIGHBOR_OFFSETS)
+			{
+				if (!grid.Contains(x + dx, z + dz)) continue;
+				Float const d = grid.At(x + dx, z + dz) - h;
+				if (d > talus) result += factors.At(x + dx, z + dz) * d;
+			}
+			return result;
+		}
+
+		void ThermalFactorRow(HeightGrid const& grid, Float* factors, Int64 z, Float c, Float talus)
+		{
+			if (z == 0 || z == grid.depth - 1)
+			{
+				for (Int64 x = 0; x < grid.width; ++x) factors[x] = ThermalFactor(grid, x, z, c, talus);
+				return;
+			}
+
+			factors[0] = ThermalFactor(grid, 0, z, c, talus);
+			Float const* r0 = grid.data + (z - 1) * grid.pitch;
+			Float const* r1 = grid.data + z * grid.pitch;
+			Float const* r2 = grid.data + (z + 1) * grid.pitch;
+			XMVECTOR const talus_v = XMVectorReplicate(talus);
+			XMVECTOR const c_v = XMVectorReplicate(c);
+			XMVECTOR const zero = XMVectorZero();
+
+			Int64 x = 1;
+			for (; x + (Int64)SIMD_WIDTH <= grid.width - 1; x += SIMD_WIDTH)
+			{
+				XMVECTOR const h = Load4(r1 + x);
+				XMVECTOR const neighbors[8] =
+				{
+					Load4(r1 + x - 1), Load4(r1 + x + 1),
+					Load4(r2 + x - 1), Load4(r2 + x), Load4(r2 + x + 1),
+					Load4(r0 + x - 1), Load4(r0 + x), Load4(r0 + x + 1)
+				};
+				XMVECTOR max_diff = zero, total_diff = zero;
+				for (XMVECTOR const& neighbor : neighbors)
+				{
+					XMVECTOR d = XMVectorSubtract(h, neighbor);
+					d = XMVectorSelect(zero, d, XMVectorGreater(d, talus_v));
+					total_diff = XMVectorAdd(total_diff, d);
+					max_diff = XMVectorMax(max_diff, d);
+				}
+				XMVECTOR factor = XMVectorDivide(XMVectorMultiply(c_v, XMVectorSubtract(max_diff, talus_v)), total_diff);
+				factor = XMVectorSelect(zero, factor, XMVectorGreater(total_diff, zero));
+				Store4(factors + x, factor);
+			}
+			for (; x < grid.width; ++x) factors[x] = ThermalFactor(grid, x, z, c, talus);
+		}
+
+		void ThermalDepositRow(HeightGrid const& grid, HeightGrid const& factors, Float* eroded, Int64 z, Float talus)
+		{
+			if (z == 0 || z == grid.depth - 1)
+			{
+				for (Int64 x = 0; x < grid.width; ++x) eroded[x] = ThermalDeposit(grid, factors, x, z, talus);
+				return;
+			}
+
+			eroded[0] = ThermalDeposit(grid, factors, 0, z, talus);
+			Float const* r0 = grid.data + (z - 1) * grid.pitch;
+			Float const* r1 = grid.data + z * grid.pitch;
+			Float const* r2 = grid.data + (z + 1) * grid.pitch;
+			Float const* f0 = factors.data + (z - 1) * factors.pitch;
+			Float const* f1 = factors.data + z * factors.pitch;
+			Float const* f2 = factors.data + (z + 1) * factors.pitch;
+			XMVECTOR const talus_v = XMVectorReplicate(talus);
+			XMVECTOR const zero = XMVectorZero();
+
+			Int64 x = 1;
+			for (; x + (Int64)SIMD_WIDTH <= grid.width - 1; x += SIMD_WIDTH)
+			{
+				XMVECTOR const h = Load4(r1 + x);
+				XMVECTOR const neighbors[8] =
+				{
+					Load4(r1 + x - 1), Load4(r1 + x + 1),
+					Load4(r2 + x - 1), Load4(r2 + x), Load4(r2 + x + 1),
+					Load4(r0 + x - 1), Load4(r0 + x), Load4(r0 + x + 1)
+				};
+				XMVECTOR const neighbor_factors[8] =
+				{
+					Load4(f1 + x - 1), Load4(f1 + x + 1),
+					Load4(f2 + x - 1), Load4(f2 + x), Load4(f2 + x + 1),
+					Load4(f0 + x - 1), Load4(f0 + x), Load4(f0 + x + 1)
+				};
+				XMVECTOR result = h;
+				for (Uint32 n = 0; n < 8; ++n)
+				{
+					XMVECTOR d = XMVectorSubtract(neighbors[n], h);
+					d = XMVectorSelect(zero, d, XMVectorGreater(d, talus_v));
+					result = XMVectorMultiplyAdd(neighbor_factors[n], d, result);
+				}
+				Store4(eroded + x, result);
+			}
+			for (; x < grid.width; ++x) eroded[x] = ThermalDeposit(grid, factors, x, z, talus);
+		}
+
+		//droplets read the heightmap as it was at the start of their batch plus their own changes
+		Uint32 SimulateDroplet(HeightGrid const& grid, HydraulicErosionDesc const& desc, Uint64 drop, DropletDelta* deltas)
+		{
+			Uint32 delta_count = 0;
+			auto Height = [&](Int64 x, Int64 z)
+			{
+				Uint64 const index = z * grid.pitch + x;
+				Float h = grid.data[index];
+				for (Uint32 i = 0; i < delta_count; ++i) if (deltas[i].index == index) h += deltas[i].delta;
+				return h;
+			};
+			auto AddHeight = [&](Int64 x, Int64 z, Float delta)
+			{
+				Uint64 const index = z * grid.pitch + x;
+				for (Uint32 i = 0; i < delta_count; ++i)
+				{
+					if (deltas[i].index == index)
+					{
+						deltas[i].delta += delta;
+						return;
+					}
+				}
+				deltas[delta_count++] = DropletDelta{ .index = index, .delta = delta };
+			};
+			auto NeighborHeight = [&](Int64 x, Int64 z)
+			{
+				return grid.Contains(x, z) ? Height(x, z) : HYDRAULIC_OUT_OF_BOUNDS_HEIGHT;
+			};
+
+			Uint64 const random = SplitMix64(SplitMix64(desc.seed) ^ drop);
+			Int64 X = (Int64)((random & 0xffffffff) % grid.width);
+			Int64 Y = (Int64)((random >> 32) % grid.depth);
+
+			Float carrying_amount = 0.0f;
+			if (Height(X, Y) <= 0.0f) return 0;
+
+			for (Int32 iter = 0; iter < desc.iterations; iter++)
+			{
+				Float const val = Height(X, Y);
+				Float const left = NeighborHeight(X - 1, Y);
+				Float const right = NeighborHeight(X + 1, Y);
+				Float const up = NeighborHeight(X, Y + 1);
+				Float const down = NeighborHeight(X, Y - 1);
+
+				enum MIN_INDEX
+				{
+					CENTER = -1, LEFT, RIGHT, UP, DOWN
+				};
+
+				Float min_height = val;
+				Int32 min_index = CENTER;
+				if (left < min_height)  { min_height = left;  min_index = LEFT; }
+				if (right < min_height) { min_height = right; min_index = RIGHT; }
+				if (up < min_height)    { min_height = up;    min_index = UP; }
+				if (down < min_height)  { min_height = down;  min_index = DOWN; }
+
+				//a droplet with no lower neighbor can not change the heightmap anymore
+				if (min_index == CENTER) break;
+
+				Float slope = std::min(HYDRAULIC_MIN_SLOPE, (val - min_height));
+				Float value_to_steal = desc.deposition_speed * slope;
+
+				if (carrying_amount > desc.carrying_capacity)
+				{
+					carrying_amount -= value_to_steal;
+					AddHeight(X, Y, value_to_steal);
+				}
+				else
+				{
+					if (carrying_amount + value_to_steal > desc.carrying_capacity)
+					{
+						Float delta = carrying_amount + value_to_steal - desc.carrying_capacity;
+						carrying_amount += delta;
+						AddHeight(X, Y, -delta);
+					}
+					else
+					{
+						carrying_amount += value_to_steal;
+						AddHeight(X, Y, -value_to_steal);
+					}
+				}
+
+				if (min_index == LEFT) X -= 1;
+				else if (min_index == RIGHT) X += 1;
+				else if (min_index == UP) Y += 1;
+				else if (min_index == DOWN) Y -= 1;
+			}
+			return delta_count;
+		}
 	}
 
 	Heightmap::Heightmap(NoiseDesc const& desc)
@@ -59,443 +313,150 @@ namespace adria
 		noise.SetFractalLacunarity(desc.lacunarity);
 		noise.SetFractalGain(desc.persistence);
 		noise.SetFrequency(desc.frequency);
-		hm.resize(desc.depth);
+		Allocate(desc.width, desc.depth);
+		if (width == 0 || depth == 0) return;
+
+		std::optional<SimdNoise> simd_noise;
+		if (SimdNoise::IsSupported(desc)) simd_noise.emplace(desc);
+
+		std::vector<Float> xs(width);
+		for (Uint32 x = 0; x < desc.width; x++) xs[x] = x * desc.noise_scale / desc.width;
 
-		Float max_height_achieved = std::numeric_limits<Float>::min();
-		Float min_height_achieved = std::numeric_limits<Float>::max();
+		Float const max_height = (Float)desc.max_height;
+		Uint32 const tile_count = (Uint32)((depth + NOISE_ROWS_PER_TILE - 1) / NOISE_ROWS_PER_TILE);
+		std::vector<Float> tile_min_heights(tile_count, std::numeric_limits<Float>::max());
+		std::vector<Float> tile_max_heights(tile_count, std::numeric_limits<Float>::lowest());
 
-		for (Uint32 z = 0; z < desc.depth; z++)
+		//min/max are reduced per tile while the rows are generated
+		g_JobSystem.ParallelFor(tile_count, 1, [&](Uint32 tile)
 		{
-			hm[z].resize(desc.width);
-			for (Uint32 x = 0; x < desc.width; x++)
+			FastNoiseLite tile_noise = noise;
+			Float min_height = std::numeric_limits<Float>::max();
+			Float max_height_achieved = std::numeric_limits<Float>::lowest();
+
+			Uint32 const z_begin = tile * NOISE_ROWS_PER_TILE;
+			Uint32 const z_end = std::min<Uint32>(z_begin + NOISE_ROWS_PER_TILE, desc.depth);
+			for (Uint32 z = z_begin; z < z_end; z++)
 			{
-				Float xf = x * desc.noise_scale / desc.width;
 				Float zf = z * desc.noise_scale / desc.depth;
+				Float* row = Row(z);
+				if (simd_noise) simd_noise->GetNoiseRow(xs.data(), zf, row, width);
+				else for (Uint32 x = 0; x < desc.width; x++) row[x] = tile_noise.GetNoise(xs[x], zf);
 
-				Float height = noise.GetNoise(xf, zf) * desc.max_height;
-				if (height > max_height_achieved) max_height_achieved = height;
-				if (height < min_height_achieved) min_height_achieved = height;
-				hm[z][x] = height;
+				for (Uint32 x = 0; x < desc.width; x++)
+				{
+					Float const height = row[x] * max_height;
+					min_height = std::min(min_height, height);
+					max_height_achieved = std::max(max_height_achieved, height);
+					row[x] = height;
+				}
 			}
-		}
+			tile_min_heights[tile] = min_height;
+			tile_max_heights[tile] = max_height_achieved;
+		});
 
+		Float const min_height_achieved = *std::min_element(tile_min_heights.begin(), tile_min_heights.end());
+		Float const max_height_achieved = *std::max_element(tile_max_heights.begin(), tile_max_heights.end());
 		auto scale = [=](Float h) -> Float
 		{
 			return (h - min_height_achieved) / (max_height_achieved - min_height_achieved)
 				* 2 * desc.max_height - desc.max_height;
 		};
 
-		for (Uint32 z = 0; z < desc.depth; z++)
+		g_JobSystem.ParallelFor(desc.depth, NOISE_ROWS_PER_TILE, [&](Uint32 z)
 		{
-			for (Uint32 x = 0; x < desc.width; x++)
-			{
-				hm[z][x] = scale(hm[z][x]);
-			}
-		}
+			Float* row = Row(z);
+			for (Uint32 x = 0; x < desc.width; x++) row[x] = scale(row[x]);
+		});
 	}
 	Heightmap::Heightmap(std::string_view heightmap_path, Uint32 max_height)
 	{
 		Image img(heightmap_path, 1);
 
-		Uint8 const* image_data = img.Data<Uint8>();
-
-		hm.resize(img.Height());
+		Allocate(img.Width(), img.Height());
 		for (Uint64 z = 0; z < img.Height(); ++z)
 		{
-			hm[z].resize(img.Width());
+			Float* row = Row(z);
 			for (Uint64 x = 0; x < img.Width(); ++x)
 			{
-				hm[z][x] = image_data[z * img.Width() + x] / 255.0f * max_height;
+				Uint64 const i = z * img.Width() + x;
+				row[x] = img.Is16Bit() ? img.Data<Uint16>()[i] / 65535.0f * max_height : img.Data<Uint8>()[i] / 255.0f * max_height;
 			}
 		}
 	}
 	Float Heightmap::HeightAt(Uint64 x, Uint64 z) const
 	{
-		return hm[z][x];
+		return Row(z)[x];
 	}
 	Uint64 Heightmap::Width() const
 	{
-		return hm[0].size();
+		return width;
 	}
 	Uint64 Heightmap::Depth() const
 	{
-		return hm.size();
+		return depth;
 	}
 
+	//double buffered: every cell first computes how much it sheds, then gathers what its higher neighbors shed into it
 	void Heightmap::ApplyThermalErosion(ThermalErosionDesc const& desc)
 	{
-		Float v1, v2, v3, v4, v5, v6, v7, v8, v9;	
-		Float d1, d2, d3, d4, d5, d6, d7, d8;		
-		Float talus = desc.talus;//4.0f / resolution
-		Float c = desc.c; //0.5f;					
-
-		for (size_t k = 0; k < desc.iterations; k++)
-		{
-			for (size_t j = 0; j < hm.size(); j++)
-			{
-				for (size_t i = 0; i < hm[j].size(); i++)
-				{
+		if (width < 2 || depth < 2) return;
 
-					Float max_diff = 0.0f;
-					Float total_diff = 0.0f;
+		std::vector<Float> factors(heights.size(), 0.0f);
+		std::vector<Float> eroded(heights.size(), 0.0f);
+		Float const talus = desc.talus;
+		Float const c = desc.c;
 
-					d1 = 0.0f;
-					d2 = 0.0f;
-					d3 = 0.0f;
-					d4 = 0.0f;
-					d5 = 0.0f;
-					d6 = 0.0f;
-					d7 = 0.0f;
-					d8 = 0.0f;
-
-					v2 = hm[j][i];
-
-					if (i == 0 && j == 0)
-					{
-						v3 = hm[j][i + 1l];
-						v5 = hm[j + 1l][i];
-						v6 = hm[j + 1l][i + 1l];
-
-						d2 = v2 - v3;
-						d4 = v2 - v5;
-						d5 = v2 - v6;
-					}
-					else if (i == hm[j].size() - 1 && j == hm.size() - 1)
-					{
-						v1 = hm[j][i - 1l];
-						v7 = hm[j - 1l][i - 1l];
-						v8 = hm[j - 1l][i];
-
-						d1 = v2 - v1;
-						d6 = v2 - v7;
-						d7 = v2 - v8;
-					}
-					else if (i == 0 && j == hm.size() - 1)
-					{
-						v3 = hm[j][i + 1l];
-						v8 = hm[j - 1l][i];
-						v9 = hm[j - 1l][i + 1l];
-
-						d2 = v2 - v3;
-						d7 = v2 - v8;
-						d8 = v2 - v9;
-					}
-					else if (i == hm[j].size() - 1 && j == 0)
-					{
-						v1 = hm[j][i - 1l];
-						v4 = hm[j + 1l][i - 1l];
-						v5 = hm[j + 1l][i];
-
-						d1 = v2 - v1;
-						d3 = v2 - v4;
-						d4 = v2 - v5;
-					}
-					else if (j == 0)
-					{
-						v1 = hm[j][i - 1l];
-						v3 = hm[j][i + 1l];
-						v4 = hm[j + 1l][i - 1l];
-						v5 = hm[j + 1l][i];
-						v6 = hm[j + 1l][i + 1l];
-
-						d1 = v2 - v1;
-						d2 = v2 - v3;
-						d3 = v2 - v4;
-						d4 = v2 - v5;
-						d5 = v2 - v6;
-					}
-					else if (j == hm.size() - 1)
-					{
-						v1 = hm[j][i - 1l];
-						v3 = hm[j][i + 1l];
-						v7 = hm[j - 1l][i - 1l];
-						v8 = hm[j - 1l][i];
-						v9 = hm[j - 1l][i + 1l];
-
-						d1 = v2 - v1;
-						d2 = v2 - v3;
-						d6 = v2 - v7;
-						d7 = v2 - v8;
-						d8 = v2 - v9;
-					}
-					else if (i == 0)
-					{
-						v3 = hm[j][i + 1l];
-						v5 = hm[j + 1l][i];
-						v6 = hm[j + 1l][i + 1l];
-						v8 = hm[j - 1l][i];
-						v9 = hm[j - 1l][i + 1l];
-
-						d2 = v2 - v3;
-						d4 = v2 - v5;
-						d5 = v2 - v6;
-						d7 = v2 - v8;
-						d8 = v2 - v9;
-					}
-					else if (i == hm[j].size() - 1)
-					{
-						v1 = hm[j][i - 1l];
-						v4 = hm[j + 1l][i - 1l];
-						v5 = hm[j + 1l][i];
-						v7 = hm[j - 1l][i - 1l];
-						v8 = hm[j - 1l][i];
-
-						d1 = v2 - v1;
-						d3 = v2 - v4;
-						d4 = v2 - v5;
-						d6 = v2 - v7;
-						d7 = v2 - v8;
-					}
-					else
-					{
-						v1 = hm[j][i - 1l];
-						v3 = hm[j][i + 1l];
-						v4 = hm[j + 1l][i - 1l];
-						v5 = hm[j + 1l][i];
-						v6 = hm[j + 1l][i + 1l];
-						v7 = hm[j - 1l][i - 1l];
-						v8 = hm[j - 1l][i];
-						v9 = hm[j - 1l][i + 1l];
-
-						d1 = v2 - v1;
-						d2 = v2 - v3;
-						d3 = v2 - v4;
-						d4 = v2 - v5;
-						d5 = v2 - v6;
-						d6 = v2 - v7;
-						d7 = v2 - v8;
-						d8 = v2 - v9;
-					}
-
-					Float d_array[] = { d1, d2, d3, d4, d5, d6, d7, d8 };
-					for (Float d : d_array)
-					{
-						if (d > talus)
-						{
-							total_diff += d;
-							if (d > max_diff) max_diff = d;
-						}
-					}
+		for (Int32 k = 0; k < desc.iterations; k++)
+		{
+			HeightGrid const grid{ heights.data(), (Int64)width, (Int64)depth, (Int64)pitch };
+			HeightGrid const factor_grid{ factors.data(), (Int64)width, (Int64)depth, (Int64)pitch };
 
-					if (i == 0 && j == 0)
-					{
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-						hm[j + 1l][i + 1l] += DepositSediment(c, max_diff, talus, d5, total_diff);
-					}
-					else if (i == hm[j].size() - 1 && j == hm.size() - 1)
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j - 1l][i - 1l] += DepositSediment(c, max_diff, talus, d6, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-					}
-					else if (i == 0 && j == hm.size() - 1)
-					{
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-						hm[j - 1l][i + 1l] += DepositSediment(c, max_diff, talus, d8, total_diff);
-					}
-					else if (i == hm[j].size() - 1 && j == 0)
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j + 1l][i - 1l] += DepositSediment(c, max_diff, talus, d3, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-					}
-					else if (j == 0)
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j + 1l][i - 1l] += DepositSediment(c, max_diff, talus, d3, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-						hm[j + 1l][i + 1l] += DepositSediment(c, max_diff, talus, d5, total_diff);
-					}
-					else if (j == hm.size() - 1)
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j - 1l][i - 1l] += DepositSediment(c, max_diff, talus, d6, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-						hm[j - 1l][i + 1l] += DepositSediment(c, max_diff, talus, d8, total_diff);
-					}
-					else if (i == 0)
-					{
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-						hm[j + 1l][i + 1l] += DepositSediment(c, max_diff, talus, d5, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-						hm[j - 1l][i + 1l] += DepositSediment(c, max_diff, talus, d8, total_diff);
-					}
-					else if (i == hm[j].size() - 1)
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j + 1l][i - 1l] += DepositSediment(c, max_diff, talus, d3, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-						hm[j - 1l][i - 1l] += DepositSediment(c, max_diff, talus, d6, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-					}
-					else
-					{
-						hm[j][i - 1l] += DepositSediment(c, max_diff, talus, d1, total_diff);
-						hm[j][i + 1l] += DepositSediment(c, max_diff, talus, d2, total_diff);
-						hm[j + 1l][i - 1l] += DepositSediment(c, max_diff, talus, d3, total_diff);
-						hm[j + 1l][i] += DepositSediment(c, max_diff, talus, d4, total_diff);
-						hm[j + 1l][i + 1l] += DepositSediment(c, max_diff, talus, d5, total_diff);
-						hm[j - 1l][i - 1l] += DepositSediment(c, max_diff, talus, d6, total_diff);
-						hm[j - 1l][i] += DepositSediment(c, max_diff, talus, d7, total_diff);
-						hm[j - 1l][i + 1l] += DepositSediment(c, max_diff, talus, d8, total_diff);
-					}
-				}
-			}
+			g_JobSystem.ParallelFor((Uint32)depth, THERMAL_ROWS_PER_JOB, [&](Uint32 z)
+			{
+				ThermalFactorRow(grid, factors.data() + z * pitch, z, c, talus);
+			});
+			g_JobSystem.ParallelFor((Uint32)depth, THERMAL_ROWS_PER_JOB, [&](Uint32 z)
+			{
+				ThermalDepositRow(grid, factor_grid, eroded.data() + z * pitch, z, talus);
+			});
+			heights.swap(eroded);
 		}
 	}
+
+	//droplets run in parallel batches, their changes are applied in drop order after each batch so the result
+	//only depends on the seed and not on the thread count
 	void Heightmap::ApplyHydraulicErosion(HydraulicErosionDesc const& desc)
 	{
-		Uint64 drops = (Uint64)desc.drops;
-
-		Uint64 xresolution = Width();
-		Uint64 yresolution = Depth();
+		if (width == 0 || depth == 0 || desc.iterations <= 0) return;
 
-		IntRandomGenerator<Uint64> x_random(0, xresolution - 1);
-		IntRandomGenerator<Uint64> y_random(0, yresolution - 1);
+		Uint64 const drops = (Uint64)desc.drops;
+		Uint32 const max_deltas_per_drop = (Uint32)desc.iterations;
+		std::vector<DropletDelta> deltas((Uint64)HYDRAULIC_BATCH_SIZE * max_deltas_per_drop);
+		std::vector<Uint32> delta_counts(HYDRAULIC_BATCH_SIZE);
 
-		for (Uint64 drop = 0; drop < drops; drop++)
+		for (Uint64 batch_start = 0; batch_start < drops; batch_start += HYDRAULIC_BATCH_SIZE)
 		{
-			// Get random coordinates to drop the water droplet at
-			Uint64 X = x_random();
-			Uint64 Y = y_random();
-
-			Float carryingAmount = 0.0f;
-			Float minSlope = 1.15f;
-
-			if (hm[Y][X] > 0.0f)
+			Uint32 const batch_count = (Uint32)std::min<Uint64>(HYDRAULIC_BATCH_SIZE, drops - batch_start);
+			HeightGrid const grid{ heights.data(), (Int64)width, (Int64)depth, (Int64)pitch };
+			g_JobSystem.ParallelFor(batch_count, HYDRAULIC_DROPS_PER_JOB, [&](Uint32 i)
 			{
-				for (Int32 iter = 0; iter < desc.iterations; iter++)
-				{
-					Float val = hm[Y][X];
-					Float left = 1000.0f;
-					Float right = 1000.0f;
-					Float up = 1000.0f;
-					Float down = 1000.0f;
-
-					if (X == 0 && Y == 0)
-					{
-						right = hm[Y][X + 1];
-						up = hm[Y + 1][X];
-					}
-					else if (X == xresolution - 1 && Y == yresolution - 1)
-					{
-						left = hm[Y][X - 1];
-						down = hm[Y - 1][X];
-					}
-					else if (X == 0 && Y == yresolution - 1)
-					{
-						down = hm[Y - 1][X];
-						right = hm[Y][X + 1];
-					}
-					else if (X == xresolution - 1 && Y == 0)
-					{
-						left = hm[Y][X - 1];
-						up = hm[Y + 1][X];
-					}
-					else if (Y == 0)
-					{
-						left = hm[Y][X - 1];
-						right = hm[Y][X + 1];
-						up = hm[Y + 1][X];
-					}
-					else if (Y == yresolution - 1)
-					{
-						left = hm[Y][X - 1];
-						right = hm[Y][X + 1];
-						down = hm[Y - 1][X];
-					}
-					else if (X == 0)
-					{
-						right = hm[Y][X + 1];
-						up = hm[Y + 1][X];
-						down = hm[Y - 1][X];
-					}
-					else if (X == xresolution - 1)
-					{
-						left = hm[Y][X - 1];
-						up = hm[Y + 1][X];
-						down = hm[Y - 1][X];
-					}
-					else
-					{
-						left = hm[Y][X - 1];
-						right = hm[Y][X + 1];
-						up = hm[Y + 1][X];
-						down = hm[Y - 1][X];
-					}
-
-					enum MIN_INDEX
-					{
-						CENTER = -1, LEFT, RIGHT, UP, DOWN
-					};
-					
-					Float minHeight = val;
-					Int32 minIndex = CENTER;
-
-					if (left < minHeight)
-					{
-						minHeight = left;
-						minIndex = LEFT;
-					}
-					if (right < minHeight)
-					{
-						minHeight = right;
-						minIndex = RIGHT;
-					}
-					if (up < minHeight)
-					{
-						minHeight = up;
-						minIndex = UP;
-					}
-					if (down < minHeight)
-					{
-						minHeight = down;
-						minIndex = DOWN;
-					}
-					if (minHeight < val) 
-					{
-						Float slope = std::min(minSlope, (val - minHeight));
-						Float valueToSteal = desc.deposition_speed * slope;
-
-						if (carryingAmount > desc.carrying_capacity)
-						{
-							carryingAmount -= valueToSteal;
-							hm[Y][X] += valueToSteal;
-						}
-						else 
-						{
-							if (carryingAmount + valueToSteal > desc.carrying_capacity)
-							{
-								Float delta = carryingAmount + valueToSteal - desc.carrying_capacity;
-								carryingAmount += delta;
-								hm[Y][X] -= delta;
-							}
-							else
-							{
-								carryingAmount += valueToSteal;
-								hm[Y][X] -= valueToSteal;
-							}
-						}
-
-						if (minIndex == LEFT) X -= 1;
-						else if (minIndex == RIGHT) X += 1;
-						else if (minIndex == UP) Y += 1;
-						else if (minIndex == DOWN) Y -= 1;
-
-						if (X > xresolution - 1) X = xresolution - 1;
-						if (Y > yresolution - 1) Y = yresolution - 1;
-						if (Y < 0) Y = 0;
-						if (X < 0) X = 0;
-					}
-
-				}
+				delta_counts[i] = SimulateDroplet(grid, desc, batch_start + i, deltas.data() + (Uint64)i * max_deltas_per_drop);
+			});
 
+			for (Uint32 i = 0; i < batch_count; ++i)
+			{
+				DropletDelta const* drop_deltas = deltas.data() + (Uint64)i * max_deltas_per_drop;
+				for (Uint32 j = 0; j < delta_counts[i]; ++j) heights[drop_deltas[j].index] += drop_deltas[j].delta;
 			}
 		}
 	}
-}
\ No newline at end of file
+
+	void Heightmap::Allocate(Uint64 _width, Uint64 _depth)
+	{
+		width = _width;
+		depth = _depth;
+		pitch = (width + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+		heights.assign(pitch * depth, 0.0f);
+	}
+}
@@ -50,6 +50,7 @@ namespace adria
 		Int32 drops;
 		Float carrying_capacity;
 		Float deposition_speed;
+		Uint32 seed = 1337;
 	};
 
 	class Heightmap
@@ -67,7 +68,16 @@ namespace adria
 		void ApplyHydraulicErosion(HydraulicErosionDesc const& desc);
 
 	private:
-		std::vector<std::vector<Float>> hm;
+		//rows are padded to a multiple of SIMD_WIDTH, padding is never read by the kernels
+		std::vector<Float> heights;
+		Uint64 width = 0;
+		Uint64 depth = 0;
+		Uint64 pitch = 0;
+
+	private:
+		void Allocate(Uint64 width, Uint64 depth);
+		Float* Row(Uint64 z) { return heights.data() + z * pitch; }
+		Float const* Row(Uint64 z) const { return heights.data() + z * pitch; }
 	};
 }
 
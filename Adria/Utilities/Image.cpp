@@ -12,6 +12,7 @@ namespace adria
 	{
 		Int32 width, height, channels;
 
+		is_16_bit = false;
 		if (is_hdr = static_cast<Bool>(stbi_is_hdr(image_file.data())); is_hdr)
 		{
 			Float* pixels = stbi_loadf(image_file.data(), &width, &height, &channels, desired_channels);
@@ -21,6 +22,15 @@ namespace adria
 			}
 			else  _pixels.reset(reinterpret_cast<Uint8*>(pixels));
 		}
+		else if (is_16_bit = static_cast<Bool>(stbi_is_16_bit(image_file.data())); is_16_bit)
+		{
+			stbi_us* pixels = stbi_load_16(image_file.data(), &width, &height, &channels, desired_channels);
+			if (!pixels)
+			{
+				ADRIA_LOG(ERROR, "Loading image file %s unsuccessful", image_file.data());
+			}
+			else _pixels.reset(reinterpret_cast<Uint8*>(pixels));
+		}
 		else
 		{
 			stbi_uc* pixels = stbi_load(image_file.data(), &width, &height, &channels, desired_channels);
@@ -53,7 +63,8 @@ namespace adria
 
 	Uint32 Image::BytesPerPixel() const
 	{
-		return _channels * (is_hdr ? sizeof(Float) : sizeof(Uint8));
+		if (is_hdr) return _channels * sizeof(Float);
+		return _channels * (is_16_bit ? sizeof(Uint16) : sizeof(Uint8));
 	}
 
 	Uint32 Image::Pitch() const
@@ -66,6 +77,11 @@ namespace adria
 		return is_hdr;
 	}
 
+	Bool Image::Is16Bit() const
+	{
+		return is_16_bit;
+	}
+
 	void WriteImageTGA(Char const* name, std::vector<Uint8> const& data, int width, int height)
 	{
 		stbi_write_tga(name, width, height, STBI_rgb_alpha, (void*)data.data());
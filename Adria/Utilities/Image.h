@@ -29,6 +29,9 @@ namespace adria
 
 		Bool IsHDR() const;
 
+		//16 bit PNGs keep their precision, Data<Uint16>() has to be used for them
+		Bool Is16Bit() const;
+
 		template<typename T>
 		T const* Data() const;
 
@@ -37,6 +40,7 @@ namespace adria
 		Uint32 _channels;
 		std::unique_ptr<Uint8[]> _pixels;
 		Bool is_hdr;
+		Bool is_16_bit;
 	};
 
 	template<typename T>
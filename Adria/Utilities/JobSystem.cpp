@@ -0,0 +1,175 @@
+#include "JobSystem.h"
+#include "Core/CpuProfiler.h"
+
+namespace adria
+{
+	namespace
+	{
+		thread_local Uint32 tls_worker_index = static_cast<Uint32>(-1);
+
+		Uint32 XorShift(Uint32& state)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+	}
+
+	void JobSystem::Initialize(Uint32 thread_count)
+	{
+		static Uint32 const max_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		Uint32 const num_threads = thread_count == 0 ? max_threads - 1 : (std::min)(max_threads - 1, thread_count);
+
+		done.store(false);
+		worker_count = num_threads + 1;
+		workers = std::make_unique<Worker[]>(worker_count);
+		for (Uint32 i = 0; i < worker_count; ++i)
+		{
+			workers[i].job_pool = std::make_unique<Job[]>(MAX_JOB_COUNT);
+			workers[i].random_state = 0x9E3779B9u * (i + 1);
+		}
+
+		tls_worker_index = 0;
+		g_CpuProfiler.SetThreadName("Main Thread");
+		threads.reserve(num_threads);
+		for (Uint32 i = 1; i < worker_count; ++i)
+		{
+			threads.emplace_back(&JobSystem::ThreadWork, this, i);
+		}
+	}
+
+	void JobSystem::Destroy()
+	{
+		if (done.load() || workers == nullptr) return;
+		{
+			std::lock_guard<std::mutex> lk(sleep_mutex);
+			done.store(true);
+		}
+		sleep_cv.notify_all();
+		for (auto& thread : threads) if (thread.joinable()) thread.join();
+		threads.clear();
+		workers.reset();
+		worker_count = 0;
+		tls_worker_index = INVALID_WORKER_INDEX;
+	}
+
+	void JobSystem::Run(Job* job, JobCounter* counter)
+	{
+		ADRIA_ASSERT(job != nullptr);
+		if (counter)
+		{
+			job->counter = counter;
+			counter->value.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		pending_jobs.fetch_add(1);
+		GetCurrentWorker().deque.Push(job);
+		if (sleeping_threads.load() > 0)
+		{
+			std::lock_guard<std::mutex> lk(sleep_mutex);
+			sleep_cv.notify_one();
+		}
+	}
+
+	void JobSystem::Wait(JobCounter const& counter)
+	{
+		while (!counter.IsDone())
+		{
+			if (!ExecuteNext()) std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::ThreadWork(Uint32 worker_index)
+	{
+		tls_worker_index = worker_index;
+		g_CpuProfiler.SetThreadName("Worker " + std::to_string(worker_index));
+		static constexpr Uint32 SPIN_COUNT = 64;
+
+		Uint32 idle_spins = 0;
+		while (!done.load(std::memory_order_relaxed))
+		{
+			if (ExecuteNext())
+			{
+				idle_spins = 0;
+				continue;
+			}
+
+			if (++idle_spins < SPIN_COUNT)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lk(sleep_mutex);
+			sleeping_threads.fetch_add(1);
+			sleep_cv.wait(lk, [this]() { return done.load() || pending_jobs.load() > 0; });
+			sleeping_threads.fetch_sub(1);
+			idle_spins = 0;
+		}
+	}
+
+	Bool JobSystem::ExecuteNext()
+	{
+		Job* job = GetJob();
+		if (!job) return false;
+		pending_jobs.fetch_sub(1);
+		Execute(job);
+		return true;
+	}
+
+	Job* JobSystem::GetJob()
+	{
+		Worker& worker = GetCurrentWorker();
+		if (Job* job = worker.deque.Pop()) return job;
+
+		if (worker_count <= 1) return nullptr;
+		Uint32 const start = XorShift(worker.random_state) % worker_count;
+		for (Uint32 i = 0; i < worker_count; ++i)
+		{
+			Uint32 const victim = (start + i) % worker_count;
+			if (victim == tls_worker_index) continue;
+			if (Job* job = workers[victim].deque.Steal()) return job;
+		}
+		return nullptr;
+	}
+
+	Job* JobSystem::AllocateJob()
+	{
+		Worker& worker = GetCurrentWorker();
+		Job* job = &worker.job_pool[worker.allocated_jobs++ & (MAX_JOB_COUNT - 1)];
+		//ring slot is still referenced by an unfinished job, help out until it is released
+		while (job->in_use.load(std::memory_order_acquire))
+		{
+			if (!ExecuteNext()) std::this_thread::yield();
+		}
+		job->in_use.store(true, std::memory_order_relaxed);
+		return job;
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		job->function(job->storage);
+		Finish(job);
+	}
+
+	void JobSystem::Finish(Job* job)
+	{
+		Int32 const unfinished_jobs = job->unfinished_jobs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+		if (unfinished_jobs != 0) return;
+
+		Job* parent = job->parent;
+		JobCounter* counter = job->counter;
+		job->in_use.store(false, std::memory_order_release);
+
+		if (parent) Finish(parent);
+		if (counter) counter->value.fetch_sub(1, std::memory_order_release);
+	}
+
+	JobSystem::Worker& JobSystem::GetCurrentWorker()
+	{
+		ADRIA_ASSERT_MSG(tls_worker_index < worker_count, "Jobs can only be scheduled from the main thread or worker threads!");
+		return workers[tls_worker_index];
+	}
+
+}
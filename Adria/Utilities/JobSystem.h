@@ -0,0 +1,228 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "Singleton.h"
+
+namespace adria
+{
+	struct Job;
+
+	struct JobCounter
+	{
+		std::atomic<Uint32> value = 0;
+
+		Bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+	};
+
+	struct alignas(64) Job
+	{
+		static constexpr Uint64 STORAGE_SIZE = 64;
+		using JobFunction = void(*)(void*);
+
+		alignas(std::max_align_t) std::byte storage[STORAGE_SIZE];
+		JobFunction function = nullptr;
+		Job* parent = nullptr;
+		JobCounter* counter = nullptr;
+		std::atomic<Int32> unfinished_jobs = 0;
+		std::atomic<Bool> in_use = false;
+	};
+
+	//Chase-Lev work-stealing deque. Push and Pop are called only by the owning worker, Steal by everyone else.
+	class JobDeque
+	{
+	public:
+		static constexpr Int64 CAPACITY = 4096;
+		static constexpr Int64 MASK = CAPACITY - 1;
+		static_assert((CAPACITY & MASK) == 0, "Job deque capacity has to be a power of two!");
+
+	public:
+		void Push(Job* job)
+		{
+			Int64 b = bottom.load(std::memory_order_relaxed);
+			jobs[b & MASK].store(job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		Job* Pop()
+		{
+			Int64 b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			Int64 t = top.load(std::memory_order_relaxed);
+
+			if (t > b)
+			{
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* job = jobs[b & MASK].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				//last job in the deque, race against stealers
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job* Steal()
+		{
+			Int64 t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			Int64 b = bottom.load(std::memory_order_acquire);
+			if (t >= b) return nullptr;
+
+			Job* job = jobs[t & MASK].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+			return job;
+		}
+
+		Int64 Size() const
+		{
+			Int64 b = bottom.load(std::memory_order_relaxed);
+			Int64 t = top.load(std::memory_order_relaxed);
+			return b >= t ? b - t : 0;
+		}
+
+	private:
+		alignas(64) std::atomic<Int64> top = 0;
+		alignas(64) std::atomic<Int64> bottom = 0;
+		alignas(64) std::atomic<Job*> jobs[CAPACITY];
+	};
+
+	class JobSystem : public Singleton<JobSystem>
+	{
+		friend class Singleton<JobSystem>;
+
+		static constexpr Uint32 MAX_JOB_COUNT = JobDeque::CAPACITY;
+		static constexpr Uint32 INVALID_WORKER_INDEX = static_cast<Uint32>(-1);
+
+		struct Worker
+		{
+			JobDeque deque;
+			std::unique_ptr<Job[]> job_pool;
+			Uint32 allocated_jobs = 0;
+			Uint32 random_state = 0;
+		};
+
+	public:
+
+		void Initialize(Uint32 thread_count = 0);
+		void Destroy();
+
+		//calling thread is the main thread and always counts as worker 0
+		Uint32 GetWorkerCount() const { return worker_count; }
+
+		template<typename F>
+		Job* CreateJob(F&& f)
+		{
+			return CreateJobImpl(nullptr, std::forward<F>(f));
+		}
+
+		template<typename F>
+		Job* CreateChildJob(Job* parent, F&& f)
+		{
+			ADRIA_ASSERT(parent != nullptr);
+			parent->unfinished_jobs.fetch_add(1, std::memory_order_relaxed);
+			return CreateJobImpl(parent, std::forward<F>(f));
+		}
+
+		void Run(Job* job, JobCounter* counter = nullptr);
+
+		template<typename F>
+		void Submit(F&& f, JobCounter& counter)
+		{
+			Run(CreateJob(std::forward<F>(f)), &counter);
+		}
+
+		void Wait(JobCounter const& counter);
+
+		//F is either void(Uint32 index) or void(Uint32 begin, Uint32 end)
+		template<typename F>
+		void ParallelFor(Uint32 count, Uint32 grain, F&& f)
+		{
+			if (count == 0) return;
+			if (grain == 0) grain = 1;
+
+			if (count <= grain || worker_count <= 1)
+			{
+				InvokeRange(f, 0, count);
+				return;
+			}
+
+			JobCounter counter{};
+			for (Uint32 begin = grain; begin < count; begin += grain)
+			{
+				Uint32 const end = (std::min)(begin + grain, count);
+				Submit([&f, begin, end]() { InvokeRange(f, begin, end); }, counter);
+			}
+			InvokeRange(f, 0, grain);
+			Wait(counter);
+		}
+
+		JobSystem(JobSystem const&) = delete;
+		JobSystem(JobSystem&&) = delete;
+		JobSystem& operator=(JobSystem const&) = delete;
+		JobSystem& operator=(JobSystem&&) = delete;
+
+	private:
+		std::vector<std::thread> threads;
+		std::unique_ptr<Worker[]> workers;
+		Uint32 worker_count = 0;
+
+		std::atomic<Bool> done = false;
+		std::atomic<Uint32> pending_jobs = 0;
+		std::atomic<Uint32> sleeping_threads = 0;
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+
+	private:
+		JobSystem() = default;
+		~JobSystem() = default;
+
+		void ThreadWork(Uint32 worker_index);
+		Bool ExecuteNext();
+		Job* GetJob();
+		Job* AllocateJob();
+		void Execute(Job* job);
+		void Finish(Job* job);
+		Worker& GetCurrentWorker();
+
+		template<typename F>
+		Job* CreateJobImpl(Job* parent, F&& f)
+		{
+			using Fn = std::decay_t<F>;
+			static_assert(sizeof(Fn) <= Job::STORAGE_SIZE, "Job callable is too large for the inline storage!");
+			static_assert(alignof(Fn) <= alignof(std::max_align_t), "Job callable is over-aligned!");
+			static_assert(std::is_invocable_v<Fn&>, "Job callable has to be invocable without arguments!");
+
+			Job* job = AllocateJob();
+			new (job->storage) Fn(std::forward<F>(f));
+			job->function = [](void* storage)
+			{
+				Fn* fn = std::launder(reinterpret_cast<Fn*>(storage));
+				(*fn)();
+				fn->~Fn();
+			};
+			job->parent = parent;
+			job->counter = nullptr;
+			job->unfinished_jobs.store(1, std::memory_order_relaxed);
+			return job;
+		}
+
+		template<typename F>
+		static void InvokeRange(F& f, Uint32 begin, Uint32 end)
+		{
+			if constexpr (std::is_invocable_v<F&, Uint32, Uint32>) f(begin, end);
+			else for (Uint32 i = begin; i < end; ++i) f(i);
+		}
+	};
+	#define g_JobSystem JobSystem::Get()
+}
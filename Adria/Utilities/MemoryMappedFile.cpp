@@ -0,0 +1,28 @@
+#include "MemoryMappedFile.h"
+#include "StringUtil.h"
+
+namespace adria
+{
+	MemoryMappedFile::MemoryMappedFile(std::string const& path)
+	{
+		file = CreateFileW(ToWideString(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER file_size{};
+		//empty files can't be mapped
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) return;
+
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) return;
+
+		data = static_cast<Uint8 const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (data) size = static_cast<Uint64>(file_size.QuadPart);
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	}
+}
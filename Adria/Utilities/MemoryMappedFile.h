@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+namespace adria
+{
+	//read only mapping of a whole file, views into Data() stay valid as long as the object lives
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile() = default;
+		explicit MemoryMappedFile(std::string const& path);
+		MemoryMappedFile(MemoryMappedFile const&) = delete;
+		MemoryMappedFile& operator=(MemoryMappedFile const&) = delete;
+		~MemoryMappedFile();
+
+		Bool IsValid() const { return data != nullptr; }
+		Uint8 const* Data() const { return data; }
+		Uint64 Size() const { return size; }
+
+	private:
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+		Uint8 const* data = nullptr;
+		Uint64 size = 0;
+	};
+}
@@ -76,15 +76,17 @@ namespace adria
 		{
 			if (Full()) return INVALID_OFFSET;
 
+			//padding in front of an aligned allocation is owned by the current frame like the allocation itself
+			OffsetType const aligned_tail = Align(tail, align);
 			if (tail >= head)
 			{
-				if (tail + size <= max_size)
+				if (aligned_tail + size <= max_size)
 				{
-					auto offset = tail;
-					tail += size;
-					used_size += size;
-					current_frame_size += size;
-					return offset + reserve;
+					OffsetType add_size = (aligned_tail - tail) + size;
+					tail = aligned_tail + size;
+					used_size += add_size;
+					current_frame_size += add_size;
+					return aligned_tail + reserve;
 				}
 				else if (size <= head)
 				{
@@ -96,13 +98,13 @@ namespace adria
 					return 0 + reserve;
 				}
 			}
-			else if (tail + size <= head)
+			else if (aligned_tail + size <= head)
 			{
-				auto offset = tail;
-				tail += size;
-				used_size += size;
-				current_frame_size += size;
-				return offset + reserve;
+				OffsetType add_size = (aligned_tail - tail) + size;
+				tail = aligned_tail + size;
+				used_size += add_size;
+				current_frame_size += add_size;
+				return aligned_tail + reserve;
 			}
 
 			return INVALID_OFFSET;
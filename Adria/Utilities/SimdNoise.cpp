@@ -0,0 +1,253 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "SimdNoise.h"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint64 SIMD_WIDTH = 4;
+		constexpr Uint32 PRIME_X = 501125321u;
+		constexpr Uint32 PRIME_Y = 1136930381u;
+		constexpr Float PERLIN_SCALE = 1.4247691104677813f;
+		constexpr Float SIMPLEX_SCALE = 99.83685446303647f;
+		constexpr Float SQRT3 = 1.7320508075688772935274463415059f;
+		constexpr Float F2 = 0.5f * (SQRT3 - 1);
+		constexpr Float G2 = (3 - SQRT3) / 6;
+
+		//same layout as FastNoiseLite's 2D gradient lookup: 24 directions repeated five times, then 8 diagonals
+		struct Gradients2D
+		{
+			Float values[256];
+
+			Gradients2D()
+			{
+				constexpr Float64 DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+				for (Uint32 i = 0; i < 120; ++i)
+				{
+					Float64 const angle = (7.5 + 15.0 * (i % 24)) * DEG_TO_RAD;
+					values[2 * i] = (Float)std::sin(angle);
+					values[2 * i + 1] = (Float)std::cos(angle);
+				}
+				for (Uint32 i = 0; i < 8; ++i)
+				{
+					Float64 const angle = (22.5 + 45.0 * i) * DEG_TO_RAD;
+					values[240 + 2 * i] = (Float)std::sin(angle);
+					values[240 + 2 * i + 1] = (Float)std::cos(angle);
+				}
+			}
+		};
+		Gradients2D const gradients{};
+
+		inline Float GradCoord(Int32 seed, Uint32 x_primed, Uint32 y_primed, Float xd, Float yd)
+		{
+			Uint32 hash = ((Uint32)seed ^ x_primed ^ y_primed) * 0x27d4eb2du;
+			hash ^= hash >> 15;
+			hash &= 127 << 1;
+			return xd * gradients.values[hash] + yd * gradients.values[hash | 1];
+		}
+
+		//FastNoiseLite's FastFloor, including its behavior for negative integers
+		inline XMVECTOR XM_CALLCONV FastFloor(FXMVECTOR f)
+		{
+			XMVECTOR const truncated = XMVectorTruncate(f);
+			return XMVectorSelect(XMVectorSubtract(truncated, XMVectorSplatOne()), truncated, XMVectorGreaterOrEqual(f, XMVectorZero()));
+		}
+
+		inline XMVECTOR XM_CALLCONV InterpQuintic(FXMVECTOR t)
+		{
+			XMVECTOR const t3 = XMVectorMultiply(XMVectorMultiply(t, t), t);
+			XMVECTOR inner = XMVectorSubtract(XMVectorMultiply(t, XMVectorReplicate(6.0f)), XMVectorReplicate(15.0f));
+			inner = XMVectorAdd(XMVectorMultiply(t, inner), XMVectorReplicate(10.0f));
+			return XMVectorMultiply(t3, inner);
+		}
+
+		inline XMVECTOR XM_CALLCONV Lerp(FXMVECTOR a, FXMVECTOR b, FXMVECTOR t)
+		{
+			return XMVectorAdd(a, XMVectorMultiply(t, XMVectorSubtract(b, a)));
+		}
+
+		inline void XM_CALLCONV ToPrimed(FXMVECTOR floored, Uint32 prime, Uint32 (&out)[SIMD_WIDTH])
+		{
+			XMFLOAT4 f;
+			XMStoreFloat4(&f, floored);
+			out[0] = (Uint32)(Int32)f.x * prime;
+			out[1] = (Uint32)(Int32)f.y * prime;
+			out[2] = (Uint32)(Int32)f.z * prime;
+			out[3] = (Uint32)(Int32)f.w * prime;
+		}
+
+		//hashing and the gradient table gather stay scalar per lane, the rest runs four wide
+		XMVECTOR XM_CALLCONV SinglePerlin(Int32 seed, FXMVECTOR x, FXMVECTOR y)
+		{
+			XMVECTOR const x_floor = FastFloor(x);
+			XMVECTOR const y_floor = FastFloor(y);
+			XMVECTOR const xd0 = XMVectorSubtract(x, x_floor);
+			XMVECTOR const yd0 = XMVectorSubtract(y, y_floor);
+			XMVECTOR const xd1 = XMVectorSubtract(xd0, XMVectorSplatOne());
+			XMVECTOR const yd1 = XMVectorSubtract(yd0, XMVectorSplatOne());
+			XMVECTOR const xs = InterpQuintic(xd0);
+			XMVECTOR const ys = InterpQuintic(yd0);
+
+			Uint32 x0[SIMD_WIDTH], y0[SIMD_WIDTH];
+			ToPrimed(x_floor, PRIME_X, x0);
+			ToPrimed(y_floor, PRIME_Y, y0);
+
+			XMFLOAT4A xd0_, xd1_, yd0_, yd1_;
+			XMStoreFloat4A(&xd0_, xd0); XMStoreFloat4A(&xd1_, xd1);
+			XMStoreFloat4A(&yd0_, yd0); XMStoreFloat4A(&yd1_, yd1);
+			Float const* xd0_lanes = &xd0_.x; Float const* xd1_lanes = &xd1_.x;
+			Float const* yd0_lanes = &yd0_.x; Float const* yd1_lanes = &yd1_.x;
+
+			alignas(16) Float g00[SIMD_WIDTH], g10[SIMD_WIDTH], g01[SIMD_WIDTH], g11[SIMD_WIDTH];
+			for (Uint64 lane = 0; lane < SIMD_WIDTH; ++lane)
+			{
+				Uint32 const x1 = x0[lane] + PRIME_X;
+				Uint32 const y1 = y0[lane] + PRIME_Y;
+				g00[lane] = GradCoord(seed, x0[lane], y0[lane], xd0_lanes[lane], yd0_lanes[lane]);
+				g10[lane] = GradCoord(seed, x1, y0[lane], xd1_lanes[lane], yd0_lanes[lane]);
+				g01[lane] = GradCoord(seed, x0[lane], y1, xd0_lanes[lane], yd1_lanes[lane]);
+				g11[lane] = GradCoord(seed, x1, y1, xd1_lanes[lane], yd1_lanes[lane]);
+			}
+
+			XMVECTOR const xf0 = Lerp(XMLoadFloat4A((XMFLOAT4A const*)g00), XMLoadFloat4A((XMFLOAT4A const*)g10), xs);
+			XMVECTOR const xf1 = Lerp(XMLoadFloat4A((XMFLOAT4A const*)g01), XMLoadFloat4A((XMFLOAT4A const*)g11), xs);
+			return XMVectorMultiply(Lerp(xf0, xf1, ys), XMVectorReplicate(PERLIN_SCALE));
+		}
+
+		//expects coordinates that are already skewed
+		XMVECTOR XM_CALLCONV SingleSimplex(Int32 seed, FXMVECTOR x, FXMVECTOR y)
+		{
+			XMVECTOR const zero = XMVectorZero();
+			XMVECTOR const half = XMVectorReplicate(0.5f);
+			XMVECTOR const g2 = XMVectorReplicate(G2);
+
+			XMVECTOR const i_floor = FastFloor(x);
+			XMVECTOR const j_floor = FastFloor(y);
+			XMVECTOR const xi = XMVectorSubtract(x, i_floor);
+			XMVECTOR const yi = XMVectorSubtract(y, j_floor);
+
+			XMVECTOR const t = XMVectorMultiply(XMVectorAdd(xi, yi), g2);
+			XMVECTOR const x0 = XMVectorSubtract(xi, t);
+			XMVECTOR const y0 = XMVectorSubtract(yi, t);
+
+			XMVECTOR const a = XMVectorSubtract(XMVectorSubtract(half, XMVectorMultiply(x0, x0)), XMVectorMultiply(y0, y0));
+			XMVECTOR const c = XMVectorAdd(XMVectorMultiply(XMVectorReplicate((Float)(2 * (1 - 2 * G2) * (1 / G2 - 2))), t),
+										   XMVectorAdd(XMVectorReplicate((Float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))), a));
+			XMVECTOR const x2 = XMVectorAdd(x0, XMVectorReplicate(2 * G2 - 1));
+			XMVECTOR const y2 = XMVectorAdd(y0, XMVectorReplicate(2 * G2 - 1));
+
+			XMVECTOR const upper = XMVectorGreater(y0, x0);
+			XMVECTOR const x1 = XMVectorAdd(x0, XMVectorSelect(XMVectorReplicate(G2 - 1), g2, upper));
+			XMVECTOR const y1 = XMVectorAdd(y0, XMVectorSelect(g2, XMVectorReplicate(G2 - 1), upper));
+			XMVECTOR const b = XMVectorSubtract(XMVectorSubtract(half, XMVectorMultiply(x1, x1)), XMVectorMultiply(y1, y1));
+
+			Uint32 i[SIMD_WIDTH], j[SIMD_WIDTH];
+			ToPrimed(i_floor, PRIME_X, i);
+			ToPrimed(j_floor, PRIME_Y, j);
+
+			XMFLOAT4A x0_, y0_, x1_, y1_, x2_, y2_;
+			XMStoreFloat4A(&x0_, x0); XMStoreFloat4A(&y0_, y0);
+			XMStoreFloat4A(&x1_, x1); XMStoreFloat4A(&y1_, y1);
+			XMStoreFloat4A(&x2_, x2); XMStoreFloat4A(&y2_, y2);
+			Float const* x0_lanes = &x0_.x; Float const* y0_lanes = &y0_.x;
+			Float const* x1_lanes = &x1_.x; Float const* y1_lanes = &y1_.x;
+			Float const* x2_lanes = &x2_.x; Float const* y2_lanes = &y2_.x;
+
+			alignas(16) Float grad0[SIMD_WIDTH], grad1[SIMD_WIDTH], grad2[SIMD_WIDTH];
+			for (Uint64 lane = 0; lane < SIMD_WIDTH; ++lane)
+			{
+				Bool const upper_lane = y0_lanes[lane] > x0_lanes[lane];
+				grad0[lane] = GradCoord(seed, i[lane], j[lane], x0_lanes[lane], y0_lanes[lane]);
+				grad1[lane] = upper_lane ? GradCoord(seed, i[lane], j[lane] + PRIME_Y, x1_lanes[lane], y1_lanes[lane])
+										 : GradCoord(seed, i[lane] + PRIME_X, j[lane], x1_lanes[lane], y1_lanes[lane]);
+				grad2[lane] = GradCoord(seed, i[lane] + PRIME_X, j[lane] + PRIME_Y, x2_lanes[lane], y2_lanes[lane]);
+			}
+
+			auto Falloff = [zero](FXMVECTOR w, FXMVECTOR grad)
+			{
+				XMVECTOR const w2 = XMVectorMultiply(w, w);
+				return XMVectorSelect(zero, XMVectorMultiply(XMVectorMultiply(w2, w2), grad), XMVectorGreater(w, zero));
+			};
+			XMVECTOR const n0 = Falloff(a, XMLoadFloat4A((XMFLOAT4A const*)grad0));
+			XMVECTOR const n1 = Falloff(b, XMLoadFloat4A((XMFLOAT4A const*)grad1));
+			XMVECTOR const n2 = Falloff(c, XMLoadFloat4A((XMFLOAT4A const*)grad2));
+			return XMVectorMultiply(XMVectorAdd(XMVectorAdd(n0, n1), n2), XMVectorReplicate(SIMPLEX_SCALE));
+		}
+	}
+
+	SimdNoise::SimdNoise(NoiseDesc const& desc)
+		: simplex(desc.noise_type == NoiseType::OpenSimplex2 || desc.noise_type == NoiseType::Cellular),
+		  fbm(desc.fractal_type == FractalType::FBM),
+		  seed(desc.seed), frequency(desc.frequency), lacunarity(desc.lacunarity),
+		  gain(desc.persistence), octaves(desc.octaves)
+	{
+		ADRIA_ASSERT(IsSupported(desc));
+		Float const abs_gain = std::abs(gain);
+		Float amp = abs_gain;
+		Float amp_fractal = 1.0f;
+		for (Int32 i = 1; i < octaves; i++)
+		{
+			amp_fractal += amp;
+			amp *= abs_gain;
+		}
+		fractal_bounding = 1 / amp_fractal;
+	}
+
+	//Cellular is generated as OpenSimplex2 by Heightmap, so it takes the simplex path here as well
+	Bool SimdNoise::IsSupported(NoiseDesc const& desc)
+	{
+		Bool const noise_supported = desc.noise_type == NoiseType::Perlin || desc.noise_type == NoiseType::OpenSimplex2 || desc.noise_type == NoiseType::Cellular;
+		Bool const fractal_supported = desc.fractal_type == FractalType::None || desc.fractal_type == FractalType::FBM;
+		return noise_supported && fractal_supported;
+	}
+
+	void SimdNoise::GetNoiseRow(Float const* x, Float y, Float* out, Uint64 count) const
+	{
+		XMVECTOR const frequency_v = XMVectorReplicate(frequency);
+		XMVECTOR const lacunarity_v = XMVectorReplicate(lacunarity);
+		XMVECTOR const y_v = XMVectorMultiply(XMVectorReplicate(y), frequency_v);
+
+		for (Uint64 i = 0; i < count; i += SIMD_WIDTH)
+		{
+			Uint64 const lanes = std::min(SIMD_WIDTH, count - i);
+			XMFLOAT4 x_lanes(0.0f, 0.0f, 0.0f, 0.0f);
+			std::memcpy(&x_lanes, x + i, lanes * sizeof(Float));
+
+			XMVECTOR xv = XMVectorMultiply(XMLoadFloat4(&x_lanes), frequency_v);
+			XMVECTOR yv = y_v;
+			if (simplex)
+			{
+				XMVECTOR const t = XMVectorMultiply(XMVectorAdd(xv, yv), XMVectorReplicate(F2));
+				xv = XMVectorAdd(xv, t);
+				yv = XMVectorAdd(yv, t);
+			}
+
+			XMVECTOR result;
+			if (!fbm)
+			{
+				result = simplex ? SingleSimplex(seed, xv, yv) : SinglePerlin(seed, xv, yv);
+			}
+			else
+			{
+				result = XMVectorZero();
+				Float amp = fractal_bounding;
+				for (Int32 octave = 0; octave < octaves; ++octave)
+				{
+					XMVECTOR const noise = simplex ? SingleSimplex(seed + octave, xv, yv) : SinglePerlin(seed + octave, xv, yv);
+					result = XMVectorAdd(result, XMVectorMultiply(noise, XMVectorReplicate(amp)));
+					xv = XMVectorMultiply(xv, lacunarity_v);
+					yv = XMVectorMultiply(yv, lacunarity_v);
+					amp *= gain;
+				}
+			}
+
+			XMFLOAT4 result_lanes;
+			XMStoreFloat4(&result_lanes, result);
+			std::memcpy(out + i, &result_lanes, lanes * sizeof(Float));
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Heightmap.h"
+
+namespace adria
+{
+	//Evaluates 2D Perlin and OpenSimplex2 noise, optionally with FBM, four samples at a time.
+	//Matches FastNoiseLite::GetNoise for the same settings; other noise and fractal types are not supported.
+	class SimdNoise
+	{
+	public:
+		explicit SimdNoise(NoiseDesc const& desc);
+
+		static Bool IsSupported(NoiseDesc const& desc);
+
+		//out[i] = noise(x[i], y)
+		void GetNoiseRow(Float const* x, Float y, Float* out, Uint64 count) const;
+
+	private:
+		Bool simplex;
+		Bool fbm;
+		Int32 seed;
+		Float frequency;
+		Float lacunarity;
+		Float gain;
+		Int32 octaves;
+		Float fractal_bounding;
+	};
+}
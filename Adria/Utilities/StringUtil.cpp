@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <ostream>
+#include <cstdio>
 #include "StringUtil.h"
 
 namespace adria
@@ -170,5 +172,40 @@ namespace adria
 		tokens.push_back(text.substr(start));
 		return tokens;
 	}
-}
 
+	void WriteJsonString(std::ostream& os, Char const* string)
+	{
+		os.put('"');
+		for (Char const* c = string; *c; ++c)
+		{
+			switch (*c)
+			{
+			case '"':  os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if (static_cast<Uint8>(*c) < 0x20)
+				{
+					Char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<Uint8>(*c));
+					os << escaped;
+				}
+				else os.put(*c);
+			}
+		}
+		os.put('"');
+	}
+
+	void WriteCsvString(std::ostream& os, Char const* string)
+	{
+		//quotes inside a quoted field are doubled, commas and line breaks need no escaping
+		os.put('"');
+		for (Char const* c = string; *c; ++c)
+		{
+			if (*c == '"') os.put('"');
+			os.put(*c);
+		}
+		os.put('"');
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <iosfwd>
 
 namespace adria
 {
@@ -21,4 +22,8 @@ namespace adria
 	std::string BoolToString(Bool val);
 
 	std::vector<std::string> SplitString(std::string const& text, Char delimeter);
+
+	//quoted and escaped for a JSON or CSV file
+	void WriteJsonString(std::ostream& os, Char const* string);
+	void WriteCsvString(std::ostream& os, Char const* string);
 }
\ No newline at end of file
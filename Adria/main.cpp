@@ -4,7 +4,11 @@
 #include "Core/Window.h"
 #include "Core/Engine.h"
 #include "Core/Logger.h"
+#include "Core/Paths.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FrameBenchmark.h"
 #include "Editor/Editor.h"
+#include "Tests/TestRegistry.h"
 #include "Utilities/MemoryDebugger.h"
 #include "Utilities/CLIParser.h"
 
@@ -32,6 +36,11 @@ int APIENTRY wWinMain(
 	CLIArg& loglevel = parser.AddArg(true, "-loglvl", "--loglevel");
 	CLIArg& maximize = parser.AddArg(false, "-max", "--maximize");
 	CLIArg& vsync = parser.AddArg(false, "-vsync");
+	CLIArg& bake = parser.AddArg(false, "-bake");
+	CLIArg& bench_frame = parser.AddArg(true, "-bench_frame");
+	CLIArg& cpu_capture = parser.AddArg(true, "-cpu_capture");
+	CLIArg& test = parser.AddArg(true, "-test");
+	CLIArg& bench = parser.AddArg(true, "-bench");
 
 	parser.Parse(lpCmdLine);
     {
@@ -47,14 +56,41 @@ int APIENTRY wWinMain(
 		std::string window_title = title.AsStringOr("Adria");
 		window_init.title = window_title.c_str();
 		window_init.maximize = maximize;
+		window_init.hidden = bench_frame.IsPresent() || test.IsPresent() || bench.IsPresent();
 		Window window(window_init);
 		g_Input.Initialize(&window);
+		//started before the engine so that the capture includes startup
+		if (cpu_capture.IsPresent()) g_CpuProfiler.StartCapture(cpu_capture.AsIntOr(1), paths::SavedDir + "CpuTrace.json");
+
+		//in-engine tests and benchmarks, the argument is a name prefix or "all"
+		if (test.IsPresent() || bench.IsPresent())
+		{
+			ADRIA_REGISTER_LOGGER(new OutputStreamLogger(false, static_cast<LogLevel>(log_level)));
+			Uint32 failed_count = 0;
+			if (test.IsPresent()) failed_count += g_TestRegistry.Run(TestKind::Test, test.AsString(), &window);
+			if (bench.IsPresent()) failed_count += g_TestRegistry.Run(TestKind::Benchmark, bench.AsString(), &window);
+			return static_cast<int>(failed_count);
+		}
 
         EngineInit engine_init{};
         engine_init.vsync = vsync;
+        engine_init.bake_models = bake;
 		engine_init.window = &window;
         engine_init.scene_file = scene.AsStringOr("sponza.json");
 
+		//headless CPU frame benchmark: renders the scene with the null device and logs per frame and per pass timings
+		if (bench_frame.IsPresent())
+		{
+			ADRIA_REGISTER_LOGGER(new OutputStreamLogger(false, static_cast<LogLevel>(log_level)));
+			engine_init.headless = true;
+			Engine engine(engine_init);
+			FrameBenchmark benchmark(engine);
+			FrameBenchmarkReport report = benchmark.Run(RendererSettings{}, bench_frame.AsIntOr(500));
+			FrameBenchmark::Log(report);
+			FrameBenchmark::WriteStream(report, paths::SavedDir + "BenchFrame.cmds");
+			return 0;
+		}
+
         EditorInit editor_init{};
         editor_init.engine_init = std::move(engine_init);
 
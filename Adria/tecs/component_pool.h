@@ -14,27 +14,85 @@ class component_pool : public sparse_set
     using component_type = C;
     using size_type = base_type::size_type;
 
+public:
+    using tick_type = uint64_t;
+
 public:
     virtual void remove(entity e) override
     {
         using std::swap;
         auto index = base_type::index(e);
         swap(components[index], components.back());
+        swap(versions[index], versions.back());
         components.pop_back();
+        versions.pop_back();
+        //the last component moved into the hole, consumers indexing by position have to see it as changed
+        ++current_tick;
+        if (index < versions.size()) versions[index] = current_tick;
         base_type::remove(e);
     }
 
     virtual void clear() override
     {
         components.clear();
+        versions.clear();
+        ++current_tick;
         base_type::clear();
     }
 
+    virtual void compact() override
+    {
+        components.shrink_to_fit();
+        versions.shrink_to_fit();
+        base_type::compact();
+    }
+
+    virtual void swap_positions(size_type lhs, size_type rhs) override
+    {
+        using std::swap;
+        swap(components[lhs], components[rhs]);
+        if (lhs != rhs) versions[lhs] = versions[rhs] = ++current_tick;
+        base_type::swap_positions(lhs, rhs);
+    }
+
     size_type size() const
     {
         return components.size();
     }
 
+    component_type* data()
+    {
+        return components.data();
+    }
+
+    component_type const* data() const
+    {
+        return components.data();
+    }
+
+    //increases on every emplace, replace, update, touch and remove
+    tick_type tick() const
+    {
+        return current_tick;
+    }
+
+    //tick of the last change of the component of e
+    tick_type version(entity e) const
+    {
+        return versions[base_type::index(e)];
+    }
+
+    bool changed_since(entity e, tick_type since) const
+    {
+        return versions[base_type::index(e)] > since;
+    }
+
+    //marks the component of e as changed after it was written through a reference
+    void touch(entity e)
+    {
+        versions[base_type::index(e)] = ++current_tick;
+    }
+
     component_type const& get(entity e) const
     {
         return components[base_type::index(e)];
@@ -62,6 +120,7 @@ public:
     {
         if constexpr (std::is_aggregate_v<component_type>)  components.push_back(component_type{ std::forward<Args>(args)... });
         else components.emplace_back(std::forward<Args>(args)...);
+        versions.push_back(++current_tick);
         base_type::emplace(e);
     }
 
@@ -69,6 +128,7 @@ public:
     {
         assert(!contains(e));
         components.push_back(c);
+        versions.push_back(++current_tick);
         base_type::emplace(e);
     }
 
@@ -78,6 +138,7 @@ public:
         assert(contains(e));
         auto&& component = components[base_type::index(e)];
         component = component_type(std::forward<Args>(args)...);
+        touch(e);
     }
 
     void replace(entity e, component_type const& c)
@@ -85,6 +146,7 @@ public:
         assert(contains(e));
         auto&& component = components[base_type::index(e)];
         component = c;
+        touch(e);
     }
 
     template<typename... F> requires (component_updater<component_type, F> && ...)
@@ -92,12 +154,15 @@ public:
     {
         auto&& component = components[base_type::index(e)];
         (std::forward<F>(func)(component), ...);
+        touch(e);
         return component;
     }
 
 
 private:
     std::vector<component_type> components;
+    std::vector<tick_type> versions;
+    tick_type current_tick = 0;
 };
 
 }
\ No newline at end of file
@@ -26,7 +26,7 @@ namespace adria::tecs
         return static_cast<underlying_type>(e);
     }
 
-    inline constexpr version_type get_index(entity e)
+    inline constexpr index_type get_index(entity e)
     {
         auto integer = as_integer(e);
 
@@ -44,7 +44,7 @@ namespace adria::tecs
     {
         auto integer = as_integer(e);
 
-        return std::make_pair(static_cast<index_type>(integer), static_cast<version_type>(integer << 32));
+        return std::make_pair(static_cast<index_type>(integer), static_cast<version_type>(integer >> 32));
     }
 
     inline constexpr entity null_entity = make_entity(static_cast<index_type>(-1));
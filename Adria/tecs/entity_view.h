@@ -1,5 +1,6 @@
 #pragma once
 #include "component_pool.h"
+#include "parallel.h"
 #include <tuple>
 #include <array>
 #include <algorithm>
@@ -21,6 +22,12 @@ namespace adria::tecs
     template <typename F>
     concept valid_each_function = requires(entity e, F&& f) { { f(e) } ->std::same_as<void>; };
 
+    template <typename F, typename... Cs>
+    concept valid_component_each_function = requires(entity e, Cs&... cs, F && f) { { f(e, cs...) } ->std::same_as<void>; };
+
+    //entities per chunk when par_each is called without a grain
+    inline constexpr size_t default_grain = 256;
+
     template<typename... Cs>
     class entity_view
     {
@@ -132,6 +139,7 @@ namespace adria::tecs
         using size_type = size_t;
         using iterator = view_iterator<sparse_set::const_iterator>;
         using reverse_iterator = view_iterator<sparse_set::const_reverse_iterator>;
+        using chunk = view_chunk<iterator>;
 
     public:
 
@@ -177,6 +185,50 @@ namespace adria::tecs
             for (auto& entity : *this) f(entity);
         }
 
+        //f(e) or f(e, Cs&...) for the entities whose C changed after the tick since, see registry::tick
+        template <typename C, typename F> requires valid_each_function<F> || valid_component_each_function<F, Cs...>
+        void each_changed(uint64_t since, F&& f)
+        {
+            static_assert(details::contains<C, Cs...>);
+            auto const* changed_pool = std::get<component_pool<C>*>(pools);
+            for (auto e : *this)
+            {
+                if (!changed_pool->changed_since(e, since)) continue;
+                if constexpr (valid_component_each_function<F, Cs...>) f(e, std::get<component_pool<Cs>*>(pools)->get(e)...);
+                else f(e);
+            }
+        }
+
+        //Splits the driving (smallest) set into chunks of grain candidates. Chunks can hold fewer entities
+        //than grain since candidates missing one of the other components are skipped.
+        std::vector<chunk> split(size_type grain = default_grain) const
+        {
+            auto const unchecked = get_unchecked(view);
+            auto const first = view->begin();
+            return split_chunks<chunk>(view->size(), grain, [&](size_type begin, size_type end)
+                {
+                    return chunk(iterator(first + begin, first + end, first + begin, unchecked), iterator(first + begin, first + end, first + end, unchecked));
+                });
+        }
+
+        //f(e) or f(e, Cs&...) is called concurrently from several threads, it may only touch the components of e
+        template <typename F> requires valid_each_function<F> || valid_component_each_function<F, Cs...>
+        void par_each(F&& f, size_type grain = default_grain)
+        {
+            auto const unchecked = get_unchecked(view);
+            sparse_set const* driving = view;
+            parallel_for(driving->size(), grain, [&](size_type begin, size_type end)
+                {
+                    for (size_type i = begin; i < end; ++i)
+                    {
+                        entity const e = (*driving)[i];
+                        if (!std::all_of(unchecked.begin(), unchecked.end(), [e](sparse_set const* pool) { return pool->contains(e); })) continue;
+                        if constexpr (valid_component_each_function<F, Cs...>) f(e, std::get<component_pool<Cs>*>(pools)->get(e)...);
+                        else f(e);
+                    }
+                });
+        }
+
         template<typename... _Cs> requires (sizeof...(_Cs) != 1)
         decltype(auto) get(entity e) const
         {
@@ -215,6 +267,7 @@ namespace adria::tecs
         using size_type = size_t;
         using iterator = sparse_set::const_iterator;
         using reverse_iterator = sparse_set::const_reverse_iterator;
+        using chunk = view_chunk<iterator>;
 
     public:
 
@@ -262,6 +315,42 @@ namespace adria::tecs
             for (auto& entity : *this) f(entity);
         }
 
+        //f(e) or f(e, C&) for the entities whose component changed after the tick since, see registry::tick
+        template <typename F> requires valid_each_function<F> || valid_component_each_function<F, C>
+        void each_changed(uint64_t since, F&& f)
+        {
+            auto* pool = std::get<0>(pools);
+            if (pool->tick() <= since) return;
+            for (size_type i = 0; i < pool->size(); ++i)
+            {
+                entity const e = (*pool)[i];
+                if (!pool->changed_since(e, since)) continue;
+                if constexpr (valid_component_each_function<F, C>) f(e, pool->data()[i]);
+                else f(e);
+            }
+        }
+
+        std::vector<chunk> split(size_type grain = default_grain) const
+        {
+            auto const first = begin();
+            return split_chunks<chunk>(size(), grain, [first](size_type begin, size_type end) { return chunk(first + begin, first + end); });
+        }
+
+        //f(e) or f(e, C&) is called concurrently from several threads, it may only touch the component of e
+        template <typename F> requires valid_each_function<F> || valid_component_each_function<F, C>
+        void par_each(F&& f, size_type grain = default_grain)
+        {
+            auto* pool = std::get<0>(pools);
+            parallel_for(pool->size(), grain, [&](size_type begin, size_type end)
+                {
+                    for (size_type i = begin; i < end; ++i)
+                    {
+                        if constexpr (valid_component_each_function<F, C>) f((*pool)[i], pool->data()[i]);
+                        else f((*pool)[i]);
+                    }
+                });
+        }
+
         entity operator[](size_type pos) const
         {
             return begin()[pos];
@@ -280,7 +369,7 @@ namespace adria::tecs
 
         decltype(auto) get(entity e) const
         {
-            assert(contains(entity));
+            assert(contains(e));
             return const_cast<component_pool<component_type> const*>(std::get<0>(pools))->get(e);
         }
 
@@ -0,0 +1,133 @@
+#pragma once
+#include "entity_view.h"
+
+namespace adria::tecs
+{
+
+    //View over an owning group: the first size() entities of every owned pool are the group members, in the same order.
+    //Iteration walks the packed arrays linearly instead of probing the other pools for every candidate.
+    template<typename... Cs>
+    class group_view
+    {
+    public:
+        using size_type = size_t;
+        using iterator = sparse_set::const_iterator;
+        using reverse_iterator = sparse_set::const_reverse_iterator;
+        using chunk = view_chunk<iterator>;
+
+    public:
+        group_view() : pools{}, length{ nullptr }
+        {}
+
+        group_view(size_type const& group_size, component_pool<Cs>&... components)
+            : pools{ &components... }, length{ &group_size }
+        {}
+
+        explicit operator bool() const
+        {
+            return length != nullptr;
+        }
+
+        size_type size() const
+        {
+            return *length;
+        }
+
+        bool empty() const
+        {
+            return *length == 0;
+        }
+
+        bool contains(entity e) const
+        {
+            auto const* pool = std::get<0>(pools);
+            return pool->contains(e) && pool->index(e) < *length;
+        }
+
+        iterator begin() const
+        {
+            return std::get<0>(pools)->begin();
+        }
+
+        iterator end() const
+        {
+            return std::get<0>(pools)->begin() + *length;
+        }
+
+        reverse_iterator rbegin() const
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const
+        {
+            return reverse_iterator(begin());
+        }
+
+        entity operator[](size_type pos) const
+        {
+            assert(pos < *length);
+            return (*std::get<0>(pools))[pos];
+        }
+
+        template <typename F> requires valid_each_function<F> || valid_component_each_function<F, Cs...>
+        void each(F&& f)
+        {
+            auto const* first = std::get<0>(pools);
+            for (size_type i = 0; i < *length; ++i)
+            {
+                if constexpr (valid_component_each_function<F, Cs...>) f((*first)[i], std::get<component_pool<Cs>*>(pools)->data()[i]...);
+                else f((*first)[i]);
+            }
+        }
+
+        std::vector<chunk> split(size_type grain = default_grain) const
+        {
+            auto const first = begin();
+            return split_chunks<chunk>(*length, grain, [first](size_type begin, size_type end) { return chunk(first + begin, first + end); });
+        }
+
+        //f(e) or f(e, Cs&...) is called concurrently from several threads, it may only touch the components of e
+        template <typename F> requires valid_each_function<F> || valid_component_each_function<F, Cs...>
+        void par_each(F&& f, size_type grain = default_grain)
+        {
+            auto const* first = std::get<0>(pools);
+            parallel_for(*length, grain, [&](size_type begin, size_type end)
+                {
+                    for (size_type i = begin; i < end; ++i)
+                    {
+                        if constexpr (valid_component_each_function<F, Cs...>) f((*first)[i], std::get<component_pool<Cs>*>(pools)->data()[i]...);
+                        else f((*first)[i]);
+                    }
+                });
+        }
+
+        template<typename... _Cs> requires (sizeof...(_Cs) != 1)
+        decltype(auto) get(entity e) const
+        {
+            static_assert(details::is_subset_of<std::tuple<std::remove_const_t<_Cs>...>, std::tuple<Cs...> >);
+            assert(contains(e));
+
+            //members share their position in every owned pool
+            auto const pos = std::get<0>(pools)->index(e);
+            if constexpr (sizeof...(_Cs) == 0)
+                return std::forward_as_tuple(std::get<component_pool<Cs>*>(pools)->data()[pos]...);
+            else
+                return std::forward_as_tuple(const_cast<_Cs&>(std::get<component_pool<std::remove_const_t<_Cs>>*>(pools)->data()[pos]) ...);
+        }
+
+        template<typename C>
+        decltype(auto) get(entity e) const
+        {
+            static_assert(details::contains<std::remove_const_t<C>, Cs...>);
+            assert(contains(e));
+
+            return (const_cast<C&>(std::get<component_pool<std::remove_const_t<C>>*>(pools)->get(e)));
+        }
+
+    private:
+        std::tuple<component_pool<Cs>*...> const pools;
+        size_type const* length;
+    };
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "sparse_set.h"
+
+namespace adria::tecs
+{
+
+    //Collects the entities that got (added) or lost (removed) a component until it is cleared. Every entity is listed once
+    //however often it changed, so an added entity can have lost the component again and a removed one can be destroyed by now.
+    //An entity whose index was recycled stays listed next to the new one, so a consumer sees the destroyed entity's removal too.
+    class observer
+    {
+        friend class registry;
+
+    public:
+        using size_type = sparse_set::size_type;
+        using iterator = std::vector<entity>::const_iterator;
+
+    public:
+        size_type size() const
+        {
+            return entities.size();
+        }
+
+        bool empty() const
+        {
+            return entities.empty();
+        }
+
+        bool contains(entity e) const
+        {
+            if (latest.contains(e)) return true;
+            //an older entity of a recycled index is only in the list
+            return latest.find(get_index(e)) != null_entity && std::find(entities.begin(), entities.end(), e) != entities.end();
+        }
+
+        iterator begin() const
+        {
+            return entities.begin();
+        }
+
+        iterator end() const
+        {
+            return entities.end();
+        }
+
+        void clear()
+        {
+            entities.clear();
+            latest.clear();
+        }
+
+    private:
+        std::vector<entity> entities;
+        sparse_set latest; //the newest listed entity of every index
+
+    private:
+        //versions only grow, so an entity that replaced another in latest is never notified again
+        void notify(entity e)
+        {
+            if (latest.contains(e)) return;
+            if (entity stale = latest.find(get_index(e)); stale != null_entity) latest.remove(stale);
+            latest.emplace(e);
+            entities.push_back(e);
+        }
+    };
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+namespace adria::tecs
+{
+
+    //body(context, begin, end) processes one chunk, chunks may run concurrently
+    using parallel_body = void(*)(void* context, size_t begin, size_t end);
+    //splits [0, count) into chunks of at most grain elements and returns after every chunk is done
+    using parallel_for_function = void(*)(size_t count, size_t grain, void* context, parallel_body body);
+
+    namespace details
+    {
+        inline parallel_for_function parallel_for_impl = nullptr;
+    }
+
+    //tecs has no threads of its own, the application plugs in its job system. Without one everything runs serially.
+    inline void set_parallel_for(parallel_for_function impl)
+    {
+        details::parallel_for_impl = impl;
+    }
+
+    template<typename F> requires std::is_invocable_v<F&, size_t, size_t>
+    void parallel_for(size_t count, size_t grain, F&& f)
+    {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        if (!details::parallel_for_impl || count <= grain)
+        {
+            f(size_t{ 0 }, count);
+            return;
+        }
+
+        using function_type = std::remove_reference_t<F>;
+        details::parallel_for_impl(count, grain, const_cast<void*>(static_cast<void const*>(&f)), [](void* context, size_t begin, size_t end)
+            {
+                (*static_cast<function_type*>(context))(begin, end);
+            });
+    }
+
+    //contiguous part of the packed array of a view's driving set
+    template<typename It>
+    class view_chunk
+    {
+    public:
+        view_chunk(It first, It last) : first{ first }, last{ last }
+        {}
+
+        It begin() const
+        {
+            return first;
+        }
+
+        It end() const
+        {
+            return last;
+        }
+
+    private:
+        It first;
+        It last;
+    };
+
+    template<typename Chunk, typename MakeChunk>
+    std::vector<Chunk> split_chunks(size_t count, size_t grain, MakeChunk&& make_chunk)
+    {
+        if (grain == 0) grain = 1;
+        std::vector<Chunk> chunks;
+        chunks.reserve((count + grain - 1) / grain);
+        for (size_t begin = 0; begin < count; begin += grain) chunks.push_back(make_chunk(begin, (std::min)(begin + grain, count)));
+        return chunks;
+    }
+
+}
@@ -1,5 +1,6 @@
 #pragma once
-#include "entity_view.h"
+#include "group_view.h"
+#include "observer.h"
 #include <memory>
 #include <deque>
 
@@ -10,6 +11,23 @@ namespace adria::tecs
 	{
 		using component_id_t = size_t;
 
+		//pools owned by a group keep the entities that have every owned component packed at their front
+		struct group_data
+		{
+			std::vector<sparse_set*> owned;
+			size_t size = 0;
+
+			bool contains_all(entity e) const
+			{
+				return std::all_of(owned.begin(), owned.end(), [e](sparse_set const* pool) { return pool->contains(e); });
+			}
+
+			bool is_member(entity e) const
+			{
+				return owned[0]->contains(e) && owned[0]->index(e) < size;
+			}
+		};
+
 		class component_id_generator
 		{
 			inline static component_id_t counter{};
@@ -54,6 +72,8 @@ namespace adria::tecs
 			return entities[i] = make_entity(i, v);
 		}
 
+		//a released slot stores the index of the next free slot and the version its next entity gets,
+		//so handles to the destroyed entity stop being valid once the slot is reused
 		void release_entity(entity e)
 		{
 			auto i = get_index(e);
@@ -61,15 +81,75 @@ namespace adria::tecs
 
 			entities[i] = make_entity(get_index(next), v + 1);
 			next = make_entity(i);
-
 		}
 
 		void remove_all(entity e)
 		{
 			assert(valid(e));
 
-			for (auto& pool : pools)
-				if (pool && pool->contains(e)) pool->remove(e);
+			for (component_id_t id = 0; id < pools.size(); ++id)
+			{
+				if (auto& pool = pools[id]; pool && pool->contains(e))
+				{
+					on_remove(id, e);
+					pool->remove(e);
+				}
+			}
+		}
+
+		group_data* owner_of(component_id_t id) const
+		{
+			return id < owners.size() ? owners[id] : nullptr;
+		}
+
+		static void notify(std::vector<std::vector<observer*>> const& table, component_id_t id, entity e)
+		{
+			if (id < table.size())
+				for (observer* o : table[id]) o->notify(e);
+		}
+
+		//moves e into the packed front of the group if it now has every owned component, observers are not notified
+		static void add_to_group(group_data* group, entity e)
+		{
+			if (!group || !group->contains_all(e) || group->is_member(e)) return;
+			for (sparse_set* pool : group->owned) pool->swap_positions(pool->index(e), group->size);
+			++group->size;
+		}
+
+		void on_emplace(component_id_t id, entity e)
+		{
+			notify(added_observers, id, e);
+			add_to_group(owner_of(id), e);
+		}
+
+		void on_remove(component_id_t id, entity e)
+		{
+			notify(removed_observers, id, e);
+			group_data* group = owner_of(id);
+			if (!group || !group->is_member(e)) return;
+			--group->size;
+			for (sparse_set* pool : group->owned) pool->swap_positions(pool->index(e), group->size);
+		}
+
+		observer& connect(std::vector<std::vector<observer*>>& table, component_id_t id)
+		{
+			if (id >= table.size()) table.resize(id + 1);
+			observer* o = observers.emplace_back(std::make_unique<observer>()).get();
+			table[id].push_back(o);
+			return *o;
+		}
+
+		template<typename C>
+		void on_emplace(entity e)
+		{
+			on_emplace(component_id_generator::template type<C>, e);
+		}
+
+		template<typename C>
+		void on_remove(entity e)
+		{
+			auto* pool = get_component_pool<C>();
+			if (pool->contains(e)) on_remove(component_id_generator::template type<C>, e);
 		}
 	public:
 		using size_type = size_t;
@@ -85,7 +165,7 @@ namespace adria::tecs
 		[[maybe_unused]]
 		entity create()
 		{
-			return generate_entity(); // next == null_entity ? generate_entity() : recycle_entity(); bug with recycle_entity
+			return next == null_entity ? generate_entity() : recycle_entity();
 		}
 
 		void destroy(entity e)
@@ -135,6 +215,14 @@ namespace adria::tecs
 			return pool ? pool->size() : size_type{ 0 };
 		}
 
+		//sparse pages allocated by the pool of C, released by compact once their entities are gone
+		template<typename C>
+		size_type page_count() const
+		{
+			auto const* pool = get_component_pool_if_exists<C>();
+			return pool ? pool->page_count() : size_type{ 0 };
+		}
+
 		template<typename... Cs>
 		bool empty() const
 		{
@@ -147,13 +235,37 @@ namespace adria::tecs
 		{
 			if constexpr (sizeof...(Cs) == 0)
 			{
-				for (auto& pool : pools)
-					if (pool) pool->clear();
-				for (auto e : entities) release_entity(e);
+				//pools are kept so that their ticks keep increasing for change tracking consumers
+				for (component_id_t id = 0; id < pools.size(); ++id)
+				{
+					if (auto& pool = pools[id]; pool)
+					{
+						for (entity e : *pool) notify(removed_observers, id, e);
+						pool->clear();
+						pool->compact();
+					}
+				}
 				entities.clear();
-				pools.clear();
+				next = null_entity;
+				//groups stay alive since group views refer to their size
+				for (auto& group : groups) group->size = 0;
 			}
-			else ([this](auto* pool) {pool->clear(); }(get_component_pool<Cs>()), ...);
+			else ([this]<typename C>(component_pool<C>* pool)
+			{
+				component_id_t const id = component_id_generator::template type<C>;
+				for (entity e : *pool) notify(removed_observers, id, e);
+				if (group_data* group = owner_of(id)) group->size = 0;
+				pool->clear();
+			}(get_component_pool<Cs>()), ...);
+		}
+
+		//releases memory left behind by destroyed entities: sparse pages without entities and unused capacity.
+		//free entity slots are kept since they remember the versions of the entities that used them.
+		void compact()
+		{
+			for (auto& pool : pools)
+				if (pool) pool->compact();
+			entities.shrink_to_fit();
 		}
 
 		template<typename... Cs>
@@ -201,6 +313,7 @@ namespace adria::tecs
 		{
 			assert(valid(e));
 			get_component_pool<std::remove_const_t<C>>()->emplace(e, std::forward<Args>(args)...);
+			on_emplace<std::remove_const_t<C>>(e);
 		}
 
 		template<typename C>
@@ -208,6 +321,7 @@ namespace adria::tecs
 		{
 			assert(valid(e));
 			get_component_pool<std::remove_const_t<C>>()->add(e, c);
+			on_emplace<std::remove_const_t<C>>(e);
 		}
 
 		template<typename C, typename... Args>
@@ -224,6 +338,60 @@ namespace adria::tecs
 			get_component_pool<std::remove_const_t<C>>()->replace(e, c);
 		}
 
+		//returns the component of e for writing and marks it as changed
+		template<typename C>
+		C& modify(entity e)
+		{
+			assert(valid(e));
+			auto* pool = get_component_pool<std::remove_const_t<C>>();
+			pool->touch(e);
+			return pool->get(e);
+		}
+
+		//marks the component of e as changed after it was written through a reference from get or a view
+		template<typename C>
+		void touch(entity e)
+		{
+			assert(valid(e));
+			get_component_pool<std::remove_const_t<C>>()->touch(e);
+		}
+
+		//increases on every change of a C component, including emplace and remove
+		template<typename C>
+		uint64_t tick() const
+		{
+			auto const* pool = get_component_pool_if_exists<std::remove_const_t<C>>();
+			return pool ? pool->tick() : 0;
+		}
+
+		template<typename C>
+		bool changed_since(entity e, uint64_t since) const
+		{
+			auto const* pool = get_component_pool_if_exists<std::remove_const_t<C>>();
+			assert(pool);
+			return pool->changed_since(e, since);
+		}
+
+		//the observer lives as long as the registry or until it is disconnected
+		template<typename C>
+		observer& on_added()
+		{
+			return connect(added_observers, component_id_generator::template type<std::remove_const_t<C>>);
+		}
+
+		template<typename C>
+		observer& on_removed()
+		{
+			return connect(removed_observers, component_id_generator::template type<std::remove_const_t<C>>);
+		}
+
+		void disconnect(observer& o)
+		{
+			for (auto* table : { &added_observers, &removed_observers })
+				for (auto& list : *table) std::erase(list, &o);
+			std::erase_if(observers, [&o](auto const& owned) { return owned.get() == &o; });
+		}
+
 		template<typename C, typename... F> requires (component_updater<C, F> && ...)
 		[[maybe_unused]] decltype(auto) update(entity e, F&&... func)
 		{
@@ -236,7 +404,7 @@ namespace adria::tecs
 		{
 			assert(valid(e));
 			if constexpr (sizeof...(Cs) == 0) remove_all(e);
-			else  (get_component_pool<std::remove_const_t<Cs>>()->remove(e), ...);
+			else  ((on_remove<std::remove_const_t<Cs>>(e), get_component_pool<std::remove_const_t<Cs>>()->remove(e)), ...);
 		}
 
 		template<typename C>
@@ -261,6 +429,19 @@ namespace adria::tecs
 			return [e](auto const*... pool) { return !((!pool || !pool->contains(e)) && ...); }(get_component_pool_if_exists<Cs>()...);
 		}
 
+		template<typename C>
+		static size_type type_id()
+		{
+			return component_id_generator::template type<std::remove_const_t<C>>;
+		}
+
+		//creates missing pools up front, views create them lazily which is not safe while other threads read the registry
+		template<typename... Cs>
+		void assure()
+		{
+			(get_component_pool<std::remove_const_t<Cs>>(), ...);
+		}
+
 		template<typename... Cs>
 		entity_view<Cs...> view()
 		{
@@ -268,10 +449,46 @@ namespace adria::tecs
 			return { *get_component_pool<std::remove_const_t<Cs>>()... };
 		}
 
+		//The group takes ownership of the pools of Cs, a pool can be owned by one group only.
+		//Later calls with the same components return a view of the existing group.
+		template<typename... Cs>
+		group_view<Cs...> group()
+		{
+			static_assert(sizeof...(Cs) > 1, "Group needs at least two component types!");
+			static_assert((std::same_as<Cs, std::decay_t<Cs>> && ...), "Non-decayed Component types are not allowed!");
+
+			std::array<component_id_t, sizeof...(Cs)> const ids{ component_id_generator::template type<Cs>... };
+			std::array<sparse_set*, sizeof...(Cs)> const owned{ get_component_pool<Cs>()... };
+			if (group_data* group = owner_of(ids[0]))
+			{
+				assert(group->owned.size() == sizeof...(Cs) && std::all_of(ids.begin(), ids.end(), [&](component_id_t id) { return owner_of(id) == group; }));
+				return { group->size, *get_component_pool<Cs>()... };
+			}
+			assert(std::none_of(ids.begin(), ids.end(), [this](component_id_t id) { return owner_of(id) != nullptr; }) && "Component pool is already owned by another group!");
+
+			auto& group = groups.emplace_back(std::make_unique<group_data>());
+			group->owned.assign(owned.begin(), owned.end());
+			for (component_id_t id : ids)
+			{
+				if (id >= owners.size()) owners.resize(id + 1, nullptr);
+				owners[id] = group.get();
+			}
+
+			sparse_set const* smallest = *std::min_element(owned.begin(), owned.end(), [](sparse_set const* lhs, sparse_set const* rhs) { return lhs->size() < rhs->size(); });
+			std::vector<entity> const candidates(smallest->begin(), smallest->end());
+			for (entity e : candidates) add_to_group(group.get(), e);
+			return { group->size, *get_component_pool<Cs>()... };
+		}
+
 	private:
 		std::vector<entity>	entities;
 		entity next = null_entity;
 		mutable std::vector<std::unique_ptr<sparse_set>> pools;
+		std::vector<group_data*> owners;
+		std::vector<std::unique_ptr<group_data>> groups;
+		std::vector<std::unique_ptr<observer>> observers;
+		std::vector<std::vector<observer*>> added_observers;
+		std::vector<std::vector<observer*>> removed_observers;
 
 	};
 
@@ -0,0 +1,158 @@
+#pragma once
+#include "registry.h"
+#include <string>
+#include <functional>
+
+namespace adria::tecs
+{
+
+    //Components a system reads and writes, declared before it runs. Two systems conflict when one of them
+    //writes a component the other one reads or writes, or when either of them changes the registry structure.
+    class access_set
+    {
+        struct access
+        {
+            size_t id;
+            bool write;
+            void(*assure)(registry&);
+        };
+
+    public:
+        template<typename... Cs>
+        access_set& read()
+        {
+            (add<Cs>(false), ...);
+            return *this;
+        }
+
+        template<typename... Cs>
+        access_set& write()
+        {
+            (add<Cs>(true), ...);
+            return *this;
+        }
+
+        //the system creates or destroys entities, or adds or removes components
+        access_set& structural()
+        {
+            structural_changes = true;
+            return *this;
+        }
+
+        bool conflicts_with(access_set const& other) const
+        {
+            if (structural_changes || other.structural_changes) return true;
+            for (access const& lhs : accesses)
+            {
+                for (access const& rhs : other.accesses)
+                {
+                    if (lhs.id == rhs.id && (lhs.write || rhs.write)) return true;
+                }
+            }
+            return false;
+        }
+
+        void assure(registry& reg) const
+        {
+            for (access const& a : accesses) a.assure(reg);
+        }
+
+    private:
+        std::vector<access> accesses;
+        bool structural_changes = false;
+
+    private:
+        template<typename C>
+        void add(bool write)
+        {
+            size_t const id = registry::type_id<C>();
+            for (access& a : accesses)
+            {
+                if (a.id == id)
+                {
+                    a.write = a.write || write;
+                    return;
+                }
+            }
+            accesses.push_back(access{ id, write, [](registry& reg) { reg.assure<C>(); } });
+        }
+    };
+
+    //Runs systems in batches: a system goes to the batch after the last earlier system it conflicts with,
+    //so conflicting systems keep their registration order and the systems of one batch run concurrently.
+    class system_scheduler
+    {
+        struct system
+        {
+            std::string name;
+            access_set access;
+            std::function<void()> function;
+            size_t batch;
+        };
+
+    public:
+        explicit system_scheduler(registry& reg) : reg{ reg }
+        {}
+
+        void add(std::string name, access_set const& access, std::function<void()> function)
+        {
+            size_t batch = 0;
+            for (system const& other : systems)
+            {
+                if (access.conflicts_with(other.access)) batch = (std::max)(batch, other.batch + 1);
+            }
+            if (batches.size() <= batch) batches.resize(batch + 1);
+            batches[batch].push_back(systems.size());
+            systems.push_back(system{ std::move(name), access, std::move(function), batch });
+        }
+
+        void clear()
+        {
+            systems.clear();
+            batches.clear();
+        }
+
+        void run()
+        {
+            //pools are created before any system runs so that concurrent views never resize the pool table
+            for (system const& s : systems) s.access.assure(reg);
+            for (auto const& batch : batches)
+            {
+                parallel_for(batch.size(), 1, [&](size_t begin, size_t end)
+                    {
+                        for (size_t i = begin; i < end; ++i) systems[batch[i]].function();
+                    });
+            }
+        }
+
+        size_t size() const
+        {
+            return systems.size();
+        }
+
+        size_t batch_count() const
+        {
+            return batches.size();
+        }
+
+        //pairs of systems that cannot run concurrently, the first one of each pair is registered first
+        std::vector<std::pair<std::string, std::string>> conflicts() const
+        {
+            std::vector<std::pair<std::string, std::string>> conflicting;
+            for (size_t i = 0; i < systems.size(); ++i)
+            {
+                for (size_t j = i + 1; j < systems.size(); ++j)
+                {
+                    if (systems[i].access.conflicts_with(systems[j].access)) conflicting.emplace_back(systems[i].name, systems[j].name);
+                }
+            }
+            return conflicting;
+        }
+
+    private:
+        registry& reg;
+        std::vector<system> systems;
+        std::vector<std::vector<size_t>> batches;
+    };
+
+}
@@ -1,15 +1,20 @@
 #pragma once
 #include "entity.h"
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 namespace adria::tecs
 {
 
+	//The sparse array is split into pages that are allocated when the first entity of their index range is added,
+	//so a few entities with large indices do not allocate positions for every smaller index.
 	class sparse_set
 	{
 	public:
 		using size_type = size_t;
+		static constexpr size_type page_size = 4096;
+		static constexpr size_type null_position = static_cast<size_type>(-1);
 		using iterator = std::vector<entity>::iterator;
 		using const_iterator = std::vector<entity>::const_iterator;
 		using reverse_iterator = std::vector<entity>::reverse_iterator;
@@ -39,34 +44,49 @@ namespace adria::tecs
 			auto index = get_index(e);
 
 			packed_array.push_back(e);
-
-			if (sparse_array.size() <= index)
-				sparse_array.resize(index + 1);
-
-			sparse_array[index] = pos;
+			assure_sparse(index) = pos;
 		}
 
 		bool contains(entity e) const
 		{
-			auto index = get_index(e);
+			auto const* pos = sparse_if(get_index(e));
 
-			return index < sparse_array.size() && sparse_array[index] < packed_array.size()
-				&& packed_array[sparse_array[index]] == e;
+			return pos && *pos < packed_array.size() && packed_array[*pos] == e;
 		}
 
 		virtual void remove(entity e)
 		{
 			if (!contains(e)) return;
-			auto index = as_integer(e);
-			auto last = as_integer(packed_array.back());
-			std::swap(packed_array.back(), packed_array[sparse_array[index]]);
-			std::swap(sparse_array[last], sparse_array[index]);
+			auto& pos = sparse(get_index(e));
+			auto const last = packed_array.back();
+			packed_array[pos] = last;
+			sparse(get_index(last)) = pos;
+			pos = null_position;
 			packed_array.pop_back();
 		}
 
 		virtual void clear()
 		{
 			packed_array.clear();
+			sparse_pages.clear();
+		}
+
+		//releases sparse pages without entities and unused capacity
+		virtual void compact()
+		{
+			for (auto& page : sparse_pages)
+			{
+				if (!page.empty() && std::all_of(page.begin(), page.end(), [](size_type pos) { return pos == null_position; }))
+					std::vector<size_type>{}.swap(page);
+			}
+			while (!sparse_pages.empty() && sparse_pages.back().empty()) sparse_pages.pop_back();
+			sparse_pages.shrink_to_fit();
+			packed_array.shrink_to_fit();
+		}
+
+		size_type page_count() const
+		{
+			return static_cast<size_type>(std::count_if(sparse_pages.begin(), sparse_pages.end(), [](auto const& page) { return !page.empty(); }));
 		}
 
 		entity at(size_type pos) const
@@ -74,6 +94,21 @@ namespace adria::tecs
 			return pos < packed_array.size() ? packed_array[pos] : null_entity;
 		}
 
+		//the entity stored for an index whatever its version, null_entity if there is none
+		entity find(index_type index) const
+		{
+			auto const* pos = sparse_if(index);
+			return pos && *pos < packed_array.size() ? packed_array[*pos] : null_entity;
+		}
+
+		//swaps the packed positions of two entities, derived pools move their components along
+		virtual void swap_positions(size_type lhs, size_type rhs)
+		{
+			assert(lhs < packed_array.size() && rhs < packed_array.size());
+			std::swap(sparse(get_index(packed_array[lhs])), sparse(get_index(packed_array[rhs])));
+			std::swap(packed_array[lhs], packed_array[rhs]);
+		}
+
 		entity operator[](size_type pos) const
 		{
 			assert(pos < packed_array.size());
@@ -83,7 +118,7 @@ namespace adria::tecs
 		size_type index(entity e) const
 		{
 			assert(contains(e));
-			return sparse_array[get_index(e)];
+			return *sparse_if(get_index(e));
 		}
 
 		iterator begin()
@@ -147,8 +182,30 @@ namespace adria::tecs
 		}
 
 	private:
-		std::vector<size_type>	sparse_array;
-		std::vector<entity>		packed_array;
+		std::vector<std::vector<size_type>>	sparse_pages;
+		std::vector<entity>					packed_array;
+
+	private:
+		size_type const* sparse_if(index_type index) const
+		{
+			auto const page = index / page_size;
+			if (page >= sparse_pages.size() || sparse_pages[page].empty()) return nullptr;
+			return &sparse_pages[page][index % page_size];
+		}
+
+		size_type& sparse(index_type index)
+		{
+			assert(sparse_if(index));
+			return sparse_pages[index / page_size][index % page_size];
+		}
+
+		size_type& assure_sparse(index_type index)
+		{
+			auto const page = index / page_size;
+			if (sparse_pages.size() <= page) sparse_pages.resize(page + 1);
+			if (sparse_pages[page].empty()) sparse_pages[page].assign(page_size, null_position);
+			return sparse_pages[page][index % page_size];
+		}
 	};
 
 }
\ No newline at end of file